@@ -76,6 +76,28 @@ uart_port_t ld2450_get_uart_port(void);
 void ld2450_rx_pause(void);
 void ld2450_rx_resume(void);
 
+/**
+ * UART receive counters for health monitoring.  Gaps are measured between
+ * frames while RX runs: a config session (RX paused) never counts as one,
+ * and the first frame after a resume is timed from the resume.
+ */
+typedef struct {
+    uint32_t bytes;            // parser counters, cumulative since boot
+    uint32_t frames;
+    uint32_t garbage_bytes;
+    uint32_t bad_frames;
+    uint32_t pauses;           // RX pauses (config sessions) since boot
+    bool     paused;           // RX is paused right now
+    uint32_t last_frame_ms;    // uptime of the last frame or RX resume, 0 = neither yet
+    uint32_t gap_max_ms;       // longest frame-to-frame gap since the last reset
+} ld2450_rx_stats_t;
+
+/**
+ * Copy out the RX counters.  reset_gap restarts gap_max_ms, so a poller
+ * sees the longest gap that ended since its previous call.
+ */
+esp_err_t ld2450_get_rx_stats(ld2450_rx_stats_t *out, bool reset_gap);
+
 /**
  * Block until the first valid data frame is received from the sensor.
  * Returns ESP_OK if frame received, ESP_ERR_TIMEOUT if timeout_ms elapsed.
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "esp_err.h"
+#include "ld2450_hw_filter.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -10,12 +11,55 @@
  *
  * All commands enter config mode, send the command, then exit config mode.
  * A mutex serializes access so callers don't need external locking.
+ * To change several settings, collect them in an ld2450_cmd_batch_t and
+ * run it: one enter/exit session and one RX pause for all of them.
+ *
+ * The module caches what the sensor holds (read back, or last written with
+ * a good ACK).  Commands the sensor already holds are not sent; a batch
+ * left empty opens no session and does not pause RX.  Bluetooth cannot be
+ * read back and is known only once written.
  *
  * NOTE: There is no dedicated "set max distance" or "set angle" command.
- * Distance/angle limiting is done via the hardware zone filter (0xC2).
- * Use ld2450_cmd_set_region() to configure a detection region that
- * implements the desired distance and angle limits.
+ * Distance/angle limiting is done via the hardware zone filter (0xC2),
+ * whose three rectangles ld2450_hw_filter_plan_range() fits to the
+ * detection sector (see ld2450_hw_filter.h).
+ */
+
+/** Largest command value (0xC2 zone filter payload) */
+#define LD2450_CMD_VALUE_MAX   26
+/** Commands per batch: Bluetooth, tracking mode, region, one spare */
+#define LD2450_CMD_BATCH_MAX   4
+
+/**
+ * Commands for one config-mode session, encoded when added.  Plain data:
+ * can be built on one task and run (or queued) on another.
  */
+typedef struct {
+    uint8_t count;
+    struct {
+        uint8_t cmd;
+        uint8_t len;
+        uint8_t value[LD2450_CMD_VALUE_MAX];
+    } item[LD2450_CMD_BATCH_MAX];
+} ld2450_cmd_batch_t;
+
+/** Sensor state as read back or last written (ld2450_cmd_get_sensor_info()). */
+typedef struct {
+    bool     fw_valid;
+    uint16_t fw_type;
+    uint16_t fw_major;          /* printed as V<hi>.<lo:02X>.<minor:08X> */
+    uint32_t fw_minor;
+    bool     mac_valid;
+    uint8_t  mac[6];
+    bool     region_valid;      /* zone_type/zone below are what the sensor holds */
+    uint16_t zone_type;         /* 0 = off, 1 = detect inside, 2 = exclude inside */
+    int16_t  zone[3][4];        /* x1, y1, x2, y2 per slot, mm */
+    int8_t   tracking;          /* 1 = single, 0 = multi, -1 = unknown */
+    int8_t   bluetooth;         /* 1 = on, 0 = off, -1 = unknown (no read command) */
+    uint32_t sessions;          /* config-mode sessions (RX pauses) since boot */
+    uint32_t skipped;           /* commands not sent: the sensor already held the value */
+    uint32_t drift;             /* read-backs that found a value other than the cached one */
+} ld2450_sensor_info_t;
 
 /** Initialize the command module (creates mutex). Call after ld2450_init(). */
 esp_err_t ld2450_cmd_init(void);
@@ -36,17 +80,17 @@ esp_err_t ld2450_cmd_restart(void);
 esp_err_t ld2450_cmd_factory_reset(void);
 
 /**
- * Set the hardware detection region via the zone filter command (0xC2).
+ * Program the hardware zone filter (0xC2): all three slots, unused ones
+ * zeroed.  ESP_ERR_INVALID_ARG for more than LD2450_HW_FILTER_SLOTS rects.
+ */
+esp_err_t ld2450_cmd_set_filter(const ld2450_hw_filter_t *f);
+
+/**
+ * Set a single-rectangle hardware detection region (slot 1; slots 2 & 3
+ * zeroed).
  *
  * zone_type: 0 = disabled, 1 = detect only inside, 2 = exclude inside
  * x1/y1, x2/y2: corners of the rectangular region, in mm (signed).
- *
- * Only zone slot 1 is used (slots 2 & 3 set to zero).
- * For distance+angle limiting, compute the rectangle from:
- *   x_left  = -(max_dist_mm * tan(left_angle_deg))
- *   x_right =  (max_dist_mm * tan(right_angle_deg))
- *   y_min   = 0, y_max = max_dist_mm
- * and call with zone_type=1 (detect only inside).
  */
 esp_err_t ld2450_cmd_set_region(uint16_t zone_type,
                                 int16_t x1, int16_t y1,
@@ -56,10 +100,55 @@ esp_err_t ld2450_cmd_set_region(uint16_t zone_type,
 esp_err_t ld2450_cmd_clear_region(void);
 
 /**
- * Apply distance and angle limits by computing a detection rectangle.
- * max_dist_mm: 0-6000. angle_left/right: 0-90 degrees.
- * If max_dist=6000 and both angles=90, clears the region filter.
+ * Apply distance and angle limits through the zone filter planned by
+ * ld2450_hw_filter_plan_range().  max_dist_mm: 0-6000.
+ * angle_left/right: 0-90 degrees.  If max_dist=6000 and both angles=90,
+ * clears the region filter.
  */
 esp_err_t ld2450_cmd_apply_distance_angle(uint16_t max_dist_mm,
                                           uint8_t angle_left_deg,
                                           uint8_t angle_right_deg);
+
+/* ---- Batches ---- */
+
+/** Empty the batch. */
+void ld2450_cmd_batch_init(ld2450_cmd_batch_t *b);
+
+/* Append a command; ESP_ERR_NO_MEM when the batch is full.  Restart and
+ * factory reset stay single commands: the first reboots the sensor
+ * mid-session, the second undoes whatever the batch set. */
+esp_err_t ld2450_cmd_batch_add_single_target(ld2450_cmd_batch_t *b);
+esp_err_t ld2450_cmd_batch_add_multi_target(ld2450_cmd_batch_t *b);
+esp_err_t ld2450_cmd_batch_add_bluetooth(ld2450_cmd_batch_t *b, bool enable);
+esp_err_t ld2450_cmd_batch_add_filter(ld2450_cmd_batch_t *b, const ld2450_hw_filter_t *f);
+esp_err_t ld2450_cmd_batch_add_region(ld2450_cmd_batch_t *b, uint16_t zone_type,
+                                      int16_t x1, int16_t y1,
+                                      int16_t x2, int16_t y2);
+esp_err_t ld2450_cmd_batch_add_distance_angle(ld2450_cmd_batch_t *b, uint16_t max_dist_mm,
+                                              uint8_t angle_left_deg, uint8_t angle_right_deg);
+
+/**
+ * Send every command of the batch, in order, in one config-mode session.
+ * Stops at the first command without a successful ACK and returns its
+ * error; the commands before it have been applied.  An empty batch is a
+ * no-op returning ESP_OK.
+ */
+esp_err_t ld2450_cmd_batch_run(const ld2450_cmd_batch_t *b);
+
+/* ---- Read-back ---- */
+
+/**
+ * Read firmware version, MAC, zone filter and tracking mode in one session
+ * and refresh the cache; values differing from the cache count as drift.
+ */
+esp_err_t ld2450_cmd_query(void);
+
+/**
+ * Forget what the sensor holds (it restarted or was power-cycled and may
+ * have come back with other settings): the next write of each setting is
+ * sent even if it matches the old cache.  Firmware version and MAC stay.
+ */
+void ld2450_cmd_forget_settings(void);
+
+/** Copy out the cached sensor state and counters. */
+void ld2450_cmd_get_sensor_info(ld2450_sensor_info_t *out);
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "esp_err.h"
+#include "ld2450_cmd.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LD2450 command worker.
+ *
+ * A config command holds the UART for enter-config, the command and
+ * exit-config, each waiting up to 500 ms for its ACK, plus exit retries.
+ * The worker runs them one at a time on its own task, in submission order,
+ * so Zigbee and HTTP handlers only queue a request and return.
+ *
+ * Completion is reported per request (done callback, or
+ * ld2450_cmd_submit_wait() for callers that may block) and as a global
+ * status (ld2450_cmd_worker_get_status(), status callback on every change).
+ *
+ * Every sensor command after boot should go through the worker: direct
+ * ld2450_cmd_* calls are still serialized by the command mutex, but could
+ * overtake a queued request and leave the sensor with older settings.
+ */
+
+typedef enum {
+    LD2450_CMD_OP_REGION = 1,      /* ld2450_cmd_apply_distance_angle() */
+    LD2450_CMD_OP_BLUETOOTH,
+    LD2450_CMD_OP_SINGLE_TARGET,
+    LD2450_CMD_OP_MULTI_TARGET,
+    LD2450_CMD_OP_RESTART,
+    LD2450_CMD_OP_FACTORY_RESET,
+    LD2450_CMD_OP_BATCH,           /* ld2450_cmd_batch_run(): one config session */
+    LD2450_CMD_OP_QUERY,           /* ld2450_cmd_query(): read back sensor state */
+} ld2450_cmd_op_t;
+
+typedef struct {
+    uint8_t op;                    /* ld2450_cmd_op_t */
+    union {
+        struct {
+            uint16_t max_dist_mm;
+            uint8_t  angle_left_deg;
+            uint8_t  angle_right_deg;
+        } region;
+        bool bt_enable;
+        ld2450_cmd_batch_t batch;
+    } u;
+} ld2450_cmd_req_t;
+
+typedef enum {
+    LD2450_CMD_STATE_IDLE = 0,     /* nothing queued, last command succeeded */
+    LD2450_CMD_STATE_BUSY,         /* a command is running or queued */
+    LD2450_CMD_STATE_FAILED,       /* nothing queued, last command failed */
+} ld2450_cmd_state_t;
+
+typedef struct {
+    uint8_t   state;               /* ld2450_cmd_state_t */
+    uint8_t   pending;             /* queued, not started */
+    uint8_t   last_op;             /* ld2450_cmd_op_t of the last finished command */
+    esp_err_t last_err;
+    uint32_t  last_ms;             /* duration of the last finished command */
+    uint32_t  submitted;
+    uint32_t  completed;           /* finished, successfully or not */
+    uint32_t  failed;
+    uint32_t  rejected;            /* submit refused: queue full */
+} ld2450_cmd_status_t;
+
+/** Called from the worker task when the request's command has finished. */
+typedef void (*ld2450_cmd_done_cb_t)(uint32_t ticket, esp_err_t err, void *arg);
+
+/** Called on every status change, from the worker or the submitting task. Keep it short. */
+typedef void (*ld2450_cmd_status_cb_t)(const ld2450_cmd_status_t *status);
+
+/** Create the queue and worker task. Call after ld2450_cmd_init(). */
+esp_err_t ld2450_cmd_worker_start(void);
+
+/**
+ * Queue a command and return at once.  done (may be NULL) runs on the
+ * worker task with the command's result; *ticket (may be NULL) identifies
+ * the request there.  ESP_ERR_INVALID_STATE before ld2450_cmd_worker_start(),
+ * ESP_ERR_NO_MEM if the queue is full, ESP_ERR_INVALID_ARG for an unknown op.
+ */
+esp_err_t ld2450_cmd_submit(const ld2450_cmd_req_t *req, ld2450_cmd_done_cb_t done,
+                            void *arg, uint32_t *ticket);
+
+/**
+ * Queue a command behind everything already submitted and block until it
+ * has run; returns its result.  For the CLI and boot code, never for the
+ * Zigbee or HTTP tasks.
+ */
+esp_err_t ld2450_cmd_submit_wait(const ld2450_cmd_req_t *req);
+
+/** Copy out the current status. */
+void ld2450_cmd_worker_get_status(ld2450_cmd_status_t *out);
+
+/** Register the status change listener (one; NULL removes it). */
+void ld2450_cmd_worker_set_status_cb(ld2450_cmd_status_cb_t cb);
+
+/** Short name of an op for logs and JSON ("region", "bluetooth", ...). */
+const char *ld2450_cmd_op_name(uint8_t op);
+
+#ifdef __cplusplus
+}
+#endif
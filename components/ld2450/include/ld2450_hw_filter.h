@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ld2450_zone.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Planner for the LD2450 hardware zone filter (0xC2): up to three
+ * axis-aligned rectangles the sensor applies before it reports a target.
+ *
+ * Targets the filter drops never reach the firmware, so they cost no UART
+ * bytes, parser time or tracking slot; everything inside it is still
+ * checked against the software zone polygons.  A plan must therefore
+ * cover every point the software would accept, and should cover as little
+ * else as possible.
+ *
+ * Pure C, no ESP-IDF dependencies (tested in components/ld2450/test).
+ */
+
+#define LD2450_HW_FILTER_SLOTS   3
+#define LD2450_HW_FILTER_LIMIT   6000     /* sensor range, mm */
+
+typedef enum {
+    LD2450_HW_FILTER_RANGE = 0,   /* distance and angle limits only */
+    LD2450_HW_FILTER_ZONES,       /* software zones' bounding boxes, within the limits */
+} ld2450_hw_filter_mode_t;
+
+typedef struct {
+    int16_t x1, y1, x2, y2;       /* mm, x1 <= x2, y1 <= y2, edges included */
+} ld2450_rect_t;
+
+typedef struct {
+    uint8_t       zone_type;      /* 0 = off (report everything), 1 = detect only inside
+                                     (2 = exclude inside: ld2450_cmd_set_region() only) */
+    uint8_t       count;          /* rectangles used, 0 when off */
+    ld2450_rect_t rect[LD2450_HW_FILTER_SLOTS];
+} ld2450_hw_filter_t;
+
+/**
+ * Cover the detection sector (radial distance <= max_dist_mm, left/right
+ * angle from the sensor axis) with up to three stacked rectangles of the
+ * least total area.  Off when the limits are the sensor's own
+ * (6000 mm, 90/90 degrees).
+ */
+void ld2450_hw_filter_plan_range(uint16_t max_dist_mm, uint8_t angle_left_deg,
+                                 uint8_t angle_right_deg, ld2450_hw_filter_t *out);
+
+/**
+ * Cover the active zones (vertex_count >= 3, first LD2450_ZONE_COUNT) with
+ * up to three rectangles: each zone's bounding box clipped to each of range's
+ * rectangles, pieces that merge without adding area joined, then the pair
+ * whose merge adds the least area merged until three remain.  Falls back to
+ * *range when no active zone lies within it.
+ */
+void ld2450_hw_filter_plan_zones(const ld2450_zone_t *zones, size_t n,
+                                 const ld2450_hw_filter_t *range, ld2450_hw_filter_t *out);
+
+/** True if the sensor reports a target at (x, y) under f. */
+bool ld2450_hw_filter_contains(const ld2450_hw_filter_t *f, int16_t x, int16_t y);
+
+/** Area the sensor reports in, cm^2 (union of the rectangles; the full range when off). */
+uint32_t ld2450_hw_filter_area_cm2(const ld2450_hw_filter_t *f);
+
+/** True if a and b program the sensor identically. */
+bool ld2450_hw_filter_equal(const ld2450_hw_filter_t *a, const ld2450_hw_filter_t *b);
+
+/** "range" / "zones" */
+const char *ld2450_hw_filter_mode_name(uint8_t mode);
+
+#ifdef __cplusplus
+}
+#endif
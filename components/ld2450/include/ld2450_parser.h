@@ -23,6 +23,14 @@ typedef struct {
 
 typedef struct ld2450_parser ld2450_parser_t;
 
+/** Cumulative counters since create; wrap at 2^32. */
+typedef struct {
+    uint32_t bytes;          // fed in
+    uint32_t frames;         // UPDATE frames parsed
+    uint32_t garbage_bytes;  // dropped while resyncing (noise, ACK frames, partial frames)
+    uint32_t bad_frames;     // header found but end marker wrong
+} ld2450_parser_stats_t;
+
 /** Create/destroy parser instance */
 ld2450_parser_t *ld2450_parser_create(void);
 void ld2450_parser_destroy(ld2450_parser_t *p);
@@ -36,6 +44,9 @@ bool ld2450_parser_feed(ld2450_parser_t *p, const uint8_t *data, size_t len);
 /** Get the most recent parsed report (valid after ld2450_parser_feed returns true at least once). */
 const ld2450_report_t *ld2450_parser_get_report(const ld2450_parser_t *p);
 
+/** Copy out the byte/frame counters (zeroed for a NULL parser). */
+void ld2450_parser_get_stats(const ld2450_parser_t *p, ld2450_parser_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
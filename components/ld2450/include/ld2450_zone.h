@@ -13,6 +13,7 @@ typedef struct {
 } ld2450_point_t;
 
 #define MAX_ZONE_VERTICES   10
+#define LD2450_ZONE_COUNT   10
 
 /* Sensor physical limit is 6m; 7m gives a small margin for legitimate
  * boundary zones while still rejecting clearly out-of-range coordinates
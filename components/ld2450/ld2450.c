@@ -11,12 +11,12 @@
 
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <inttypes.h>
 
 #include "ld2450_parser.h"
 #include "ld2450_zone.h"
 
-#define LD2450_ZONE_COUNT 10
 #define ZONE_ID_USER(z) ((z) + 1)
 
 static ld2450_zone_t s_zones[LD2450_ZONE_COUNT] = {
@@ -47,6 +47,12 @@ static ld2450_runtime_cfg_t s_cfg = {
 };
 
 static ld2450_state_t s_state = {0};
+static ld2450_rx_stats_t s_rx_stats = {0};
+
+static uint32_t uptime_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
 
 static bool zone_vertices_sane(const ld2450_zone_t *z)
 {
@@ -129,15 +135,47 @@ static void ld2450_uart_task(void *arg)
     while (1) {
         // If command module requested pause, yield until resumed
         if (s_rx_pause_requested) {
+            portENTER_CRITICAL(&s_lock);
+            s_rx_stats.paused = true;
+            s_rx_stats.pauses++;
+            portEXIT_CRITICAL(&s_lock);
             xSemaphoreGive(s_rx_paused_sem);  // signal "I'm paused"
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // block until resumed
+            // Time the next gap from here, not from the frame before the pause
+            portENTER_CRITICAL(&s_lock);
+            s_rx_stats.paused = false;
+            if (s_rx_stats.last_frame_ms) s_rx_stats.last_frame_ms = uptime_ms();
+            portEXIT_CRITICAL(&s_lock);
             continue;
         }
 
-        // Block up to 100ms waiting for data (short so pause requests aren't delayed)
-        int n = uart_read_bytes(s_uart_num, buf, buf_len, pdMS_TO_TICKS(100));
+        // Block up to 100ms waiting for data (short so pause requests aren't delayed).
+        // uart_read_bytes() only returns early on a 100ms lull, which a 10 Hz
+        // stream may never leave, so ask for what is buffered (or one byte).
+        size_t avail = 0;
+        uart_get_buffered_data_len(s_uart_num, &avail);
+        size_t want = avail == 0 ? 1 : (avail < (size_t)buf_len ? avail : (size_t)buf_len);
+        int n = uart_read_bytes(s_uart_num, buf, want, pdMS_TO_TICKS(100));
         if (n > 0) {
-            if (ld2450_parser_feed(parser, buf, (size_t)n)) {
+            bool parsed = ld2450_parser_feed(parser, buf, (size_t)n);
+
+            ld2450_parser_stats_t ps;
+            ld2450_parser_get_stats(parser, &ps);
+            uint32_t now = uptime_ms();
+            portENTER_CRITICAL(&s_lock);
+            s_rx_stats.bytes         = ps.bytes;
+            s_rx_stats.frames        = ps.frames;
+            s_rx_stats.garbage_bytes = ps.garbage_bytes;
+            s_rx_stats.bad_frames    = ps.bad_frames;
+            if (parsed) {
+                if (s_rx_stats.last_frame_ms && now - s_rx_stats.last_frame_ms > s_rx_stats.gap_max_ms) {
+                    s_rx_stats.gap_max_ms = now - s_rx_stats.last_frame_ms;
+                }
+                s_rx_stats.last_frame_ms = now ? now : 1;
+            }
+            portEXIT_CRITICAL(&s_lock);
+
+            if (parsed) {
                 static bool s_first_frame_signaled = false;
                 if (!s_first_frame_signaled) {
                     xEventGroupSetBits(s_event_group, LD2450_FIRST_FRAME_BIT);
@@ -386,6 +424,16 @@ esp_err_t ld2450_set_zone(size_t zone_index, const ld2450_zone_t *zone)
     return ESP_OK;
 }
 
+esp_err_t ld2450_get_rx_stats(ld2450_rx_stats_t *out, bool reset_gap)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_lock);
+    *out = s_rx_stats;
+    if (reset_gap) s_rx_stats.gap_max_ms = 0;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
 esp_err_t ld2450_wait_for_first_frame(uint32_t timeout_ms)
 {
     if (!s_event_group) return ESP_ERR_INVALID_STATE;
@@ -3,7 +3,6 @@
 #include "ld2450.h"
 
 #include <string.h>
-#include <math.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
@@ -24,13 +23,31 @@ static const uint8_t CMD_FOOTER[4] = {0x04, 0x03, 0x02, 0x01};
 #define CMD_BLUETOOTH     0xA4
 #define CMD_FACTORY_RESET 0xA2
 #define CMD_SET_ZONE      0xC2
+#define CMD_QUERY_ZONE    0xC1
+#define CMD_QUERY_TRACK   0x91
+#define CMD_READ_FW       0xA0
+#define CMD_READ_MAC      0xA5
 
 #define ACK_TIMEOUT_MS    500
 #define CMD_DELAY_MS       50
 #define MAX_FRAME_SIZE     64
+#define ACK_BODY_MAX       40     /* cmd(2) + status(2) + zone query result(26), with margin */
 
 static SemaphoreHandle_t s_cmd_mutex = NULL;
 
+/* What the sensor holds, as read back or as last written with a good ACK.
+ * Written under s_cmd_mutex, copied out under s_info_lock. */
+static ld2450_sensor_info_t s_info = { .tracking = -1, .bluetooth = -1 };
+static uint8_t s_region[LD2450_CMD_VALUE_MAX];     /* raw 0xC1/0xC2 payload when region_valid */
+static portMUX_TYPE s_info_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Read-backs a session can do before its commands */
+#define Q_ZONE    0x01
+#define Q_TRACK   0x02
+#define Q_FW      0x04
+#define Q_MAC     0x08
+#define Q_ALL     (Q_ZONE | Q_TRACK | Q_FW | Q_MAC)
+
 /* Build and send a command frame. Returns ESP_OK on success. */
 static esp_err_t send_frame(uint8_t cmd_id, const uint8_t *value, uint16_t value_len)
 {
@@ -71,15 +88,17 @@ static esp_err_t send_frame(uint8_t cmd_id, const uint8_t *value, uint16_t value
 
 /* Scan UART for ACK frame, skipping interleaved data frames.
  * Data frames start with AA FF 03 00, ACK frames with FD FC FB FA.
- * Returns ESP_OK if ACK status == success. */
-static esp_err_t read_ack(uint8_t expected_cmd)
+ * Returns ESP_OK if ACK status == success; the bytes after the status
+ * (query results) are copied to data (may be NULL), *data_len set. */
+static esp_err_t read_ack_data(uint8_t expected_cmd, uint8_t *data, uint8_t data_max,
+                               uint8_t *data_len)
 {
     uart_port_t port = ld2450_get_uart_port();
     uint8_t buf[64];
     int hdr_matched = 0;   /* how many ACK header bytes matched so far */
     int ack_pos = 0;       /* bytes collected after header match */
-    uint8_t ack[16];       /* ACK payload: length(2) + cmd(2) + status(2) + footer(4) */
-    const int ack_need = 10; /* minimum bytes after header: len(2)+cmd(2)+status(2)+footer(4) */
+    uint8_t ack[2 + ACK_BODY_MAX + 4];  /* length(2) + cmd(2) + status(2) + data + footer(4) */
+    int ack_need = 2;      /* the length field first, then the rest of the frame */
     TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ACK_TIMEOUT_MS);
 
     int total_read = 0;
@@ -100,6 +119,14 @@ static esp_err_t read_ack(uint8_t expected_cmd)
             } else {
                 /* Collecting ACK body after header */
                 ack[ack_pos++] = buf[i];
+                if (ack_pos == 2) {
+                    uint16_t intra_len = (uint16_t)(ack[0] | (ack[1] << 8));
+                    if (intra_len < 4 || intra_len > ACK_BODY_MAX) {
+                        ESP_LOGW(TAG, "ACK bad length %u for cmd 0x%02X", intra_len, expected_cmd);
+                        return ESP_ERR_INVALID_RESPONSE;
+                    }
+                    ack_need = 2 + intra_len + 4;
+                }
                 if (ack_pos >= ack_need) goto got_ack;
             }
         }
@@ -111,7 +138,7 @@ static esp_err_t read_ack(uint8_t expected_cmd)
 
 got_ack:
     /* ack[0..1] = intra-frame length (LE), ack[2] = cmd echo, ack[3] = 0x01,
-     * ack[4..5] = status, ack[6..9] = footer */
+     * ack[4..5] = status, ack[6..] = data, then footer */
 
     if (ack[2] != expected_cmd || ack[3] != 0x01) {
         ESP_LOGW(TAG, "ACK unexpected cmd word: 0x%02X 0x%02X (expected 0x%02X 0x01)",
@@ -125,10 +152,22 @@ got_ack:
         return ESP_FAIL;
     }
 
+    if (data_len) {
+        uint8_t n = (uint8_t)(ack_need - 2 - 4 - 4);   /* minus length, cmd+status, footer */
+        if (n > data_max) n = data_max;
+        if (data && n) memcpy(data, &ack[6], n);
+        *data_len = n;
+    }
+
     ESP_LOGD(TAG, "ACK OK for cmd 0x%02X", expected_cmd);
     return ESP_OK;
 }
 
+static esp_err_t read_ack(uint8_t expected_cmd)
+{
+    return read_ack_data(expected_cmd, NULL, 0, NULL);
+}
+
 /* Enter config mode */
 static esp_err_t enter_config(void)
 {
@@ -157,13 +196,178 @@ static esp_err_t exit_config(void)
     return ESP_FAIL;
 }
 
-/* Send a command wrapped in enter/exit config.
- * Pauses the RX task so we have exclusive UART access for ACK reads. */
-static esp_err_t send_config_command(uint8_t cmd_id, const uint8_t *value, uint16_t value_len)
+/* ---- Sensor state cache ---- */
+
+static void cache_set_region(const uint8_t raw[LD2450_CMD_VALUE_MAX])
+{
+    portENTER_CRITICAL(&s_info_lock);
+    memcpy(s_region, raw, LD2450_CMD_VALUE_MAX);
+    s_info.region_valid = true;
+    s_info.zone_type = (uint16_t)(raw[0] | (raw[1] << 8));
+    for (int z = 0; z < 3; z++) {
+        for (int c = 0; c < 4; c++) {
+            const uint8_t *p = &raw[2 + z * 8 + c * 2];
+            s_info.zone[z][c] = (int16_t)(p[0] | (p[1] << 8));
+        }
+    }
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+static void cache_count(uint32_t *counter, uint32_t n)
+{
+    portENTER_CRITICAL(&s_info_lock);
+    *counter += n;
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+/* True if the sensor is known to hold what this command would set */
+static bool cache_matches(uint8_t cmd, const uint8_t *value)
+{
+    switch (cmd) {
+    case CMD_SET_ZONE:      return s_info.region_valid && memcmp(s_region, value, LD2450_CMD_VALUE_MAX) == 0;
+    case CMD_BLUETOOTH:     return s_info.bluetooth >= 0 && s_info.bluetooth == (value[0] ? 1 : 0);
+    case CMD_SINGLE_TARGET: return s_info.tracking == 1;
+    case CMD_MULTI_TARGET:  return s_info.tracking == 0;
+    default:                return false;
+    }
+}
+
+/* Read-back needed before deciding whether cmd must be sent */
+static uint8_t cache_query_for(uint8_t cmd)
+{
+    switch (cmd) {
+    case CMD_SET_ZONE:      return s_info.region_valid ? 0 : Q_ZONE;
+    case CMD_SINGLE_TARGET:
+    case CMD_MULTI_TARGET:  return s_info.tracking >= 0 ? 0 : Q_TRACK;
+    default:                return 0;   /* Bluetooth has no read command */
+    }
+}
+
+static void cache_forget(void)
+{
+    portENTER_CRITICAL(&s_info_lock);
+    s_info.region_valid = false;
+    s_info.tracking = -1;
+    s_info.bluetooth = -1;
+    portEXIT_CRITICAL(&s_info_lock);
+}
+
+/* Record a command the sensor ACKed */
+static void cache_apply(uint8_t cmd, const uint8_t *value)
+{
+    switch (cmd) {
+    case CMD_SET_ZONE:
+        cache_set_region(value);
+        break;
+    case CMD_BLUETOOTH:
+    case CMD_SINGLE_TARGET:
+    case CMD_MULTI_TARGET:
+        portENTER_CRITICAL(&s_info_lock);
+        if (cmd == CMD_BLUETOOTH) s_info.bluetooth = value[0] ? 1 : 0;
+        else                      s_info.tracking  = (cmd == CMD_SINGLE_TARGET) ? 1 : 0;
+        portEXIT_CRITICAL(&s_info_lock);
+        break;
+    case CMD_FACTORY_RESET:
+        /* Settings revert on the sensor's next restart: nothing is known */
+        cache_forget();
+        break;
+    default:
+        break;
+    }
+}
+
+/* Read-backs inside an open session.  A value that differs from a valid
+ * cache entry is drift: the sensor was changed by something else (BT app,
+ * power-on default, lost write).  Returns the first error. */
+static esp_err_t run_queries(uint8_t queries)
+{
+    esp_err_t first_err = ESP_OK;
+    uint8_t data[ACK_BODY_MAX];
+    uint8_t n;
+
+    if (queries & Q_ZONE) {
+        esp_err_t err = send_frame(CMD_QUERY_ZONE, NULL, 0);
+        if (err == ESP_OK) err = read_ack_data(CMD_QUERY_ZONE, data, sizeof(data), &n);
+        if (err == ESP_OK && n < LD2450_CMD_VALUE_MAX) err = ESP_ERR_INVALID_RESPONSE;
+        if (err == ESP_OK) {
+            if (s_info.region_valid && memcmp(s_region, data, LD2450_CMD_VALUE_MAX) != 0) {
+                ESP_LOGW(TAG, "Zone filter drift: sensor no longer holds the last written region");
+                cache_count(&s_info.drift, 1);
+            }
+            cache_set_region(data);
+        } else if (first_err == ESP_OK) {
+            first_err = err;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+    }
+
+    if (queries & Q_TRACK) {
+        esp_err_t err = send_frame(CMD_QUERY_TRACK, NULL, 0);
+        if (err == ESP_OK) err = read_ack_data(CMD_QUERY_TRACK, data, sizeof(data), &n);
+        if (err == ESP_OK && (n < 2 || (data[0] != 1 && data[0] != 2))) err = ESP_ERR_INVALID_RESPONSE;
+        if (err == ESP_OK) {
+            int8_t mode = (data[0] == 1) ? 1 : 0;
+            if (s_info.tracking >= 0 && s_info.tracking != mode) {
+                ESP_LOGW(TAG, "Tracking mode drift: sensor reports %s", mode ? "single" : "multi");
+                cache_count(&s_info.drift, 1);
+            }
+            portENTER_CRITICAL(&s_info_lock);
+            s_info.tracking = mode;
+            portEXIT_CRITICAL(&s_info_lock);
+        } else if (first_err == ESP_OK) {
+            first_err = err;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+    }
+
+    if (queries & Q_FW) {
+        esp_err_t err = send_frame(CMD_READ_FW, NULL, 0);
+        if (err == ESP_OK) err = read_ack_data(CMD_READ_FW, data, sizeof(data), &n);
+        if (err == ESP_OK && n < 8) err = ESP_ERR_INVALID_RESPONSE;
+        if (err == ESP_OK) {
+            portENTER_CRITICAL(&s_info_lock);
+            s_info.fw_valid = true;
+            s_info.fw_type  = (uint16_t)(data[0] | (data[1] << 8));
+            s_info.fw_major = (uint16_t)(data[2] | (data[3] << 8));
+            s_info.fw_minor = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+                              ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+            portEXIT_CRITICAL(&s_info_lock);
+        } else if (first_err == ESP_OK) {
+            first_err = err;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+    }
+
+    if (queries & Q_MAC) {
+        uint8_t val[] = {0x01, 0x00};
+        esp_err_t err = send_frame(CMD_READ_MAC, val, sizeof(val));
+        if (err == ESP_OK) err = read_ack_data(CMD_READ_MAC, data, sizeof(data), &n);
+        if (err == ESP_OK && n < 6) err = ESP_ERR_INVALID_RESPONSE;
+        if (err == ESP_OK) {
+            portENTER_CRITICAL(&s_info_lock);
+            s_info.mac_valid = true;
+            memcpy(s_info.mac, data, 6);
+            portEXIT_CRITICAL(&s_info_lock);
+        } else if (first_err == ESP_OK) {
+            first_err = err;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+    }
+
+    return first_err;
+}
+
+/* Run a batch in one config-mode session: enter, the read-backs, each
+ * command the sensor does not already hold with its ACK, exit.  Pauses the
+ * RX task so we have exclusive UART access for ACK reads.  Stops at the
+ * first failed command; later commands are not sent.  A failed read-back
+ * only means its command is sent unconditionally. */
+static esp_err_t run_session(const ld2450_cmd_batch_t *b, uint8_t queries)
 {
     esp_err_t err;
 
     ld2450_rx_pause();
+    cache_count(&s_info.sessions, 1);
 
     err = enter_config();
     if (err != ESP_OK) {
@@ -172,21 +376,40 @@ static esp_err_t send_config_command(uint8_t cmd_id, const uint8_t *value, uint1
         return err;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
-
-    err = send_frame(cmd_id, value, value_len);
-    if (err != ESP_OK) {
-        exit_config();
-        ld2450_rx_resume();
-        return err;
+    if (queries) {
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+        esp_err_t qerr = run_queries(queries);
+        if (qerr != ESP_OK) {
+            ESP_LOGW(TAG, "Sensor read-back incomplete: %s", esp_err_to_name(qerr));
+            if (b->count == 0) err = qerr;
+        }
     }
 
-    err = read_ack(cmd_id);
-    if (err != ESP_OK) {
-        ESP_LOGW(TAG, "Command 0x%02X ACK failed", cmd_id);
-        exit_config();
-        ld2450_rx_resume();
-        return err;
+    for (uint8_t i = 0; i < b->count; i++) {
+        const uint8_t cmd_id = b->item[i].cmd;
+
+        if (cache_matches(cmd_id, b->item[i].value)) {
+            ESP_LOGD(TAG, "Command 0x%02X skipped: sensor already holds it", cmd_id);
+            cache_count(&s_info.skipped, 1);
+            continue;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
+
+        err = send_frame(cmd_id, b->item[i].value, b->item[i].len);
+        if (err == ESP_OK) {
+            err = read_ack(cmd_id);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Command 0x%02X ACK failed (%u/%u in session)",
+                         cmd_id, i + 1, b->count);
+            }
+        }
+        if (err != ESP_OK) {
+            exit_config();
+            ld2450_rx_resume();
+            return err;
+        }
+        cache_apply(cmd_id, b->item[i].value);
     }
 
     vTaskDelay(pdMS_TO_TICKS(CMD_DELAY_MS));
@@ -203,6 +426,88 @@ static esp_err_t send_config_command(uint8_t cmd_id, const uint8_t *value, uint1
     return err;  /* return the command result, not exit result */
 }
 
+/* Run a batch under the mutex.  Commands the cache shows as already held
+ * are dropped; if none is left (and nothing must be read) no session is
+ * opened and RX never pauses.  The first session also reads the firmware
+ * version and MAC. */
+static esp_err_t run_locked(const ld2450_cmd_batch_t *b, uint8_t queries)
+{
+    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
+
+    uint8_t to_send = 0;
+    for (uint8_t i = 0; i < b->count; i++) {
+        if (!cache_matches(b->item[i].cmd, b->item[i].value)) to_send++;
+        queries |= cache_query_for(b->item[i].cmd);
+    }
+
+    esp_err_t err = ESP_OK;
+    if (to_send == 0 && queries == 0) {
+        cache_count(&s_info.skipped, b->count);
+        ESP_LOGD(TAG, "%u command(s) skipped: sensor already holds them", b->count);
+    } else {
+        if (!s_info.fw_valid)  queries |= Q_FW;
+        if (!s_info.mac_valid) queries |= Q_MAC;
+        err = run_session(b, queries);
+    }
+
+    xSemaphoreGive(s_cmd_mutex);
+    return err;
+}
+
+static esp_err_t batch_add(ld2450_cmd_batch_t *b, uint8_t cmd_id,
+                           const uint8_t *value, uint8_t value_len)
+{
+    if (!b || value_len > LD2450_CMD_VALUE_MAX) return ESP_ERR_INVALID_ARG;
+    if (b->count >= LD2450_CMD_BATCH_MAX) return ESP_ERR_NO_MEM;
+    b->item[b->count].cmd = cmd_id;
+    b->item[b->count].len = value_len;
+    if (value_len) memcpy(b->item[b->count].value, value, value_len);
+    b->count++;
+    return ESP_OK;
+}
+
+/* Single command: a one-item batch */
+static esp_err_t send_config_command(uint8_t cmd_id, const uint8_t *value, uint8_t value_len)
+{
+    ld2450_cmd_batch_t b;
+    ld2450_cmd_batch_init(&b);
+    batch_add(&b, cmd_id, value, value_len);
+    return run_locked(&b, 0);
+}
+
+/* 26-byte 0xC2 payload: zone_type(2) + zone1(8) + zone2(8) + zone3(8), LE.
+ * Slots past f->count are left as zeros (unused). */
+static void build_filter_payload(uint8_t payload[26], const ld2450_hw_filter_t *f)
+{
+    memset(payload, 0, 26);
+
+    /* Zone type (LE) */
+    payload[0] = f->zone_type;
+    payload[1] = 0;
+
+    /* Zone coordinates (LE int16) */
+    for (uint8_t i = 0; i < f->count && i < LD2450_HW_FILTER_SLOTS; i++) {
+        const int16_t c[4] = { f->rect[i].x1, f->rect[i].y1, f->rect[i].x2, f->rect[i].y2 };
+        uint8_t *p = &payload[2 + i * 8];
+        for (int k = 0; k < 4; k++) {
+            p[k * 2]     = (uint8_t)(c[k] & 0xFF);
+            p[k * 2 + 1] = (uint8_t)((uint16_t)c[k] >> 8);
+        }
+    }
+}
+
+static void region_filter(ld2450_hw_filter_t *f, uint16_t zone_type,
+                          int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    memset(f, 0, sizeof(*f));
+    f->zone_type = (uint8_t)zone_type;
+    if (zone_type != 0) {
+        f->count = 1;
+        f->rect[0] = (ld2450_rect_t){ x1, y1, x2, y2 };
+    }
+}
+
 /* ---- Public API ---- */
 
 esp_err_t ld2450_cmd_init(void)
@@ -215,90 +520,66 @@ esp_err_t ld2450_cmd_init(void)
 
 esp_err_t ld2450_cmd_set_single_target(void)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
     esp_err_t err = send_config_command(CMD_SINGLE_TARGET, NULL, 0);
-    xSemaphoreGive(s_cmd_mutex);
     ESP_LOGI(TAG, "Set single-target: %s", esp_err_to_name(err));
     return err;
 }
 
 esp_err_t ld2450_cmd_set_multi_target(void)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
     esp_err_t err = send_config_command(CMD_MULTI_TARGET, NULL, 0);
-    xSemaphoreGive(s_cmd_mutex);
     ESP_LOGI(TAG, "Set multi-target: %s", esp_err_to_name(err));
     return err;
 }
 
 esp_err_t ld2450_cmd_set_bluetooth(bool enable)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
     uint8_t val[] = {enable ? 0x01 : 0x00, 0x00};
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
     esp_err_t err = send_config_command(CMD_BLUETOOTH, val, sizeof(val));
-    xSemaphoreGive(s_cmd_mutex);
     ESP_LOGI(TAG, "Set bluetooth %s: %s", enable ? "on" : "off", esp_err_to_name(err));
     return err;
 }
 
 esp_err_t ld2450_cmd_restart(void)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
     esp_err_t err = send_config_command(CMD_RESTART, NULL, 0);
-    xSemaphoreGive(s_cmd_mutex);
     ESP_LOGI(TAG, "Sensor restart: %s", esp_err_to_name(err));
     return err;
 }
 
 esp_err_t ld2450_cmd_factory_reset(void)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
     esp_err_t err = send_config_command(CMD_FACTORY_RESET, NULL, 0);
-    xSemaphoreGive(s_cmd_mutex);
     ESP_LOGI(TAG, "Factory reset: %s", esp_err_to_name(err));
     return err;
 }
 
-esp_err_t ld2450_cmd_set_region(uint16_t zone_type,
-                                int16_t x1, int16_t y1,
-                                int16_t x2, int16_t y2)
+esp_err_t ld2450_cmd_set_filter(const ld2450_hw_filter_t *f)
 {
-    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
+    if (!f || f->count > LD2450_HW_FILTER_SLOTS) return ESP_ERR_INVALID_ARG;
 
-    /* 26-byte payload: zone_type(2) + zone1(8) + zone2(8) + zone3(8) */
     uint8_t payload[26];
-    memset(payload, 0, sizeof(payload));
-
-    /* Zone type (LE) */
-    payload[0] = (uint8_t)(zone_type & 0xFF);
-    payload[1] = (uint8_t)(zone_type >> 8);
-
-    /* Zone 1 coordinates (LE int16) */
-    payload[2]  = (uint8_t)(x1 & 0xFF);
-    payload[3]  = (uint8_t)((uint16_t)x1 >> 8);
-    payload[4]  = (uint8_t)(y1 & 0xFF);
-    payload[5]  = (uint8_t)((uint16_t)y1 >> 8);
-    payload[6]  = (uint8_t)(x2 & 0xFF);
-    payload[7]  = (uint8_t)((uint16_t)x2 >> 8);
-    payload[8]  = (uint8_t)(y2 & 0xFF);
-    payload[9]  = (uint8_t)((uint16_t)y2 >> 8);
-
-    /* Zones 2 & 3 left as zeros (unused) */
-
-    xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
+    build_filter_payload(payload, f);
     esp_err_t err = send_config_command(CMD_SET_ZONE, payload, sizeof(payload));
-    xSemaphoreGive(s_cmd_mutex);
 
-    ESP_LOGI(TAG, "Set region type=%u (%d,%d)-(%d,%d): %s",
-             zone_type, x1, y1, x2, y2, esp_err_to_name(err));
+    ESP_LOGI(TAG, "Set zone filter type=%u, %u rect(s): %s",
+             f->zone_type, f->count, esp_err_to_name(err));
+    for (uint8_t i = 0; i < f->count; i++) {
+        ESP_LOGD(TAG, "  slot %u: (%d,%d)-(%d,%d)", i + 1,
+                 f->rect[i].x1, f->rect[i].y1, f->rect[i].x2, f->rect[i].y2);
+    }
     return err;
 }
 
+esp_err_t ld2450_cmd_set_region(uint16_t zone_type,
+                                int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2)
+{
+    ld2450_hw_filter_t f;
+    region_filter(&f, zone_type, x1, y1, x2, y2);
+    return ld2450_cmd_set_filter(&f);
+}
+
 esp_err_t ld2450_cmd_clear_region(void)
 {
     return ld2450_cmd_set_region(0, 0, 0, 0, 0);
@@ -308,26 +589,95 @@ esp_err_t ld2450_cmd_apply_distance_angle(uint16_t max_dist_mm,
                                           uint8_t angle_left_deg,
                                           uint8_t angle_right_deg)
 {
-    /* Clamp inputs */
-    if (max_dist_mm > 6000) max_dist_mm = 6000;
-    if (angle_left_deg > 90) angle_left_deg = 90;
-    if (angle_right_deg > 90) angle_right_deg = 90;
+    ld2450_hw_filter_t f;
+    ld2450_hw_filter_plan_range(max_dist_mm, angle_left_deg, angle_right_deg, &f);
+    return ld2450_cmd_set_filter(&f);
+}
 
-    /* If at max range and max angles, no filtering needed */
-    if (max_dist_mm >= 6000 && angle_left_deg >= 90 && angle_right_deg >= 90) {
-        return ld2450_cmd_clear_region();
-    }
+/* ---- Batches ---- */
+
+void ld2450_cmd_batch_init(ld2450_cmd_batch_t *b)
+{
+    if (b) b->count = 0;
+}
+
+esp_err_t ld2450_cmd_batch_add_single_target(ld2450_cmd_batch_t *b)
+{
+    return batch_add(b, CMD_SINGLE_TARGET, NULL, 0);
+}
+
+esp_err_t ld2450_cmd_batch_add_multi_target(ld2450_cmd_batch_t *b)
+{
+    return batch_add(b, CMD_MULTI_TARGET, NULL, 0);
+}
+
+esp_err_t ld2450_cmd_batch_add_bluetooth(ld2450_cmd_batch_t *b, bool enable)
+{
+    uint8_t val[] = {enable ? 0x01 : 0x00, 0x00};
+    return batch_add(b, CMD_BLUETOOTH, val, sizeof(val));
+}
+
+esp_err_t ld2450_cmd_batch_add_filter(ld2450_cmd_batch_t *b, const ld2450_hw_filter_t *f)
+{
+    if (!f || f->count > LD2450_HW_FILTER_SLOTS) return ESP_ERR_INVALID_ARG;
+
+    uint8_t payload[26];
+    build_filter_payload(payload, f);
+    return batch_add(b, CMD_SET_ZONE, payload, sizeof(payload));
+}
 
-    /* Compute X boundaries from angles using trig */
-    double left_rad  = (double)angle_left_deg  * M_PI / 180.0;
-    double right_rad = (double)angle_right_deg * M_PI / 180.0;
+esp_err_t ld2450_cmd_batch_add_region(ld2450_cmd_batch_t *b, uint16_t zone_type,
+                                      int16_t x1, int16_t y1,
+                                      int16_t x2, int16_t y2)
+{
+    ld2450_hw_filter_t f;
+    region_filter(&f, zone_type, x1, y1, x2, y2);
+    return ld2450_cmd_batch_add_filter(b, &f);
+}
 
-    int16_t x_left  = (int16_t)(-((double)max_dist_mm * tan(left_rad)));
-    int16_t x_right = (int16_t)( ((double)max_dist_mm * tan(right_rad)));
+esp_err_t ld2450_cmd_batch_add_distance_angle(ld2450_cmd_batch_t *b, uint16_t max_dist_mm,
+                                              uint8_t angle_left_deg, uint8_t angle_right_deg)
+{
+    ld2450_hw_filter_t f;
+    ld2450_hw_filter_plan_range(max_dist_mm, angle_left_deg, angle_right_deg, &f);
+    return ld2450_cmd_batch_add_filter(b, &f);
+}
 
-    /* Clamp to sensor limits */
-    if (x_left  < -6000) x_left  = -6000;
-    if (x_right >  6000) x_right =  6000;
+esp_err_t ld2450_cmd_batch_run(const ld2450_cmd_batch_t *b)
+{
+    if (!s_cmd_mutex) return ESP_ERR_INVALID_STATE;
+    if (!b || b->count > LD2450_CMD_BATCH_MAX) return ESP_ERR_INVALID_ARG;
+    if (b->count == 0) return ESP_OK;
+
+    esp_err_t err = run_locked(b, 0);
 
-    return ld2450_cmd_set_region(1, x_left, 0, x_right, (int16_t)max_dist_mm);
+    ESP_LOGI(TAG, "Batch of %u command(s) in one session: %s", b->count, esp_err_to_name(err));
+    return err;
+}
+
+/* ---- Read-back ---- */
+
+esp_err_t ld2450_cmd_query(void)
+{
+    ld2450_cmd_batch_t b;
+    ld2450_cmd_batch_init(&b);
+    esp_err_t err = run_locked(&b, Q_ALL);
+    ESP_LOGI(TAG, "Sensor read-back: %s", esp_err_to_name(err));
+    return err;
+}
+
+void ld2450_cmd_forget_settings(void)
+{
+    /* Under the mutex, so a session in progress cannot re-cache behind us */
+    if (s_cmd_mutex) xSemaphoreTake(s_cmd_mutex, portMAX_DELAY);
+    cache_forget();
+    if (s_cmd_mutex) xSemaphoreGive(s_cmd_mutex);
+}
+
+void ld2450_cmd_get_sensor_info(ld2450_sensor_info_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_info_lock);
+    *out = s_info;
+    portEXIT_CRITICAL(&s_info_lock);
 }
@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: MIT
+#include "ld2450_cmd_worker.h"
+#include "ld2450_cmd.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "ld2450_worker";
+
+#define WORKER_QUEUE_LEN    8
+#define WORKER_STACK        3072
+#define WORKER_PRIO         4      /* below the Zigbee and CLI tasks, above idle */
+
+typedef struct {
+    ld2450_cmd_req_t     req;
+    ld2450_cmd_done_cb_t done;
+    void                *arg;
+    uint32_t             ticket;
+} work_item_t;
+
+static QueueHandle_t          s_queue = NULL;
+static TaskHandle_t           s_task = NULL;
+static portMUX_TYPE           s_lock = portMUX_INITIALIZER_UNLOCKED;
+static ld2450_cmd_status_t    s_status;
+static bool                   s_running = false;    /* a command is executing */
+static uint32_t               s_next_ticket = 1;
+static ld2450_cmd_status_cb_t s_status_cb = NULL;
+
+const char *ld2450_cmd_op_name(uint8_t op)
+{
+    switch (op) {
+    case LD2450_CMD_OP_REGION:        return "region";
+    case LD2450_CMD_OP_BLUETOOTH:     return "bluetooth";
+    case LD2450_CMD_OP_SINGLE_TARGET: return "single_target";
+    case LD2450_CMD_OP_MULTI_TARGET:  return "multi_target";
+    case LD2450_CMD_OP_RESTART:       return "restart";
+    case LD2450_CMD_OP_FACTORY_RESET: return "factory_reset";
+    case LD2450_CMD_OP_BATCH:         return "batch";
+    case LD2450_CMD_OP_QUERY:         return "query";
+    default:                          return "none";
+    }
+}
+
+/* Recompute state/pending under s_lock and hand a copy to the listener */
+static void status_changed(void)
+{
+    ld2450_cmd_status_t st;
+    ld2450_cmd_status_cb_t cb;
+    uint8_t pending = (uint8_t)uxQueueMessagesWaiting(s_queue);
+
+    portENTER_CRITICAL(&s_lock);
+    s_status.pending = pending;
+    if (s_running || s_status.pending > 0) {
+        s_status.state = LD2450_CMD_STATE_BUSY;
+    } else {
+        s_status.state = (s_status.completed > 0 && s_status.last_err != ESP_OK)
+            ? LD2450_CMD_STATE_FAILED : LD2450_CMD_STATE_IDLE;
+    }
+    st = s_status;
+    cb = s_status_cb;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (cb) cb(&st);
+}
+
+static esp_err_t run_request(const ld2450_cmd_req_t *req)
+{
+    switch (req->op) {
+    case LD2450_CMD_OP_REGION:
+        return ld2450_cmd_apply_distance_angle(req->u.region.max_dist_mm,
+                                               req->u.region.angle_left_deg,
+                                               req->u.region.angle_right_deg);
+    case LD2450_CMD_OP_BLUETOOTH:     return ld2450_cmd_set_bluetooth(req->u.bt_enable);
+    case LD2450_CMD_OP_SINGLE_TARGET: return ld2450_cmd_set_single_target();
+    case LD2450_CMD_OP_MULTI_TARGET:  return ld2450_cmd_set_multi_target();
+    case LD2450_CMD_OP_RESTART:       return ld2450_cmd_restart();
+    case LD2450_CMD_OP_FACTORY_RESET: return ld2450_cmd_factory_reset();
+    case LD2450_CMD_OP_BATCH:         return ld2450_cmd_batch_run(&req->u.batch);
+    case LD2450_CMD_OP_QUERY:         return ld2450_cmd_query();
+    default:                          return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static void worker_task(void *arg)
+{
+    (void)arg;
+    work_item_t item;
+
+    for (;;) {
+        if (xQueueReceive(s_queue, &item, portMAX_DELAY) != pdTRUE) continue;
+
+        portENTER_CRITICAL(&s_lock);
+        s_running = true;
+        portEXIT_CRITICAL(&s_lock);
+        status_changed();
+
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t err = run_request(&item.req);
+        uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+
+        portENTER_CRITICAL(&s_lock);
+        s_running = false;
+        s_status.last_op  = item.req.op;
+        s_status.last_err = err;
+        s_status.last_ms  = ms;
+        s_status.completed++;
+        if (err != ESP_OK) s_status.failed++;
+        portEXIT_CRITICAL(&s_lock);
+
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "#%u %s failed after %ums: %s", (unsigned)item.ticket,
+                     ld2450_cmd_op_name(item.req.op), (unsigned)ms, esp_err_to_name(err));
+        } else {
+            ESP_LOGD(TAG, "#%u %s done in %ums", (unsigned)item.ticket,
+                     ld2450_cmd_op_name(item.req.op), (unsigned)ms);
+        }
+
+        if (item.done) item.done(item.ticket, err, item.arg);
+        status_changed();
+    }
+}
+
+esp_err_t ld2450_cmd_worker_start(void)
+{
+    if (s_queue) return ESP_OK;  /* already started */
+
+    s_queue = xQueueCreate(WORKER_QUEUE_LEN, sizeof(work_item_t));
+    if (!s_queue) return ESP_ERR_NO_MEM;
+
+    BaseType_t ok = xTaskCreate(worker_task, "ld2450_cmd", WORKER_STACK, NULL, WORKER_PRIO, &s_task);
+    if (ok != pdPASS) {
+        vQueueDelete(s_queue);
+        s_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ld2450_cmd_submit(const ld2450_cmd_req_t *req, ld2450_cmd_done_cb_t done,
+                            void *arg, uint32_t *ticket)
+{
+    if (!s_queue) return ESP_ERR_INVALID_STATE;
+    if (!req || req->op < LD2450_CMD_OP_REGION || req->op > LD2450_CMD_OP_QUERY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    work_item_t item = {
+        .req  = *req,
+        .done = done,
+        .arg  = arg,
+    };
+    portENTER_CRITICAL(&s_lock);
+    item.ticket = s_next_ticket++;
+    s_status.submitted++;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (xQueueSend(s_queue, &item, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_lock);
+        s_status.submitted--;
+        s_status.rejected++;
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGW(TAG, "queue full, %s rejected", ld2450_cmd_op_name(req->op));
+        return ESP_ERR_NO_MEM;
+    }
+    if (ticket) *ticket = item.ticket;
+    status_changed();
+    return ESP_OK;
+}
+
+typedef struct {
+    SemaphoreHandle_t sem;
+    esp_err_t         err;
+} wait_ctx_t;
+
+static void wait_done_cb(uint32_t ticket, esp_err_t err, void *arg)
+{
+    (void)ticket;
+    wait_ctx_t *ctx = (wait_ctx_t *)arg;
+    ctx->err = err;
+    xSemaphoreGive(ctx->sem);
+}
+
+esp_err_t ld2450_cmd_submit_wait(const ld2450_cmd_req_t *req)
+{
+    /* Before the worker exists, or on the worker itself, run in place */
+    if (!s_queue || xTaskGetCurrentTaskHandle() == s_task) {
+        return req ? run_request(req) : ESP_ERR_INVALID_ARG;
+    }
+
+    StaticSemaphore_t buf;
+    wait_ctx_t ctx = { .sem = xSemaphoreCreateBinaryStatic(&buf), .err = ESP_FAIL };
+
+    /* The queue may be full of async requests: wait for room rather than fail */
+    esp_err_t err;
+    while ((err = ld2450_cmd_submit(req, wait_done_cb, &ctx, NULL)) == ESP_ERR_NO_MEM) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    if (err == ESP_OK) {
+        xSemaphoreTake(ctx.sem, portMAX_DELAY);
+        err = ctx.err;
+    }
+    vSemaphoreDelete(ctx.sem);
+    return err;
+}
+
+void ld2450_cmd_worker_get_status(ld2450_cmd_status_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_lock);
+    *out = s_status;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ld2450_cmd_worker_set_status_cb(ld2450_cmd_status_cb_t cb)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_status_cb = cb;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,269 @@
+// SPDX-License-Identifier: MIT
+#include "ld2450_hw_filter.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Band boundaries are searched on this many steps of max distance
+ * (125 mm at 6 m).  The band widths are exact for whatever boundaries are
+ * picked, so the grid only limits how close to the optimum the area gets. */
+#define PLAN_STEPS  48
+
+typedef struct {
+    uint16_t d;                   /* max distance, mm */
+    uint8_t  deg[2];              /* left, right */
+    double   s[2], c[2], t[2];    /* sin, cos, tan per side */
+} sector_t;
+
+/*
+ * Widest |x| of the sector on one side between heights ya and yb.  At
+ * height y the edge is at min(y * tan(a), sqrt(d^2 - y^2)): the angle line
+ * up to y = d * cos(a), the range circle above it, peaking at d * sin(a).
+ */
+static int32_t side_extent(const sector_t *sc, int side, int32_t ya, int32_t yb)
+{
+    uint8_t deg = sc->deg[side];
+    double d = sc->d;
+    double e;
+
+    if (deg == 0) return 0;
+    if (deg >= 90) {
+        e = sqrt(d * d - (double)ya * ya);
+    } else {
+        double ypk = d * sc->c[side];
+        if (ypk < ya)      e = sqrt(d * d - (double)ya * ya);
+        else if (ypk > yb) e = yb * sc->t[side];
+        else               e = d * sc->s[side];
+    }
+    /* Round outward so the rectangle still covers the sector */
+    int32_t x = (int32_t)ceil(e);
+    return x > LD2450_HW_FILTER_LIMIT ? LD2450_HW_FILTER_LIMIT : x;
+}
+
+static ld2450_rect_t band_rect(const sector_t *sc, int32_t ya, int32_t yb)
+{
+    ld2450_rect_t r = {
+        .x1 = (int16_t)-side_extent(sc, 0, ya, yb),
+        .y1 = (int16_t)ya,
+        .x2 = (int16_t)side_extent(sc, 1, ya, yb),
+        .y2 = (int16_t)yb,
+    };
+    return r;
+}
+
+static uint32_t rect_area(const ld2450_rect_t *r)
+{
+    return (uint32_t)(r->x2 - r->x1) * (uint32_t)(r->y2 - r->y1);
+}
+
+static uint32_t band_area(const sector_t *sc, int32_t ya, int32_t yb)
+{
+    if (yb <= ya) return 0;
+    ld2450_rect_t r = band_rect(sc, ya, yb);
+    return rect_area(&r);
+}
+
+void ld2450_hw_filter_plan_range(uint16_t max_dist_mm, uint8_t angle_left_deg,
+                                 uint8_t angle_right_deg, ld2450_hw_filter_t *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+
+    if (max_dist_mm > LD2450_HW_FILTER_LIMIT) max_dist_mm = LD2450_HW_FILTER_LIMIT;
+    if (angle_left_deg > 90) angle_left_deg = 90;
+    if (angle_right_deg > 90) angle_right_deg = 90;
+
+    /* The sensor's own limits: nothing to filter */
+    if (max_dist_mm >= LD2450_HW_FILTER_LIMIT && angle_left_deg >= 90 && angle_right_deg >= 90) {
+        return;
+    }
+
+    out->zone_type = 1;
+    if (max_dist_mm == 0) {
+        out->count = 1;   /* a point at the sensor: nothing is ever reported */
+        return;
+    }
+
+    sector_t sc = { .d = max_dist_mm, .deg = { angle_left_deg, angle_right_deg } };
+    for (int i = 0; i < 2; i++) {
+        double a = (double)sc.deg[i] * M_PI / 180.0;
+        sc.s[i] = sin(a);
+        sc.c[i] = cos(a);
+        sc.t[i] = tan(a);
+    }
+
+    /* Three bands [0,y1] [y1,y2] [y2,d]; an empty band frees its slot */
+    int32_t y[PLAN_STEPS + 1];
+    uint32_t lo[PLAN_STEPS + 1], hi[PLAN_STEPS + 1];
+    for (int i = 0; i <= PLAN_STEPS; i++) {
+        y[i] = (int32_t)max_dist_mm * i / PLAN_STEPS;
+    }
+    for (int i = 0; i <= PLAN_STEPS; i++) {
+        lo[i] = band_area(&sc, 0, y[i]);
+        hi[i] = band_area(&sc, y[i], max_dist_mm);
+    }
+
+    uint32_t best = lo[PLAN_STEPS];
+    int b1 = PLAN_STEPS, b2 = PLAN_STEPS;
+    for (int i = 1; i < PLAN_STEPS; i++) {
+        for (int j = i; j < PLAN_STEPS; j++) {
+            uint32_t a = lo[i] + band_area(&sc, y[i], y[j]) + hi[j];
+            if (a < best) {
+                best = a;
+                b1 = i;
+                b2 = j;
+            }
+        }
+    }
+
+    int32_t cut[4] = { 0, y[b1], y[b2], max_dist_mm };
+    for (int k = 0; k < 3; k++) {
+        if (cut[k + 1] > cut[k]) {
+            out->rect[out->count++] = band_rect(&sc, cut[k], cut[k + 1]);
+        }
+    }
+}
+
+static bool rect_intersect(const ld2450_rect_t *a, const ld2450_rect_t *b, ld2450_rect_t *out)
+{
+    ld2450_rect_t r = {
+        .x1 = a->x1 > b->x1 ? a->x1 : b->x1,
+        .y1 = a->y1 > b->y1 ? a->y1 : b->y1,
+        .x2 = a->x2 < b->x2 ? a->x2 : b->x2,
+        .y2 = a->y2 < b->y2 ? a->y2 : b->y2,
+    };
+    if (r.x1 > r.x2 || r.y1 > r.y2) return false;
+    *out = r;
+    return true;
+}
+
+static ld2450_rect_t rect_bound(const ld2450_rect_t *a, const ld2450_rect_t *b)
+{
+    ld2450_rect_t r = {
+        .x1 = a->x1 < b->x1 ? a->x1 : b->x1,
+        .y1 = a->y1 < b->y1 ? a->y1 : b->y1,
+        .x2 = a->x2 > b->x2 ? a->x2 : b->x2,
+        .y2 = a->y2 > b->y2 ? a->y2 : b->y2,
+    };
+    return r;
+}
+
+/* Area of the union of n <= 3 rectangles, by inclusion-exclusion */
+static uint32_t union_area(const ld2450_rect_t *r, uint8_t n)
+{
+    int64_t total = 0;
+    for (unsigned set = 1; set < (1u << n); set++) {
+        ld2450_rect_t acc = { -LD2450_HW_FILTER_LIMIT, 0, LD2450_HW_FILTER_LIMIT, LD2450_HW_FILTER_LIMIT };
+        bool empty = false;
+        int bits = 0;
+        for (uint8_t i = 0; i < n && !empty; i++) {
+            if (!(set & (1u << i))) continue;
+            bits++;
+            empty = !rect_intersect(&acc, &r[i], &acc);
+        }
+        if (empty) continue;
+        total += (bits & 1) ? (int64_t)rect_area(&acc) : -(int64_t)rect_area(&acc);
+    }
+    return (uint32_t)total;
+}
+
+void ld2450_hw_filter_plan_zones(const ld2450_zone_t *zones, size_t n,
+                                 const ld2450_hw_filter_t *range, ld2450_hw_filter_t *out)
+{
+    if (!out || !range) return;
+
+    /* Clip against each range rectangle, not their bounding box, so no piece
+     * reaches into the corners the range plan left out */
+    static const ld2450_rect_t full = { -LD2450_HW_FILTER_LIMIT, 0, LD2450_HW_FILTER_LIMIT, LD2450_HW_FILTER_LIMIT };
+    const ld2450_rect_t *clip = &full;
+    uint8_t clips = 1;
+    if (range->zone_type == 1 && range->count > 0) {
+        clip = range->rect;
+        clips = range->count > LD2450_HW_FILTER_SLOTS ? LD2450_HW_FILTER_SLOTS : range->count;
+    }
+
+    ld2450_rect_t box[LD2450_ZONE_COUNT * LD2450_HW_FILTER_SLOTS];
+    size_t k = 0;
+    for (size_t z = 0; zones && z < n && z < LD2450_ZONE_COUNT; z++) {
+        const ld2450_zone_t *zn = &zones[z];
+        if (zn->vertex_count < 3 || zn->vertex_count > MAX_ZONE_VERTICES) continue;
+
+        ld2450_rect_t b = { zn->v[0].x_mm, zn->v[0].y_mm, zn->v[0].x_mm, zn->v[0].y_mm };
+        for (uint8_t i = 1; i < zn->vertex_count; i++) {
+            ld2450_rect_t p = { zn->v[i].x_mm, zn->v[i].y_mm, zn->v[i].x_mm, zn->v[i].y_mm };
+            b = rect_bound(&b, &p);
+        }
+        for (uint8_t c = 0; c < clips; c++) {
+            if (rect_intersect(&b, &clip[c], &box[k])) k++;
+        }
+    }
+
+    if (k == 0) {
+        *out = *range;
+        return;
+    }
+
+    /* Merge the pair whose bounding box adds the least area beyond the two:
+     * always while that is nothing (stacked pieces of one zone), then until
+     * the slots suffice */
+    while (k > 1) {
+        size_t bi = 0, bj = 1;
+        int64_t best = INT64_MAX;
+        for (size_t i = 0; i < k; i++) {
+            for (size_t j = i + 1; j < k; j++) {
+                ld2450_rect_t pair[2] = { box[i], box[j] };
+                ld2450_rect_t m = rect_bound(&box[i], &box[j]);
+                int64_t extra = (int64_t)rect_area(&m) - union_area(pair, 2);
+                if (extra < best) {
+                    best = extra;
+                    bi = i;
+                    bj = j;
+                }
+            }
+        }
+        if (k <= LD2450_HW_FILTER_SLOTS && best > 0) break;
+        box[bi] = rect_bound(&box[bi], &box[bj]);
+        box[bj] = box[--k];
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->zone_type = 1;
+    out->count = (uint8_t)k;
+    memcpy(out->rect, box, k * sizeof(box[0]));
+}
+
+bool ld2450_hw_filter_contains(const ld2450_hw_filter_t *f, int16_t x, int16_t y)
+{
+    if (!f || f->zone_type == 0) return true;
+    for (uint8_t i = 0; i < f->count && i < LD2450_HW_FILTER_SLOTS; i++) {
+        const ld2450_rect_t *r = &f->rect[i];
+        if (x >= r->x1 && x <= r->x2 && y >= r->y1 && y <= r->y2) return true;
+    }
+    return false;
+}
+
+uint32_t ld2450_hw_filter_area_cm2(const ld2450_hw_filter_t *f)
+{
+    if (!f || f->zone_type == 0) {
+        return (uint32_t)(2 * LD2450_HW_FILTER_LIMIT) * LD2450_HW_FILTER_LIMIT / 100;
+    }
+    uint8_t n = f->count > LD2450_HW_FILTER_SLOTS ? LD2450_HW_FILTER_SLOTS : f->count;
+    return union_area(f->rect, n) / 100;
+}
+
+bool ld2450_hw_filter_equal(const ld2450_hw_filter_t *a, const ld2450_hw_filter_t *b)
+{
+    if (a->zone_type != b->zone_type) return false;
+    if (a->zone_type == 0) return true;
+    if (a->count != b->count) return false;
+    return memcmp(a->rect, b->rect, a->count * sizeof(a->rect[0])) == 0;
+}
+
+const char *ld2450_hw_filter_mode_name(uint8_t mode)
+{
+    return mode == LD2450_HW_FILTER_ZONES ? "zones" : "range";
+}
@@ -13,6 +13,7 @@ static const uint8_t k_update_header[4] = {0xAA, 0xFF, 0x03, 0x00};
 
 struct ld2450_parser {
     ld2450_report_t report;
+    ld2450_parser_stats_t stats;
 
     uint8_t *buf;
     size_t cap;
@@ -130,6 +131,24 @@ const ld2450_report_t *ld2450_parser_get_report(const ld2450_parser_t *p)
     return p ? &p->report : NULL;
 }
 
+void ld2450_parser_get_stats(const ld2450_parser_t *p, ld2450_parser_stats_t *out)
+{
+    if (!out) return;
+    if (!p) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = p->stats;
+}
+
+/* Drop n bytes that are not part of a frame */
+static void drop_garbage(ld2450_parser_t *p, size_t n)
+{
+    if (n > p->len) n = p->len;
+    p->stats.garbage_bytes += (uint32_t)n;
+    buf_consume(p, n);
+}
+
 bool ld2450_parser_feed(ld2450_parser_t *p, const uint8_t *data, size_t len)
 {
     if (!p || !data || len == 0) return false;
@@ -146,13 +165,14 @@ bool ld2450_parser_feed(ld2450_parser_t *p, const uint8_t *data, size_t len)
 
     memcpy(p->buf + p->len, data, len);
     p->len += len;
+    p->stats.bytes += (uint32_t)len;
 
     // Prevent runaway buffer growth if no headers appear (keep only a small tail)
     if (p->len > 8192) {
         // Keep last 64 bytes to preserve partial header possibilities
         const size_t keep = 64;
         const size_t drop = p->len - keep;
-        buf_consume(p, drop);
+        drop_garbage(p, drop);
     }
 
     bool parsed_any = false;
@@ -163,14 +183,14 @@ bool ld2450_parser_feed(ld2450_parser_t *p, const uint8_t *data, size_t len)
         if (pos < 0) {
             // Keep last 3 bytes in case header spans boundary
             if (p->len > 3) {
-                buf_consume(p, p->len - 3);
+                drop_garbage(p, p->len - 3);
             }
             break;
         }
 
         // Discard anything before header
         if (pos > 0) {
-            buf_consume(p, (size_t)pos);
+            drop_garbage(p, (size_t)pos);
         }
 
         // Need full frame
@@ -182,12 +202,14 @@ bool ld2450_parser_feed(ld2450_parser_t *p, const uint8_t *data, size_t len)
         const size_t end_idx = 4u + LD2450_UPDATE_PAYLOAD_LEN; // points to first end byte in buffer
         if (p->buf[end_idx + 0] != LD2450_END0 || p->buf[end_idx + 1] != LD2450_END1) {
             // Bad alignment; resync by dropping first byte and searching again
-            buf_consume(p, 1);
+            p->stats.bad_frames++;
+            drop_garbage(p, 1);
             continue;
         }
 
         // Parse payload
         parse_update_payload(p, p->buf + 4);
+        p->stats.frames++;
         parsed_any = true;
 
         // Consume this frame and continue scanning
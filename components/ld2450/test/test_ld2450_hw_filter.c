@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+// Host-side Unity tests for the hardware zone filter planner.
+//
+// Build (from components/ld2450/test/):
+//   make -f Makefile.hw_filter
+// Run:
+//   ./test_ld2450_hw_filter
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "ld2450_hw_filter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Single rectangle the firmware used before the planner */
+static uint32_t legacy_area_cm2(uint16_t d, uint8_t l, uint8_t r)
+{
+    double xl = d * tan(l * M_PI / 180.0), xr = d * tan(r * M_PI / 180.0);
+    if (xl > 6000) xl = 6000;
+    if (xr > 6000) xr = 6000;
+    return (uint32_t)((xl + xr) * d / 100.0);
+}
+
+/* Every sector point, sampled on a polar grid, lies inside the plan */
+static void assert_covers_sector(const ld2450_hw_filter_t *f, uint16_t d, uint8_t l, uint8_t r)
+{
+    for (int ri = 0; ri <= 60; ri++) {
+        double rad = d * ri / 60.0;
+        for (int ai = -180; ai <= 180; ai++) {
+            double deg = ai / 2.0;
+            if (deg < -l || deg > r) continue;
+            double a = deg * M_PI / 180.0;
+            int16_t x = (int16_t)lround(rad * sin(a));
+            int16_t y = (int16_t)lround(rad * cos(a));
+            if (y < 0) y = 0;
+            if (!ld2450_hw_filter_contains(f, x, y)) {
+                char msg[96];
+                snprintf(msg, sizeof(msg), "d=%u l=%u r=%u misses (%d,%d)", d, l, r, x, y);
+                TEST_FAIL_MESSAGE(msg);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Range plans
+// ---------------------------------------------------------------------------
+
+void test_range_full_is_off(void)
+{
+    ld2450_hw_filter_t f;
+    ld2450_hw_filter_plan_range(6000, 90, 90, &f);
+    TEST_ASSERT_EQUAL_UINT8(0, f.zone_type);
+    TEST_ASSERT_EQUAL_UINT8(0, f.count);
+    TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, -5999, 5999));
+}
+
+void test_range_clamps_inputs(void)
+{
+    ld2450_hw_filter_t a, b;
+    ld2450_hw_filter_plan_range(9000, 120, 200, &a);
+    ld2450_hw_filter_plan_range(6000, 90, 90, &b);
+    TEST_ASSERT_TRUE(ld2450_hw_filter_equal(&a, &b));
+}
+
+void test_range_covers_sector(void)
+{
+    static const struct { uint16_t d; uint8_t l, r; } cases[] = {
+        {5000, 45, 45}, {3000, 60, 30}, {6000, 90, 0}, {6000, 60, 60},
+        {2000, 90, 90}, {4500, 10, 80}, {1500, 0, 0}, {6000, 89, 89},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ld2450_hw_filter_t f;
+        ld2450_hw_filter_plan_range(cases[i].d, cases[i].l, cases[i].r, &f);
+        TEST_ASSERT_EQUAL_UINT8(1, f.zone_type);
+        TEST_ASSERT_TRUE(f.count >= 1 && f.count <= LD2450_HW_FILTER_SLOTS);
+        assert_covers_sector(&f, cases[i].d, cases[i].l, cases[i].r);
+    }
+}
+
+void test_range_smaller_than_single_rect(void)
+{
+    /* 5 m, +-60 deg: one rect is 10 m x 5 m clamped to 12 m wide */
+    ld2450_hw_filter_t f;
+    ld2450_hw_filter_plan_range(5000, 60, 60, &f);
+    uint32_t a = ld2450_hw_filter_area_cm2(&f);
+    TEST_ASSERT_TRUE(a < legacy_area_cm2(5000, 60, 60) * 7 / 10);
+
+    /* Sector area is a lower bound */
+    uint32_t sector = (uint32_t)(5000.0 * 5000.0 * (120.0 * M_PI / 180.0) / 2.0 / 100.0);
+    TEST_ASSERT_TRUE(a >= sector);
+}
+
+void test_range_rects_stay_in_limits(void)
+{
+    ld2450_hw_filter_t f;
+    ld2450_hw_filter_plan_range(6000, 90, 45, &f);
+    for (uint8_t i = 0; i < f.count; i++) {
+        TEST_ASSERT_TRUE(f.rect[i].x1 >= -6000 && f.rect[i].x2 <= 6000);
+        TEST_ASSERT_TRUE(f.rect[i].y1 >= 0 && f.rect[i].y2 <= 6000);
+        TEST_ASSERT_TRUE(f.rect[i].x1 <= f.rect[i].x2 && f.rect[i].y1 < f.rect[i].y2);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Zone plans
+// ---------------------------------------------------------------------------
+
+static ld2450_zone_t box_zone(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    ld2450_zone_t z = {
+        .vertex_count = 4,
+        .v = { {x1, y1}, {x2, y1}, {x2, y2}, {x1, y2} }
+    };
+    return z;
+}
+
+void test_zones_none_falls_back_to_range(void)
+{
+    ld2450_zone_t zones[10] = {0};
+    ld2450_hw_filter_t range, f;
+    ld2450_hw_filter_plan_range(4000, 45, 45, &range);
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_TRUE(ld2450_hw_filter_equal(&range, &f));
+}
+
+void test_zones_three_kept_apart(void)
+{
+    ld2450_zone_t zones[10] = {0};
+    zones[0] = box_zone(-2000, 500, -1000, 1500);
+    zones[2] = box_zone(0, 2000, 500, 2500);
+    zones[5] = (ld2450_zone_t){ .vertex_count = 3, .v = { {1000, 3000}, {2000, 3000}, {1500, 4000} } };
+    ld2450_hw_filter_t range, f;
+    ld2450_hw_filter_plan_range(6000, 90, 90, &range);
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_EQUAL_UINT8(1, f.zone_type);
+    TEST_ASSERT_EQUAL_UINT8(3, f.count);
+    TEST_ASSERT_EQUAL_UINT32(10000 + 2500 + 10000, ld2450_hw_filter_area_cm2(&f));
+    TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, 1500, 4000));
+    TEST_ASSERT_FALSE(ld2450_hw_filter_contains(&f, 0, 1000));
+}
+
+void test_zones_merge_nearest(void)
+{
+    /* Two close pairs and one far zone: the pairs merge, not the far one */
+    ld2450_zone_t zones[10] = {0};
+    zones[0] = box_zone(-3000, 1000, -2500, 1500);
+    zones[1] = box_zone(-2400, 1000, -2000, 1500);
+    zones[2] = box_zone(2000, 1000, 2500, 1500);
+    zones[3] = box_zone(2600, 1000, 3000, 1500);
+    zones[4] = box_zone(-500, 5000, 500, 5500);
+    ld2450_hw_filter_t range, f;
+    ld2450_hw_filter_plan_range(6000, 90, 90, &range);
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_EQUAL_UINT8(3, f.count);
+    TEST_ASSERT_FALSE(ld2450_hw_filter_contains(&f, 0, 3000));
+    TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, -2450, 1200));   /* gap inside merged pair */
+    for (int z = 0; z < 5; z++) {
+        for (uint8_t v = 0; v < zones[z].vertex_count; v++) {
+            TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, zones[z].v[v].x_mm, zones[z].v[v].y_mm));
+        }
+    }
+}
+
+void test_zones_clipped_to_range(void)
+{
+    ld2450_zone_t zones[10] = {0};
+    zones[0] = box_zone(-1000, 1000, 1000, 5000);
+    zones[1] = box_zone(3000, 4500, 4000, 5500);     /* outside 3 m range */
+    ld2450_hw_filter_t range, f;
+    ld2450_hw_filter_plan_range(3000, 90, 90, &range);
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_EQUAL_UINT8(1, f.count);
+    TEST_ASSERT_EQUAL_INT16(3000, f.rect[0].y2);
+    TEST_ASSERT_FALSE(ld2450_hw_filter_contains(&f, 0, 4000));
+}
+
+void test_zones_clipped_to_each_range_rect(void)
+{
+    /* 45/45 degree range: narrow near the sensor, wide further out */
+    ld2450_zone_t zones[10] = {0};
+    ld2450_hw_filter_t range, f;
+    ld2450_hw_filter_plan_range(6000, 45, 45, &range);
+
+    zones[0] = box_zone(-4000, 300, -3500, 800);     /* beside the sector, inside its bounds */
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_TRUE(ld2450_hw_filter_equal(&range, &f));
+
+    zones[0] = box_zone(-2500, 500, 2500, 2000);     /* spans the two nearest rects */
+    ld2450_hw_filter_plan_zones(zones, 10, &range, &f);
+    TEST_ASSERT_EQUAL_UINT8(2, f.count);
+    TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, 0, 600));
+    TEST_ASSERT_TRUE(ld2450_hw_filter_contains(&f, -2400, 1900));
+    TEST_ASSERT_FALSE(ld2450_hw_filter_contains(&f, -2000, 800));
+}
+
+void test_area_union_of_overlaps(void)
+{
+    ld2450_hw_filter_t f = {
+        .zone_type = 1, .count = 3,
+        .rect = { {0, 0, 1000, 1000}, {500, 500, 1500, 1500}, {0, 0, 1000, 1000} }
+    };
+    TEST_ASSERT_EQUAL_UINT32(17500, ld2450_hw_filter_area_cm2(&f));
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_range_full_is_off);
+    RUN_TEST(test_range_clamps_inputs);
+    RUN_TEST(test_range_covers_sector);
+    RUN_TEST(test_range_smaller_than_single_rect);
+    RUN_TEST(test_range_rects_stay_in_limits);
+    RUN_TEST(test_zones_none_falls_back_to_range);
+    RUN_TEST(test_zones_three_kept_apart);
+    RUN_TEST(test_zones_merge_nearest);
+    RUN_TEST(test_zones_clipped_to_range);
+    RUN_TEST(test_zones_clipped_to_each_range_rect);
+    RUN_TEST(test_area_union_of_overlaps);
+
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "ack_stats.h"
+
+static void put_u16(uint8_t *p, uint32_t v)
+{
+    if (v > 0xFFFF) v = 0xFFFF;
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint8_t sat_u8(uint32_t v)
+{
+    return v > 0xFF ? 0xFF : (uint8_t)v;
+}
+
+void ack_stats_init(ack_stats_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+uint8_t ack_stats_bucket(uint32_t ms)
+{
+    uint8_t b = 0;
+    uint32_t edge = ACK_HIST_FIRST_MS;
+    while (b < ACK_HIST_BUCKETS - 1 && ms >= edge) {
+        b++;
+        edge <<= 1;
+    }
+    return b;
+}
+
+uint32_t ack_stats_bucket_edge_ms(uint8_t b)
+{
+    if (b >= ACK_HIST_BUCKETS) b = ACK_HIST_BUCKETS - 1;
+    return (uint32_t)ACK_HIST_FIRST_MS << b;
+}
+
+void ack_stats_sent(ack_stats_t *s, uint8_t ep_idx)
+{
+    if (ep_idx < ACK_STATS_EPS) s->ep[ep_idx].sent++;
+}
+
+void ack_stats_acked(ack_stats_t *s, uint8_t ep_idx, uint32_t latency_ms)
+{
+    if (ep_idx >= ACK_STATS_EPS) return;
+    s->ep[ep_idx].acked++;
+    s->hist[ack_stats_bucket(latency_ms)]++;
+    s->samples++;
+    if (latency_ms > s->max_ms) s->max_ms = latency_ms;
+}
+
+void ack_stats_retry(ack_stats_t *s, uint8_t ep_idx)
+{
+    if (ep_idx < ACK_STATS_EPS) s->ep[ep_idx].retries++;
+}
+
+void ack_stats_failed(ack_stats_t *s, uint8_t ep_idx)
+{
+    if (ep_idx < ACK_STATS_EPS) s->ep[ep_idx].failed++;
+}
+
+void ack_stats_soft_fault(ack_stats_t *s)
+{
+    s->soft_faults++;
+}
+
+uint32_t ack_stats_percentile_ms(const ack_stats_t *s, uint8_t pct)
+{
+    if (s->samples == 0) return 0;
+    if (pct > 100) pct = 100;
+    /* Smallest bucket whose cumulative count reaches pct% of the samples */
+    uint64_t need = ((uint64_t)s->samples * pct + 99) / 100;
+    if (need == 0) need = 1;
+    uint64_t cum = 0;
+    for (uint8_t b = 0; b < ACK_HIST_BUCKETS; b++) {
+        cum += s->hist[b];
+        if (cum >= need) return ack_stats_bucket_edge_ms(b);
+    }
+    return ack_stats_bucket_edge_ms(ACK_HIST_BUCKETS - 1);
+}
+
+uint32_t ack_stats_suggest_timeout_ms(const ack_stats_t *s)
+{
+    if (s->samples < ACK_STATS_MIN_SAMPLES) return 0;
+    uint32_t t = 2 * ack_stats_percentile_ms(s, 99);
+    if (t < ACK_TIMEOUT_MIN_MS) t = ACK_TIMEOUT_MIN_MS;
+    if (t > ACK_TIMEOUT_MAX_MS) t = ACK_TIMEOUT_MAX_MS;
+    return t;
+}
+
+void ack_stats_totals(const ack_stats_t *s, ack_ep_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < ACK_STATS_EPS; i++) {
+        out->sent    += s->ep[i].sent;
+        out->acked   += s->ep[i].acked;
+        out->retries += s->ep[i].retries;
+        out->failed  += s->ep[i].failed;
+    }
+}
+
+uint32_t ack_stats_fail_permille(const ack_stats_t *s)
+{
+    ack_ep_stats_t t;
+    ack_stats_totals(s, &t);
+    if (t.sent == 0) return 0;
+    return (uint32_t)((uint64_t)t.failed * 1000 / t.sent);
+}
+
+void ack_stats_pack(const ack_stats_t *s, uint16_t srtt_ms, uint8_t out[ACK_STATS_PAYLOAD_LEN])
+{
+    memset(out, 0, ACK_STATS_PAYLOAD_LEN);
+    out[0] = ACK_STATS_VERSION;
+
+    /* Scale all buckets by the same power of two so the largest fits */
+    uint32_t peak = 0;
+    for (int b = 0; b < ACK_HIST_BUCKETS; b++) {
+        if (s->hist[b] > peak) peak = s->hist[b];
+    }
+    uint8_t shift = 0;
+    while ((peak >> shift) > 0xFFFF) shift++;
+    for (int b = 0; b < ACK_HIST_BUCKETS; b++) {
+        put_u16(out + 1 + 2 * b, s->hist[b] >> shift);
+    }
+
+    uint8_t *p = out + 1 + 2 * ACK_HIST_BUCKETS;
+    put_u16(p + 0, srtt_ms);
+    put_u16(p + 2, ack_stats_suggest_timeout_ms(s));
+    put_u16(p + 4, s->soft_faults);
+    put_u16(p + 6, ack_stats_fail_permille(s));
+    p += 8;
+    for (int i = 0; i < ACK_STATS_EPS; i++) {
+        p[i]                 = sat_u8(s->ep[i].retries);
+        p[ACK_STATS_EPS + i] = sat_u8(s->ep[i].failed);
+    }
+}
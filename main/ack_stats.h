@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Occupancy report link statistics: send -> APS ACK latency histogram,
+ * per-endpoint retry / failure counts and the soft-fault rate.
+ *
+ * Latency buckets are powers of two: bucket 0 is < 25 ms, bucket b < 25 << b
+ * ms, and the last bucket holds everything from 6.4 s up.  Percentiles are
+ * reported as the upper edge of the bucket they fall in, so they are always
+ * a safe (high) estimate.
+ *
+ * Packed attribute (ZB_ATTR_LINK_STATS, little-endian, ACK_STATS_PAYLOAD_LEN
+ * bytes):
+ *   [0]       version (ACK_STATS_VERSION)
+ *   [1 + 2b]  uint16 ACK count in latency bucket b, b = 0..9 (scaled down
+ *             together if any count exceeds 65535, so the shape is kept)
+ *   [21]      uint16 smoothed ACK latency, ms
+ *   [23]      uint16 suggested ACK timeout, ms (0 = not enough samples)
+ *   [25]      uint16 soft faults since boot
+ *   [27]      uint16 failed reports per 1000 sent (retries exhausted)
+ *   [29 + i]  uint8 retries for endpoint i + 1 (saturating), i = 0..10
+ *   [40 + i]  uint8 failed reports for endpoint i + 1 (saturating)
+ */
+
+#define ACK_STATS_VERSION        1
+#define ACK_HIST_BUCKETS         10
+#define ACK_HIST_FIRST_MS        25
+#define ACK_STATS_EPS            11
+#define ACK_STATS_PAYLOAD_LEN    (1 + 2 * ACK_HIST_BUCKETS + 8 + 2 * ACK_STATS_EPS)   /* 51 */
+
+#define ACK_STATS_MIN_SAMPLES    50      /* ACKs needed before a timeout is suggested */
+#define ACK_TIMEOUT_MIN_MS       500     /* nvs_config_save_ack_timeout_ms() floor */
+#define ACK_TIMEOUT_MAX_MS       10000
+
+typedef struct {
+    uint32_t sent;           /* transmissions, retries included */
+    uint32_t acked;
+    uint32_t retries;
+    uint32_t failed;         /* retries exhausted */
+} ack_ep_stats_t;
+
+typedef struct {
+    uint32_t       hist[ACK_HIST_BUCKETS];
+    uint32_t       samples;
+    uint32_t       max_ms;
+    uint32_t       soft_faults;
+    ack_ep_stats_t ep[ACK_STATS_EPS];
+} ack_stats_t;
+
+void ack_stats_init(ack_stats_t *s);
+
+/** Latency bucket for ms, and the (exclusive) upper edge of bucket b. */
+uint8_t  ack_stats_bucket(uint32_t ms);
+uint32_t ack_stats_bucket_edge_ms(uint8_t b);
+
+void ack_stats_sent(ack_stats_t *s, uint8_t ep_idx);
+/** ACK for ep_idx latency_ms after the send. */
+void ack_stats_acked(ack_stats_t *s, uint8_t ep_idx, uint32_t latency_ms);
+void ack_stats_retry(ack_stats_t *s, uint8_t ep_idx);
+void ack_stats_failed(ack_stats_t *s, uint8_t ep_idx);
+void ack_stats_soft_fault(ack_stats_t *s);
+
+/** Latency below which pct percent of ACKs arrived (bucket edge); 0 without samples. */
+uint32_t ack_stats_percentile_ms(const ack_stats_t *s, uint8_t pct);
+
+/**
+ * ACK timeout that covers the measured link: twice the 99th percentile,
+ * clamped to ACK_TIMEOUT_MIN_MS..ACK_TIMEOUT_MAX_MS.  0 until
+ * ACK_STATS_MIN_SAMPLES ACKs have been seen.
+ */
+uint32_t ack_stats_suggest_timeout_ms(const ack_stats_t *s);
+
+/** Failed reports per 1000 sent, all endpoints. */
+uint32_t ack_stats_fail_permille(const ack_stats_t *s);
+
+/** Totals over all endpoints. */
+void ack_stats_totals(const ack_stats_t *s, ack_ep_stats_t *out);
+
+void ack_stats_pack(const ack_stats_t *s, uint16_t srtt_ms, uint8_t out[ACK_STATS_PAYLOAD_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
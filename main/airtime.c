@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "airtime.h"
+
+uint32_t airtime_frame_us(uint16_t zcl_len)
+{
+    return (uint32_t)(AIRTIME_FRAME_OVERHEAD + zcl_len) * AIRTIME_US_PER_BYTE + AIRTIME_ACK_US;
+}
+
+void airtime_init(airtime_t *a, uint32_t now_ms)
+{
+    memset(a, 0, sizeof(*a));
+    a->bucket_start_ms = now_ms;
+}
+
+/* Rotate buckets up to now_ms, clearing the ones that fell out of the hour */
+static void advance(airtime_t *a, uint32_t now_ms)
+{
+    uint32_t elapsed = now_ms - a->bucket_start_ms;
+    if (elapsed < AIRTIME_BUCKET_MS) return;
+
+    uint32_t steps = elapsed / AIRTIME_BUCKET_MS;
+    if (steps > AIRTIME_BUCKETS) steps = AIRTIME_BUCKETS;
+    for (uint32_t i = 0; i < steps; i++) {
+        a->cur = (uint8_t)((a->cur + 1) % AIRTIME_BUCKETS);
+        a->us[a->cur]     = 0;
+        a->frames[a->cur] = 0;
+    }
+    a->bucket_start_ms += (elapsed / AIRTIME_BUCKET_MS) * AIRTIME_BUCKET_MS;
+}
+
+void airtime_add(airtime_t *a, uint32_t now_ms, uint16_t zcl_len)
+{
+    uint32_t us = airtime_frame_us(zcl_len);
+    advance(a, now_ms);
+    a->us[a->cur] += us;
+    a->frames[a->cur]++;
+    a->total_us += us;
+    a->total_frames++;
+}
+
+void airtime_last_hour(airtime_t *a, uint32_t now_ms, uint32_t *frames, uint32_t *us)
+{
+    advance(a, now_ms);
+    uint32_t f = 0, t = 0;
+    for (int i = 0; i < AIRTIME_BUCKETS; i++) {
+        f += a->frames[i];
+        t += a->us[i];
+    }
+    if (frames) *frames = f;
+    if (us) *us = t;
+}
+
+uint32_t airtime_jittered_period(uint32_t period_ms, uint32_t jitter_ms, uint32_t r)
+{
+    if (jitter_ms == 0 || jitter_ms >= period_ms) return period_ms;
+    return period_ms - jitter_ms + r % (2 * jitter_ms + 1);
+}
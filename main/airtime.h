@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Outgoing Zigbee airtime accounting and keep-alive scheduling helpers.
+ *
+ * Airtime is an estimate for one hop at 250 kbit/s (32 us per byte): the
+ * ZCL frame plus PHY/MAC/NWK (with security)/APS framing, the MAC ACK and
+ * the RX/TX turnaround.  CSMA backoff and relaying hops are not included,
+ * so multiply by the hop count for the mesh-wide cost.
+ *
+ * Usage is kept in AIRTIME_BUCKETS rolling buckets covering the last hour.
+ */
+
+#define AIRTIME_US_PER_BYTE     32
+#define AIRTIME_FRAME_OVERHEAD  51      /* SHR+PHR 6, MAC 11, NWK 8 + aux sec 14 + MIC 4, APS 8 */
+#define AIRTIME_ACK_US          (11 * AIRTIME_US_PER_BYTE + 192)   /* MAC ACK + turnaround */
+
+#define AIRTIME_BUCKETS         12
+#define AIRTIME_BUCKET_MS       300000u  /* 12 x 5 min = one hour */
+
+typedef struct {
+    uint32_t us[AIRTIME_BUCKETS];
+    uint32_t frames[AIRTIME_BUCKETS];
+    uint8_t  cur;
+    uint32_t bucket_start_ms;
+    uint32_t total_frames;               /* since init */
+    uint64_t total_us;
+} airtime_t;
+
+/** Estimated single-hop airtime of one frame carrying zcl_len bytes of ZCL. */
+uint32_t airtime_frame_us(uint16_t zcl_len);
+
+void airtime_init(airtime_t *a, uint32_t now_ms);
+
+/** Account one frame sent at now_ms. */
+void airtime_add(airtime_t *a, uint32_t now_ms, uint16_t zcl_len);
+
+/** Frames and airtime (us) over the last hour. */
+void airtime_last_hour(airtime_t *a, uint32_t now_ms, uint32_t *frames, uint32_t *us);
+
+/**
+ * Keep-alive period with +/- jitter_ms spread, from a random value r.  Each
+ * device draws a fresh r every period so devices that powered up together
+ * drift apart instead of refreshing in lock-step.
+ */
+uint32_t airtime_jittered_period(uint32_t period_ms, uint32_t jitter_ms, uint32_t r);
+
+#ifdef __cplusplus
+}
+#endif
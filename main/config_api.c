@@ -3,13 +3,18 @@
 
 #include "coordinator_fallback.h"
 #include "ld2450.h"
-#include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
+#include "ld2450_hw_filter.h"
 #include "ld2450_zone.h"
 #include "ld2450_zone_csv.h"
 #include "nvs_config.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
 #include "cJSON.h"
+#include <stdio.h>
 #include <string.h>
 
 /* Max bytes for a zone coords CSV string (10 vertices × ~15 chars/pair + separators) */
@@ -19,15 +24,195 @@ static const char *TAG = "config_api";
 
 /* ---- Sensor hardware config ---- */
 
+/* Sensor commands waiting for the settle window or an open config_api_begin() */
+#define SENSOR_PENDING_REGION   0x01
+
+/* Sliders and Z2M write distance, left and right angle back-to-back: wait
+ * for the writes to settle, then program the merged result once.  A change
+ * stream that never settles is flushed after SETTLE_MAX_MS. */
+#define SETTLE_MS               CONFIG_LD2450_SENSOR_CMD_SETTLE_MS
+#define SETTLE_MAX_MS           (4 * SETTLE_MS)
+
+static portMUX_TYPE s_sensor_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t s_sensor_txn_depth = 0;
+static uint8_t s_sensor_pending = 0;
+static esp_timer_handle_t s_settle_timer = NULL;
+static int64_t s_settle_first_us = 0;       /* first change of the pending set */
+static config_api_sensor_stats_t s_sensor_stats;
+
+static void sensor_cmd_done(uint32_t ticket, esp_err_t err, void *arg)
+{
+    (void)arg;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "sensor cmd #%u: %s", (unsigned)ticket, esp_err_to_name(err));
+    }
+}
+
+static void plan_hw_filter(const nvs_config_t *cfg, ld2450_hw_filter_t *out)
+{
+    ld2450_hw_filter_t range;
+    ld2450_hw_filter_plan_range(cfg->max_distance_mm, cfg->angle_left_deg,
+                                cfg->angle_right_deg, &range);
+    if (cfg->hw_filter_mode == LD2450_HW_FILTER_ZONES) {
+        ld2450_hw_filter_plan_zones(cfg->zones, 10, &range, out);
+    } else {
+        *out = range;
+    }
+}
+
+/* Queue the pending sensor changes, from the saved config, as one batch on
+ * the command worker; the caller returns without waiting for the sensor's
+ * ACKs. */
+static void submit_sensor_batch(uint8_t pending)
+{
+    ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_BATCH };
+    ld2450_cmd_batch_init(&req.u.batch);
+    if (pending & SENSOR_PENDING_REGION) {
+        ld2450_hw_filter_t f;
+        config_api_plan_hw_filter(&f);
+        ld2450_cmd_batch_add_filter(&req.u.batch, &f);
+    }
+    if (req.u.batch.count == 0) return;
+
+    portENTER_CRITICAL(&s_sensor_lock);
+    s_sensor_stats.updates++;
+    portEXIT_CRITICAL(&s_sensor_lock);
+
+    esp_err_t err = ld2450_cmd_submit(&req, sensor_cmd_done, NULL, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "queue sensor cmd: %s", esp_err_to_name(err));
+    }
+}
+
+/* Take the pending set unless a begin/commit group is open (its commit
+ * re-arms the window) */
+static uint8_t take_pending(void)
+{
+    uint8_t pending = 0;
+    portENTER_CRITICAL(&s_sensor_lock);
+    if (s_sensor_txn_depth == 0) {
+        pending = s_sensor_pending;
+        s_sensor_pending = 0;
+        s_settle_first_us = 0;
+    }
+    portEXIT_CRITICAL(&s_sensor_lock);
+    return pending;
+}
+
+static void settle_timer_cb(void *arg)
+{
+    (void)arg;
+    uint8_t pending = take_pending();
+    if (pending) submit_sensor_batch(pending);
+}
+
+/* (Re)start the settle window; past SETTLE_MAX_MS the running timer is
+ * left to fire */
+static void arm_settle(void)
+{
+    if (!s_settle_timer) {          /* before config_api_init(): no window */
+        settle_timer_cb(NULL);
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_sensor_lock);
+    if (s_settle_first_us == 0) s_settle_first_us = now;
+    bool extend = (now - s_settle_first_us) < (int64_t)SETTLE_MAX_MS * 1000;
+    portEXIT_CRITICAL(&s_sensor_lock);
+
+    if (extend || !esp_timer_is_active(s_settle_timer)) {
+        esp_timer_stop(s_settle_timer);
+        esp_timer_start_once(s_settle_timer, (uint64_t)SETTLE_MS * 1000);
+    }
+}
+
+static void sensor_changed(uint8_t what)
+{
+    portENTER_CRITICAL(&s_sensor_lock);
+    s_sensor_pending |= what;
+    s_sensor_stats.changes++;
+    bool defer = s_sensor_txn_depth > 0;
+    portEXIT_CRITICAL(&s_sensor_lock);
+    if (!defer) arm_settle();
+}
+
+esp_err_t config_api_init(void)
+{
+    if (s_settle_timer || SETTLE_MS == 0) return ESP_OK;
+    const esp_timer_create_args_t args = {
+        .callback = settle_timer_cb,
+        .name     = "cfg_settle",
+    };
+    return esp_timer_create(&args, &s_settle_timer);
+}
+
+void config_api_begin(void)
+{
+    portENTER_CRITICAL(&s_sensor_lock);
+    s_sensor_txn_depth++;
+    portEXIT_CRITICAL(&s_sensor_lock);
+}
+
+void config_api_commit(void)
+{
+    bool pending = false;
+    portENTER_CRITICAL(&s_sensor_lock);
+    if (s_sensor_txn_depth > 0 && --s_sensor_txn_depth == 0) {
+        pending = s_sensor_pending != 0;
+    }
+    portEXIT_CRITICAL(&s_sensor_lock);
+    if (pending) arm_settle();
+}
+
+void config_api_plan_hw_filter(ld2450_hw_filter_t *out)
+{
+    if (!out) return;
+    /* The plan reads range, angles, mode and all zones: one consistent copy */
+    nvs_config_t cfg;
+    nvs_config_get(&cfg);
+    plan_hw_filter(&cfg, out);
+}
+
+void config_api_build_sensor_batch(ld2450_cmd_batch_t *b)
+{
+    if (!b) return;
+    nvs_config_t cfg;
+    nvs_config_get(&cfg);
+    ld2450_hw_filter_t filter;
+    plan_hw_filter(&cfg, &filter);
+
+    ld2450_cmd_batch_init(b);
+    if (cfg.bt_disabled) {
+        ld2450_cmd_batch_add_bluetooth(b, false);
+    }
+    ld2450_cmd_batch_add_filter(b, &filter);
+}
+
+void config_api_zones_changed(void)
+{
+    /* Zones shape the sensor filter only in zones mode */
+    uint8_t mode;
+    NVS_CONFIG_READ(hw_filter_mode, &mode);
+    if (mode == LD2450_HW_FILTER_ZONES) {
+        sensor_changed(SENSOR_PENDING_REGION);
+    }
+}
+
+void config_api_get_sensor_stats(config_api_sensor_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_sensor_lock);
+    *out = s_sensor_stats;
+    portEXIT_CRITICAL(&s_sensor_lock);
+}
+
 esp_err_t config_api_set_max_distance(uint16_t mm)
 {
     esp_err_t err = nvs_config_save_max_distance(mm);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "save max_distance: %s", esp_err_to_name(err));
     }
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
-    ld2450_cmd_apply_distance_angle(cfg.max_distance_mm, cfg.angle_left_deg, cfg.angle_right_deg);
+    sensor_changed(SENSOR_PENDING_REGION);
     return err;
 }
 
@@ -37,9 +222,7 @@ esp_err_t config_api_set_angle_left(uint8_t deg)
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "save angle_left: %s", esp_err_to_name(err));
     }
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
-    ld2450_cmd_apply_distance_angle(cfg.max_distance_mm, cfg.angle_left_deg, cfg.angle_right_deg);
+    sensor_changed(SENSOR_PENDING_REGION);
     return err;
 }
 
@@ -49,9 +232,17 @@ esp_err_t config_api_set_angle_right(uint8_t deg)
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "save angle_right: %s", esp_err_to_name(err));
     }
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
-    ld2450_cmd_apply_distance_angle(cfg.max_distance_mm, cfg.angle_left_deg, cfg.angle_right_deg);
+    sensor_changed(SENSOR_PENDING_REGION);
+    return err;
+}
+
+esp_err_t config_api_set_hw_filter_mode(uint8_t mode)
+{
+    esp_err_t err = nvs_config_save_hw_filter_mode(mode);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "save hw_filter_mode: %s", esp_err_to_name(err));
+    }
+    sensor_changed(SENSOR_PENDING_REGION);
     return err;
 }
 
@@ -65,16 +256,27 @@ esp_err_t config_api_set_tracking_mode(uint8_t mode)
     return err;
 }
 
-esp_err_t config_api_set_publish_coords(uint8_t enabled)
+esp_err_t config_api_set_publish_coords(uint8_t mode)
 {
-    ld2450_set_publish_coords(enabled != 0);
-    esp_err_t err = nvs_config_save_publish_coords(enabled);
+    ld2450_set_publish_coords(mode != 0);
+    esp_err_t err = nvs_config_save_publish_coords(mode);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "save publish_coords: %s", esp_err_to_name(err));
     }
     return err;
 }
 
+esp_err_t config_api_set_coord_deadband(uint16_t mm)
+{
+    /* sensor_bridge picks up the dead-band on its next poll */
+    return nvs_config_save_coord_deadband(mm);
+}
+
+esp_err_t config_api_set_coord_min_interval(uint16_t ms)
+{
+    return nvs_config_save_coord_min_interval(ms);
+}
+
 /* ---- Occupancy timing ---- */
 
 esp_err_t config_api_set_occupancy_cooldown(uint8_t ep_idx, uint16_t sec)
@@ -112,6 +314,12 @@ esp_err_t config_api_set_fallback_cooldown(uint8_t ep_idx, uint16_t sec)
     return nvs_config_save_fallback_cooldown(ep_idx, sec);
 }
 
+esp_err_t config_api_set_fallback_group(uint8_t ep_idx, uint16_t group)
+{
+    /* coordinator_fallback reads the group from the config on each command */
+    return nvs_config_save_fallback_group(ep_idx, group);
+}
+
 esp_err_t config_api_set_fallback_enable(uint8_t enable)
 {
     coordinator_fallback_set_enable(enable);
@@ -130,6 +338,57 @@ esp_err_t config_api_set_ack_timeout(uint16_t ms)
     return ESP_OK;
 }
 
+/* ---- Zone occupancy reporting ---- */
+
+esp_err_t config_api_set_zone_ep_reports(uint8_t enable)
+{
+    /* sensor_bridge picks the change up from the next config generation */
+    return nvs_config_save_zone_ep_reports(enable ? 1 : 0);
+}
+
+/* ---- Report rate limiter ---- */
+
+esp_err_t config_api_set_rate_burst(uint8_t burst)
+{
+    /* coordinator_fallback follows the config on the next report */
+    return nvs_config_save_rate_burst(burst);
+}
+
+esp_err_t config_api_set_rate_per_min(uint16_t per_min)
+{
+    return nvs_config_save_rate_per_min(per_min);
+}
+
+/* ---- Local automation rules ---- */
+
+esp_err_t config_api_set_rules(const cJSON *texts, char *err_buf, size_t err_len)
+{
+    if (!cJSON_IsArray(texts)) {
+        snprintf(err_buf, err_len, "rules must be an array of strings");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    local_rules_t rules;
+    local_rules_init(&rules);
+    int n = 0;
+    const cJSON *t;
+    cJSON_ArrayForEach(t, texts) {
+        n++;
+        local_rule_t r;
+        const char *perr = "not a string";
+        if (!cJSON_IsString(t) || !local_rule_parse(t->valuestring, &r, &perr)) {
+            snprintf(err_buf, err_len, "rule %d: %s", n, perr);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (!local_rules_add(&rules, &r)) {
+            snprintf(err_buf, err_len, "at most %d rules", LOCAL_RULES_MAX);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    /* coordinator_fallback reads the table from the config on the next transition */
+    return nvs_config_save_rules(&rules);
+}
+
 /* ---- Heartbeat watchdog ---- */
 
 esp_err_t config_api_set_heartbeat_enable(uint8_t enable)
@@ -158,25 +417,27 @@ esp_err_t config_api_set_zone_vertex_count(uint8_t zone_idx, uint8_t vc)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
+    ld2450_zone_t zone;
+    NVS_CONFIG_READ(zones[zone_idx], &zone);
 
     if (vc > MAX_ZONE_VERTICES) {
         vc = 0;  /* clamp invalid to disabled */
     }
-    cfg.zones[zone_idx].vertex_count = vc;
+    zone.vertex_count = vc;
 
     if (vc < 3) {
         /* Disabling zone: zero coords */
-        memset(cfg.zones[zone_idx].v, 0, sizeof(cfg.zones[zone_idx].v));
+        memset(zone.v, 0, sizeof(zone.v));
     }
 
-    esp_err_t ze = ld2450_set_zone((size_t)zone_idx, &cfg.zones[zone_idx]);
+    esp_err_t ze = ld2450_set_zone((size_t)zone_idx, &zone);
     if (ze == ESP_OK) {
-        return nvs_config_save_zone(zone_idx, &cfg.zones[zone_idx]);
+        esp_err_t err = nvs_config_save_zone(zone_idx, &zone);
+        config_api_zones_changed();
+        return err;
     } else {
         /* vc >= 3 but no coords yet: cache only, wait for coords write */
-        nvs_config_update_zone_cache(zone_idx, &cfg.zones[zone_idx]);
+        nvs_config_update_zone_cache(zone_idx, &zone);
         return ESP_OK;
     }
 }
@@ -187,19 +448,21 @@ esp_err_t config_api_set_zone_coords(uint8_t zone_idx, const char *csv)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
+    ld2450_zone_t zone;
+    NVS_CONFIG_READ(zones[zone_idx], &zone);
 
     int pairs = csv_count_pairs(csv);
-    if (pairs != cfg.zones[zone_idx].vertex_count) {
+    if (pairs != zone.vertex_count) {
         ESP_LOGW(TAG, "zone_%d coords rejected: expected %d pairs, got %d",
-                 zone_idx + 1, cfg.zones[zone_idx].vertex_count, pairs);
+                 zone_idx + 1, zone.vertex_count, pairs);
         return ESP_ERR_INVALID_ARG;
     }
 
-    csv_to_zone(csv, &cfg.zones[zone_idx]);
-    ld2450_set_zone((size_t)zone_idx, &cfg.zones[zone_idx]);
-    return nvs_config_save_zone(zone_idx, &cfg.zones[zone_idx]);
+    csv_to_zone(csv, &zone);
+    ld2450_set_zone((size_t)zone_idx, &zone);
+    esp_err_t err = nvs_config_save_zone(zone_idx, &zone);
+    config_api_zones_changed();
+    return err;
 }
 
 /* ---- Read-all serialization ---- */
@@ -221,9 +484,12 @@ esp_err_t config_api_get_all(cJSON **out)
     /* Sensor config */
     cJSON_AddNumberToObject(root, "tracking_mode",    cfg.tracking_mode);
     cJSON_AddNumberToObject(root, "publish_coords",   cfg.publish_coords);
+    cJSON_AddNumberToObject(root, "coord_deadband_mm",     cfg.coord_deadband_mm);
+    cJSON_AddNumberToObject(root, "coord_min_interval_ms", cfg.coord_min_interval_ms);
     cJSON_AddNumberToObject(root, "max_distance_mm",  cfg.max_distance_mm);
     cJSON_AddNumberToObject(root, "angle_left_deg",   cfg.angle_left_deg);
     cJSON_AddNumberToObject(root, "angle_right_deg",  cfg.angle_right_deg);
+    cJSON_AddNumberToObject(root, "hw_filter_mode",   cfg.hw_filter_mode);
 
     /* Main EP occupancy timing */
     cJSON_AddNumberToObject(root, "occupancy_cooldown_sec", cfg.occupancy_cooldown_sec[0]);
@@ -233,6 +499,7 @@ esp_err_t config_api_get_all(cJSON **out)
     cJSON_AddNumberToObject(root, "fallback_mode",         cfg.fallback_mode);
     cJSON_AddNumberToObject(root, "fallback_enable",       cfg.fallback_enable);
     cJSON_AddNumberToObject(root, "fallback_cooldown_sec", cfg.fallback_cooldown_sec[0]);
+    cJSON_AddNumberToObject(root, "fallback_group",        cfg.fallback_group[0]);
     cJSON_AddNumberToObject(root, "hard_timeout_sec",      cfg.hard_timeout_sec);
     cJSON_AddNumberToObject(root, "ack_timeout_ms",        cfg.ack_timeout_ms);
 
@@ -240,6 +507,23 @@ esp_err_t config_api_get_all(cJSON **out)
     cJSON_AddNumberToObject(root, "heartbeat_enable",       cfg.heartbeat_enable);
     cJSON_AddNumberToObject(root, "heartbeat_interval_sec", cfg.heartbeat_interval_sec);
 
+    /* Zone occupancy reporting */
+    cJSON_AddNumberToObject(root, "zone_ep_reports",        cfg.zone_ep_reports);
+    cJSON_AddNumberToObject(root, "rate_burst",             cfg.rate_burst);
+    cJSON_AddNumberToObject(root, "rate_per_min",           cfg.rate_per_min);
+
+    /* Local automation rules, canonical text form */
+    cJSON *rules = cJSON_AddArrayToObject(root, "rules");
+    if (rules == NULL) {
+        cJSON_Delete(root);
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint8_t i = 0; i < cfg.rules.count; i++) {
+        char text[LOCAL_RULE_TEXT_MAX + 32];
+        local_rule_format(&cfg.rules.rule[i], text, sizeof(text));
+        cJSON_AddItemToArray(rules, cJSON_CreateString(text));
+    }
+
     /* Zones array */
     cJSON *zones = cJSON_AddArrayToObject(root, "zones");
     if (zones == NULL) {
@@ -263,6 +547,7 @@ esp_err_t config_api_get_all(cJSON **out)
         cJSON_AddNumberToObject(z, "cooldown_sec",         cfg.occupancy_cooldown_sec[i + 1]);
         cJSON_AddNumberToObject(z, "delay_ms",             cfg.occupancy_delay_ms[i + 1]);
         cJSON_AddNumberToObject(z, "fallback_cooldown_sec", cfg.fallback_cooldown_sec[i + 1]);
+        cJSON_AddNumberToObject(z, "fallback_group",        cfg.fallback_group[i + 1]);
 
         cJSON_AddItemToArray(zones, z);
     }
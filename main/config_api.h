@@ -3,6 +3,9 @@
 
 #include "esp_err.h"
 #include "cJSON.h"
+#include "ld2450_cmd.h"
+#include "ld2450_hw_filter.h"
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -18,12 +21,58 @@
  * protocol-level revert (e.g. writing back the old ZCL attribute value).
  */
 
+/** Create the sensor settle timer.  Call once after ld2450_cmd_worker_start(). */
+esp_err_t config_api_init(void);
+
+/* ---- Multi-field updates ---- */
+
+/**
+ * Sensor hardware setters (distance, angles, filter mode; zone geometry in
+ * filter mode 1) save at once but program the
+ * LD2450 only after CONFIG_LD2450_SENSOR_CMD_SETTLE_MS without further
+ * sensor changes (at most 4x that after the first): back-to-back writes
+ * become one region update and intermediate values never reach the sensor.
+ *
+ * Between config_api_begin() and the matching config_api_commit() the
+ * window is held open; commit restarts it.  Calls nest; any task's sensor
+ * change made while a group is open goes out with that group.
+ */
+void config_api_begin(void);
+void config_api_commit(void);
+
+typedef struct {
+    uint32_t changes;       /* sensor setter calls */
+    uint32_t updates;       /* batches queued to the sensor after settling */
+} config_api_sensor_stats_t;
+
+void config_api_get_sensor_stats(config_api_sensor_stats_t *out);
+
+/**
+ * Zone filter the saved config asks of the sensor: the distance/angle
+ * sector, and in hw_filter_mode 1 the active zones' bounding boxes within
+ * it (ld2450_hw_filter.h).
+ */
+void config_api_plan_hw_filter(ld2450_hw_filter_t *out);
+
+/**
+ * Everything the saved config sets on the sensor, as one batch: Bluetooth
+ * off when disabled and the planned zone filter.  Sent at boot and again
+ * whenever the sensor may have lost its settings (sensor_recovery.c).
+ */
+void config_api_build_sensor_batch(ld2450_cmd_batch_t *b);
+
+/** Zone geometry was saved outside config_api (CLI): re-plan the sensor filter in zones mode. */
+void config_api_zones_changed(void);
+
 /* ---- Sensor hardware config ---- */
 esp_err_t config_api_set_max_distance(uint16_t mm);
 esp_err_t config_api_set_angle_left(uint8_t deg);
 esp_err_t config_api_set_angle_right(uint8_t deg);
 esp_err_t config_api_set_tracking_mode(uint8_t mode);
-esp_err_t config_api_set_publish_coords(uint8_t enabled);
+esp_err_t config_api_set_hw_filter_mode(uint8_t mode);   /* ld2450_hw_filter_mode_t */
+esp_err_t config_api_set_publish_coords(uint8_t mode);   /* COORD_PUBLISH_* */
+esp_err_t config_api_set_coord_deadband(uint16_t mm);
+esp_err_t config_api_set_coord_min_interval(uint16_t ms);
 
 /* ---- Occupancy timing (ep_idx: 0=main EP, 1-10=zones) ---- */
 esp_err_t config_api_set_occupancy_cooldown(uint8_t ep_idx, uint16_t sec);
@@ -32,10 +81,27 @@ esp_err_t config_api_set_occupancy_delay(uint8_t ep_idx, uint16_t ms);
 /* ---- Coordinator fallback ---- */
 esp_err_t config_api_set_fallback_mode(uint8_t mode);
 esp_err_t config_api_set_fallback_cooldown(uint8_t ep_idx, uint16_t sec);
+esp_err_t config_api_set_fallback_group(uint8_t ep_idx, uint16_t group);   /* 0=bindings */
 esp_err_t config_api_set_fallback_enable(uint8_t enable);
 esp_err_t config_api_set_hard_timeout(uint8_t sec);
 esp_err_t config_api_set_ack_timeout(uint16_t ms);
 
+/* ---- Zone occupancy reporting ---- */
+esp_err_t config_api_set_zone_ep_reports(uint8_t enable);
+
+/* ---- Report rate limiter ---- */
+esp_err_t config_api_set_rate_burst(uint8_t burst);
+esp_err_t config_api_set_rate_per_min(uint16_t per_min);
+
+/* ---- Local automation rules ---- */
+
+/**
+ * Replace the rule table from a JSON array of rule strings (local_rules.h
+ * text form).  All-or-nothing: on a parse error nothing is saved,
+ * ESP_ERR_INVALID_ARG is returned and err_buf holds "rule <n>: <reason>".
+ */
+esp_err_t config_api_set_rules(const cJSON *texts, char *err_buf, size_t err_len);
+
 /* ---- Heartbeat watchdog ---- */
 esp_err_t config_api_set_heartbeat_enable(uint8_t enable);
 esp_err_t config_api_set_heartbeat_interval(uint16_t sec);
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "coord_report.h"
+
+/* Smoothed positions are kept in 1/16 mm; each frame moves them 1/4 of the
+ * way to the new sample.  In steady motion the per-frame step of the
+ * smoothed position equals the true step, while +/-35 mm radar jitter is
+ * cut to roughly a quarter. */
+#define POS_SCALE           16
+#define POS_SMOOTH_SHIFT    2
+/* Residual jitter of a seated person after smoothing (mm/s); subtracted so
+ * that stationary targets settle at the slow rate. */
+#define MOTION_NOISE_MM_S   100
+/* Motion estimate decays by 1/8 of the gap per frame (~0.5 s half-life) */
+#define MOTION_DECAY_SHIFT  3
+
+static void put_i16(uint8_t *p, int16_t v)
+{
+    uint16_t u = (uint16_t)v;
+    p[0] = (uint8_t)(u & 0xFF);
+    p[1] = (uint8_t)(u >> 8);
+}
+
+static uint32_t abs32(int32_t v)
+{
+    return (uint32_t)(v < 0 ? -v : v);
+}
+
+uint8_t coord_report_presence(const ld2450_target_t targets[COORD_REPORT_TARGETS])
+{
+    uint8_t bits = 0;
+    for (int i = 0; i < COORD_REPORT_TARGETS; i++) {
+        if (targets[i].present) bits |= (uint8_t)(1u << i);
+    }
+    return bits;
+}
+
+void coord_report_pack(const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                       uint8_t out[COORD_REPORT_PAYLOAD_LEN])
+{
+    memset(out, 0, COORD_REPORT_PAYLOAD_LEN);
+    out[0] = coord_report_presence(targets);
+    for (int i = 0; i < COORD_REPORT_TARGETS; i++) {
+        if (!targets[i].present) continue;
+        uint8_t *p = out + 1 + i * 6;
+        put_i16(p + 0, targets[i].x_mm);
+        put_i16(p + 2, targets[i].y_mm);
+        put_i16(p + 4, targets[i].speed);
+    }
+}
+
+void coord_report_gate_reset(coord_report_gate_t *g)
+{
+    coord_report_stats_t stats = g->stats;
+    memset(g, 0, sizeof(*g));
+    g->stats = stats;
+}
+
+void coord_report_gate_defer(coord_report_gate_t *g)
+{
+    g->valid = false;
+    if (g->stats.sent) g->stats.sent--;
+    g->stats.throttled++;
+}
+
+static bool gate_eval(coord_report_gate_t *g,
+                      const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                      uint32_t now_ms, uint16_t deadband_mm, uint32_t min_interval_ms)
+{
+    uint8_t presence = coord_report_presence(targets);
+    g->interval_ms = min_interval_ms;
+
+    if (g->valid) {
+        if (presence == 0 && g->presence == 0) {
+            g->stats.idle++;
+            return false;
+        }
+
+        bool changed = presence != g->presence;
+        bool differs = changed;
+        for (int i = 0; i < COORD_REPORT_TARGETS && !changed; i++) {
+            if (!targets[i].present) continue;
+            uint32_t dx = abs32((int32_t)targets[i].x_mm - g->x_mm[i]);
+            uint32_t dy = abs32((int32_t)targets[i].y_mm - g->y_mm[i]);
+            if (dx || dy) differs = true;
+            if (dx > deadband_mm || dy > deadband_mm) changed = true;
+        }
+
+        if (!changed || (uint32_t)(now_ms - g->last_send_ms) < min_interval_ms) {
+            if (differs) g->stats.suppressed++;
+            return false;
+        }
+    }
+
+    g->valid        = true;
+    g->presence     = presence;
+    g->last_send_ms = now_ms;
+    for (int i = 0; i < COORD_REPORT_TARGETS; i++) {
+        g->x_mm[i] = targets[i].present ? targets[i].x_mm : 0;
+        g->y_mm[i] = targets[i].present ? targets[i].y_mm : 0;
+    }
+    g->stats.sent++;
+    return true;
+}
+
+bool coord_report_gate_check(coord_report_gate_t *g,
+                             const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                             uint32_t now_ms, uint16_t deadband_mm,
+                             uint16_t min_interval_ms)
+{
+    return gate_eval(g, targets, now_ms, deadband_mm, min_interval_ms);
+}
+
+/* Fastest target speed this frame (mm/s): the larger of the radar's own
+ * radial speed and the movement of the smoothed position, which also
+ * catches walking across the sensor's field of view. */
+static uint32_t frame_speed(coord_report_gate_t *g,
+                            const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                            uint32_t now_ms)
+{
+    uint32_t dt = (uint32_t)(now_ms - g->track_ms);
+    uint32_t v = 0;
+
+    for (int i = 0; i < COORD_REPORT_TARGETS; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if (!targets[i].present) {
+            g->tracked &= (uint8_t)~bit;
+            continue;
+        }
+
+        int32_t x = (int32_t)targets[i].x_mm * POS_SCALE;
+        int32_t y = (int32_t)targets[i].y_mm * POS_SCALE;
+        if ((g->tracked & bit) && dt > 0) {
+            int32_t nx = g->sx[i] + (x - g->sx[i]) / (1 << POS_SMOOTH_SHIFT);
+            int32_t ny = g->sy[i] + (y - g->sy[i]) / (1 << POS_SMOOTH_SHIFT);
+            uint32_t step = abs32(nx - g->sx[i]);
+            uint32_t step_y = abs32(ny - g->sy[i]);
+            if (step_y > step) step = step_y;
+            uint32_t s = step * 1000u / POS_SCALE / dt;
+            if (s > v) v = s;
+            g->sx[i] = nx;
+            g->sy[i] = ny;
+        } else {
+            g->sx[i] = x;
+            g->sy[i] = y;
+            g->tracked |= bit;
+        }
+
+        uint32_t radial = abs32(targets[i].speed) * 10u;   /* cm/s -> mm/s */
+        if (radial > v) v = radial;
+    }
+
+    g->track_ms = now_ms;
+    return v > MOTION_NOISE_MM_S ? v - MOTION_NOISE_MM_S : 0;
+}
+
+bool coord_report_gate_check_adaptive(coord_report_gate_t *g,
+                                      const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                                      uint32_t now_ms, uint16_t deadband_mm)
+{
+    /* Fast attack, slow decay: a burst of movement is reported at full rate
+     * immediately, and the rate backs off gradually once the target stops. */
+    uint32_t v = frame_speed(g, targets, now_ms);
+    if (v >= g->motion_mm_s) {
+        g->motion_mm_s = v;
+    } else {
+        uint32_t gap = g->motion_mm_s - v;
+        g->motion_mm_s -= (gap >> MOTION_DECAY_SHIFT) ? (gap >> MOTION_DECAY_SHIFT) : gap;
+    }
+
+    uint32_t interval = COORD_ADAPTIVE_MAX_MS;
+    if (g->motion_mm_s > 0) {
+        interval = COORD_ADAPTIVE_TRAVEL_MM * 1000u / g->motion_mm_s;
+        if (interval < COORD_ADAPTIVE_MIN_MS) interval = COORD_ADAPTIVE_MIN_MS;
+        if (interval > COORD_ADAPTIVE_MAX_MS) interval = COORD_ADAPTIVE_MAX_MS;
+    }
+
+    return gate_eval(g, targets, now_ms, deadband_mm, interval);
+}
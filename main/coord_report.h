@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ld2450_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packed target-data attribute (EP1 0x0003) and its report gate.
+ *
+ * Payload (little-endian, COORD_REPORT_PAYLOAD_LEN bytes):
+ *   [0]        presence bits, bit i = target i present
+ *   [1 + 6*i]  int16 x_mm, int16 y_mm, int16 speed (cm/s) for target i
+ * Absent targets are packed as zeros.
+ *
+ * The gate suppresses reports for radar jitter: a new value is sent only when
+ * the presence bits change or a present target has moved more than the
+ * dead-band (per axis) from the last *sent* position, and at least the
+ * minimum interval has passed since the last send.  Comparing against the
+ * last sent position (not the previous frame) means slow drift still gets
+ * reported once it accumulates past the dead-band.
+ *
+ * Publishing modes (ZB_ATTR_COORD_PUBLISHING / nvs publish_coords):
+ *   OFF       nothing is reported
+ *   ON        fixed minimum interval (coord_min_interval_ms)
+ *   ADAPTIVE  the minimum interval follows target motion: about one report
+ *             per COORD_ADAPTIVE_TRAVEL_MM of travel, clamped between one
+ *             radar frame (fast walkers) and COORD_ADAPTIVE_MAX_MS (people
+ *             sitting still).  Once the empty-room frame has been sent, an
+ *             empty room costs nothing further.
+ */
+
+#define COORD_REPORT_TARGETS      3
+#define COORD_REPORT_PAYLOAD_LEN  (1 + COORD_REPORT_TARGETS * 6)   /* 19 */
+
+#define COORD_PUBLISH_OFF         0
+#define COORD_PUBLISH_ON          1
+#define COORD_PUBLISH_ADAPTIVE    2
+
+#define COORD_ADAPTIVE_MIN_MS     80     /* one 100 ms LD2450 frame, less poll jitter */
+#define COORD_ADAPTIVE_MAX_MS     5000
+#define COORD_ADAPTIVE_TRAVEL_MM  100
+
+typedef struct {
+    uint32_t sent;         /* frames reported */
+    uint32_t suppressed;   /* frames that differed from the last report but were held back */
+    uint32_t idle;         /* empty-room frames skipped after the empty frame was sent */
+    uint32_t throttled;    /* frames the gate passed but the report rate limiter held back */
+} coord_report_stats_t;
+
+typedef struct {
+    bool     valid;                          /* false until the first send */
+    uint8_t  presence;                       /* presence bits last sent */
+    int16_t  x_mm[COORD_REPORT_TARGETS];     /* positions last sent */
+    int16_t  y_mm[COORD_REPORT_TARGETS];
+    uint32_t last_send_ms;
+    uint32_t motion_mm_s;                    /* adaptive: decaying peak target speed */
+    uint8_t  tracked;                        /* adaptive: bit i = sx/sy[i] valid */
+    int32_t  sx[COORD_REPORT_TARGETS];       /* adaptive: smoothed position, 1/16 mm */
+    int32_t  sy[COORD_REPORT_TARGETS];
+    uint32_t track_ms;                       /* adaptive: time of the previous frame */
+    uint32_t interval_ms;                    /* min interval applied on the last check */
+    coord_report_stats_t stats;              /* kept across coord_report_gate_reset() */
+} coord_report_gate_t;
+
+/** Presence bits for a target array (bit i = targets[i].present). */
+uint8_t coord_report_presence(const ld2450_target_t targets[COORD_REPORT_TARGETS]);
+
+/** Pack targets into the wire layout described above. */
+void coord_report_pack(const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                       uint8_t out[COORD_REPORT_PAYLOAD_LEN]);
+
+/** Forget the last sent value (stats are kept); the next check always passes. */
+void coord_report_gate_reset(coord_report_gate_t *g);
+
+/**
+ * The caller could not send the frame the last check passed (report rate
+ * limiter out of tokens).  The gate forgets it so the next check passes again
+ * with the newest targets; motion tracking is kept and the frame is counted
+ * as throttled instead of sent.
+ */
+void coord_report_gate_defer(coord_report_gate_t *g);
+
+/**
+ * Fixed-rate check (COORD_PUBLISH_ON).  Returns true if targets should be
+ * reported at now_ms; on true the gate records them as the last sent value
+ * and the caller must send.  deadband_mm = 0 reports any movement;
+ * min_interval_ms = 0 disables the rate limit.  Times are wrap-safe
+ * uint32_t milliseconds.
+ */
+bool coord_report_gate_check(coord_report_gate_t *g,
+                             const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                             uint32_t now_ms, uint16_t deadband_mm,
+                             uint16_t min_interval_ms);
+
+/**
+ * Motion-adaptive check (COORD_PUBLISH_ADAPTIVE).  Call once per radar
+ * frame: the motion estimate is updated on every call, whether or not the
+ * frame is sent.  Same send contract as coord_report_gate_check().
+ */
+bool coord_report_gate_check_adaptive(coord_report_gate_t *g,
+                                      const ld2450_target_t targets[COORD_REPORT_TARGETS],
+                                      uint32_t now_ms, uint16_t deadband_mm);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,12 +4,19 @@
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "esp_zigbee_core.h"
 #include "zcl/esp_zigbee_zcl_command.h"
 #include "zcl/esp_zigbee_zcl_core.h"
 #include "aps/esp_zigbee_aps.h"
 
+#include "ack_stats.h"
+#include "airtime.h"
+#include "local_rules.h"
 #include "nvs_config.h"
+#include "rate_limit.h"
+#include "report_queue.h"
 #include "zigbee_defs.h"
 
 static const char *TAG = "fallback";
@@ -25,6 +32,12 @@ typedef struct {
     bool     fallback_session_active; /* entered occupancy under hard fallback */
     bool     fallback_occupied;       /* fallback SM occupancy (independent cooldown) */
     uint8_t  fb_cooldown_gen;         /* generation counter for stale timer invalidation */
+    bool     reported;                /* an occupancy report for this EP was ACKed */
+    uint32_t last_report_ms;          /* time of that ACK */
+    bool     rl_deferred;             /* transition held back by the rate limiter */
+    uint8_t  rl_value;                /* newest value while deferred */
+    uint8_t  rl_sent_value;           /* value last handed to the report queue */
+    uint32_t rl_change_ms;            /* time of the previous reported transition */
 } fallback_ep_state_t;
 
 /* s_ep[0] = EP1 (main), s_ep[1-10] = EP2-11 (zones) */
@@ -61,24 +74,52 @@ static uint8_t  s_heartbeat_gen          = 0;  /* generation counter -- invalida
 /*  Occupancy report retry queue                                        */
 /* ================================================================== */
 
-#define OCC_RETRY_QUEUE_SIZE   16
-#define OCC_MAX_RETRIES        3
-#define OCC_KEEPALIVE_MS       300000  /* 5 minutes */
+#define OCC_KEEPALIVE_MS        300000  /* 5 minutes */
+#define OCC_KEEPALIVE_JITTER_MS 30000   /* each period drawn from 4.5-5.5 min */
+#define OCC_KEEPALIVE_RECENT_MS (OCC_KEEPALIVE_MS / 2)
+#define OCC_REPORT_ZCL_LEN      7       /* ZCL header + one uint8 attribute record */
+#define ONOFF_CMD_ZCL_LEN       3
 
-static const uint32_t k_retry_delay_ms[OCC_MAX_RETRIES] = {250, 500, 1000};
+static rq_t      s_q;
+static uint8_t   s_ka_gen = 0;  /* keep-alive generation; invalidates stale alarms */
+static uint32_t  s_ka_sent = 0;
+static uint32_t  s_ka_skipped = 0;
+static airtime_t s_airtime;     /* every app-originated frame, EP1 sensor reports included */
+static ack_stats_t s_ack;       /* send -> ACK latency, retries, failures per EP */
+static uint8_t   s_link_attr[1 + ACK_STATS_PAYLOAD_LEN];  /* last ZB_ATTR_LINK_STATS value */
 
-typedef struct {
-    uint8_t  ep;
-    uint8_t  attempts;            /* retries fired so far (0 before first send) */
-    uint8_t  value;               /* occupancy value being reported */
-    uint8_t  next_value;          /* supersede value pending in-flight completion */
-    uint8_t  in_use            : 1;
-    uint8_t  in_flight         : 1;
-    uint8_t  pending_supersede : 1;
-} occ_slot_t;
+/* ================================================================== */
+/*  Report rate limiter                                                 */
+/* ================================================================== */
+
+/* One token bucket for occupancy transitions and target data.  The first
+ * transition on an EP that was stable for RL_SETTLE_MS is exempt (it is what
+ * turns the lights on); the transitions that follow it within that time are
+ * flicker and wait for a token.  A deferred EP is sent with its newest value,
+ * or not at all if it flickered back to the value the coordinator has. */
+#define RL_SETTLE_MS            10000
+
+static rate_limit_t s_rl;
+static uint8_t      s_rl_gen = 0;       /* drain alarm generation */
+static bool         s_rl_drain_pending = false;
+static uint32_t     s_rl_throttled = 0; /* occupancy transitions deferred */
+static uint32_t     s_rl_collapsed = 0; /* deferred transitions that flickered back */
+static uint32_t     s_rl_exempt = 0;    /* first transitions sent past an empty bucket */
+static uint32_t     s_rl_cfg_gen = 0;   /* config generation applied to s_rl */
+
+/* ================================================================== */
+/*  Local automation rules                                              */
+/* ================================================================== */
+
+/* Rules are edge-triggered on an occupancy bitmap (bit = ep_idx).  Both the
+ * normal and the fallback SM bitmaps are tracked all the time, so switching
+ * into or out of fallback never fires a rule by itself. */
+#define LEVEL_CMD_ZCL_LEN       6       /* ZCL header + level + transition time */
+#define SCENE_CMD_ZCL_LEN       6       /* ZCL header + group id + scene id */
 
-static occ_slot_t s_q[OCC_RETRY_QUEUE_SIZE];
-static uint8_t    s_ka_gen = 0;  /* keep-alive generation; invalidates stale alarms */
+static uint16_t s_rule_occ   = 0;       /* normal SM bitmap last evaluated */
+static uint16_t s_rule_fb    = 0;       /* fallback SM bitmap last evaluated */
+static uint32_t s_rule_fired = 0;
 
 /* ================================================================== */
 /*  Forward declarations                                                */
@@ -87,16 +128,19 @@ static uint8_t    s_ka_gen = 0;  /* keep-alive generation; invalidates stale ala
 static void hard_timeout_cb(uint8_t param);
 static void fallback_cooldown_cb(uint8_t param);
 static void heartbeat_timeout_cb(uint8_t param);
-static void send_onoff_via_binding(uint8_t endpoint, bool on);
+static void send_fallback_onoff(uint8_t endpoint, bool on);
+static esp_zb_aps_address_mode_t fallback_dst(uint8_t endpoint, esp_zb_zcl_basic_cmd_t *basic);
 static void enter_fallback_mode(void);
 static void start_heartbeat_watchdog(void);
 static void cancel_heartbeat_watchdog(void);
 static void enter_soft_fallback_for_ep(uint8_t ep_idx);
-static void q_send_now(occ_slot_t *slot);
+static void q_pump(void);
 static void q_on_send_status(uint8_t ep, bool ok);
-static void q_enqueue_or_coalesce(uint8_t ep, uint8_t value);
 static void q_retry_alarm_cb(uint8_t param);
+static void q_status_guard_cb(uint8_t param);
 static void keepalive_alarm_cb(uint8_t param);
+static void rl_drain_cb(uint8_t param);
+static void rules_update(void);
 
 /* ================================================================== */
 /*  ZCL attribute helpers                                               */
@@ -154,6 +198,7 @@ static void enter_soft_fallback_for_ep(uint8_t ep_idx)
     s_ep[ep_idx].soft_fallback_active = true;
 
     if (!already) {
+        ack_stats_soft_fault(&s_ack);
         s_soft_fault_count++;
         set_soft_fault_attr(s_soft_fault_count);
         ESP_LOGW(TAG, "ep%u: soft fallback #%u (retry exhausted, fb_occ=%d)",
@@ -164,9 +209,9 @@ static void enter_soft_fallback_for_ep(uint8_t ep_idx)
     }
 
     if (fb_occ) {
-        send_onoff_via_binding(endpoint, true);
+        send_fallback_onoff(endpoint, true);
     } else {
-        send_onoff_via_binding(endpoint, false);
+        send_fallback_onoff(endpoint, false);
     }
 
     if (!s_hard_timeout_pending) {
@@ -182,135 +227,294 @@ static void enter_soft_fallback_for_ep(uint8_t ep_idx)
 /*  Occupancy report retry queue implementation                        */
 /* ================================================================== */
 
-static void q_send_now(occ_slot_t *slot)
+static uint32_t q_now_ms(void)
 {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static bool q_send_now(uint8_t ep_idx)
+{
+    const rq_slot_t *slot = &s_q.slot[ep_idx];
+    uint8_t ep = ep_idx + 1;
+
     esp_zb_zcl_report_attr_cmd_t cmd = {0};
-    cmd.zcl_basic_cmd.src_endpoint = slot->ep;
+    cmd.zcl_basic_cmd.src_endpoint = ep;
     cmd.address_mode   = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
     cmd.clusterID      = ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING;
     cmd.direction      = ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI;
     cmd.dis_default_resp = 1;
     cmd.attributeID    = ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID;
 
-    slot->in_flight = 1;
     esp_err_t err = esp_zb_zcl_report_attr_cmd_req(&cmd);
     if (err != ESP_OK) {
-        slot->in_flight = 0;
-        ESP_LOGW(TAG, "ep%u: report_attr_cmd_req failed (%d), scheduling retry", slot->ep, err);
-        q_on_send_status(slot->ep, false);
-        return;
+        ESP_LOGW(TAG, "ep%u: report_attr_cmd_req failed (%d), scheduling retry", ep, err);
+        return false;
     }
-    ESP_LOGD(TAG, "ep%u: occ report sent (val=%u attempt=%u)", slot->ep, slot->value, slot->attempts);
+    airtime_add(&s_airtime, q_now_ms(), OCC_REPORT_ZCL_LEN);
+    ack_stats_sent(&s_ack, ep_idx);
+    ESP_LOGD(TAG, "ep%u: occ report sent (val=%u prio=%u attempt=%u)",
+             ep, slot->value, slot->prio, slot->attempts);
+    return true;
 }
 
-static void q_on_send_status(uint8_t ep, bool ok)
+/* Send queued reports, highest priority first, up to RQ_MAX_IN_FLIGHT */
+static void q_pump(void)
 {
-    occ_slot_t *slot = NULL;
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (s_q[i].in_use && s_q[i].in_flight && s_q[i].ep == ep) {
-            slot = &s_q[i];
-            break;
-        }
-    }
-    if (!slot) return;  /* no in-flight slot for this EP (stale callback) */
-
-    slot->in_flight = 0;
-
-    if (ok) {
-        ESP_LOGD(TAG, "ep%u: occ report ACK (attempts=%u)", ep, slot->attempts);
-        if (slot->pending_supersede) {
-            uint8_t next_val = slot->next_value;
-            slot->in_use = 0;
-            q_enqueue_or_coalesce(ep, next_val);
+    uint8_t ep_idx;
+    while ((ep_idx = rq_pop(&s_q, q_now_ms())) != RQ_NONE) {
+        if (q_send_now(ep_idx)) {
+            esp_zb_scheduler_alarm(q_status_guard_cb, ep_idx, RQ_STATUS_GUARD_MS);
         } else {
-            slot->in_use = 0;
+            q_on_send_status(ep_idx + 1, false);
         }
-        return;
     }
+}
 
-    /* Send failed — retry or exhaust */
-    slot->attempts++;
-    if (slot->attempts > OCC_MAX_RETRIES) {
-        ESP_LOGW(TAG, "ep%u: occ report retry exhausted (val=%u)", ep, slot->value);
-        uint8_t ep_idx = ep - 1;
-        if (slot->pending_supersede) {
-            uint8_t next_val = slot->next_value;
-            slot->in_use = 0;
-            q_enqueue_or_coalesce(ep, next_val);
-        } else {
-            slot->in_use = 0;
-        }
+static void q_on_send_status(uint8_t ep, bool ok)
+{
+    uint8_t  ep_idx   = ep - 1;
+    uint8_t  value    = s_q.slot[ep_idx].value;
+    uint32_t sent_ms  = s_q.slot[ep_idx].sent_ms;
+    uint32_t now      = q_now_ms();
+    uint32_t retry_ms = 0;
+
+    rq_result_t res = rq_on_status(&s_q, ep_idx, ok, now, &retry_ms);
+    if (res == RQ_STALE) return;  /* no in-flight report for this EP (stale callback) */
+    esp_zb_scheduler_alarm_cancel(q_status_guard_cb, ep_idx);
+
+    switch (res) {
+    case RQ_DONE:
+        s_ep[ep_idx].reported       = true;
+        s_ep[ep_idx].last_report_ms = now;
+        ack_stats_acked(&s_ack, ep_idx, now - sent_ms);
+        ESP_LOGD(TAG, "ep%u: occ report ACK in %ums (srtt=%ums)", ep,
+                 (unsigned)(now - sent_ms), (unsigned)rq_srtt_ms(&s_q));
+        break;
+    case RQ_RETRY:
+        ack_stats_retry(&s_ack, ep_idx);
+        ESP_LOGD(TAG, "ep%u: occ retry %u in %ums", ep, s_q.slot[ep_idx].attempts, (unsigned)retry_ms);
+        esp_zb_scheduler_alarm(q_retry_alarm_cb, ep_idx, retry_ms);
+        break;
+    case RQ_EXHAUSTED:
+        ack_stats_failed(&s_ack, ep_idx);
+        ESP_LOGW(TAG, "ep%u: occ report retry exhausted (val=%u)", ep, value);
         enter_soft_fallback_for_ep(ep_idx);
-        return;
+        break;
+    default:                        /* RQ_STALE returned above */
+        break;
+    }
+    q_pump();
+}
+
+static void q_status_guard_cb(uint8_t param)
+{
+    if (param >= RQ_EP_COUNT) return;
+    if (rq_expire(&s_q, param)) {
+        ESP_LOGW(TAG, "ep%u: no send status for occ report, slot released", param + 1);
+        q_pump();
     }
+}
 
-    uint32_t delay = k_retry_delay_ms[slot->attempts - 1];
-    ESP_LOGD(TAG, "ep%u: occ retry %u in %ums", ep, slot->attempts, delay);
-    esp_zb_scheduler_alarm(q_retry_alarm_cb, (uint8_t)(ep - 1), delay);
+static void q_retry_alarm_cb(uint8_t param)
+{
+    if (param >= RQ_EP_COUNT) return;
+    rq_retry_due(&s_q, param);
+    q_pump();
 }
 
-static void q_enqueue_or_coalesce(uint8_t ep, uint8_t value)
+/* Refresh ZB_ATTR_LINK_STATS at the keep-alive cadence, only when it changed.
+ * Reporting is on change (delta 0), so an idle link costs no frames. */
+static void link_stats_publish(void)
 {
-    /* Update existing slot for this EP if one exists */
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (!s_q[i].in_use || s_q[i].ep != ep) continue;
+    uint8_t val[1 + ACK_STATS_PAYLOAD_LEN];   /* ZCL octet-string length prefix */
+    val[0] = ACK_STATS_PAYLOAD_LEN;
+    ack_stats_pack(&s_ack, (uint16_t)rq_srtt_ms(&s_q), val + 1);
+    if (memcmp(val, s_link_attr, sizeof(val)) == 0) return;
+    memcpy(s_link_attr, val, sizeof(val));
+    esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
+        ZB_CLUSTER_LD2450_CONFIG,
+        ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+        ZB_ATTR_LINK_STATS,
+        val, false);
+}
 
-        if (!s_q[i].in_flight) {
-            s_q[i].value    = value;
-            s_q[i].attempts = 0;
-            ESP_LOGD(TAG, "ep%u: coalesced occ report (val=%u)", ep, value);
-            return;
-        }
-        s_q[i].pending_supersede = 1;
-        s_q[i].next_value        = value;
-        ESP_LOGD(TAG, "ep%u: pending supersede after in-flight (val=%u)", ep, value);
-        return;
+static uint32_t keepalive_period_ms(void)
+{
+    return airtime_jittered_period(OCC_KEEPALIVE_MS, OCC_KEEPALIVE_JITTER_MS, esp_random());
+}
+
+static void keepalive_alarm_cb(uint8_t param)
+{
+    if (param != s_ka_gen) return;  /* stale alarm */
+
+    /* Only EP1 is refreshed here.  Zone occupancy is refreshed as one packed
+     * report by the EP1 zone bitmap keepalive (sensor_bridge), which Z2M maps
+     * onto the same zone_N_occupancy states as the zone EP reports. */
+    uint32_t now = q_now_ms();
+    if (s_ep[0].reported && now - s_ep[0].last_report_ms < OCC_KEEPALIVE_RECENT_MS) {
+        s_ka_skipped++;
+        ESP_LOGD(TAG, "Keep-alive: ep1 reported %us ago, skipped",
+                 (unsigned)((now - s_ep[0].last_report_ms) / 1000));
+    } else {
+        s_ka_sent++;
+        rq_enqueue(&s_q, 0, s_ep[0].occupied ? 1 : 0, RQ_PRIO_KEEPALIVE);
+        q_pump();
     }
+    link_stats_publish();
+    esp_zb_scheduler_alarm(keepalive_alarm_cb, s_ka_gen, keepalive_period_ms());
+}
 
-    /* Allocate new slot */
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (!s_q[i].in_use) {
-            s_q[i] = (occ_slot_t){ .ep = ep, .value = value, .in_use = 1 };
-            q_send_now(&s_q[i]);
-            return;
-        }
+/* ================================================================== */
+/*  Report rate limiter implementation                                 */
+/* ================================================================== */
+
+/* Follow rate_burst / rate_per_min when the config generation moves; the
+ * pair is re-read until both fields come from the same generation */
+static void rl_sync(uint32_t now)
+{
+    if (nvs_config_generation() == s_rl_cfg_gen) return;
+    uint8_t  burst;
+    uint16_t per_min;
+    uint32_t gen;
+    do {
+        gen = NVS_CONFIG_READ(rate_burst, &burst);
+    } while (NVS_CONFIG_READ(rate_per_min, &per_min) != gen);
+    s_rl_cfg_gen = gen;
+    if (s_rl.burst != burst || s_rl.per_min != per_min) {
+        rate_limit_set(&s_rl, burst, per_min, now);
     }
+}
+
+static void rl_enqueue(uint8_t ep_idx, uint8_t value, uint32_t now)
+{
+    s_ep[ep_idx].rl_sent_value = value;
+    s_ep[ep_idx].rl_change_ms  = now;
+    rq_enqueue(&s_q, ep_idx, value, RQ_PRIO_TRANSITION);
+}
+
+static void rl_schedule_drain(uint32_t now)
+{
+    if (s_rl_drain_pending) return;
+    s_rl_drain_pending = true;
+    s_rl_gen++;
+    esp_zb_scheduler_alarm(rl_drain_cb, s_rl_gen, rate_limit_wait_ms(&s_rl, now) + 1);
+}
 
-    /* Queue full: drop oldest non-in-flight slot */
-    ESP_LOGW(TAG, "ep%u: retry queue full, dropping oldest pending slot", ep);
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (s_q[i].in_use && !s_q[i].in_flight) {
-            s_q[i] = (occ_slot_t){ .ep = ep, .value = value, .in_use = 1 };
-            q_send_now(&s_q[i]);
-            return;
+static void rl_drain_cb(uint8_t param)
+{
+    if (param != s_rl_gen) return;  /* stale alarm */
+    s_rl_drain_pending = false;
+
+    uint32_t now = q_now_ms();
+    rl_sync(now);
+    for (uint8_t i = 0; i < RQ_EP_COUNT; i++) {
+        if (!s_ep[i].rl_deferred) continue;
+        if (s_ep[i].rl_value == s_ep[i].rl_sent_value) {
+            s_ep[i].rl_deferred = false;
+            s_rl_collapsed++;
+            ESP_LOGD(TAG, "ep%u: deferred occ flickered back to %u, not sent", i + 1, s_ep[i].rl_value);
+            continue;
+        }
+        if (!rate_limit_take(&s_rl, now)) {
+            rl_schedule_drain(now);
+            break;
         }
+        s_ep[i].rl_deferred = false;
+        rl_enqueue(i, s_ep[i].rl_value, now);
     }
-    ESP_LOGE(TAG, "ep%u: all queue slots in flight, report dropped", ep);
+    q_pump();
 }
 
-static void q_retry_alarm_cb(uint8_t param)
+/* ================================================================== */
+/*  Local automation rules implementation                              */
+/* ================================================================== */
+
+static void rule_dispatch(const local_rule_t *r)
 {
-    uint8_t ep_idx = param;
-    if (ep_idx > 10) return;
-    uint8_t ep = ep_idx + 1;
+    esp_zb_zcl_basic_cmd_t basic = {0};
+    esp_zb_aps_address_mode_t mode;
+    if (r->dst_mode == LR_DST_GROUP) {
+        basic.dst_addr_u.addr_short = r->dst;
+        basic.src_endpoint = ZB_EP_MAIN;
+        mode = ESP_ZB_APS_ADDR_MODE_16_GROUP_ENDP_NOT_PRESENT;
+    } else {
+        mode = fallback_dst((uint8_t)r->dst, &basic);   /* "ep N": EP N's group or bindings */
+    }
 
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (s_q[i].in_use && !s_q[i].in_flight && s_q[i].ep == ep) {
-            q_send_now(&s_q[i]);
-            return;
-        }
+    uint16_t len = ONOFF_CMD_ZCL_LEN;
+    switch (r->action) {
+    case LR_ACT_ON:
+    case LR_ACT_OFF:
+    case LR_ACT_TOGGLE: {
+        esp_zb_zcl_on_off_cmd_t cmd = {0};
+        cmd.zcl_basic_cmd = basic;
+        cmd.address_mode  = mode;
+        cmd.on_off_cmd_id = r->action == LR_ACT_ON  ? ESP_ZB_ZCL_CMD_ON_OFF_ON_ID
+                          : r->action == LR_ACT_OFF ? ESP_ZB_ZCL_CMD_ON_OFF_OFF_ID
+                          : ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID;
+        esp_zb_zcl_on_off_cmd_req(&cmd);
+        break;
+    }
+    case LR_ACT_LEVEL: {
+        esp_zb_zcl_move_to_level_cmd_t cmd = {0};
+        cmd.zcl_basic_cmd   = basic;
+        cmd.address_mode    = mode;
+        cmd.level           = (uint8_t)(((uint16_t)r->arg * 254 + 50) / 100);
+        cmd.transition_time = 0;
+        esp_zb_zcl_level_move_to_level_with_onoff_cmd_req(&cmd);
+        len = LEVEL_CMD_ZCL_LEN;
+        break;
+    }
+    case LR_ACT_SCENE: {
+        esp_zb_zcl_scenes_recall_scene_cmd_t cmd = {0};
+        cmd.zcl_basic_cmd = basic;
+        cmd.address_mode  = mode;
+        cmd.group_id      = r->dst;
+        cmd.scene_id      = r->arg;
+        esp_zb_zcl_scenes_recall_scene_cmd_req(&cmd);
+        len = SCENE_CMD_ZCL_LEN;
+        break;
     }
+    default:
+        return;
+    }
+    airtime_add(&s_airtime, q_now_ms(), len);
 }
 
-static void keepalive_alarm_cb(uint8_t param)
+static bool any_fallback_active(void)
 {
-    if (param != s_ka_gen) return;  /* stale alarm */
+    if (s_fallback_mode) return true;
+    for (int i = 0; i < 11; i++) {
+        if (s_ep[i].soft_fallback_active) return true;
+    }
+    return false;
+}
 
-    ESP_LOGD(TAG, "Keep-alive: enqueuing all 11 EP occupancy reports");
+/* Evaluate rules after any change to occupied / fallback_occupied.  In
+ * fallback every rule runs on the fallback SM (its long cooldown keeps the
+ * lights on); in normal operation only "always" rules run, on the normal SM. */
+static void rules_update(void)
+{
+    uint16_t occ = 0, fb = 0;
     for (int i = 0; i < 11; i++) {
-        q_enqueue_or_coalesce((uint8_t)(i + 1), s_ep[i].occupied ? 1 : 0);
+        if (s_ep[i].occupied)          occ |= (uint16_t)(1u << i);
+        if (s_ep[i].fallback_occupied) fb  |= (uint16_t)(1u << i);
+    }
+
+    local_rules_t rules;            /* a copy: a rules write may publish mid-dispatch */
+    NVS_CONFIG_READ(rules, &rules);
+    uint16_t fire = any_fallback_active()
+        ? local_rules_eval(&rules, s_rule_fb, fb, true)
+        : local_rules_eval(&rules, s_rule_occ, occ, false);
+    s_rule_occ = occ;
+    s_rule_fb  = fb;
+
+    for (uint8_t i = 0; fire; i++, fire >>= 1) {
+        if (!(fire & 1)) continue;
+        rule_dispatch(&rules.rule[i]);
+        s_rule_fired++;
+        ESP_LOGI(TAG, "rule %u fired (occ=0x%03x fb=0x%03x)", i + 1, occ, fb);
     }
-    esp_zb_scheduler_alarm(keepalive_alarm_cb, s_ka_gen, OCC_KEEPALIVE_MS);
 }
 
 /* ================================================================== */
@@ -339,12 +543,7 @@ static void send_status_cb(esp_zb_zcl_command_send_status_message_t msg)
     if (src_ep < 1 || src_ep > 11) return;
 
     /* Route to retry queue for any in-flight occupancy report from this EP */
-    for (int i = 0; i < OCC_RETRY_QUEUE_SIZE; i++) {
-        if (s_q[i].in_use && s_q[i].in_flight && s_q[i].ep == src_ep) {
-            q_on_send_status(src_ep, success);
-            break;
-        }
-    }
+    q_on_send_status(src_ep, success);
 
     if (success) {
         /* Coordinator ACKed -- clear awaiting_ack for ALL EPs */
@@ -451,24 +650,38 @@ static void fallback_cooldown_cb(uint8_t param)
 
     s_ep[ep_idx].fallback_occupied = false;
     ESP_LOGI(TAG, "ep%u: fallback cooldown expired, fallback_occupied=0", endpoint);
+    rules_update();
 
     if (s_fallback_mode || s_ep[ep_idx].soft_fallback_active) {
-        send_onoff_via_binding(endpoint, false);
-        ESP_LOGI(TAG, "ep%u: sent Off via binding (fallback cooldown expired)", endpoint);
+        send_fallback_onoff(endpoint, false);
+        ESP_LOGI(TAG, "ep%u: sent Off (fallback cooldown expired)", endpoint);
     }
 }
 
 /* ================================================================== */
-/*  On/Off dispatch via binding                                         */
+/*  On/Off dispatch: fallback group or bindings                         */
 /* ================================================================== */
 
-static void send_onoff_via_binding(uint8_t endpoint, bool on)
+/* Address a command to endpoint's lights: its fallback group if one is set
+ * (one group-cast frame, however many lights), else its bindings (one APS
+ * unicast per matching binding-table entry). */
+static esp_zb_aps_address_mode_t fallback_dst(uint8_t endpoint, esp_zb_zcl_basic_cmd_t *basic)
+{
+    basic->src_endpoint = endpoint;
+    uint16_t group;
+    NVS_CONFIG_READ(fallback_group[endpoint - 1], &group);
+    if (group == 0) return ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
+    basic->dst_addr_u.addr_short = group;
+    return ESP_ZB_APS_ADDR_MODE_16_GROUP_ENDP_NOT_PRESENT;
+}
+
+static void send_fallback_onoff(uint8_t endpoint, bool on)
 {
     esp_zb_zcl_on_off_cmd_t cmd = {0};
-    cmd.zcl_basic_cmd.src_endpoint = endpoint;
-    cmd.address_mode = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
+    cmd.address_mode = fallback_dst(endpoint, &cmd.zcl_basic_cmd);
     cmd.on_off_cmd_id = on ? ESP_ZB_ZCL_CMD_ON_OFF_ON_ID : ESP_ZB_ZCL_CMD_ON_OFF_OFF_ID;
     esp_zb_zcl_on_off_cmd_req(&cmd);
+    airtime_add(&s_airtime, q_now_ms(), ONOFF_CMD_ZCL_LEN);
 }
 
 /* ================================================================== */
@@ -491,7 +704,7 @@ static void enter_fallback_mode(void)
         ZB_ATTR_FALLBACK_MODE,
         &val, false);
 
-    ESP_LOGW(TAG, "HARD FALLBACK MODE ACTIVE -- On/Off via binding until HA clears");
+    ESP_LOGW(TAG, "HARD FALLBACK MODE ACTIVE -- On/Off via group/binding until HA clears");
 }
 
 /* ================================================================== */
@@ -601,8 +814,9 @@ void coordinator_fallback_set_hard_timeout(uint8_t sec)
 
 void coordinator_fallback_set_ack_timeout(uint16_t ms)
 {
-    if (ms < 500) ms = 500;
+    if (ms < ACK_TIMEOUT_MIN_MS) ms = ACK_TIMEOUT_MIN_MS;
     s_ack_timeout_ms = ms;
+    rq_set_rto_max(&s_q, ms);
     nvs_config_save_ack_timeout_ms(ms);
     ESP_LOGI(TAG, "ACK timeout -> %ums", ms);
 }
@@ -619,10 +833,14 @@ uint8_t coordinator_fallback_get_soft_fault_count(void)
 void coordinator_fallback_init(void)
 {
     memset(s_ep, 0, sizeof(s_ep));
-    memset(s_q, 0, sizeof(s_q));
+    rq_init(&s_q, RQ_MAX_IN_FLIGHT);
+    airtime_init(&s_airtime, q_now_ms());
+    ack_stats_init(&s_ack);
+    memset(s_link_attr, 0, sizeof(s_link_attr));
 
     nvs_config_t cfg;
     nvs_config_get(&cfg);
+    rate_limit_init(&s_rl, cfg.rate_burst, cfg.rate_per_min, q_now_ms());
 
     s_fallback_mode        = (cfg.fallback_mode != 0);
     s_coordinator_reachable = true;
@@ -633,6 +851,7 @@ void coordinator_fallback_init(void)
     if (s_hard_timeout_sec == 0) s_hard_timeout_sec = 10;
     s_ack_timeout_ms    = cfg.ack_timeout_ms;
     if (s_ack_timeout_ms == 0) s_ack_timeout_ms = 2000;
+    rq_set_rto_max(&s_q, s_ack_timeout_ms);
 
     s_heartbeat_enabled      = (cfg.heartbeat_enable != 0);
     s_heartbeat_interval_sec = cfg.heartbeat_interval_sec;
@@ -667,9 +886,8 @@ void coordinator_fallback_on_occupancy_change(uint8_t endpoint, bool occupied)
         esp_zb_scheduler_alarm_cancel(fallback_cooldown_cb, cancel_param);
         s_ep[ep_idx].fallback_occupied = true;
     } else {
-        nvs_config_t cfg;
-        nvs_config_get(&cfg);
-        uint16_t cooldown_sec = cfg.fallback_cooldown_sec[ep_idx];
+        uint16_t cooldown_sec;
+        NVS_CONFIG_READ(fallback_cooldown_sec[ep_idx], &cooldown_sec);
 
         s_ep[ep_idx].fb_cooldown_gen++;
         uint8_t gen   = s_ep[ep_idx].fb_cooldown_gen;
@@ -686,16 +904,18 @@ void coordinator_fallback_on_occupancy_change(uint8_t endpoint, bool occupied)
         }
     }
 
+    rules_update();
+
     /* ---- Dispatch: hard fallback path ---- */
     if (s_fallback_mode) {
         s_ep[ep_idx].fallback_session_active = true;
 
         if (s_ep[ep_idx].fallback_occupied) {
-            send_onoff_via_binding(endpoint, true);
-            ESP_LOGI(TAG, "ep%u: sent On via binding (hard fallback)", endpoint);
+            send_fallback_onoff(endpoint, true);
+            ESP_LOGI(TAG, "ep%u: sent On (hard fallback)", endpoint);
         } else {
-            send_onoff_via_binding(endpoint, false);
-            ESP_LOGI(TAG, "ep%u: sent Off via binding (hard fallback)", endpoint);
+            send_fallback_onoff(endpoint, false);
+            ESP_LOGI(TAG, "ep%u: sent Off (hard fallback)", endpoint);
         }
         return;
     }
@@ -703,11 +923,11 @@ void coordinator_fallback_on_occupancy_change(uint8_t endpoint, bool occupied)
     /* ---- Dispatch: soft fallback path (skip probing) ---- */
     if (s_ep[ep_idx].soft_fallback_active) {
         if (s_ep[ep_idx].fallback_occupied) {
-            send_onoff_via_binding(endpoint, true);
-            ESP_LOGI(TAG, "ep%u: sent On via binding (soft fallback, occ change)", endpoint);
+            send_fallback_onoff(endpoint, true);
+            ESP_LOGI(TAG, "ep%u: sent On (soft fallback, occ change)", endpoint);
         } else {
-            send_onoff_via_binding(endpoint, false);
-            ESP_LOGI(TAG, "ep%u: sent Off via binding (soft fallback, occ change)", endpoint);
+            send_fallback_onoff(endpoint, false);
+            ESP_LOGI(TAG, "ep%u: sent Off (soft fallback, occ change)", endpoint);
         }
         return;
     }
@@ -719,14 +939,105 @@ void coordinator_fallback_on_occupancy_change(uint8_t endpoint, bool occupied)
 void coordinator_fallback_report_occupancy(uint8_t ep, bool occupied)
 {
     if (ep < 1 || ep > 11) return;
-    q_enqueue_or_coalesce(ep, occupied ? 1 : 0);
+    uint8_t  ep_idx = ep - 1;
+    uint8_t  value  = occupied ? 1 : 0;
+    uint32_t now    = q_now_ms();
+    fallback_ep_state_t *st = &s_ep[ep_idx];
+
+    rl_sync(now);
+    if (st->rl_deferred) {
+        /* Already waiting for a token: the drain sends the newest value */
+        st->rl_value = value;
+        return;
+    }
+    if (now - st->rl_change_ms >= RL_SETTLE_MS || st->rl_change_ms == 0) {
+        /* First transition after a quiet spell: never delayed */
+        if (!rate_limit_take(&s_rl, now)) s_rl_exempt++;
+    } else if (!rate_limit_take(&s_rl, now)) {
+        st->rl_deferred = true;
+        st->rl_value    = value;
+        s_rl_throttled++;
+        ESP_LOGD(TAG, "ep%u: occ report throttled (val=%u)", ep, value);
+        rl_schedule_drain(now);
+        return;
+    }
+    rl_enqueue(ep_idx, value, now);
+    q_pump();
+}
+
+bool coordinator_fallback_rate_take(void)
+{
+    uint32_t now = q_now_ms();
+    rl_sync(now);
+    /* Occupancy wins: target data never spends the lower half of the bucket,
+     * and nothing at all while a deferred transition waits for a token */
+    if (s_rl_drain_pending) return false;
+    return rate_limit_take_above(&s_rl, s_rl.burst / 2, now);
+}
+
+void coordinator_fallback_get_rate_stats(coordinator_fallback_rate_stats_t *out)
+{
+    if (!out) return;
+    uint32_t now = q_now_ms();
+    rl_sync(now);
+    out->throttled_occ = s_rl_throttled;
+    out->collapsed_occ = s_rl_collapsed;
+    out->exempt_occ    = s_rl_exempt;
+    out->tokens        = rate_limit_tokens(&s_rl, now);
 }
 
 void coordinator_fallback_start_keepalive(void)
 {
+    /* Random phase: sensors powered up together must not refresh in lock-step */
+    uint32_t phase = esp_random() % OCC_KEEPALIVE_MS;
     s_ka_gen++;
-    esp_zb_scheduler_alarm(keepalive_alarm_cb, s_ka_gen, OCC_KEEPALIVE_MS);
-    ESP_LOGI(TAG, "Occupancy keep-alive started (period=%us)", OCC_KEEPALIVE_MS / 1000);
+    esp_zb_scheduler_alarm(keepalive_alarm_cb, s_ka_gen, phase);
+    ESP_LOGI(TAG, "Occupancy keep-alive started (period=%us +/-%us, first in %us)",
+             OCC_KEEPALIVE_MS / 1000, OCC_KEEPALIVE_JITTER_MS / 1000, (unsigned)(phase / 1000));
+}
+
+uint32_t coordinator_fallback_keepalive_delay_ms(bool first)
+{
+    return first ? esp_random() % OCC_KEEPALIVE_MS : keepalive_period_ms();
+}
+
+void coordinator_fallback_note_tx(uint16_t zcl_len)
+{
+    airtime_add(&s_airtime, q_now_ms(), zcl_len);
+}
+
+void coordinator_fallback_get_tx_stats(coordinator_fallback_tx_stats_t *out)
+{
+    if (!out) return;
+    uint32_t us = 0;
+    airtime_last_hour(&s_airtime, q_now_ms(), &out->frames_hour, &us);
+    out->airtime_ms_hour = us / 1000;
+    out->frames_total    = s_airtime.total_frames;
+    out->ka_sent         = s_ka_sent;
+    out->ka_skipped      = s_ka_skipped;
+}
+
+void coordinator_fallback_get_link_stats(coordinator_fallback_link_stats_t *out)
+{
+    if (!out) return;
+    out->ack            = s_ack;
+    out->srtt_ms        = rq_srtt_ms(&s_q);
+    out->rto_ms         = rq_rto_ms(&s_q);
+    out->ack_timeout_ms = s_ack_timeout_ms;
+}
+
+bool coordinator_fallback_rule_run(uint8_t idx)
+{
+    local_rules_t rules;
+    NVS_CONFIG_READ(rules, &rules);
+    if (idx >= rules.count) return false;
+    rule_dispatch(&rules.rule[idx]);
+    return true;
+}
+
+uint32_t coordinator_fallback_rules_fired(void)
+{
+    return s_rule_fired;
 }
 
 bool coordinator_fallback_is_active(void)
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "ack_stats.h"
+
 /**
  * Coordinator offline fallback module — dual state machine design.
  *
@@ -14,7 +16,8 @@
  *
  * Fallback SM (this module): Maintains its own fallback_occupied per EP with
  * independent fallback cooldown timers. When fallback activates (soft or hard),
- * dispatches On/Off via binding based on fallback_occupied.
+ * dispatches On/Off based on fallback_occupied: group-cast to the endpoint's
+ * fallback group (nvs_config fallback_group) if set, else via its bindings.
  *
  * Reconciliation is one-way: when fallback clears (ACK during soft, or HA
  * clears hard), the fallback SM pushes all EP fallback_occupied states to Z2M
@@ -103,7 +106,11 @@ void coordinator_fallback_set_enable(uint8_t enable);
 /** Set the hard timeout (seconds from first soft fault → hard fallback).  Persists to NVS. */
 void coordinator_fallback_set_hard_timeout(uint8_t sec);
 
-/** Set the APS ACK timeout in ms.  Persists to NVS. */
+/**
+ * Set the APS ACK timeout in ms (min 500).  Persists to NVS.  It caps the
+ * adaptive occupancy report retry timeout, which otherwise follows the
+ * measured ACK latency.
+ */
 void coordinator_fallback_set_ack_timeout(uint16_t ms);
 
 /** Return the current soft fault count (read-only; firmware clears on coordinator ACK). */
@@ -113,14 +120,84 @@ uint8_t coordinator_fallback_get_soft_fault_count(void);
  * Enqueue an explicit occupancy report for the given endpoint with ACK tracking
  * and retry.  Replaces the raw esp_zb_zcl_set_attribute_val auto-report path.
  *
+ * Reports pass the rate limiter (rate_burst / rate_per_min).  The first
+ * transition after 10 s without one on that EP is never delayed; later ones
+ * wait for a token and are then sent with the newest value, or dropped if
+ * the EP flickered back to the value last reported.
+ *
  * @param ep       Zigbee endpoint (1=main, 2-11=zones)
  * @param occupied New occupancy state
  */
 void coordinator_fallback_report_occupancy(uint8_t ep, bool occupied);
 
 /**
- * Start the firmware-side occupancy keep-alive timer (fires every 5 minutes).
- * Reports all 11 endpoint occupancy states as a burst so Z2M always has a
- * fresh snapshot even with no motion.  Call once after sensor_bridge_start().
+ * Start the firmware-side EP1 occupancy keep-alive.  The first refresh comes
+ * at a random point in the 5-minute period and each later period is
+ * jittered by +/-30 s, so co-powered sensors spread their refreshes instead
+ * of bursting together.  A refresh is skipped if EP1 was reported within
+ * the last half period.  Zone occupancy is refreshed by the packed EP1 zone
+ * bitmap keepalive.  Call once after sensor_bridge_start().
  */
 void coordinator_fallback_start_keepalive(void);
+
+/**
+ * Spread another 5-minute refresh (the EP1 zone bitmap keepalive) the same
+ * way: a random phase when first is true, else a jittered period.
+ */
+uint32_t coordinator_fallback_keepalive_delay_ms(bool first);
+
+typedef struct {
+    uint32_t frames_hour;      /* frames sent in the last hour */
+    uint32_t airtime_ms_hour;  /* estimated single-hop airtime of those frames */
+    uint32_t frames_total;     /* since boot */
+    uint32_t ka_sent;          /* EP1 occupancy keep-alives sent */
+    uint32_t ka_skipped;       /* skipped: EP1 was reported recently */
+} coordinator_fallback_tx_stats_t;
+
+/** Account one app-originated frame of zcl_len ZCL bytes for the airtime stats. */
+void coordinator_fallback_note_tx(uint16_t zcl_len);
+
+/** Copy out outgoing traffic / airtime counters (see airtime.h). */
+void coordinator_fallback_get_tx_stats(coordinator_fallback_tx_stats_t *out);
+
+typedef struct {
+    uint32_t throttled_occ;    /* occupancy transitions deferred for a token */
+    uint32_t collapsed_occ;    /* deferred transitions dropped: flickered back */
+    uint32_t exempt_occ;       /* first transitions sent with the bucket empty */
+    uint16_t tokens;           /* tokens available now */
+} coordinator_fallback_rate_stats_t;
+
+/**
+ * Take one token from the report rate limiter for a non-occupancy report
+ * (target data).  Returns false if the report must be held back: the lower
+ * half of the burst is reserved for occupancy transitions, and nothing is
+ * given out while one is deferred.
+ */
+bool coordinator_fallback_rate_take(void);
+
+/** Copy out the report rate limiter counters (see rate_limit.h). */
+void coordinator_fallback_get_rate_stats(coordinator_fallback_rate_stats_t *out);
+
+typedef struct {
+    ack_stats_t ack;           /* latency histogram, per-EP counts (see ack_stats.h) */
+    uint32_t    srtt_ms;       /* smoothed ACK latency, 0 before the first ACK */
+    uint32_t    rto_ms;        /* current retry timeout */
+    uint16_t    ack_timeout_ms;
+} coordinator_fallback_link_stats_t;
+
+/** Copy out occupancy report link statistics. */
+void coordinator_fallback_get_link_stats(coordinator_fallback_link_stats_t *out);
+
+/**
+ * Local automation rules (nvs_config rules, see local_rules.h) are evaluated
+ * here on every occupancy change and send their On/Off, Level or Scene
+ * command straight to the group or bindings, without the coordinator.  They
+ * run in hard or soft fallback; rules marked "always" also run in normal
+ * operation.
+ */
+
+/** Send rule idx's command now (0-based), e.g. to check a new rule.  False if no such rule. */
+bool coordinator_fallback_rule_run(uint8_t idx);
+
+/** Rules fired since boot. */
+uint32_t coordinator_fallback_rules_fired(void);
@@ -10,6 +10,7 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -19,11 +20,16 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 
+#include "config_api.h"
+#include "coord_report.h"
 #include "coordinator_fallback.h"
 #include "crash_diag.h"
 #include "ld2450.h"
-#include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
 #include "nvs_config.h"
+#include "sensor_bridge.h"
+#include "sensor_recovery.h"
+#include "zigbee_defs.h"
 #include "zigbee_signal_handlers.h"
 #if CONFIG_IDF_TARGET_ESP32C6
 #include "wifi_manager.h"
@@ -52,7 +58,12 @@ static void print_help(void)
         "  ld maxdist <mm>               (0-6000)\n"
         "  ld angle <left> <right>       (0-90 degrees)\n"
         "  ld bt <on|off>\n"
-        "  ld coords <on|off>\n"
+        "  ld filter [range|zones]      (sensor zone filter plan; zones = drop targets outside all zones)\n"
+        "  ld coords <on|off|adaptive>  (adaptive: rate follows target motion)\n"
+        "  ld coords deadband <mm>      (0-1000, min movement to report)\n"
+        "  ld coords interval <ms>      (0-10000, min time between reports)\n"
+        "  ld zonereports <on|off>      (per-zone EP reports; off = EP1 bitmap only)\n"
+        "  ld rate [<burst> <per_min>]  (report rate limiter: 1-100, 0-3000/min, 0=off)\n"
         "  ld cooldown [seconds]         (set main, show all if no value)\n"
         "  ld cooldown zone <1-10> <sec> (set zone cooldown)\n"
         "  ld cooldown all <seconds>     (set all endpoints)\n"
@@ -65,13 +76,29 @@ static void print_help(void)
         "  ld fallback enable [0|1]     (get/set global fallback enable)\n"
         "  ld fallback timeout [sec]    (get/set hard timeout, default 10s)\n"
         "  ld fallback ack-timeout [ms] (get/set ACK timeout, default 2000ms)\n"
+        "  ld fallback stats            (ACK latency histogram, retries, soft faults)\n"
+        "  ld fallback autotune         (set ACK timeout from measured latency)\n"
         "  ld fallback cooldown         (show all 11 fallback cooldowns)\n"
         "  ld fallback cooldown <sec>   (set main fallback cooldown)\n"
         "  ld fallback cooldown zone <1-10> <sec>\n"
         "  ld fallback cooldown all <sec>\n"
+        "  ld fallback group            (show fallback groups, 0=bindings)\n"
+        "  ld fallback group <id>       (set main fallback group)\n"
+        "  ld fallback group zone <1-10> <id>\n"
+        "  ld fallback group all <id>\n"
+        "  ld rule                      (list local automation rules)\n"
+        "  ld rule add <cond> -> <action> [group <id>|ep <n>] [always]\n"
+        "                               (e.g. z2 !z5 -> level 40 group 0x0003)\n"
+        "  ld rule del <n>              (remove rule n)\n"
+        "  ld rule clear                (remove all rules)\n"
+        "  ld rule test <n>             (send rule n's command now)\n"
         "  ld config\n"
         "  ld diag [show]               (show crash diagnostics)\n"
         "  ld diag reset                (reset boot counter to 0)\n"
+        "  ld stats                     (sensor bridge reporting counters)\n"
+        "  ld sensor [read]             (LD2450 firmware, MAC, zone filter; read = query sensor)\n"
+        "  ld events                    (recent occupancy transitions, newest first)\n"
+        "  ld health                    (UART frame/garbage counters, recovery events)\n"
         "  ld nvs                       (test NVS health)\n"
         "  ld reboot\n"
         "  ld factory-reset             (FULL reset: erase Zigbee + config)\n"
@@ -82,6 +109,29 @@ static void print_help(void)
     );
 }
 
+static void print_rules(void)
+{
+    local_rules_t rules;
+    NVS_CONFIG_READ(rules, &rules);
+    printf("rules: %u/%u, fired %" PRIu32 " since boot\n", rules.count, LOCAL_RULES_MAX,
+           coordinator_fallback_rules_fired());
+    for (uint8_t i = 0; i < rules.count; i++) {
+        char text[LOCAL_RULE_TEXT_MAX + 32];
+        local_rule_format(&rules.rule[i], text, sizeof(text));
+        printf("  %2u: %s\n", i + 1, text);
+    }
+}
+
+static void save_rules(const local_rules_t *rules, const char *what)
+{
+    esp_err_t err = nvs_config_save_rules(rules);
+    if (err == ESP_OK) {
+        printf("rule: %s (saved)\n", what);
+    } else {
+        printf("rule: %s BUT NVS SAVE FAILED: %s\n", what, esp_err_to_name(err));
+    }
+}
+
 static void print_state(void)
 {
     ld2450_state_t s;
@@ -144,6 +194,15 @@ static void print_zones(void)
     }
 }
 
+static const char *coord_mode_name(uint8_t mode)
+{
+    switch (mode) {
+    case COORD_PUBLISH_ON:       return "on";
+    case COORD_PUBLISH_ADAPTIVE: return "adaptive";
+    default:                     return "off";
+    }
+}
+
 static void print_config(void)
 {
     nvs_config_t cfg;
@@ -155,7 +214,13 @@ static void print_config(void)
            cfg.max_distance_mm, cfg.angle_left_deg, cfg.angle_right_deg,
            cfg.bt_disabled,
            cfg.tracking_mode ? "single" : "multi",
-           cfg.publish_coords ? "on" : "off");
+           coord_mode_name(cfg.publish_coords));
+    printf("coords: deadband=%u mm min_interval=%u ms\n",
+           cfg.coord_deadband_mm, cfg.coord_min_interval_ms);
+    printf("hw_filter: %s\n", ld2450_hw_filter_mode_name(cfg.hw_filter_mode));
+    printf("zone_reports: %s\n", cfg.zone_ep_reports ? "per-zone EPs + bitmap" : "bitmap only");
+    printf("rate_limit: burst=%u sustained=%u/min%s\n",
+           cfg.rate_burst, cfg.rate_per_min, cfg.rate_per_min ? "" : " (off)");
     printf("cooldown: main=%u z1=%u z2=%u z3=%u z4=%u z5=%u z6=%u z7=%u z8=%u z9=%u z10=%u sec\n",
            cfg.occupancy_cooldown_sec[0],  cfg.occupancy_cooldown_sec[1],
            cfg.occupancy_cooldown_sec[2],  cfg.occupancy_cooldown_sec[3],
@@ -187,6 +252,269 @@ static void print_diag(void)
     printf("  min_free_heap:   %" PRIu32 " bytes\n", diag.min_free_heap);
 }
 
+static void print_stats(void)
+{
+    sensor_bridge_push_stats_t ps;
+    sensor_bridge_get_push_stats(&ps);
+    printf("Sensor Bridge:\n");
+    printf("  config_pushes:   %" PRIu32 "\n", ps.push_cycles);
+    printf("  attrs_written:   %" PRIu32 "\n", ps.attrs_written);
+    printf("  attrs_skipped:   %" PRIu32 " (clean, not re-pushed)\n", ps.attrs_skipped);
+
+    sensor_bridge_report_stats_t rs;
+    sensor_bridge_get_report_stats(&rs);
+    printf("Sensor Reports (%s):\n",
+           rs.batched ? "batched per poll" : "per attribute");
+    printf("  events:          %" PRIu32 " (polls with a sensor attr change)\n", rs.events);
+    printf("  attrs_changed:   %" PRIu32 "\n", rs.attrs);
+    printf("  frames:          %" PRIu32 "\n", rs.frames);
+    if (rs.events) {
+        printf("  frames/event:    %" PRIu32 ".%02" PRIu32 " (per-attribute: %" PRIu32 ".%02" PRIu32 ")\n",
+               rs.frames / rs.events, (rs.frames * 100 / rs.events) % 100,
+               rs.attrs / rs.events, (rs.attrs * 100 / rs.events) % 100);
+    }
+    if (rs.send_errors) {
+        printf("  send_errors:     %" PRIu32 "\n", rs.send_errors);
+    }
+
+    coordinator_fallback_tx_stats_t ts;
+    coordinator_fallback_get_tx_stats(&ts);
+    printf("Zigbee Airtime (single hop, estimated):\n");
+    printf("  last_hour:       %" PRIu32 " frames, %" PRIu32 " ms\n", ts.frames_hour, ts.airtime_ms_hour);
+    printf("  frames_total:    %" PRIu32 "\n", ts.frames_total);
+    printf("  keepalives:      %" PRIu32 " sent, %" PRIu32 " skipped (reported recently)\n",
+           ts.ka_sent, ts.ka_skipped);
+
+    sensor_bridge_coord_stats_t cs;
+    sensor_bridge_get_coord_stats(&cs);
+    printf("Target Data (%s):\n", coord_mode_name(cs.mode));
+    printf("  sent:            %" PRIu32 "\n", cs.sent);
+    printf("  suppressed:      %" PRIu32 " (changed, held back)\n", cs.suppressed);
+    printf("  idle:            %" PRIu32 " (empty room, skipped)\n", cs.idle);
+    printf("  throttled:       %" PRIu32 " (rate limiter, held back)\n", cs.throttled);
+    if (cs.mode != COORD_PUBLISH_OFF) {
+        printf("  interval:        %" PRIu32 " ms\n", cs.interval_ms);
+    }
+
+    static const char *const state_names[] = { "idle", "busy", "failed" };
+    ld2450_cmd_status_t cst;
+    ld2450_cmd_worker_get_status(&cst);
+    printf("Sensor Commands (%s, %u queued):\n",
+           cst.state < 3 ? state_names[cst.state] : "?", cst.pending);
+    printf("  completed:       %" PRIu32 " (%" PRIu32 " failed)\n", cst.completed, cst.failed);
+    printf("  rejected:        %" PRIu32 " (queue full)\n", cst.rejected);
+    ld2450_sensor_info_t si;
+    ld2450_cmd_get_sensor_info(&si);
+    printf("  sessions:        %" PRIu32 " (RX pauses)\n", si.sessions);
+    printf("  skipped:         %" PRIu32 " (sensor already matched)\n", si.skipped);
+    printf("  drift:           %" PRIu32 "\n", si.drift);
+    config_api_sensor_stats_t sst;
+    config_api_get_sensor_stats(&sst);
+    printf("  coalesced:       %" PRIu32 " changes -> %" PRIu32 " updates\n",
+           sst.changes, sst.updates);
+    if (cst.completed) {
+        printf("  last:            %s, %s, %" PRIu32 " ms\n", ld2450_cmd_op_name(cst.last_op),
+               esp_err_to_name(cst.last_err), cst.last_ms);
+    }
+}
+
+static void print_link_stats(void)
+{
+    coordinator_fallback_link_stats_t ls;
+    coordinator_fallback_get_link_stats(&ls);
+    const ack_stats_t *a = &ls.ack;
+
+    printf("Occupancy Report ACK Latency (%" PRIu32 " samples, max %" PRIu32 " ms):\n",
+           a->samples, a->max_ms);
+    for (uint8_t b = 0; b < ACK_HIST_BUCKETS; b++) {
+        if (b == ACK_HIST_BUCKETS - 1) {
+            printf("  >=%5" PRIu32 " ms:     %" PRIu32 "\n", ack_stats_bucket_edge_ms(b - 1), a->hist[b]);
+        } else {
+            printf("  < %5" PRIu32 " ms:     %" PRIu32 "\n", ack_stats_bucket_edge_ms(b), a->hist[b]);
+        }
+    }
+    printf("  p50/p90/p99:     %" PRIu32 " / %" PRIu32 " / %" PRIu32 " ms\n",
+           ack_stats_percentile_ms(a, 50), ack_stats_percentile_ms(a, 90),
+           ack_stats_percentile_ms(a, 99));
+    printf("  srtt:            %" PRIu32 " ms (retry timeout %" PRIu32 " ms, cap %u ms)\n",
+           ls.srtt_ms, ls.rto_ms, ls.ack_timeout_ms);
+
+    printf("Per Endpoint:\n");
+    printf("  ep   sent  acked  retries  failed\n");
+    for (uint8_t i = 0; i < ACK_STATS_EPS; i++) {
+        const ack_ep_stats_t *e = &a->ep[i];
+        if (e->sent == 0 && e->retries == 0 && e->failed == 0) continue;
+        printf("  %2u %6" PRIu32 " %6" PRIu32 " %8" PRIu32 " %7" PRIu32 "\n",
+               i + 1, e->sent, e->acked, e->retries, e->failed);
+    }
+    ack_ep_stats_t t;
+    ack_stats_totals(a, &t);
+    printf("  all %5" PRIu32 " %6" PRIu32 " %8" PRIu32 " %7" PRIu32 "\n",
+           t.sent, t.acked, t.retries, t.failed);
+    printf("  failed/1000:     %" PRIu32 "\n", ack_stats_fail_permille(a));
+    printf("  soft_faults:     %" PRIu32 " since boot\n", a->soft_faults);
+
+    uint32_t suggest = ack_stats_suggest_timeout_ms(a);
+    if (suggest) {
+        printf("  suggested ack_timeout: %" PRIu32 " ms (2 x p99; 'ld fallback autotune' applies it)\n",
+               suggest);
+    } else {
+        printf("  suggested ack_timeout: - (needs %u ACKs)\n", ACK_STATS_MIN_SAMPLES);
+    }
+}
+
+static void print_sensor_info(void)
+{
+    static const char *const zone_types[] = { "off", "detect inside", "exclude inside" };
+    ld2450_sensor_info_t si;
+    ld2450_cmd_get_sensor_info(&si);
+
+    printf("LD2450 Sensor (cached):\n");
+    if (si.fw_valid) {
+        printf("  firmware:        V%u.%02X.%08" PRIX32 " (type %u)\n",
+               si.fw_major >> 8, si.fw_major & 0xFF, si.fw_minor, si.fw_type);
+    } else {
+        printf("  firmware:        unknown\n");
+    }
+    if (si.mac_valid) {
+        printf("  mac:             %02X:%02X:%02X:%02X:%02X:%02X\n",
+               si.mac[0], si.mac[1], si.mac[2], si.mac[3], si.mac[4], si.mac[5]);
+    } else {
+        printf("  mac:             unknown\n");
+    }
+    printf("  tracking:        %s\n",
+           si.tracking < 0 ? "unknown" : (si.tracking ? "single" : "multi"));
+    printf("  bluetooth:       %s\n",
+           si.bluetooth < 0 ? "unknown (not readable)" : (si.bluetooth ? "on" : "off"));
+    if (!si.region_valid) {
+        printf("  zone filter:     unknown\n");
+    } else {
+        printf("  zone filter:     %s\n",
+               si.zone_type < 3 ? zone_types[si.zone_type] : "?");
+        for (int z = 0; z < 3 && si.zone_type != 0; z++) {
+            if (si.zone[z][0] == 0 && si.zone[z][1] == 0 && si.zone[z][2] == 0 && si.zone[z][3] == 0) continue;
+            printf("    slot %d:        (%d,%d)-(%d,%d) mm\n", z + 1,
+                   si.zone[z][0], si.zone[z][1], si.zone[z][2], si.zone[z][3]);
+        }
+    }
+    printf("  sessions/skipped/drift: %" PRIu32 " / %" PRIu32 " / %" PRIu32 "\n",
+           si.sessions, si.skipped, si.drift);
+}
+
+/* What the sensor filters in hardware and what the firmware still checks */
+static void print_filter(void)
+{
+    nvs_config_t cfg;
+    nvs_config_get(&cfg);
+    ld2450_hw_filter_t plan;
+    config_api_plan_hw_filter(&plan);
+
+    uint32_t area = ld2450_hw_filter_area_cm2(&plan);
+    uint32_t full = ld2450_hw_filter_area_cm2(NULL);
+    printf("Hardware (LD2450 zone filter, mode %s):\n", ld2450_hw_filter_mode_name(cfg.hw_filter_mode));
+    if (plan.zone_type == 0) {
+        printf("  off: the sensor reports its whole range\n");
+    } else {
+        printf("  detect inside %u rect(s), %" PRIu32 ".%02" PRIu32 " m2 of %" PRIu32 ".%02" PRIu32 " m2\n",
+               plan.count, area / 10000, (area % 10000) / 100,
+               full / 10000, (full % 10000) / 100);
+        for (uint8_t i = 0; i < plan.count; i++) {
+            printf("    slot %u: (%d,%d)-(%d,%d) mm\n", i + 1,
+                   plan.rect[i].x1, plan.rect[i].y1, plan.rect[i].x2, plan.rect[i].y2);
+        }
+    }
+
+    ld2450_sensor_info_t si;
+    ld2450_cmd_get_sensor_info(&si);
+    if (!si.region_valid) {
+        printf("  sensor holds: unknown (ld sensor read)\n");
+    } else {
+        ld2450_hw_filter_t held = { .zone_type = (uint8_t)si.zone_type, .count = LD2450_HW_FILTER_SLOTS };
+        ld2450_hw_filter_t want = plan;
+        for (int z = 0; z < LD2450_HW_FILTER_SLOTS; z++) {
+            held.rect[z] = (ld2450_rect_t){ si.zone[z][0], si.zone[z][1], si.zone[z][2], si.zone[z][3] };
+        }
+        want.count = LD2450_HW_FILTER_SLOTS;   /* unused slots are sent as zeros */
+        printf("  sensor holds: %s\n",
+               ld2450_hw_filter_equal(&held, &want) ? "this plan" : "a different filter (ld sensor)");
+    }
+
+    int active = 0;
+    for (int i = 0; i < 10; i++) {
+        if (cfg.zones[i].vertex_count >= 3) active++;
+    }
+    printf("Software (firmware, every reported target):\n");
+    printf("  zones: %d active polygon(s), point-in-polygon per frame\n", active);
+    printf("  main occupancy: %s\n",
+           cfg.hw_filter_mode == LD2450_HW_FILTER_ZONES && active > 0
+               ? "targets inside a zone's bounding box"
+               : "any target within distance/angle");
+}
+
+static void print_events(void)
+{
+    occ_event_log_t log;
+    sensor_bridge_get_occ_event_log(&log);
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+
+    printf("Occupancy events: %u logged since boot\n", log.seq);
+    occ_event_t e;
+    for (uint8_t i = 0; occ_event_log_get(&log, i, &e); i++) {
+        uint32_t age = now - e.t_ms;
+        if (e.ep == ZB_EP_MAIN) printf("  main     ");
+        else                    printf("  zone%-2u   ", e.ep - ZB_EP_ZONE(0) + 1);
+        printf("%-8s %" PRIu32 ".%03" PRIu32 " s ago\n",
+               e.occupied ? "occupied" : "clear", age / 1000, age % 1000);
+    }
+}
+
+static void print_health(void)
+{
+    ld2450_rx_stats_t rx;
+    sensor_health_t h;
+    ld2450_get_rx_stats(&rx, false);
+    sensor_recovery_get(&h);
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+
+    printf("Sensor health: %s (last sample %u%% of 10 Hz, %u%% garbage)\n",
+           sensor_health_state_name(h.state), h.rate_pct, h.noise_pct);
+    printf("  rx:       %" PRIu32 " frames, %" PRIu32 " bytes, %" PRIu32 " garbage, %" PRIu32 " bad end marker\n",
+           rx.frames, rx.bytes, rx.garbage_bytes, rx.bad_frames);
+    if (rx.last_frame_ms) {
+        printf("  last frame: %" PRIu32 " ms ago%s\n", now - rx.last_frame_ms,
+               rx.paused ? " (RX paused)" : "");
+    } else {
+        printf("  last frame: never\n");
+    }
+    printf("  faults:   %" PRIu32 " gap(s), longest %" PRIu32 " ms; %" PRIu32 " stall(s); %" PRIu32 " noisy\n",
+           h.gaps, h.longest_gap_ms, h.stalls, h.noise);
+    printf("  recovery: %" PRIu32 " restart(s), %" PRIu32 " re-apply(s)",
+           h.restarts, h.reapplies);
+    if (h.state != SENSOR_HEALTH_OK) {
+        printf(", next restart in %" PRId32 " ms", (int32_t)(h.next_restart_ms - now));
+    }
+    printf("\n");
+
+    sensor_health_event_t ev;
+    for (uint8_t i = 0; sensor_health_get_event(&h, i, &ev); i++) {
+        uint32_t age = now - ev.t_ms;
+        printf("  %-9s %-8" PRIu32 " %" PRIu32 ".%03" PRIu32 " s ago\n",
+               sensor_health_event_name(ev.type), ev.value, age / 1000, age % 1000);
+    }
+}
+
+/* Queue the saved zone filter plan (distance, angles, zones) behind any
+ * pending Zigbee/HTTP commands and wait for it */
+static esp_err_t cli_apply_region(void)
+{
+    ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_BATCH };
+    ld2450_hw_filter_t f;
+    config_api_plan_hw_filter(&f);
+    ld2450_cmd_batch_init(&req.u.batch);
+    ld2450_cmd_batch_add_filter(&req.u.batch, &f);
+    return ld2450_cmd_submit_wait(&req);
+}
+
 static void cli_task(void *arg)
 {
     (void)arg;
@@ -237,6 +565,39 @@ static void cli_task(void *arg)
                 continue;
             }
 
+            if (strcmp(cmd, "stats") == 0) { print_stats(); continue; }
+            if (strcmp(cmd, "events") == 0) { print_events(); continue; }
+            if (strcmp(cmd, "health") == 0) { print_health(); continue; }
+
+            if (strcmp(cmd, "filter") == 0) {
+                char *v = strtok(NULL, " \t\r\n");
+                if (v) {
+                    int mode = strcmp(v, "zones") == 0 ? LD2450_HW_FILTER_ZONES
+                             : strcmp(v, "range") == 0 ? LD2450_HW_FILTER_RANGE : -1;
+                    if (mode < 0) { printf("usage: ld filter [range|zones]\n"); continue; }
+                    nvs_config_save_hw_filter_mode((uint8_t)mode);
+                    esp_err_t err = cli_apply_region();
+                    printf("hw_filter=%s (saved, %s)\n", v,
+                           err == ESP_OK ? "applied" : esp_err_to_name(err));
+                }
+                print_filter();
+                continue;
+            }
+
+            if (strcmp(cmd, "sensor") == 0) {
+                char *v = strtok(NULL, " \t\r\n");
+                if (v && strcmp(v, "read") == 0) {
+                    ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_QUERY };
+                    esp_err_t err = ld2450_cmd_submit_wait(&req);
+                    if (err != ESP_OK) printf("read-back failed: %s\n", esp_err_to_name(err));
+                } else if (v) {
+                    printf("usage: ld sensor [read]\n");
+                    continue;
+                }
+                print_sensor_info();
+                continue;
+            }
+
             if (strcmp(cmd, "en") == 0) {
                 char *v = strtok(NULL, " \t\r\n");
                 if (!v) { printf("usage: ld en <0|1>\n"); continue; }
@@ -265,11 +626,56 @@ static void cli_task(void *arg)
 
             if (strcmp(cmd, "coords") == 0) {
                 char *v = strtok(NULL, " \t\r\n");
-                if (!v) { printf("usage: ld coords <on|off>\n"); continue; }
+                if (!v) { printf("usage: ld coords <on|off|adaptive|deadband <mm>|interval <ms>>\n"); continue; }
+                if (strcmp(v, "deadband") == 0 || strcmp(v, "interval") == 0) {
+                    char *n = strtok(NULL, " \t\r\n");
+                    if (!n) { printf("usage: ld coords %s <value>\n", v); continue; }
+                    uint16_t val = (uint16_t)atoi(n);
+                    if (v[0] == 'd') {
+                        nvs_config_save_coord_deadband(val);
+                        NVS_CONFIG_READ(coord_deadband_mm, &val);
+                        printf("coords deadband=%u mm (saved)\n", val);
+                    } else {
+                        nvs_config_save_coord_min_interval(val);
+                        NVS_CONFIG_READ(coord_min_interval_ms, &val);
+                        printf("coords interval=%u ms (saved)\n", val);
+                    }
+                    continue;
+                }
+                uint8_t mode = strcmp(v, "adaptive") == 0 ? COORD_PUBLISH_ADAPTIVE
+                             : strcmp(v, "on") == 0       ? COORD_PUBLISH_ON
+                             :                              COORD_PUBLISH_OFF;
+                ld2450_set_publish_coords(mode != COORD_PUBLISH_OFF);
+                nvs_config_save_publish_coords(mode);
+                printf("coords=%s (saved)\n", coord_mode_name(mode));
+                continue;
+            }
+
+            if (strcmp(cmd, "zonereports") == 0) {
+                char *v = strtok(NULL, " \t\r\n");
+                if (!v) { printf("usage: ld zonereports <on|off>\n"); continue; }
                 bool on = strcmp(v, "on") == 0;
-                ld2450_set_publish_coords(on);
-                nvs_config_save_publish_coords(on ? 1 : 0);
-                printf("coords=%s (saved)\n", on ? "on" : "off");
+                nvs_config_save_zone_ep_reports(on ? 1 : 0);
+                printf("zonereports=%s (saved)\n", on ? "on" : "off");
+                continue;
+            }
+
+            if (strcmp(cmd, "rate") == 0) {
+                char *b = strtok(NULL, " \t\r\n");
+                char *m = strtok(NULL, " \t\r\n");
+                if (b && !m) { printf("usage: ld rate [<burst> <per_min>]\n"); continue; }
+                if (b) {
+                    nvs_config_save_rate_burst((uint8_t)atoi(b));
+                    nvs_config_save_rate_per_min((uint16_t)atoi(m));
+                }
+                nvs_config_t rc;
+                nvs_config_get(&rc);
+                coordinator_fallback_rate_stats_t rl;
+                coordinator_fallback_get_rate_stats(&rl);
+                printf("rate: burst=%u sustained=%u/min%s%s\n", rc.rate_burst, rc.rate_per_min,
+                       rc.rate_per_min ? "" : " (off)", b ? " (saved)" : "");
+                printf("  tokens=%u throttled=%" PRIu32 " collapsed=%" PRIu32 " exempt=%" PRIu32 "\n",
+                       rl.tokens, rl.throttled_occ, rl.collapsed_occ, rl.exempt_occ);
                 continue;
             }
 
@@ -504,6 +910,26 @@ static void cli_task(void *arg)
                     continue;
                 }
 
+                if (strcmp(sub, "stats") == 0) {
+                    print_link_stats();
+                    continue;
+                }
+
+                if (strcmp(sub, "autotune") == 0) {
+                    coordinator_fallback_link_stats_t ls;
+                    coordinator_fallback_get_link_stats(&ls);
+                    uint32_t ms = ack_stats_suggest_timeout_ms(&ls.ack);
+                    if (ms == 0) {
+                        printf("fallback autotune: only %" PRIu32 " ACKs measured, need %u\n",
+                               ls.ack.samples, ACK_STATS_MIN_SAMPLES);
+                        continue;
+                    }
+                    coordinator_fallback_set_ack_timeout((uint16_t)ms);
+                    printf("fallback ack timeout %u -> %" PRIu32 " ms (p99 %" PRIu32 " ms, saved)\n",
+                           ls.ack_timeout_ms, ms, ack_stats_percentile_ms(&ls.ack, 99));
+                    continue;
+                }
+
                 if (strcmp(sub, "cooldown") == 0) {
                     char *arg1 = strtok(NULL, " \t\r\n");
                     if (!arg1) {
@@ -560,7 +986,106 @@ static void cli_task(void *arg)
                     continue;
                 }
 
-                printf("usage: ld fallback [on|off|enable|timeout|ack-timeout|cooldown ...]\n");
+                if (strcmp(sub, "group") == 0) {
+                    char *arg1 = strtok(NULL, " \t\r\n");
+                    if (!arg1) {
+                        uint16_t g[11];
+                        NVS_CONFIG_READ(fallback_group, g);
+                        printf("fallback group: main=0x%04x", g[0]);
+                        for (int i = 1; i < 11; i++) printf(" z%d=0x%04x", i, g[i]);
+                        printf(" (0=bindings)\n");
+                        continue;
+                    }
+
+                    uint8_t first = 0, last = 0;
+                    char *val_str = arg1;
+                    if (strcmp(arg1, "zone") == 0) {
+                        char *zone_str = strtok(NULL, " \t\r\n");
+                        val_str = strtok(NULL, " \t\r\n");
+                        int zone = zone_str ? atoi(zone_str) : 0;
+                        if (zone < 1 || zone > 10 || !val_str) {
+                            printf("usage: ld fallback group zone <1-10> <group id>\n");
+                            continue;
+                        }
+                        first = last = (uint8_t)zone;
+                    } else if (strcmp(arg1, "all") == 0) {
+                        val_str = strtok(NULL, " \t\r\n");
+                        if (!val_str) { printf("usage: ld fallback group all <group id>\n"); continue; }
+                        last = 10;
+                    }
+
+                    long group = strtol(val_str, NULL, 0);
+                    if (group < 0 || group > 0xFFF7) {
+                        printf("group must be 0 (bindings) or 0x0001-0xFFF7\n");
+                        continue;
+                    }
+                    bool all_ok = true;
+                    for (uint8_t i = first; i <= last; i++) {
+                        if (nvs_config_save_fallback_group(i, (uint16_t)group) != ESP_OK) all_ok = false;
+                    }
+                    char label[8];
+                    if (first != last)  snprintf(label, sizeof(label), "all");
+                    else if (first)     snprintf(label, sizeof(label), "zone%u", first);
+                    else                snprintf(label, sizeof(label), "main");
+                    printf("fallback group %s=0x%04lx%s\n", label, group,
+                           all_ok ? " (saved)" : " (NVS FAILED)");
+                    continue;
+                }
+
+                printf("usage: ld fallback [on|off|enable|timeout|ack-timeout|stats|autotune|cooldown|group ...]\n");
+                continue;
+            }
+
+            if (strcmp(cmd, "rule") == 0 || strcmp(cmd, "rules") == 0) {
+                char *sub = strtok(NULL, " \t\r\n");
+                if (!sub) {
+                    print_rules();
+                    continue;
+                }
+
+                local_rules_t rules;
+                NVS_CONFIG_READ(rules, &rules);
+
+                if (strcmp(sub, "add") == 0) {
+                    char *text = strtok(NULL, "\r\n");
+                    local_rule_t r;
+                    const char *perr;
+                    if (!text) {
+                        printf("usage: ld rule add <cond> -> <action> [group <id>|ep <n>] [always]\n");
+                    } else if (!local_rule_parse(text, &r, &perr)) {
+                        printf("rule: %s\n", perr);
+                    } else if (!local_rules_add(&rules, &r)) {
+                        printf("rule: table full (%u rules)\n", LOCAL_RULES_MAX);
+                    } else {
+                        save_rules(&rules, "added");
+                        print_rules();
+                    }
+                    continue;
+                }
+
+                if (strcmp(sub, "del") == 0 || strcmp(sub, "test") == 0) {
+                    char *v = strtok(NULL, " \t\r\n");
+                    int n = v ? atoi(v) : 0;
+                    if (n < 1 || n > rules.count) {
+                        printf("usage: ld rule %s <1-%u>\n", sub, rules.count);
+                    } else if (sub[0] == 't') {
+                        coordinator_fallback_rule_run((uint8_t)(n - 1));
+                        printf("rule %d: sent\n", n);
+                    } else {
+                        local_rules_remove(&rules, (uint8_t)(n - 1));
+                        save_rules(&rules, "removed");
+                        print_rules();
+                    }
+                    continue;
+                }
+
+                if (strcmp(sub, "clear") == 0) {
+                    local_rules_init(&rules);
+                    save_rules(&rules, "all removed");
+                    continue;
+                }
+
+                printf("usage: ld rule [add <text>|del <n>|clear|test <n>]\n");
                 continue;
             }
 
@@ -572,10 +1097,9 @@ static void cli_task(void *arg)
 
                 nvs_config_t cfg;
                 nvs_config_get(&cfg);
-                ld2450_cmd_apply_distance_angle(cfg.max_distance_mm,
-                                                 cfg.angle_left_deg,
-                                                 cfg.angle_right_deg);
-                printf("maxdist=%u mm (saved, applied)\n", cfg.max_distance_mm);
+                esp_err_t err = cli_apply_region();
+                printf("maxdist=%u mm (saved, %s)\n", cfg.max_distance_mm,
+                       err == ESP_OK ? "applied" : esp_err_to_name(err));
                 continue;
             }
 
@@ -590,11 +1114,10 @@ static void cli_task(void *arg)
 
                 nvs_config_t cfg;
                 nvs_config_get(&cfg);
-                ld2450_cmd_apply_distance_angle(cfg.max_distance_mm,
-                                                 cfg.angle_left_deg,
-                                                 cfg.angle_right_deg);
-                printf("angle left=%u right=%u (saved, applied)\n",
-                       cfg.angle_left_deg, cfg.angle_right_deg);
+                esp_err_t err = cli_apply_region();
+                printf("angle left=%u right=%u (saved, %s)\n",
+                       cfg.angle_left_deg, cfg.angle_right_deg,
+                       err == ESP_OK ? "applied" : esp_err_to_name(err));
                 continue;
             }
 
@@ -602,7 +1125,9 @@ static void cli_task(void *arg)
                 char *v = strtok(NULL, " \t\r\n");
                 if (!v) { printf("usage: ld bt <on|off>\n"); continue; }
                 bool on = strcmp(v, "on") == 0;
-                ld2450_cmd_set_bluetooth(on);
+                ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_BLUETOOTH, .u.bt_enable = on };
+                esp_err_t err = ld2450_cmd_submit_wait(&req);
+                if (err != ESP_OK) printf("bt command failed: %s\n", esp_err_to_name(err));
                 nvs_config_save_bt_disabled(on ? 0 : 1);
                 printf("bt=%s (saved, restart sensor to take effect)\n", on ? "on" : "off");
                 continue;
@@ -628,6 +1153,7 @@ static void cli_task(void *arg)
                     z.vertex_count = 0;
                     if (ld2450_set_zone((size_t)zi, &z) == ESP_OK) {
                         esp_err_t err = nvs_config_save_zone((uint8_t)zi, &z);
+                        config_api_zones_changed();
                         if (err == ESP_OK) {
                             printf("zone%d disabled (saved)\n", zi + 1);
                         } else {
@@ -672,6 +1198,7 @@ static void cli_task(void *arg)
 
                 if (ld2450_set_zone((size_t)zi, &z) == ESP_OK) {
                     esp_err_t err = nvs_config_save_zone((uint8_t)zi, &z);
+                    config_api_zones_changed();
                     if (err == ESP_OK) {
                         printf("zone%d set (saved)\n", zi + 1);
                     } else {
@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: MIT
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "local_rules.h"
+
+void local_rules_init(local_rules_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->version = LOCAL_RULES_VERSION;
+}
+
+static bool rule_valid(const local_rule_t *r)
+{
+    if (r->action == LR_ACT_NONE || r->action > LR_ACT_SCENE) return false;
+    if (((r->occ_mask | r->clear_mask | r->any_mask) & ~LR_ALL_MASK) != 0) return false;
+    if ((r->occ_mask | r->clear_mask | r->any_mask) == 0) return false;
+    if (r->occ_mask & r->clear_mask) return false;
+    if (r->action == LR_ACT_LEVEL && r->arg > 100) return false;
+    if (r->dst_mode == LR_DST_BINDING) {
+        if (r->dst < 1 || r->dst > 11 || r->action == LR_ACT_SCENE) return false;
+    } else if (r->dst_mode != LR_DST_GROUP) {
+        return false;
+    }
+    return true;
+}
+
+bool local_rules_valid(const local_rules_t *t)
+{
+    if (t->version != LOCAL_RULES_VERSION || t->count > LOCAL_RULES_MAX) return false;
+    for (uint8_t i = 0; i < t->count; i++) {
+        if (!rule_valid(&t->rule[i])) return false;
+    }
+    return true;
+}
+
+/* "main" -> bit 0, "zN" -> bit N; 0 if not an endpoint name */
+static uint16_t ep_bit(const char *s)
+{
+    if (strcmp(s, "main") == 0) return LR_MAIN_MASK;
+    if (s[0] != 'z' || s[1] < '0' || s[1] > '9') return 0;
+    char *end;
+    long n = strtol(s + 1, &end, 10);
+    if (*end != '\0' || n < 1 || n > 10) return 0;
+    return (uint16_t)(1u << n);
+}
+
+#define WS " \t\r\n"
+
+/* Next token of *p split on delims (NUL-terminated in place), NULL at the end */
+static char *next_tok(char **p, const char *delims)
+{
+    char *s = *p + strspn(*p, delims);
+    if (*s == '\0') { *p = s; return NULL; }
+    char *e = s + strcspn(s, delims);
+    if (*e != '\0') *e++ = '\0';
+    *p = e;
+    return s;
+}
+
+static bool parse_num(const char *s, long min, long max, long *out)
+{
+    if (!s) return false;
+    char *end;
+    long v = strtol(s, &end, 0);
+    if (*s == '\0' || *end != '\0' || v < min || v > max) return false;
+    *out = v;
+    return true;
+}
+
+static bool parse_term(char *tok, local_rule_t *r, const char **err)
+{
+    if (strcmp(tok, "any") == 0) { r->any_mask |= LR_ZONES_MASK; return true; }
+    if (strcmp(tok, "none") == 0) { r->clear_mask |= LR_ALL_MASK; return true; }
+    if (tok[0] == '!') {
+        uint16_t b = ep_bit(tok + 1);
+        if (!b) { *err = "unknown endpoint after '!' (main, z1-z10)"; return false; }
+        r->clear_mask |= b;
+        return true;
+    }
+    if (strchr(tok, '|')) {
+        uint16_t any = 0;
+        char *rest = tok;
+        for (char *p = next_tok(&rest, "|"); p; p = next_tok(&rest, "|")) {
+            uint16_t b = ep_bit(p);
+            if (!b) { *err = "unknown endpoint in '|' list (main, z1-z10)"; return false; }
+            any |= b;
+        }
+        if (r->any_mask) { *err = "only one 'any' / '|' term per rule"; return false; }
+        r->any_mask = any;
+        return true;
+    }
+    uint16_t b = ep_bit(tok);
+    if (!b) { *err = "unknown condition (main, zN, !zN, any, none, zA|zB)"; return false; }
+    r->occ_mask |= b;
+    return true;
+}
+
+bool local_rule_parse(const char *text, local_rule_t *out, const char **err)
+{
+    static const char *dummy;
+    if (!err) err = &dummy;
+    *err = NULL;
+    if (!text) { *err = "empty rule"; return false; }
+
+    char buf[LOCAL_RULE_TEXT_MAX + 1];
+    size_t n = strlen(text);
+    if (n > LOCAL_RULE_TEXT_MAX) { *err = "rule too long"; return false; }
+    for (size_t i = 0; i <= n; i++) {
+        char c = text[i];
+        buf[i] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+
+    local_rule_t r = {0};
+    r.dst_mode = LR_DST_BINDING;
+    r.dst      = 1;
+
+    char *rest = buf;
+    char *tok;
+    bool arrow = false;
+    while ((tok = next_tok(&rest, WS)) != NULL) {
+        if (strcmp(tok, "->") == 0 || strcmp(tok, "then") == 0) { arrow = true; break; }
+        if (!parse_term(tok, &r, err)) return false;
+    }
+    if (!arrow) { *err = "missing '->' between condition and action"; return false; }
+    if ((r.occ_mask | r.clear_mask | r.any_mask) == 0) { *err = "missing condition"; return false; }
+    if (r.occ_mask & r.clear_mask) { *err = "endpoint both occupied and clear"; return false; }
+
+    tok = next_tok(&rest, WS);
+    long v;
+    if (!tok) { *err = "missing action"; return false; }
+    if (strcmp(tok, "on") == 0) {
+        r.action = LR_ACT_ON;
+    } else if (strcmp(tok, "off") == 0) {
+        r.action = LR_ACT_OFF;
+    } else if (strcmp(tok, "toggle") == 0) {
+        r.action = LR_ACT_TOGGLE;
+    } else if (strcmp(tok, "level") == 0) {
+        if (!parse_num(next_tok(&rest, WS "%"), 0, 100, &v)) { *err = "level needs 0-100 (%)"; return false; }
+        r.action = LR_ACT_LEVEL;
+        r.arg    = (uint8_t)v;
+    } else if (strcmp(tok, "scene") == 0) {
+        if (!parse_num(next_tok(&rest, WS), 0, 255, &v)) { *err = "scene needs an id 0-255"; return false; }
+        r.action = LR_ACT_SCENE;
+        r.arg    = (uint8_t)v;
+    } else {
+        *err = "unknown action (on, off, toggle, level <%>, scene <id>)";
+        return false;
+    }
+
+    while ((tok = next_tok(&rest, WS)) != NULL) {
+        if (strcmp(tok, "group") == 0) {
+            if (!parse_num(next_tok(&rest, WS), 1, 0xFFF7, &v)) { *err = "group needs an id 0x0001-0xFFF7"; return false; }
+            r.dst_mode = LR_DST_GROUP;
+            r.dst      = (uint16_t)v;
+        } else if (strcmp(tok, "ep") == 0) {
+            if (!parse_num(next_tok(&rest, WS), 1, 11, &v)) { *err = "ep needs 1-11"; return false; }
+            r.dst_mode = LR_DST_BINDING;
+            r.dst      = (uint16_t)v;
+        } else if (strcmp(tok, "always") == 0) {
+            r.flags |= LR_FLAG_ALWAYS;
+        } else {
+            *err = "unknown option (group <id>, ep <n>, always)";
+            return false;
+        }
+    }
+    if (r.action == LR_ACT_SCENE && r.dst_mode != LR_DST_GROUP) { *err = "scene needs 'group <id>'"; return false; }
+
+    *out = r;
+    return true;
+}
+
+static void append(char *buf, size_t len, size_t *pos, const char *fmt, ...)
+{
+    if (*pos >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(buf + *pos, len - *pos, fmt, ap);
+    va_end(ap);
+    *pos = (w < 0) ? len : *pos + (size_t)w;
+}
+
+static void append_ep(char *buf, size_t len, size_t *pos, uint8_t i)
+{
+    if (i == 0) append(buf, len, pos, "main");
+    else        append(buf, len, pos, "z%u", i);
+}
+
+void local_rule_format(const local_rule_t *r, char *buf, size_t buflen)
+{
+    static const char *const act[] = {"?", "on", "off", "toggle", "level", "scene"};
+    if (buflen == 0) return;
+    buf[0] = '\0';
+    size_t pos = 0;
+
+    if (r->clear_mask == LR_ALL_MASK && r->occ_mask == 0 && r->any_mask == 0) {
+        append(buf, buflen, &pos, "none");
+    } else {
+        for (uint8_t i = 0; i < 11; i++) {
+            uint16_t b = (uint16_t)(1u << i);
+            if (!((r->occ_mask | r->clear_mask) & b)) continue;
+            append(buf, buflen, &pos, "%s%s", pos ? " " : "", (r->clear_mask & b) ? "!" : "");
+            append_ep(buf, buflen, &pos, i);
+        }
+        if (r->any_mask == LR_ZONES_MASK) {
+            append(buf, buflen, &pos, "%sany", pos ? " " : "");
+        } else if (r->any_mask) {
+            bool first = true;
+            for (uint8_t i = 0; i < 11; i++) {
+                if (!(r->any_mask & (1u << i))) continue;
+                append(buf, buflen, &pos, "%s", first ? (pos ? " " : "") : "|");
+                append_ep(buf, buflen, &pos, i);
+                first = false;
+            }
+        }
+    }
+
+    append(buf, buflen, &pos, " -> %s", r->action <= LR_ACT_SCENE ? act[r->action] : "?");
+    if (r->action == LR_ACT_LEVEL || r->action == LR_ACT_SCENE) append(buf, buflen, &pos, " %u", r->arg);
+    if (r->dst_mode == LR_DST_GROUP) append(buf, buflen, &pos, " group 0x%04X", r->dst);
+    else                             append(buf, buflen, &pos, " ep %u", r->dst);
+    if (r->flags & LR_FLAG_ALWAYS)   append(buf, buflen, &pos, " always");
+}
+
+bool local_rule_match(const local_rule_t *r, uint16_t bits)
+{
+    if ((bits & r->occ_mask) != r->occ_mask) return false;
+    if (bits & r->clear_mask) return false;
+    if (r->any_mask && !(bits & r->any_mask)) return false;
+    return true;
+}
+
+uint16_t local_rules_eval(const local_rules_t *t, uint16_t prev, uint16_t now, bool fallback)
+{
+    if (prev == now) return 0;
+    uint16_t fire = 0;
+    for (uint8_t i = 0; i < t->count && i < LOCAL_RULES_MAX; i++) {
+        const local_rule_t *r = &t->rule[i];
+        if (!fallback && !(r->flags & LR_FLAG_ALWAYS)) continue;
+        if (local_rule_match(r, now) && !local_rule_match(r, prev)) fire |= (uint16_t)(1u << i);
+    }
+    return fire;
+}
+
+bool local_rules_add(local_rules_t *t, const local_rule_t *r)
+{
+    if (t->count >= LOCAL_RULES_MAX) return false;
+    t->rule[t->count++] = *r;
+    return true;
+}
+
+bool local_rules_remove(local_rules_t *t, uint8_t idx)
+{
+    if (idx >= t->count) return false;
+    memmove(&t->rule[idx], &t->rule[idx + 1], (size_t)(t->count - idx - 1) * sizeof(t->rule[0]));
+    t->count--;
+    memset(&t->rule[t->count], 0, sizeof(t->rule[0]));
+    return true;
+}
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * On-device automation rules, evaluated on occupancy transitions so lights
+ * respond without the coordinator round-trip.
+ *
+ * Occupancy is a bitmap with bit 0 = main sensor (EP1) and bit n = zone n
+ * (EP n+1).  A rule's condition is
+ *
+ *     (bits & occ_mask) == occ_mask  &&  (bits & clear_mask) == 0
+ *     &&  (any_mask == 0 || (bits & any_mask) != 0)
+ *
+ * and the rule fires once when its condition goes from false to true.
+ * Rules run while the sensor is in fallback; rules with LR_FLAG_ALWAYS also
+ * run in normal operation, in front of the coordinator.
+ *
+ * Text form (CLI, web, converter):
+ *
+ *     <cond> ... -> <action> [group <id> | ep <1-11>] [always]
+ *
+ *     cond:    main | zN | !main | !zN | any | none | a|b|...  (all terms AND)
+ *     action:  on | off | toggle | level <0-100 %> | scene <id>
+ *
+ * e.g. "z2 !z5 -> level 40 group 0x0003", "any -> scene 1 group 3 always".
+ * Without a destination the command goes to EP1's lights: its fallback group
+ * if one is set, else its On/Off (Level) bindings.  Scene recall needs a group.
+ */
+
+#define LOCAL_RULES_MAX        16
+#define LOCAL_RULES_VERSION    1
+#define LOCAL_RULE_TEXT_MAX    96
+
+#define LR_MAIN_MASK           0x0001
+#define LR_ZONES_MASK          0x07FE
+#define LR_ALL_MASK            0x07FF
+
+#define LR_FLAG_ALWAYS         0x01   /* also in normal operation, not only in fallback */
+
+typedef enum {
+    LR_ACT_NONE = 0,
+    LR_ACT_ON,
+    LR_ACT_OFF,
+    LR_ACT_TOGGLE,
+    LR_ACT_LEVEL,            /* arg = level in percent, Move to Level (with On/Off) */
+    LR_ACT_SCENE,            /* arg = scene id, recalled in group dst */
+} local_rule_action_t;
+
+typedef enum {
+    LR_DST_BINDING = 0,      /* dst = source endpoint, sent to its fallback group or bindings */
+    LR_DST_GROUP,            /* dst = group id, sent from EP1 */
+} local_rule_dst_t;
+
+typedef struct {
+    uint16_t occ_mask;       /* all of these occupied */
+    uint16_t clear_mask;     /* all of these clear */
+    uint16_t any_mask;       /* at least one of these occupied (0 = no such term) */
+    uint16_t dst;
+    uint8_t  action;         /* local_rule_action_t */
+    uint8_t  arg;
+    uint8_t  dst_mode;       /* local_rule_dst_t */
+    uint8_t  flags;          /* LR_FLAG_* */
+} local_rule_t;
+
+/* Stored as one NVS blob, version first */
+typedef struct {
+    uint8_t      version;
+    uint8_t      count;
+    local_rule_t rule[LOCAL_RULES_MAX];
+} local_rules_t;
+
+void local_rules_init(local_rules_t *t);
+
+/** True if t is a table this firmware can run (version, count, every rule valid). */
+bool local_rules_valid(const local_rules_t *t);
+
+/** Parse one rule.  On failure returns false and points *err at a message. */
+bool local_rule_parse(const char *text, local_rule_t *out, const char **err);
+
+/** Canonical text form of r (parses back to the same rule). */
+void local_rule_format(const local_rule_t *r, char *buf, size_t buflen);
+
+/** Condition of r for an occupancy bitmap. */
+bool local_rule_match(const local_rule_t *r, uint16_t bits);
+
+/**
+ * Rules that fire on the transition prev -> now: bit i set for rule i.  In
+ * normal operation (fallback == false) only LR_FLAG_ALWAYS rules run.
+ */
+uint16_t local_rules_eval(const local_rules_t *t, uint16_t prev, uint16_t now, bool fallback);
+
+/** Append r; false if the table is full. */
+bool local_rules_add(local_rules_t *t, const local_rule_t *r);
+
+/** Remove rule idx (0-based), shifting the rest up; false if out of range. */
+bool local_rules_remove(local_rules_t *t, uint8_t idx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,11 +7,14 @@
 #include "nvs_flash.h"
 
 extern "C" {
+#include "config_api.h"
 #include "crash_diag.h"
 #include "ld2450.h"
 #include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
 #include "ld2450_cli.h"
 #include "nvs_config.h"
+#include "sensor_recovery.h"
 #include "zigbee_init.h"
 #include "zigbee_signal_handlers.h"
 #if CONFIG_IDF_TARGET_ESP32C6
@@ -62,15 +65,11 @@ static void apply_saved_config(const nvs_config_t *cfg)
     vTaskDelay(pdMS_TO_TICKS(1000));
     ESP_LOGI(TAG, "Sensor ready — applying hardware config");
 
-    /* Apply hardware config via sensor commands */
-    if (cfg->bt_disabled) {
-        ld2450_cmd_set_bluetooth(false);
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
-
-    ld2450_cmd_apply_distance_angle(cfg->max_distance_mm,
-                                     cfg->angle_left_deg,
-                                     cfg->angle_right_deg);
+    /* Apply hardware config in one config-mode session (worker queue, waited for) */
+    ld2450_cmd_req_t req = {};
+    req.op = LD2450_CMD_OP_BATCH;
+    config_api_build_sensor_batch(&req.u.batch);
+    ld2450_cmd_submit_wait(&req);
 
     ESP_LOGI(TAG, "Saved config applied");
 }
@@ -113,10 +112,15 @@ extern "C" void app_main(void)
 
     ESP_ERROR_CHECK(ld2450_init(&cfg));
     ESP_ERROR_CHECK(ld2450_cmd_init());
+    ESP_ERROR_CHECK(ld2450_cmd_worker_start());
+    ESP_ERROR_CHECK(config_api_init());
 
     /* Apply saved config (zones, hardware params) */
     apply_saved_config(&saved_cfg);
 
+    /* From here on, restart a stalled sensor and re-apply the config after a reboot */
+    ESP_ERROR_CHECK(sensor_recovery_start());
+
     /* Bring up CLI early so we can debug even if Zigbee gets noisy */
     ld2450_cli_start();
 
@@ -5,6 +5,9 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "coord_report.h"
+#include "rate_limit.h"
 #include "sensor_bridge.h"
 #if CONFIG_IDF_TARGET_ESP32C6
 #include "web_server_base.h"
@@ -63,14 +66,26 @@ static const char *NVS_NAMESPACE = "ld2450_cfg";
 static nvs_config_t s_cfg;
 static bool s_initialized = false;
 
+/* Published config: s_cfg is the writers' working copy; every change is
+ * copied here under s_snap_lock, and readers only copy out of it under the
+ * same lock, so nobody sees a setter half way through. */
+static struct {
+    uint32_t     generation;
+    nvs_config_t cfg;
+} s_snap;
+static portMUX_TYPE s_snap_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /* Default config values */
 static const nvs_config_t DEFAULT_CONFIG = {
     .tracking_mode    = 0,     /* multi */
     .publish_coords   = 0,     /* off */
+    .coord_deadband_mm     = 50,
+    .coord_min_interval_ms = 500,
     .max_distance_mm  = 6000,
     .angle_left_deg   = 60,
     .angle_right_deg  = 60,
     .bt_disabled      = 1,     /* BT off by default */
+    .hw_filter_mode   = 0,     /* range limits only */
     .zones = {
         { .vertex_count = 0 }, { .vertex_count = 0 }, { .vertex_count = 0 },
         { .vertex_count = 0 }, { .vertex_count = 0 }, { .vertex_count = 0 },
@@ -86,9 +101,21 @@ static const nvs_config_t DEFAULT_CONFIG = {
     .ack_timeout_ms         = 2000,
     .heartbeat_enable       = 0,
     .heartbeat_interval_sec = 120,
+    .zone_ep_reports        = 1,
+    .rate_burst             = RATE_LIMIT_BURST_DEFAULT,
+    .rate_per_min           = RATE_LIMIT_PER_MIN_DEFAULT,
+    .rules                  = { .version = LOCAL_RULES_VERSION, .count = 0 },
 };
 
-static esp_err_t nvs_save_u8(const char *key, uint8_t val)
+static void publish_snapshot(void)
+{
+    portENTER_CRITICAL(&s_snap_lock);
+    s_snap.cfg = s_cfg;
+    s_snap.generation++;
+    portEXIT_CRITICAL(&s_snap_lock);
+}
+
+static esp_err_t nvs_save_u8(const char *key, uint8_t val, uint64_t dirty)
 {
     nvs_handle_t h;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
@@ -97,7 +124,7 @@ static esp_err_t nvs_save_u8(const char *key, uint8_t val)
     if (err == ESP_OK) err = nvs_commit(h);
     nvs_close(h);
     if (err == ESP_OK) {
-        sensor_bridge_mark_config_dirty();
+        sensor_bridge_mark_config_dirty_mask(dirty);
 #if CONFIG_IDF_TARGET_ESP32C6
         web_server_base_sse_notify("config");
 #endif
@@ -105,7 +132,7 @@ static esp_err_t nvs_save_u8(const char *key, uint8_t val)
     return err;
 }
 
-static esp_err_t nvs_save_u16(const char *key, uint16_t val)
+static esp_err_t nvs_save_u16(const char *key, uint16_t val, uint64_t dirty)
 {
     nvs_handle_t h;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
@@ -114,7 +141,7 @@ static esp_err_t nvs_save_u16(const char *key, uint16_t val)
     if (err == ESP_OK) err = nvs_commit(h);
     nvs_close(h);
     if (err == ESP_OK) {
-        sensor_bridge_mark_config_dirty();
+        sensor_bridge_mark_config_dirty_mask(dirty);
 #if CONFIG_IDF_TARGET_ESP32C6
         web_server_base_sse_notify("config");
 #endif
@@ -122,7 +149,7 @@ static esp_err_t nvs_save_u16(const char *key, uint16_t val)
     return err;
 }
 
-static esp_err_t nvs_save_blob(const char *key, const void *data, size_t len)
+static esp_err_t nvs_save_blob(const char *key, const void *data, size_t len, uint64_t dirty)
 {
     nvs_handle_t h;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
@@ -131,7 +158,7 @@ static esp_err_t nvs_save_blob(const char *key, const void *data, size_t len)
     if (err == ESP_OK) err = nvs_commit(h);
     nvs_close(h);
     if (err == ESP_OK) {
-        sensor_bridge_mark_config_dirty();
+        sensor_bridge_mark_config_dirty_mask(dirty);
 #if CONFIG_IDF_TARGET_ESP32C6
         web_server_base_sse_notify("config");
 #endif
@@ -149,11 +176,13 @@ esp_err_t nvs_config_init(void)
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
     if (err == ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGI(TAG, "No saved config, using defaults");
+        publish_snapshot();
         s_initialized = true;
         return ESP_OK;
     }
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "NVS open failed: %s, using defaults", esp_err_to_name(err));
+        publish_snapshot();
         s_initialized = true;
         return ESP_OK;
     }
@@ -161,10 +190,15 @@ esp_err_t nvs_config_init(void)
     /* Load each field, keeping default if not found */
     nvs_get_u8(h, "track_mode", &s_cfg.tracking_mode);
     nvs_get_u8(h, "pub_coords", &s_cfg.publish_coords);
+    if (s_cfg.publish_coords > COORD_PUBLISH_ADAPTIVE) s_cfg.publish_coords = COORD_PUBLISH_ON;
+    nvs_get_u16(h, "coord_db_mm", &s_cfg.coord_deadband_mm);
+    nvs_get_u16(h, "coord_min_ms", &s_cfg.coord_min_interval_ms);
     nvs_get_u16(h, "max_dist", &s_cfg.max_distance_mm);
     nvs_get_u8(h, "angle_l", &s_cfg.angle_left_deg);
     nvs_get_u8(h, "angle_r", &s_cfg.angle_right_deg);
     nvs_get_u8(h, "bt_off", &s_cfg.bt_disabled);
+    nvs_get_u8(h, "hw_filter", &s_cfg.hw_filter_mode);
+    if (s_cfg.hw_filter_mode > 1) s_cfg.hw_filter_mode = 0;
 
     /* Load zones: three-way detection — new format, old format (migrate), or missing (default) */
     char key[12];
@@ -258,6 +292,14 @@ esp_err_t nvs_config_init(void)
     nvs_get_u16(h, "ack_to_ms", &s_cfg.ack_timeout_ms);
     if (s_cfg.ack_timeout_ms == 0) s_cfg.ack_timeout_ms = 2000;
 
+    /* Load zone reporting mode (absent key keeps the default: per-zone reports on) */
+    nvs_get_u8(h, "zone_ep_rpt", &s_cfg.zone_ep_reports);
+
+    /* Load report rate limiter */
+    nvs_get_u8(h, "rate_burst", &s_cfg.rate_burst);
+    if (s_cfg.rate_burst == 0) s_cfg.rate_burst = RATE_LIMIT_BURST_DEFAULT;
+    nvs_get_u16(h, "rate_min", &s_cfg.rate_per_min);
+
     /* Load fallback cooldowns — versioned blob: { version(1), reserved(1), cooldowns[11] } */
     {
         typedef struct { uint8_t version; uint8_t reserved; uint16_t cooldowns[11]; } fb_cool_blob_t;
@@ -270,12 +312,35 @@ esp_err_t nvs_config_init(void)
         /* else: keep defaults (300s each) */
     }
 
+    /* Load fallback groups — versioned blob: { version(1), reserved(1), groups[11] } */
+    {
+        typedef struct { uint8_t version; uint8_t reserved; uint16_t groups[11]; } fb_group_blob_t;
+        fb_group_blob_t blob = {0};
+        size_t blen = sizeof(blob);
+        if (nvs_get_blob(h, "fb_group", &blob, &blen) == ESP_OK
+                && blen == sizeof(blob) && blob.version == 1) {
+            memcpy(s_cfg.fallback_group, blob.groups, sizeof(s_cfg.fallback_group));
+        }
+        /* else: keep defaults (0 = bindings) */
+    }
+
+    /* Load automation rules — versioned blob (local_rules_t); ignored if invalid */
+    {
+        local_rules_t rules;
+        size_t rlen = sizeof(rules);
+        if (nvs_get_blob(h, "rules", &rules, &rlen) == ESP_OK
+                && rlen == sizeof(rules) && local_rules_valid(&rules)) {
+            s_cfg.rules = rules;
+        }
+    }
+
     nvs_close(h);
 
     ESP_LOGI(TAG, "Config loaded: dist=%u left=%u right=%u bt_off=%u mode=%u coords=%u",
              s_cfg.max_distance_mm, s_cfg.angle_left_deg, s_cfg.angle_right_deg,
              s_cfg.bt_disabled, s_cfg.tracking_mode, s_cfg.publish_coords);
 
+    publish_snapshot();
     s_initialized = true;
     return ESP_OK;
 }
@@ -284,62 +349,110 @@ esp_err_t nvs_config_get(nvs_config_t *out)
 {
     if (!out) return ESP_ERR_INVALID_ARG;
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
-    *out = s_cfg;
+    portENTER_CRITICAL(&s_snap_lock);
+    *out = s_snap.cfg;
+    portEXIT_CRITICAL(&s_snap_lock);
     return ESP_OK;
 }
 
+uint32_t nvs_config_generation(void)
+{
+    return s_snap.generation;
+}
+
+uint32_t nvs_config_read(size_t offset, size_t len, void *out)
+{
+    portENTER_CRITICAL(&s_snap_lock);
+    memcpy(out, (const uint8_t *)&s_snap.cfg + offset, len);
+    uint32_t gen = s_snap.generation;
+    portEXIT_CRITICAL(&s_snap_lock);
+    return gen;
+}
+
 esp_err_t nvs_config_save_tracking_mode(uint8_t mode)
 {
     s_cfg.tracking_mode = mode;
-    return nvs_save_u8("track_mode", mode);
+    publish_snapshot();
+    return nvs_save_u8("track_mode", mode, SB_DIRTY_TRACKING_MODE);
+}
+
+esp_err_t nvs_config_save_publish_coords(uint8_t mode)
+{
+    if (mode > COORD_PUBLISH_ADAPTIVE) mode = COORD_PUBLISH_ON;
+    s_cfg.publish_coords = mode;
+    publish_snapshot();
+    return nvs_save_u8("pub_coords", mode, SB_DIRTY_COORD_PUBLISHING);
+}
+
+esp_err_t nvs_config_save_coord_deadband(uint16_t mm)
+{
+    if (mm > 1000) mm = 1000;
+    s_cfg.coord_deadband_mm = mm;
+    publish_snapshot();
+    return nvs_save_u16("coord_db_mm", mm, SB_DIRTY_COORD_DEADBAND);
 }
 
-esp_err_t nvs_config_save_publish_coords(uint8_t enabled)
+esp_err_t nvs_config_save_coord_min_interval(uint16_t ms)
 {
-    s_cfg.publish_coords = enabled;
-    return nvs_save_u8("pub_coords", enabled);
+    if (ms > 10000) ms = 10000;
+    s_cfg.coord_min_interval_ms = ms;
+    publish_snapshot();
+    return nvs_save_u16("coord_min_ms", ms, SB_DIRTY_COORD_MIN_INTERVAL);
 }
 
 esp_err_t nvs_config_save_max_distance(uint16_t mm)
 {
     if (mm > 6000) mm = 6000;
     s_cfg.max_distance_mm = mm;
-    return nvs_save_u16("max_dist", mm);
+    publish_snapshot();
+    return nvs_save_u16("max_dist", mm, SB_DIRTY_MAX_DISTANCE);
 }
 
 esp_err_t nvs_config_save_angle_left(uint8_t deg)
 {
     if (deg > 90) deg = 90;
     s_cfg.angle_left_deg = deg;
-    return nvs_save_u8("angle_l", deg);
+    publish_snapshot();
+    return nvs_save_u8("angle_l", deg, SB_DIRTY_ANGLE_LEFT);
 }
 
 esp_err_t nvs_config_save_angle_right(uint8_t deg)
 {
     if (deg > 90) deg = 90;
     s_cfg.angle_right_deg = deg;
-    return nvs_save_u8("angle_r", deg);
+    publish_snapshot();
+    return nvs_save_u8("angle_r", deg, SB_DIRTY_ANGLE_RIGHT);
 }
 
 esp_err_t nvs_config_save_bt_disabled(uint8_t disabled)
 {
     s_cfg.bt_disabled = disabled;
-    return nvs_save_u8("bt_off", disabled);
+    publish_snapshot();
+    return nvs_save_u8("bt_off", disabled, 0);
+}
+
+esp_err_t nvs_config_save_hw_filter_mode(uint8_t mode)
+{
+    s_cfg.hw_filter_mode = mode ? 1 : 0;
+    publish_snapshot();
+    return nvs_save_u8("hw_filter", s_cfg.hw_filter_mode, SB_DIRTY_HW_FILTER_MODE);
 }
 
 void nvs_config_update_zone_cache(uint8_t zone_index, const ld2450_zone_t *zone)
 {
     if (zone_index >= 10 || !zone) return;
     s_cfg.zones[zone_index] = *zone;
+    publish_snapshot();
 }
 
 esp_err_t nvs_config_save_zone(uint8_t zone_index, const ld2450_zone_t *zone)
 {
     if (zone_index >= 10 || !zone) return ESP_ERR_INVALID_ARG;
     s_cfg.zones[zone_index] = *zone;
+    publish_snapshot();
     char key[12];
     snprintf(key, sizeof(key), "zone_%d", zone_index);
-    return nvs_save_blob(key, zone, sizeof(ld2450_zone_t));
+    return nvs_save_blob(key, zone, sizeof(ld2450_zone_t), SB_DIRTY_ZONE_GEOMETRY(zone_index));
 }
 
 esp_err_t nvs_config_save_occupancy_cooldown(uint8_t endpoint_index, uint16_t sec)
@@ -347,33 +460,40 @@ esp_err_t nvs_config_save_occupancy_cooldown(uint8_t endpoint_index, uint16_t se
     if (endpoint_index >= 11) return ESP_ERR_INVALID_ARG;
     if (sec > 300) sec = 300;
     s_cfg.occupancy_cooldown_sec[endpoint_index] = sec;
-    return nvs_save_blob("occ_cool", s_cfg.occupancy_cooldown_sec, sizeof(s_cfg.occupancy_cooldown_sec));
+    publish_snapshot();
+    return nvs_save_blob("occ_cool", s_cfg.occupancy_cooldown_sec, sizeof(s_cfg.occupancy_cooldown_sec),
+                         SB_DIRTY_OCC_COOLDOWN(endpoint_index));
 }
 
 esp_err_t nvs_config_save_occupancy_delay(uint8_t endpoint_index, uint16_t ms)
 {
     if (endpoint_index >= 11) return ESP_ERR_INVALID_ARG;
     s_cfg.occupancy_delay_ms[endpoint_index] = ms;
-    return nvs_save_blob("occ_delay", s_cfg.occupancy_delay_ms, sizeof(s_cfg.occupancy_delay_ms));
+    publish_snapshot();
+    return nvs_save_blob("occ_delay", s_cfg.occupancy_delay_ms, sizeof(s_cfg.occupancy_delay_ms),
+                         SB_DIRTY_OCC_DELAY(endpoint_index));
 }
 
 esp_err_t nvs_config_save_fallback_mode(uint8_t mode)
 {
     s_cfg.fallback_mode = mode;
-    return nvs_save_u8("fb_mode", mode);
+    publish_snapshot();
+    return nvs_save_u8("fb_mode", mode, SB_DIRTY_FALLBACK_MODE);
 }
 
 esp_err_t nvs_config_save_heartbeat_enable(uint8_t enable)
 {
     s_cfg.heartbeat_enable = enable;
-    return nvs_save_u8("hb_enable", enable);
+    publish_snapshot();
+    return nvs_save_u8("hb_enable", enable, SB_DIRTY_HEARTBEAT_ENABLE);
 }
 
 esp_err_t nvs_config_save_heartbeat_interval(uint16_t sec)
 {
     if (sec == 0) sec = 120;
     s_cfg.heartbeat_interval_sec = sec;
-    return nvs_save_u16("hb_interval", sec);
+    publish_snapshot();
+    return nvs_save_u16("hb_interval", sec, SB_DIRTY_HEARTBEAT_INTERVAL);
 }
 
 esp_err_t nvs_config_save_fallback_cooldown(uint8_t endpoint_index, uint16_t sec)
@@ -381,30 +501,80 @@ esp_err_t nvs_config_save_fallback_cooldown(uint8_t endpoint_index, uint16_t sec
     if (endpoint_index >= 11) return ESP_ERR_INVALID_ARG;
     if (sec > 600) sec = 600;
     s_cfg.fallback_cooldown_sec[endpoint_index] = sec;
+    publish_snapshot();
 
     /* Versioned blob: { version=1, reserved=0, cooldowns[11] } */
     typedef struct { uint8_t version; uint8_t reserved; uint16_t cooldowns[11]; } fb_cool_blob_t;
     fb_cool_blob_t blob = { .version = 1, .reserved = 0 };
     memcpy(blob.cooldowns, s_cfg.fallback_cooldown_sec, sizeof(s_cfg.fallback_cooldown_sec));
-    return nvs_save_blob("fb_cool", &blob, sizeof(blob));
+    return nvs_save_blob("fb_cool", &blob, sizeof(blob),
+                         endpoint_index == 0 ? SB_DIRTY_FALLBACK_COOLDOWN : 0);
+}
+
+esp_err_t nvs_config_save_fallback_group(uint8_t endpoint_index, uint16_t group)
+{
+    if (endpoint_index >= 11 || group > 0xFFF7) return ESP_ERR_INVALID_ARG;
+    s_cfg.fallback_group[endpoint_index] = group;
+    publish_snapshot();
+
+    /* Versioned blob: { version=1, reserved=0, groups[11] } */
+    typedef struct { uint8_t version; uint8_t reserved; uint16_t groups[11]; } fb_group_blob_t;
+    fb_group_blob_t blob = { .version = 1, .reserved = 0 };
+    memcpy(blob.groups, s_cfg.fallback_group, sizeof(s_cfg.fallback_group));
+    return nvs_save_blob("fb_group", &blob, sizeof(blob), SB_DIRTY_FALLBACK_GROUP);
 }
 
 esp_err_t nvs_config_save_fallback_enable(uint8_t enable)
 {
     s_cfg.fallback_enable = enable;
-    return nvs_save_u8("fb_enable", enable);
+    publish_snapshot();
+    return nvs_save_u8("fb_enable", enable, SB_DIRTY_FALLBACK_ENABLE);
 }
 
 esp_err_t nvs_config_save_hard_timeout_sec(uint8_t sec)
 {
     if (sec == 0) sec = 10;
     s_cfg.hard_timeout_sec = sec;
-    return nvs_save_u8("hard_to_sec", sec);
+    publish_snapshot();
+    return nvs_save_u8("hard_to_sec", sec, SB_DIRTY_HARD_TIMEOUT);
 }
 
 esp_err_t nvs_config_save_ack_timeout_ms(uint16_t ms)
 {
     if (ms < 500) ms = 500;
     s_cfg.ack_timeout_ms = ms;
-    return nvs_save_u16("ack_to_ms", ms);
+    publish_snapshot();
+    return nvs_save_u16("ack_to_ms", ms, SB_DIRTY_ACK_TIMEOUT);
+}
+
+esp_err_t nvs_config_save_zone_ep_reports(uint8_t enable)
+{
+    s_cfg.zone_ep_reports = enable ? 1 : 0;
+    publish_snapshot();
+    return nvs_save_u8("zone_ep_rpt", s_cfg.zone_ep_reports, SB_DIRTY_ZONE_EP_REPORTS);
+}
+
+esp_err_t nvs_config_save_rate_burst(uint8_t burst)
+{
+    if (burst < 1) burst = 1;
+    if (burst > RATE_LIMIT_BURST_MAX) burst = RATE_LIMIT_BURST_MAX;
+    s_cfg.rate_burst = burst;
+    publish_snapshot();
+    return nvs_save_u8("rate_burst", burst, SB_DIRTY_RATE_LIMIT);
+}
+
+esp_err_t nvs_config_save_rate_per_min(uint16_t per_min)
+{
+    if (per_min > RATE_LIMIT_PER_MIN_MAX) per_min = RATE_LIMIT_PER_MIN_MAX;
+    s_cfg.rate_per_min = per_min;
+    publish_snapshot();
+    return nvs_save_u16("rate_min", per_min, SB_DIRTY_RATE_LIMIT);
+}
+
+esp_err_t nvs_config_save_rules(const local_rules_t *rules)
+{
+    if (!rules || !local_rules_valid(rules)) return ESP_ERR_INVALID_ARG;
+    s_cfg.rules = *rules;
+    publish_snapshot();
+    return nvs_save_blob("rules", rules, sizeof(*rules), 0);
 }
@@ -4,6 +4,8 @@
 #include "esp_err.h"
 #include "ld2450.h"
 #include "ld2450_zone.h"
+#include "local_rules.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -14,13 +16,16 @@
 typedef struct {
     /* Software config */
     uint8_t tracking_mode;      /* 0=multi, 1=single */
-    uint8_t publish_coords;     /* 0=off, 1=on */
+    uint8_t publish_coords;     /* 0=off, 1=on, 2=adaptive (COORD_PUBLISH_*) */
+    uint16_t coord_deadband_mm;     /* 0-1000: movement below this is not reported (default 50) */
+    uint16_t coord_min_interval_ms; /* 0-10000: min time between target data reports (default 500) */
 
     /* Sensor hardware config (applied via LD2450 commands) */
     uint16_t max_distance_mm;   /* 0-6000 */
     uint8_t angle_left_deg;     /* 0-90 */
     uint8_t angle_right_deg;    /* 0-90 */
     uint8_t bt_disabled;        /* 0=BT on, 1=BT off */
+    uint8_t hw_filter_mode;     /* 0=range limits only, 1=also drop targets outside all zones (ld2450_hw_filter_mode_t) */
 
     /* Zones */
     ld2450_zone_t zones[10];
@@ -32,6 +37,7 @@ typedef struct {
     /* Coordinator fallback */
     uint8_t  fallback_mode;               /* 0=normal, 1=fallback active (sticky, NVS-backed) */
     uint16_t fallback_cooldown_sec[11];   /* [0]=main EP, [1-10]=zones; default 300s each */
+    uint16_t fallback_group[11];          /* [0]=main EP, [1-10]=zones; 0=bindings (default), else group-cast to this group */
 
     /* Soft/hard two-tier fallback parameters */
     uint8_t  fallback_enable;             /* 0=disabled (pure HA mode), 1=soft/hard fallback active */
@@ -41,6 +47,16 @@ typedef struct {
     /* Software watchdog (heartbeat) */
     uint8_t  heartbeat_enable;            /* 0=off, 1=expect periodic heartbeat writes */
     uint16_t heartbeat_interval_sec;      /* expected beat interval; watchdog = interval × 2; default 120s */
+
+    /* Zone occupancy reporting */
+    uint8_t  zone_ep_reports;             /* 1=per-zone Occupancy reports on EP2-11 (default), 0=EP1 zone bitmap only */
+
+    /* Report rate limiter (occupancy + target data, see rate_limit.h) */
+    uint8_t  rate_burst;                  /* 1-100 reports sent back-to-back (default 20) */
+    uint16_t rate_per_min;                /* 0-3000 sustained reports/min, 0=unlimited (default 600) */
+
+    /* On-device automation rules (see local_rules.h) */
+    local_rules_t rules;
 } nvs_config_t;
 
 /** Initialize NVS config module and load saved config (or defaults). */
@@ -49,13 +65,35 @@ esp_err_t nvs_config_init(void);
 /** Get a copy of the current loaded config. */
 esp_err_t nvs_config_get(nvs_config_t *out);
 
+/**
+ * Generation of the published config: 0 until nvs_config_init(), then
+ * bumped by every in-memory change.  Cache anything derived from the
+ * config (ticks, ms, ...) keyed on it and re-read only when it moves.
+ */
+uint32_t nvs_config_generation(void);
+
+/**
+ * Copy len bytes at offset in the published config under its lock and
+ * return the generation they came from.  Use NVS_CONFIG_READ(rules, &rules)
+ * for a member; offset 0 and sizeof(nvs_config_t) copy the whole config.
+ * A web form publishes once per field: fields that must agree come from
+ * one read, or from reads that returned the same generation.
+ */
+uint32_t nvs_config_read(size_t offset, size_t len, void *out);
+
+#define NVS_CONFIG_READ(member, out) \
+    nvs_config_read(offsetof(nvs_config_t, member), sizeof(((nvs_config_t *)0)->member), (out))
+
 /* Per-field save functions. Each updates the in-memory copy and writes to NVS. */
 esp_err_t nvs_config_save_tracking_mode(uint8_t mode);
-esp_err_t nvs_config_save_publish_coords(uint8_t enabled);
+esp_err_t nvs_config_save_publish_coords(uint8_t mode);
+esp_err_t nvs_config_save_coord_deadband(uint16_t mm);
+esp_err_t nvs_config_save_coord_min_interval(uint16_t ms);
 esp_err_t nvs_config_save_max_distance(uint16_t mm);
 esp_err_t nvs_config_save_angle_left(uint8_t deg);
 esp_err_t nvs_config_save_angle_right(uint8_t deg);
 esp_err_t nvs_config_save_bt_disabled(uint8_t disabled);
+esp_err_t nvs_config_save_hw_filter_mode(uint8_t mode);
 esp_err_t nvs_config_save_zone(uint8_t zone_index, const ld2450_zone_t *zone);
 
 /** Update the in-memory zone cache without writing to NVS flash.
@@ -72,6 +110,9 @@ esp_err_t nvs_config_save_fallback_mode(uint8_t mode);
 /** Save one fallback cooldown entry.  endpoint_index: 0=main, 1-10=zones. */
 esp_err_t nvs_config_save_fallback_cooldown(uint8_t endpoint_index, uint16_t sec);
 
+/** Save one fallback group entry (0=bindings, 0x0001-0xFFF7=group).  endpoint_index: 0=main, 1-10=zones. */
+esp_err_t nvs_config_save_fallback_group(uint8_t endpoint_index, uint16_t group);
+
 /** Save heartbeat_enable (0=off, 1=on) to NVS. */
 esp_err_t nvs_config_save_heartbeat_enable(uint8_t enable);
 
@@ -86,3 +127,13 @@ esp_err_t nvs_config_save_hard_timeout_sec(uint8_t sec);
 
 /** Save ack_timeout_ms (APS ACK timeout in ms) to NVS. */
 esp_err_t nvs_config_save_ack_timeout_ms(uint16_t ms);
+
+/** Save zone_ep_reports (0=zone bitmap only, 1=also per-zone EP reports) to NVS. */
+esp_err_t nvs_config_save_zone_ep_reports(uint8_t enable);
+
+/** Save the report rate limiter burst size (1-100) and sustained rate (reports/min, 0=unlimited). */
+esp_err_t nvs_config_save_rate_burst(uint8_t burst);
+esp_err_t nvs_config_save_rate_per_min(uint16_t per_min);
+
+/** Save the automation rule table.  Rejected (ESP_ERR_INVALID_ARG) unless local_rules_valid(). */
+esp_err_t nvs_config_save_rules(const local_rules_t *rules);
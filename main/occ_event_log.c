@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "occ_event_log.h"
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void occ_event_log_init(occ_event_log_t *log)
+{
+    memset(log, 0, sizeof(*log));
+}
+
+void occ_event_log_add(occ_event_log_t *log, uint8_t ep, bool occupied, uint32_t t_ms)
+{
+    occ_event_t *e = &log->ev[log->head];
+    e->ep       = ep;
+    e->occupied = occupied;
+    e->t_ms     = t_ms;
+
+    log->head = (uint8_t)((log->head + 1) % OCC_EVENT_LOG_LEN);
+    if (log->count < OCC_EVENT_LOG_LEN) log->count++;
+    log->seq++;
+}
+
+bool occ_event_log_get(const occ_event_log_t *log, uint8_t idx, occ_event_t *out)
+{
+    if (idx >= log->count) return false;
+    uint8_t slot = (uint8_t)((log->head + OCC_EVENT_LOG_LEN - 1 - idx) % OCC_EVENT_LOG_LEN);
+    *out = log->ev[slot];
+    return true;
+}
+
+void occ_event_log_pack(const occ_event_log_t *log, uint32_t now_ms,
+                        uint8_t out[OCC_EVENT_LOG_PAYLOAD_LEN])
+{
+    memset(out, 0, OCC_EVENT_LOG_PAYLOAD_LEN);
+    put_u16(out + 0, log->seq);
+    out[2] = log->count;
+    put_u32(out + 3, now_ms);
+
+    for (uint8_t i = 0; i < log->count; i++) {
+        occ_event_t e;
+        occ_event_log_get(log, i, &e);
+        uint8_t *p = out + OCC_EVENT_LOG_HEADER_LEN + i * OCC_EVENT_LOG_ENTRY_LEN;
+        p[0] = (uint8_t)(e.ep | (e.occupied ? OCC_EVENT_OCCUPIED_BIT : 0));
+        put_u32(p + 1, now_ms - e.t_ms);
+    }
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Occupancy event log (EP1 0x0006): a small ring of timestamped occupancy
+ * transitions so the coordinator can rebuild exact transition times even
+ * when individual Occupancy reports arrive late or are retried.
+ *
+ * Payload (little-endian, OCC_EVENT_LOG_PAYLOAD_LEN bytes, fixed length):
+ *   [0]  uint16 seq     events logged since boot (wraps); seq of entry 0
+ *   [2]  uint8  count   valid entries (0..OCC_EVENT_LOG_LEN)
+ *   [3]  uint32 now_ms  device uptime when the payload was packed
+ *   [7 + 5*i]           entry i, newest first:
+ *          uint8  ep | 0x80 if occupied
+ *          uint32 age_ms  now_ms - event time
+ * Unused entries are packed as zeros.
+ *
+ * Entries are relative to now_ms and the attribute is rewritten on every new
+ * event, so consecutive payloads overlap.  A receiver pins each payload to
+ * its timeline through an entry it already holds (seq tells which) and only
+ * falls back to its own receipt time when nothing overlaps, so transition
+ * spacing stays exact however late the reports arrive.  A gap in seq means
+ * events fell out of the ring between two reads.
+ */
+
+#define OCC_EVENT_LOG_LEN          8
+#define OCC_EVENT_LOG_HEADER_LEN   7
+#define OCC_EVENT_LOG_ENTRY_LEN    5
+#define OCC_EVENT_LOG_PAYLOAD_LEN  (OCC_EVENT_LOG_HEADER_LEN + OCC_EVENT_LOG_LEN * OCC_EVENT_LOG_ENTRY_LEN)   /* 47 */
+
+#define OCC_EVENT_OCCUPIED_BIT     0x80
+
+typedef struct {
+    uint8_t  ep;
+    bool     occupied;
+    uint32_t t_ms;        /* device uptime of the reported transition */
+} occ_event_t;
+
+typedef struct {
+    occ_event_t ev[OCC_EVENT_LOG_LEN];
+    uint8_t  head;        /* slot the next event goes into */
+    uint8_t  count;
+    uint16_t seq;         /* events logged since init, wraps */
+} occ_event_log_t;
+
+void occ_event_log_init(occ_event_log_t *log);
+
+/** Record one reported transition; the oldest entry is dropped when full. */
+void occ_event_log_add(occ_event_log_t *log, uint8_t ep, bool occupied, uint32_t t_ms);
+
+/** Entry idx (0 = newest).  Returns false if idx >= count. */
+bool occ_event_log_get(const occ_event_log_t *log, uint8_t idx, occ_event_t *out);
+
+/** Pack the log relative to now_ms into the wire layout described above. */
+void occ_event_log_pack(const occ_event_log_t *log, uint32_t now_ms,
+                        uint8_t out[OCC_EVENT_LOG_PAYLOAD_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
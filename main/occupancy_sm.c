@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "occupancy_sm.h"
+
+void occupancy_sm_init(occupancy_sm_t *sm, uint8_t count,
+                       occupancy_sm_clock_fn_t clock,
+                       occupancy_sm_report_fn_t report, void *ctx)
+{
+    memset(sm, 0, sizeof(*sm));
+    sm->count  = count > OCCUPANCY_SM_MAX_EPS ? OCCUPANCY_SM_MAX_EPS : count;
+    sm->clock  = clock;
+    sm->report = report;
+    sm->ctx    = ctx;
+}
+
+void occupancy_sm_set_timing(occupancy_sm_t *sm, uint8_t idx,
+                             uint32_t delay_ms, uint32_t cooldown_ms)
+{
+    if (idx >= sm->count) return;
+    sm->ep[idx].delay_ms    = delay_ms;
+    sm->ep[idx].cooldown_ms = cooldown_ms;
+}
+
+static void emit(occupancy_sm_t *sm, uint8_t idx, bool occupied, uint32_t now)
+{
+    occupancy_sm_ep_t *e = &sm->ep[idx];
+    e->reported       = occupied;
+    e->last_report_ms = now;
+    if (sm->report) sm->report(idx, occupied, sm->ctx);
+}
+
+uint8_t occupancy_sm_tick(occupancy_sm_t *sm, uint32_t raw_bitmap)
+{
+    uint32_t now = sm->clock(sm->ctx);
+    uint8_t reports = 0;
+
+    for (uint8_t i = 0; i < sm->count; i++) {
+        occupancy_sm_ep_t *e = &sm->ep[i];
+        bool occupied = (raw_bitmap >> i) & 1u;
+
+        if (occupied != e->raw) {
+            e->raw = occupied;
+            if (!occupied) {
+                /* Occupied -> Clear: cancel pending occupied, start cooldown */
+                e->pending_occupied = false;
+                if (!e->pending_clear) {
+                    e->pending_clear  = true;
+                    e->clear_start_ms = now;
+                }
+            } else {
+                /* Clear -> Occupied: cancel pending clear, start delay timer */
+                e->pending_clear = false;
+                if (!e->pending_occupied) {
+                    e->pending_occupied  = true;
+                    e->occupied_start_ms = now;
+                }
+            }
+        }
+
+        if (e->pending_occupied && occupied &&
+            (e->delay_ms == 0 || (uint32_t)(now - e->occupied_start_ms) >= e->delay_ms)) {
+            e->pending_occupied = false;
+            emit(sm, i, true, now);
+            reports++;
+        }
+
+        if (e->pending_clear && !occupied &&
+            (e->cooldown_ms == 0 || (uint32_t)(now - e->clear_start_ms) >= e->cooldown_ms)) {
+            e->pending_clear = false;
+            emit(sm, i, false, now);
+            reports++;
+        }
+    }
+
+    return reports;
+}
+
+bool occupancy_sm_reported(const occupancy_sm_t *sm, uint8_t idx)
+{
+    if (idx >= sm->count) return false;
+    return sm->ep[idx].reported;
+}
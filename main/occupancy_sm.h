@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Occupancy delay/cooldown state machine.
+ *
+ * Pure C, no ESP-IDF dependencies: time comes from an injected clock and
+ * state changes leave through a report callback, so the same code runs on
+ * the device (sensor_bridge.c) and in the host tests under tools/host_test.
+ *
+ * Per endpoint slot (0 = main EP, 1-10 = zones):
+ *   - Clear -> Occupied is reported once the raw input has stayed occupied
+ *     for delay_ms (0 = immediately on the next tick).
+ *   - Occupied -> Clear is reported once the raw input has stayed clear
+ *     for cooldown_ms (0 = immediately on the next tick).
+ *   - A raw edge in the opposite direction cancels the pending report.
+ *
+ * Edge detection uses the raw input of the previous tick, never the last
+ * reported value.  Using the reported value skipped the cancellation path
+ * when occupancy cleared inside the delay window (no report had fired yet,
+ * so "clear != last reported" was false), leaving pending_occupied stuck
+ * with a stale start time and making the next real detection fire with no
+ * delay at all.
+ *
+ * Times are uint32_t milliseconds; elapsed time is computed by unsigned
+ * subtraction so clock wraparound (~49 days) is harmless.
+ */
+
+#define OCCUPANCY_SM_MAX_EPS  11
+
+/** Returns the current monotonic time in milliseconds. */
+typedef uint32_t (*occupancy_sm_clock_fn_t)(void *ctx);
+
+/** Called when a debounced state must be reported for endpoint slot idx. */
+typedef void (*occupancy_sm_report_fn_t)(uint8_t idx, bool occupied, void *ctx);
+
+typedef struct {
+    bool     raw;                /* sensor state seen on the previous tick */
+    bool     reported;           /* last value passed to the report callback */
+    bool     pending_occupied;
+    bool     pending_clear;
+    uint32_t occupied_start_ms;  /* when the raw Clear -> Occupied edge was seen */
+    uint32_t clear_start_ms;     /* when the raw Occupied -> Clear edge was seen */
+    uint32_t last_report_ms;
+    uint32_t delay_ms;
+    uint32_t cooldown_ms;
+} occupancy_sm_ep_t;
+
+typedef struct {
+    occupancy_sm_ep_t        ep[OCCUPANCY_SM_MAX_EPS];
+    uint8_t                  count;
+    occupancy_sm_clock_fn_t  clock;
+    occupancy_sm_report_fn_t report;
+    void                    *ctx;
+} occupancy_sm_t;
+
+/**
+ * Reset all slots to Clear with no pending reports and zero timing.
+ * count is clamped to OCCUPANCY_SM_MAX_EPS.
+ */
+void occupancy_sm_init(occupancy_sm_t *sm, uint8_t count,
+                       occupancy_sm_clock_fn_t clock,
+                       occupancy_sm_report_fn_t report, void *ctx);
+
+/**
+ * Set delay/cooldown for one slot.  Takes effect on the next tick, including
+ * for a report that is already pending (elapsed time is measured from the
+ * original edge, not from the timing change).
+ */
+void occupancy_sm_set_timing(occupancy_sm_t *sm, uint8_t idx,
+                             uint32_t delay_ms, uint32_t cooldown_ms);
+
+/**
+ * Advance every slot by one poll cycle.  Bit n of raw_bitmap is the current
+ * sensor state of slot n.  The clock is read once per call.
+ *
+ * @return Number of report callbacks fired during this tick.
+ */
+uint8_t occupancy_sm_tick(occupancy_sm_t *sm, uint32_t raw_bitmap);
+
+/** Last reported state of slot idx (false for out-of-range idx). */
+bool occupancy_sm_reported(const occupancy_sm_t *sm, uint8_t idx);
+
+#ifdef __cplusplus
+}
+#endif
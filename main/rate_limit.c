@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+#include "rate_limit.h"
+
+void rate_limit_init(rate_limit_t *rl, uint16_t burst, uint16_t per_min, uint32_t now_ms)
+{
+    if (burst == 0) burst = 1;
+    rl->burst   = burst;
+    rl->per_min = per_min;
+    rl->credit  = (uint32_t)burst * RATE_LIMIT_UNIT;
+    rl->last_ms = now_ms;
+}
+
+static void refill(rate_limit_t *rl, uint32_t now_ms)
+{
+    uint32_t elapsed = now_ms - rl->last_ms;
+    uint32_t cap = (uint32_t)rl->burst * RATE_LIMIT_UNIT;
+    rl->last_ms = now_ms;
+    uint64_t add = (uint64_t)elapsed * rl->per_min;
+    rl->credit = (add >= cap - rl->credit) ? cap : rl->credit + (uint32_t)add;
+}
+
+void rate_limit_set(rate_limit_t *rl, uint16_t burst, uint16_t per_min, uint32_t now_ms)
+{
+    refill(rl, now_ms);
+    if (burst == 0) burst = 1;
+    rl->burst   = burst;
+    rl->per_min = per_min;
+    if (rl->credit > (uint32_t)burst * RATE_LIMIT_UNIT) rl->credit = (uint32_t)burst * RATE_LIMIT_UNIT;
+}
+
+bool rate_limit_take(rate_limit_t *rl, uint32_t now_ms)
+{
+    return rate_limit_take_above(rl, 0, now_ms);
+}
+
+bool rate_limit_take_above(rate_limit_t *rl, uint16_t reserve, uint32_t now_ms)
+{
+    if (rl->per_min == 0) return true;
+    refill(rl, now_ms);
+    if (rl->credit < ((uint32_t)reserve + 1) * RATE_LIMIT_UNIT) return false;
+    rl->credit -= RATE_LIMIT_UNIT;
+    return true;
+}
+
+uint16_t rate_limit_tokens(rate_limit_t *rl, uint32_t now_ms)
+{
+    if (rl->per_min == 0) return rl->burst;
+    refill(rl, now_ms);
+    return (uint16_t)(rl->credit / RATE_LIMIT_UNIT);
+}
+
+uint32_t rate_limit_wait_ms(rate_limit_t *rl, uint32_t now_ms)
+{
+    if (rl->per_min == 0) return 0;
+    refill(rl, now_ms);
+    if (rl->credit >= RATE_LIMIT_UNIT) return 0;
+    return (RATE_LIMIT_UNIT - rl->credit + rl->per_min - 1) / rl->per_min;
+}
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Token bucket for outgoing report traffic.
+ *
+ * The bucket holds up to `burst` tokens and refills at `per_min` tokens a
+ * minute; one report costs one token.  per_min == 0 disables limiting.
+ * Credit is kept in 1/60000 token units, so refilling at per_min tokens a
+ * minute adds exactly per_min units per millisecond with no rounding loss.
+ */
+
+#define RATE_LIMIT_BURST_DEFAULT     20
+#define RATE_LIMIT_PER_MIN_DEFAULT   600     /* 10 reports/s sustained */
+#define RATE_LIMIT_BURST_MAX         100
+#define RATE_LIMIT_PER_MIN_MAX       3000
+#define RATE_LIMIT_UNIT              60000u  /* credit per token (ms per minute) */
+
+typedef struct {
+    uint16_t burst;
+    uint16_t per_min;
+    uint32_t credit;         /* tokens x RATE_LIMIT_UNIT */
+    uint32_t last_ms;
+} rate_limit_t;
+
+/** Start with a full bucket. */
+void rate_limit_init(rate_limit_t *rl, uint16_t burst, uint16_t per_min, uint32_t now_ms);
+
+/** Change burst / rate, keeping the tokens already earned (clamped to burst). */
+void rate_limit_set(rate_limit_t *rl, uint16_t burst, uint16_t per_min, uint32_t now_ms);
+
+/** Take one token.  Returns false (nothing taken) if the bucket is empty. */
+bool rate_limit_take(rate_limit_t *rl, uint32_t now_ms);
+
+/** Take one token only if more than `reserve` are left, so the last `reserve`
+ *  tokens stay available to rate_limit_take() callers. */
+bool rate_limit_take_above(rate_limit_t *rl, uint16_t reserve, uint32_t now_ms);
+
+/** Whole tokens available at now_ms (burst when limiting is disabled). */
+uint16_t rate_limit_tokens(rate_limit_t *rl, uint32_t now_ms);
+
+/** Milliseconds until one token is available (0 if one is available now). */
+uint32_t rate_limit_wait_ms(rate_limit_t *rl, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
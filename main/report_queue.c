@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "report_queue.h"
+
+void rq_init(rq_t *q, uint8_t max_in_flight)
+{
+    memset(q, 0, sizeof(*q));
+    memset(q->head, RQ_NONE, sizeof(q->head));
+    memset(q->tail, RQ_NONE, sizeof(q->tail));
+    q->max_in_flight = max_in_flight ? max_in_flight : 1;
+    q->rto_max_ms    = RQ_RTO_MAX_MS;
+}
+
+static void push_back(rq_t *q, uint8_t i)
+{
+    rq_slot_t *s = &q->slot[i];
+    s->state = RQ_QUEUED;
+    s->next  = RQ_NONE;
+    if (q->tail[s->prio] == RQ_NONE) q->head[s->prio] = i;
+    else q->slot[q->tail[s->prio]].next = i;
+    q->tail[s->prio] = i;
+}
+
+static void push_front(rq_t *q, uint8_t i)
+{
+    rq_slot_t *s = &q->slot[i];
+    s->state = RQ_QUEUED;
+    s->next  = q->head[s->prio];
+    q->head[s->prio] = i;
+    if (q->tail[s->prio] == RQ_NONE) q->tail[s->prio] = i;
+}
+
+/* Unlink a queued slot; FIFOs hold at most RQ_EP_COUNT entries */
+static void unlink_slot(rq_t *q, uint8_t i)
+{
+    uint8_t p = q->slot[i].prio, prev = RQ_NONE;
+    for (uint8_t k = q->head[p]; k != RQ_NONE; prev = k, k = q->slot[k].next) {
+        if (k != i) continue;
+        if (prev == RQ_NONE) q->head[p] = q->slot[k].next;
+        else q->slot[prev].next = q->slot[k].next;
+        if (q->tail[p] == i) q->tail[p] = prev;
+        return;
+    }
+}
+
+void rq_enqueue(rq_t *q, uint8_t ep_idx, uint8_t value, rq_prio_t prio)
+{
+    if (ep_idx >= RQ_EP_COUNT || prio >= RQ_PRIO_COUNT) return;
+    rq_slot_t *s = &q->slot[ep_idx];
+    q->stats.enqueued++;
+
+    switch (s->state) {
+    case RQ_IDLE:
+        s->value    = value;
+        s->prio     = (uint8_t)prio;
+        s->attempts = 0;
+        s->pending_supersede = 0;
+        push_back(q, ep_idx);
+        break;
+    case RQ_QUEUED:
+        q->stats.coalesced++;
+        s->value    = value;
+        s->attempts = 0;
+        if (prio > s->prio) {
+            unlink_slot(q, ep_idx);
+            s->prio = (uint8_t)prio;
+            push_back(q, ep_idx);
+        }
+        break;
+    case RQ_BACKOFF:
+        q->stats.coalesced++;
+        s->value    = value;
+        s->attempts = 0;
+        if (prio > s->prio) s->prio = (uint8_t)prio;
+        break;
+    case RQ_IN_FLIGHT:
+        if (s->pending_supersede) {
+            q->stats.coalesced++;
+            if (prio > s->next_prio) s->next_prio = (uint8_t)prio;
+        } else {
+            s->next_prio = (uint8_t)prio;
+        }
+        s->pending_supersede = 1;
+        s->next_value        = value;
+        break;
+    }
+}
+
+uint8_t rq_pop(rq_t *q, uint32_t now_ms)
+{
+    if (q->in_flight >= q->max_in_flight) return RQ_NONE;
+
+    for (int p = RQ_PRIO_COUNT - 1; p >= 0; p--) {
+        uint8_t i = q->head[p];
+        if (i == RQ_NONE) continue;
+        rq_slot_t *s = &q->slot[i];
+        q->head[p] = s->next;
+        if (q->head[p] == RQ_NONE) q->tail[p] = RQ_NONE;
+        s->state   = RQ_IN_FLIGHT;
+        s->sent_ms = now_ms;
+        q->in_flight++;
+        q->stats.sent++;
+        return i;
+    }
+    return RQ_NONE;
+}
+
+static void rtt_sample(rq_t *q, uint32_t r)
+{
+    if (q->srtt_x8 == 0) {
+        q->srtt_x8   = (r ? r : 1) << 3;
+        q->rttvar_x4 = r << 1;
+        return;
+    }
+    int32_t delta = (int32_t)r - (int32_t)(q->srtt_x8 >> 3);
+    q->srtt_x8 = (uint32_t)((int32_t)q->srtt_x8 + delta);
+    if (q->srtt_x8 == 0) q->srtt_x8 = 1;
+    if (delta < 0) delta = -delta;
+    q->rttvar_x4 = (uint32_t)((int32_t)q->rttvar_x4 + delta - (int32_t)(q->rttvar_x4 >> 2));
+}
+
+uint32_t rq_srtt_ms(const rq_t *q)
+{
+    return q->srtt_x8 >> 3;
+}
+
+void rq_set_rto_max(rq_t *q, uint32_t ms)
+{
+    q->rto_max_ms = ms < RQ_RTO_MIN_MS ? RQ_RTO_MIN_MS : ms;
+}
+
+uint32_t rq_rto_ms(const rq_t *q)
+{
+    uint32_t rto = RQ_RTO_INIT_MS;
+    if (q->srtt_x8 != 0) {
+        rto = (q->srtt_x8 >> 3) + q->rttvar_x4;
+        if (rto < RQ_RTO_MIN_MS) rto = RQ_RTO_MIN_MS;
+    }
+    if (rto > q->rto_max_ms) rto = q->rto_max_ms;
+    return rto;
+}
+
+/* Slot finished its send: re-queue a superseding value or go idle */
+static void release(rq_t *q, uint8_t i)
+{
+    rq_slot_t *s = &q->slot[i];
+    if (s->pending_supersede) {
+        s->value    = s->next_value;
+        s->prio     = s->next_prio;
+        s->attempts = 0;
+        s->pending_supersede = 0;
+        push_back(q, i);
+    } else {
+        s->state = RQ_IDLE;
+    }
+}
+
+rq_result_t rq_on_status(rq_t *q, uint8_t ep_idx, bool ok, uint32_t now_ms,
+                         uint32_t *retry_ms)
+{
+    if (ep_idx >= RQ_EP_COUNT) return RQ_STALE;
+    rq_slot_t *s = &q->slot[ep_idx];
+    if (s->state != RQ_IN_FLIGHT) return RQ_STALE;
+    q->in_flight--;
+
+    if (ok) {
+        q->stats.acked++;
+        rtt_sample(q, now_ms - s->sent_ms);
+        release(q, ep_idx);
+        return RQ_DONE;
+    }
+
+    /* A newer value is already waiting: retry with that instead */
+    if (s->pending_supersede) {
+        s->value = s->next_value;
+        if (s->next_prio > s->prio) s->prio = s->next_prio;
+        s->pending_supersede = 0;
+    }
+
+    s->attempts++;
+    if (s->attempts > RQ_MAX_RETRIES) {
+        q->stats.exhausted++;
+        release(q, ep_idx);
+        return RQ_EXHAUSTED;
+    }
+
+    q->stats.retries++;
+    uint32_t delay = rq_rto_ms(q) << (s->attempts - 1);
+    if (delay > 2 * q->rto_max_ms) delay = 2 * q->rto_max_ms;
+    *retry_ms = delay;
+    s->state = RQ_BACKOFF;
+    return RQ_RETRY;
+}
+
+bool rq_expire(rq_t *q, uint8_t ep_idx)
+{
+    if (ep_idx >= RQ_EP_COUNT || q->slot[ep_idx].state != RQ_IN_FLIGHT) return false;
+    q->in_flight--;
+    q->stats.expired++;
+    release(q, ep_idx);
+    return true;
+}
+
+void rq_retry_due(rq_t *q, uint8_t ep_idx)
+{
+    if (ep_idx >= RQ_EP_COUNT || q->slot[ep_idx].state != RQ_BACKOFF) return;
+    push_front(q, ep_idx);
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Occupancy report retry queue used by coordinator_fallback.c.
+ *
+ * One slot per endpoint (index = endpoint - 1), so lookup is O(1) and a new
+ * report for an endpoint always coalesces into its slot instead of competing
+ * for capacity: nothing is ever dropped for lack of room.  Slots waiting to
+ * be sent sit on one FIFO per priority class and at most max_in_flight
+ * reports are outstanding at once, so a keep-alive burst is paced by ACKs
+ * and an occupancy transition queued behind it goes out next.
+ *
+ * Retry backoff follows the measured ACK latency (smoothed RTT + 4 x
+ * variance, as in TCP): RQ_RTO_INIT_MS until the first ACK, then RTO,
+ * 2 x RTO, 4 x RTO for attempts 1-3.  RTO is capped at rto_max_ms
+ * (RQ_RTO_MAX_MS unless rq_set_rto_max() changes it) and each backoff at
+ * twice that.
+ */
+
+#define RQ_EP_COUNT          11
+#define RQ_MAX_RETRIES       3
+#define RQ_MAX_IN_FLIGHT     2
+#define RQ_RTO_INIT_MS       250    /* first retry before any ACK is measured */
+#define RQ_RTO_MIN_MS        100
+#define RQ_RTO_MAX_MS        2000   /* default rto_max_ms */
+#define RQ_BACKOFF_MAX_MS    (2 * RQ_RTO_MAX_MS)   /* backoff cap at the default rto_max_ms */
+#define RQ_STATUS_GUARD_MS   15000  /* in-flight slot released if no send status arrives */
+
+#define RQ_NONE              0xFF
+
+typedef enum {
+    RQ_PRIO_DIAG = 0,        /* lowest: diagnostic refreshes */
+    RQ_PRIO_KEEPALIVE,       /* periodic state refresh */
+    RQ_PRIO_TRANSITION,      /* occupancy changed */
+    RQ_PRIO_COUNT,
+} rq_prio_t;
+
+typedef enum {
+    RQ_IDLE = 0,
+    RQ_QUEUED,               /* on a priority FIFO, waiting for an in-flight slot */
+    RQ_BACKOFF,              /* failed, waiting for the retry alarm */
+    RQ_IN_FLIGHT,            /* sent, waiting for send status */
+} rq_state_t;
+
+typedef enum {
+    RQ_STALE = 0,            /* no report in flight for this endpoint */
+    RQ_DONE,                 /* ACKed */
+    RQ_RETRY,                /* failed, retry alarm needed after *retry_ms */
+    RQ_EXHAUSTED,            /* failed RQ_MAX_RETRIES + 1 times, slot released */
+} rq_result_t;
+
+typedef struct {
+    uint8_t  state;
+    uint8_t  prio;
+    uint8_t  value;          /* occupancy value being reported */
+    uint8_t  attempts;       /* retries fired so far (0 before first send) */
+    uint8_t  next_value;     /* supersede value pending in-flight completion */
+    uint8_t  next_prio;
+    uint8_t  pending_supersede;
+    uint8_t  next;           /* FIFO link (RQ_NONE = end) */
+    uint32_t sent_ms;        /* time of the send in flight */
+} rq_slot_t;
+
+typedef struct {
+    uint32_t enqueued;
+    uint32_t coalesced;      /* merged into a slot that was already queued */
+    uint32_t sent;
+    uint32_t acked;
+    uint32_t retries;
+    uint32_t exhausted;
+    uint32_t expired;        /* released by rq_expire() */
+} rq_stats_t;
+
+typedef struct {
+    rq_slot_t slot[RQ_EP_COUNT];
+    uint8_t   head[RQ_PRIO_COUNT];
+    uint8_t   tail[RQ_PRIO_COUNT];
+    uint8_t   in_flight;
+    uint8_t   max_in_flight;
+    uint32_t  srtt_x8;       /* smoothed ACK latency, ms x 8 (0 = no sample yet) */
+    uint32_t  rttvar_x4;     /* latency variance, ms x 4 */
+    uint32_t  rto_max_ms;    /* RTO ceiling; backoff is capped at twice this */
+    rq_stats_t stats;
+} rq_t;
+
+void rq_init(rq_t *q, uint8_t max_in_flight);
+
+/**
+ * Queue value for ep_idx at prio.  A queued or backing-off slot takes the
+ * new value (retry count reset) and the higher of the two priorities; an
+ * in-flight slot remembers it and re-queues once the send completes.
+ */
+void rq_enqueue(rq_t *q, uint8_t ep_idx, uint8_t value, rq_prio_t prio);
+
+/**
+ * Next slot to send, highest priority first, FIFO within a class.  Marks it
+ * in flight at now_ms.  Returns RQ_NONE when nothing is queued or
+ * max_in_flight reports are already outstanding.
+ */
+uint8_t rq_pop(rq_t *q, uint32_t now_ms);
+
+/**
+ * Send status for ep_idx.  An ACK feeds the latency estimator; a failure
+ * moves the slot to RQ_BACKOFF (taking any superseding value) and sets
+ * *retry_ms, after which the caller calls rq_retry_due().  On
+ * RQ_EXHAUSTED the slot is idle again.
+ */
+rq_result_t rq_on_status(rq_t *q, uint8_t ep_idx, bool ok, uint32_t now_ms,
+                         uint32_t *retry_ms);
+
+/**
+ * No send status arrived for ep_idx within RQ_STATUS_GUARD_MS (e.g. the
+ * report had no coordinator binding): release the in-flight slot without
+ * counting a failure so it cannot hold up the queue.  Returns true if the
+ * slot was still in flight.
+ */
+bool rq_expire(rq_t *q, uint8_t ep_idx);
+
+/** Retry alarm for ep_idx fired: put the slot back at the front of its class. */
+void rq_retry_due(rq_t *q, uint8_t ep_idx);
+
+/** Set the RTO ceiling (at least RQ_RTO_MIN_MS). */
+void rq_set_rto_max(rq_t *q, uint32_t ms);
+
+/** Current retry timeout (before the per-attempt doubling), ms. */
+uint32_t rq_rto_ms(const rq_t *q);
+
+/** Smoothed ACK latency in ms, 0 before the first ACK. */
+uint32_t rq_srtt_ms(const rq_t *q);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "sdkconfig.h"
+
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
@@ -11,21 +13,30 @@
 #include "freertos/task.h"
 
 #include "esp_zigbee_core.h"
+#include "aps/esp_zigbee_aps.h"
 
 /* Project */
+#include "coord_report.h"
 #include "coordinator_fallback.h"
 #include "ld2450.h"
+#include "ld2450_cmd_worker.h"
 #include "ld2450_zone_csv.h"
 #include "nvs_config.h"
+#include "occ_event_log.h"
+#include "occupancy_sm.h"
 #include "sensor_bridge.h"
 #include "zigbee_defs.h"
+#include "zcl_batch.h"
 #include "zigbee_signal_handlers.h"
 #include "crash_diag.h"
 
 static const char *TAG = "sensor_bridge";
 
-/* Set by sensor_bridge_mark_config_dirty(); cleared after push_config_attrs() */
-static volatile bool s_config_dirty = false;
+/* SB_DIRTY_* bits set by sensor_bridge_mark_config_dirty_mask() from any task;
+ * taken and cleared by sensor_poll_cb before push_config_attrs() */
+static uint64_t s_config_dirty = 0;
+static portMUX_TYPE s_dirty_lock = portMUX_INITIALIZER_UNLOCKED;
+static sensor_bridge_push_stats_t s_push_stats;
 
 /* Sensor poll interval (ms) - LD2450 outputs at 10Hz (100ms) */
 #define SENSOR_POLL_INTERVAL_MS  100
@@ -33,103 +44,120 @@ static volatile bool s_config_dirty = false;
 /* Reporting intervals (seconds) */
 #define REPORT_MIN_INTERVAL   0
 #define REPORT_MAX_INTERVAL   300
+#define ZONE_OCC_MAX_INTERVAL 30     /* zone EP Occupancy, as the Z2M converter configures it */
 
 /* Scheduler alarm param */
 #define ALARM_PARAM_POLL    0
 
 /* ---- State tracking for change detection ---- */
-static bool s_last_occupied = false;
-static bool s_last_zone_occ[10] = {false};
 static uint8_t s_last_target_count = 0;
-static char s_last_coords[64] = {0};
-
-/* ---- Cooldown tracking (per endpoint: 0=main, 1-10=zones) ---- */
-static uint32_t s_last_report_time[11] = {0};
-static bool s_pending_clear[11] = {false};      /* tracking pending Clear reports */
-static uint32_t s_clear_start_time[11] = {0};  /* when Clear was first detected */
-
-/* ---- Occupancy delay tracking (per endpoint: 0=main, 1-10=zones) ---- */
-static bool s_pending_occupied[11] = {false};      /* tracking pending Occupied reports */
-static int64_t s_occupied_start_time[11] = {0};   /* when Occupied was first detected (microseconds) */
+static coord_report_gate_t s_coord_gate;   /* dead-band state for ZB_ATTR_TARGET_DATA */
+static uint8_t s_coord_mode;               /* COORD_PUBLISH_* used on the last poll */
 static uint32_t s_last_min_free_heap = 0;
-
-/* ---- Raw state tracking (transition detection, independent of reported state) ----
- *
- * s_last_occupied / s_last_zone_occ track the last *reported* state and must
- * only be updated when an attribute report is actually sent.  Using them for
- * transition detection causes the delay-cancellation path to be skipped when
- * occupancy clears during the delay window (before a report fires), because
- * "current_clear != last_reported_clear" evaluates false.  This leaves
- * s_pending_occupied stuck true with a stale timestamp, causing the next real
- * detection to fire immediately (no delay) — observed as Zone 1 reporting
- * before Zone 2 and general light-response sluggishness across rooms.
- *
- * s_raw_occupied / s_raw_zone_occ track the actual sensor state every poll
- * cycle and are the correct variables for edge-detection.
- */
-static bool s_raw_occupied = false;
-static bool s_raw_zone_occ[10] = {false};
+static uint32_t s_last_throttled_occ = 0;
+static uint32_t s_last_throttled_coords = 0;
+static uint8_t s_last_cmd_state = LD2450_CMD_STATE_IDLE;
+
+/* ---- Occupancy delay/cooldown (slot 0=main EP, 1-10=zones) ----
+ * Edge detection, pending reports and timing live in occupancy_sm.c so the
+ * logic can be exercised off-device (tools/host_test/test_occupancy_sm.c). */
+static occupancy_sm_t s_occ_sm;
+static uint32_t s_occ_timing_gen = 0;  /* config generation applied to s_occ_sm */
+
+/* ---- Config as of this poll ----
+ * Copied whole with nvs_config_read() when the generation moves, so a poll
+ * never mixes fields from before and after a multi-field web/CLI change. */
+static nvs_config_t s_cfg;
+static uint32_t s_cfg_gen = 0;
+
+/* ---- Zone bitmap (EP1 0x0002): bit n = zone n+1 reported occupied ----
+ * One attribute covers all zones, so a multi-zone transition is one ZBoss
+ * report instead of one Occupancy report per zone EP.  When zone_ep_reports
+ * is off, the zone EP attributes are still written but no per-change report
+ * is sent for them; the bitmap is the prompt source of zone occupancy. */
+static uint16_t s_zone_bitmap = 0;
+static uint16_t s_zone_bitmap_written = 0;  /* value last written to the ZCL table */
+static bool s_zone_ep_reports = true;
+
+/* ---- Occupancy event log (EP1 0x0006) ----
+ * Every reported transition, timestamped on the device, so the coordinator
+ * can rebuild exact timing when Occupancy reports are delayed or retried.
+ * Written to the ZCL table once per tick, after all edges are logged. */
+static occ_event_log_t s_occ_log;
+static bool s_occ_log_dirty = false;
+
+/* ---- EP1 sensor attribute reports (count, target data, zone bitmap, event
+ * log, min free heap) ----
+ * With CONFIG_LD2450_ZCL_REPORT_BATCHING every sensor attr changed in one
+ * poll goes out as one Report Attributes command, split only where the
+ * records exceed an unfragmented frame.  ZBoss auto-reporting for these
+ * attrs is stopped so nothing is sent twice.  Without it ZBoss reports each
+ * attr in its own frame; the counters are kept either way for comparison. */
+static zcl_batch_t s_batch;
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+static uint8_t s_batch_seq = 0;
+static uint32_t s_batch_last_ms = 0;        /* last batched send (keepalive) */
+static uint32_t s_batch_ka_ms = 0;          /* quiet time before the next keepalive */
+#endif
+static sensor_bridge_report_stats_t s_report_stats;
 
 /* ================================================================== */
 /*  Sensor bridge: poll LD2450 and update Zigbee attributes            */
 /* ================================================================== */
 
-static void format_coords_string(const ld2450_state_t *state, char *buf, size_t buf_size)
-{
-    /* Format: "x1,y1;x2,y2;x3,y3" with ZCL char-string length prefix */
-    char tmp[48];
-    int pos = 0;
-
-    for (int i = 0; i < 3; i++) {
-        if (state->targets[i].present) {
-            if (pos > 0) {
-                pos += snprintf(tmp + pos, sizeof(tmp) - pos, ";");
-            }
-            pos += snprintf(tmp + pos, sizeof(tmp) - pos, "%d,%d",
-                          (int)state->targets[i].x_mm, (int)state->targets[i].y_mm);
-        }
-    }
-
-    if (pos == 0) {
-        buf[0] = 0;  /* ZCL empty string */
-        buf[1] = 0;
-    } else {
-        buf[0] = (char)pos;  /* ZCL length prefix */
-        memcpy(buf + 1, tmp, pos);
-        buf[pos + 1] = 0;
-    }
-}
-
-/* Push all writable config attributes into the ZCL attribute table.
- * Called from sensor_poll_cb (Zigbee task context) when s_config_dirty is set. */
-static void push_config_attrs(void)
+/* Push dirty config attributes into the ZCL attribute table.
+ * Called from sensor_poll_cb (Zigbee task context) with the SB_DIRTY_* bits
+ * taken since the last push; clean attributes are left alone. */
+static void push_config_attrs(uint64_t dirty)
 {
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
+    /* ZBoss copies each value into its own attribute storage */
+    const nvs_config_t *cfg = &s_cfg;
+    uint32_t visited = 0;   /* attrs a full push would write */
+    uint32_t written = 0;
 
 #define SET_ATTR(ep, cluster, attr, val) \
     esp_zb_zcl_set_attribute_val((ep), (cluster), \
-        ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, (attr), (val), false)
+        ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, (attr), (void *)(val), false)
+#define PUSH_ATTR(bit, ep, attr, val) \
+    do { \
+        visited++; \
+        if (dirty & (bit)) { \
+            SET_ATTR((ep), ZB_CLUSTER_LD2450_CONFIG, (attr), (val)); \
+            written++; \
+        } \
+    } while (0)
 
     /* ---- Sensor config ---- */
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_MAX_DISTANCE,      &cfg.max_distance_mm);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_ANGLE_LEFT,        &cfg.angle_left_deg);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_ANGLE_RIGHT,       &cfg.angle_right_deg);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_TRACKING_MODE,     &cfg.tracking_mode);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_COORD_PUBLISHING,  &cfg.publish_coords);
+    PUSH_ATTR(SB_DIRTY_MAX_DISTANCE,     ZB_EP_MAIN, ZB_ATTR_MAX_DISTANCE,     &cfg->max_distance_mm);
+    PUSH_ATTR(SB_DIRTY_ANGLE_LEFT,       ZB_EP_MAIN, ZB_ATTR_ANGLE_LEFT,       &cfg->angle_left_deg);
+    PUSH_ATTR(SB_DIRTY_ANGLE_RIGHT,      ZB_EP_MAIN, ZB_ATTR_ANGLE_RIGHT,      &cfg->angle_right_deg);
+    PUSH_ATTR(SB_DIRTY_TRACKING_MODE,    ZB_EP_MAIN, ZB_ATTR_TRACKING_MODE,    &cfg->tracking_mode);
+    PUSH_ATTR(SB_DIRTY_HW_FILTER_MODE,   ZB_EP_MAIN, ZB_ATTR_HW_FILTER_MODE,   &cfg->hw_filter_mode);
+    PUSH_ATTR(SB_DIRTY_COORD_PUBLISHING, ZB_EP_MAIN, ZB_ATTR_COORD_PUBLISHING, &cfg->publish_coords);
+    PUSH_ATTR(SB_DIRTY_COORD_DEADBAND,   ZB_EP_MAIN, ZB_ATTR_COORD_DEADBAND,   &cfg->coord_deadband_mm);
+    PUSH_ATTR(SB_DIRTY_COORD_MIN_INTERVAL, ZB_EP_MAIN, ZB_ATTR_COORD_MIN_INTERVAL, &cfg->coord_min_interval_ms);
 
     /* ---- Main EP occupancy timing ---- */
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_OCCUPANCY_COOLDOWN, &cfg.occupancy_cooldown_sec[0]);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_OCCUPANCY_DELAY,    &cfg.occupancy_delay_ms[0]);
+    PUSH_ATTR(SB_DIRTY_OCC_COOLDOWN(0), ZB_EP_MAIN, ZB_ATTR_OCCUPANCY_COOLDOWN, &cfg->occupancy_cooldown_sec[0]);
+    PUSH_ATTR(SB_DIRTY_OCC_DELAY(0),    ZB_EP_MAIN, ZB_ATTR_OCCUPANCY_DELAY,    &cfg->occupancy_delay_ms[0]);
 
     /* ---- Coordinator fallback ---- */
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_FALLBACK_MODE,      &cfg.fallback_mode);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_FALLBACK_ENABLE,    &cfg.fallback_enable);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_FALLBACK_COOLDOWN,  &cfg.fallback_cooldown_sec[0]);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_HARD_TIMEOUT_SEC,   &cfg.hard_timeout_sec);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_ACK_TIMEOUT_MS,     &cfg.ack_timeout_ms);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_HEARTBEAT_ENABLE,   &cfg.heartbeat_enable);
-    SET_ATTR(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, ZB_ATTR_HEARTBEAT_INTERVAL, &cfg.heartbeat_interval_sec);
+    PUSH_ATTR(SB_DIRTY_FALLBACK_MODE,      ZB_EP_MAIN, ZB_ATTR_FALLBACK_MODE,      &cfg->fallback_mode);
+    PUSH_ATTR(SB_DIRTY_FALLBACK_ENABLE,    ZB_EP_MAIN, ZB_ATTR_FALLBACK_ENABLE,    &cfg->fallback_enable);
+    PUSH_ATTR(SB_DIRTY_FALLBACK_COOLDOWN,  ZB_EP_MAIN, ZB_ATTR_FALLBACK_COOLDOWN,  &cfg->fallback_cooldown_sec[0]);
+    PUSH_ATTR(SB_DIRTY_HARD_TIMEOUT,       ZB_EP_MAIN, ZB_ATTR_HARD_TIMEOUT_SEC,   &cfg->hard_timeout_sec);
+    PUSH_ATTR(SB_DIRTY_ACK_TIMEOUT,        ZB_EP_MAIN, ZB_ATTR_ACK_TIMEOUT_MS,     &cfg->ack_timeout_ms);
+    PUSH_ATTR(SB_DIRTY_HEARTBEAT_ENABLE,   ZB_EP_MAIN, ZB_ATTR_HEARTBEAT_ENABLE,   &cfg->heartbeat_enable);
+    PUSH_ATTR(SB_DIRTY_HEARTBEAT_INTERVAL, ZB_EP_MAIN, ZB_ATTR_HEARTBEAT_INTERVAL, &cfg->heartbeat_interval_sec);
+    PUSH_ATTR(SB_DIRTY_ZONE_EP_REPORTS,    ZB_EP_MAIN, ZB_ATTR_ZONE_EP_REPORTS,    &cfg->zone_ep_reports);
+    for (int n = 0; n < 11; n++) {
+        PUSH_ATTR(SB_DIRTY_FALLBACK_GROUP, ZB_EP_MAIN, ZB_ATTR_FALLBACK_GROUP_BASE + n,
+                  &cfg->fallback_group[n]);
+    }
+
+    /* ---- Report rate limiter ---- */
+    PUSH_ATTR(SB_DIRTY_RATE_LIMIT,         ZB_EP_MAIN, ZB_ATTR_RATE_BURST,         &cfg->rate_burst);
+    PUSH_ATTR(SB_DIRTY_RATE_LIMIT,         ZB_EP_MAIN, ZB_ATTR_RATE_SUSTAINED,     &cfg->rate_per_min);
 
     /* ---- Zone config (each zone on its own EP) ---- */
     /* With each zone on its own cluster instance, ZBoss handles CHAR_STRING reports
@@ -139,33 +167,229 @@ static void push_config_attrs(void)
 
     for (int n = 0; n < ZB_EP_ZONE_COUNT; n++) {
         uint8_t ep = ZB_EP_ZONE(n);
-        SET_ATTR(ep, ZB_CLUSTER_LD2450_CONFIG,
-                 ZB_ATTR_ZONE_VERTEX_COUNT(n), &cfg.zones[n].vertex_count);
 
-        SET_ATTR(ep, ZB_CLUSTER_LD2450_CONFIG,
-                 ZB_ATTR_ZONE_COOLDOWN(n), &cfg.occupancy_cooldown_sec[n + 1]);
+        PUSH_ATTR(SB_DIRTY_OCC_COOLDOWN(n + 1), ep,
+                  ZB_ATTR_ZONE_COOLDOWN(n), &cfg->occupancy_cooldown_sec[n + 1]);
+        PUSH_ATTR(SB_DIRTY_OCC_DELAY(n + 1), ep,
+                  ZB_ATTR_ZONE_DELAY(n), &cfg->occupancy_delay_ms[n + 1]);
+
+        visited += 2;
+        if (!(dirty & SB_DIRTY_ZONE_GEOMETRY(n))) continue;
 
         SET_ATTR(ep, ZB_CLUSTER_LD2450_CONFIG,
-                 ZB_ATTR_ZONE_DELAY(n), &cfg.occupancy_delay_ms[n + 1]);
+                 ZB_ATTR_ZONE_VERTEX_COUNT(n), &cfg->zones[n].vertex_count);
 
         /* Coords: ZCL CHAR_STRING = length byte + CSV payload.
          * false flag: ZBoss copies value into its own attr storage — local buffer safe. */
-        zone_to_csv(&cfg.zones[n], csv, sizeof(csv));
+        zone_to_csv(&cfg->zones[n], csv, sizeof(csv));
         size_t len = strlen(csv);
         zb_str[0] = (char)len;
         memcpy(zb_str + 1, csv, len + 1);
         SET_ATTR(ep, ZB_CLUSTER_LD2450_CONFIG,
                  ZB_ATTR_ZONE_COORDS(n), zb_str);
+        written += 2;
     }
 
+#undef PUSH_ATTR
 #undef SET_ATTR
 
-    ESP_LOGD(TAG, "Config attrs pushed to ZCL table");
+    s_push_stats.push_cycles++;
+    s_push_stats.attrs_written += written;
+    s_push_stats.attrs_skipped += visited - written;
+    ESP_LOGD(TAG, "Config attrs pushed to ZCL table: %u/%u (dirty=0x%llx)",
+             (unsigned)written, (unsigned)visited, (unsigned long long)dirty);
+}
+
+static uint32_t occ_clock_ms(void *ctx)
+{
+    (void)ctx;
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/* Write one EP's Occupancy attribute (the report is sent separately) */
+static void write_ep_occupancy(uint8_t ep, bool occupied)
+{
+    uint8_t val = occupied ? 1 : 0;
+    esp_zb_zcl_set_attribute_val(ep,
+        ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
+        ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+        ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
+        &val, false);
+}
+
+/* occupancy_sm report callback: update the ZCL attribute and hand the change
+ * to coordinator_fallback for ACK-tracked reporting.  Zone changes also land
+ * in s_zone_bitmap, which sensor_poll_cb writes once per tick. */
+static void occ_report_cb(uint8_t idx, bool occupied, void *ctx)
+{
+    (void)ctx;
+    uint8_t ep = (idx == 0) ? ZB_EP_MAIN : ZB_EP_ZONE(idx - 1);
+
+    occ_event_log_add(&s_occ_log, ep, occupied, occ_clock_ms(NULL));
+    s_occ_log_dirty = true;
+
+    if (idx > 0) {
+        uint16_t bit = (uint16_t)(1u << (idx - 1));
+        s_zone_bitmap = occupied ? (s_zone_bitmap | bit) : (s_zone_bitmap & ~bit);
+    }
+
+    /* The attribute is always kept current, so reads and ZBoss periodic
+     * reports never carry a stale value; zone_ep_reports gates the explicit
+     * per-change report (ZBoss's own is held off by
+     * configure_zone_occupancy_reporting).  Fallback still tracks every EP
+     * so bindings fire in fallback mode. */
+    write_ep_occupancy(ep, occupied);
+    coordinator_fallback_on_occupancy_change(ep, occupied);
+    if (idx == 0 || s_zone_ep_reports) {
+        coordinator_fallback_report_occupancy(ep, occupied);
+    }
+}
+
+/* Zone EP Occupancy reporting in ZBoss's table.  With per_change off the
+ * minimum interval is raised to the maximum, so ZBoss sends only the periodic
+ * report and an attribute write never triggers a frame of its own; with it on
+ * the converter's report-on-change setting is restored.  A later Configure
+ * from the coordinator replaces these entries until the next boot or toggle. */
+static void configure_zone_occupancy_reporting(bool per_change)
+{
+    for (uint8_t n = 0; n < ZB_EP_ZONE_COUNT; n++) {
+        esp_zb_zcl_reporting_info_t rpt = {0};
+        rpt.direction    = ESP_ZB_ZCL_REPORT_DIRECTION_SEND;
+        rpt.ep           = ZB_EP_ZONE(n);
+        rpt.cluster_id   = ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING;
+        rpt.cluster_role = ESP_ZB_ZCL_CLUSTER_SERVER_ROLE;
+        rpt.attr_id      = ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID;
+        rpt.u.send_info.min_interval     = per_change ? REPORT_MIN_INTERVAL : ZONE_OCC_MAX_INTERVAL;
+        rpt.u.send_info.max_interval     = ZONE_OCC_MAX_INTERVAL;
+        rpt.u.send_info.def_min_interval = rpt.u.send_info.min_interval;
+        rpt.u.send_info.def_max_interval = ZONE_OCC_MAX_INTERVAL;
+        rpt.u.send_info.delta.u32        = 0;
+        rpt.dst.profile_id = ESP_ZB_AF_HA_PROFILE_ID;
+        rpt.manuf_code     = ESP_ZB_ZCL_ATTR_NON_MANUFACTURER_SPECIFIC;
+        esp_zb_zcl_update_reporting_info(&rpt);
+    }
+}
+
+/* No explicit zone EP reports went out while zone_ep_reports was off: send
+ * the current debounced state so the coordinator catches up at once. */
+static void resync_zone_eps(void)
+{
+    for (uint8_t n = 0; n < ZB_EP_ZONE_COUNT; n++) {
+        coordinator_fallback_report_occupancy(ZB_EP_ZONE(n),
+                                              occupancy_sm_reported(&s_occ_sm, n + 1));
+    }
+}
+
+void sensor_bridge_mark_config_dirty_mask(uint64_t mask)
+{
+    portENTER_CRITICAL(&s_dirty_lock);
+    s_config_dirty |= mask & SB_DIRTY_ALL;
+    portEXIT_CRITICAL(&s_dirty_lock);
 }
 
 void sensor_bridge_mark_config_dirty(void)
 {
-    s_config_dirty = true;
+    sensor_bridge_mark_config_dirty_mask(SB_DIRTY_ALL);
+}
+
+void sensor_bridge_get_push_stats(sensor_bridge_push_stats_t *out)
+{
+    if (out) *out = s_push_stats;
+}
+
+void sensor_bridge_get_report_stats(sensor_bridge_report_stats_t *out)
+{
+    if (!out) return;
+    *out = s_report_stats;
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    out->batched = true;
+#endif
+}
+
+void sensor_bridge_get_occ_event_log(occ_event_log_t *out)
+{
+    if (out) *out = s_occ_log;
+}
+
+void sensor_bridge_get_coord_stats(sensor_bridge_coord_stats_t *out)
+{
+    if (!out) return;
+    out->mode        = s_coord_mode;
+    out->interval_ms = s_coord_gate.interval_ms;
+    out->sent        = s_coord_gate.stats.sent;
+    out->suppressed  = s_coord_gate.stats.suppressed;
+    out->idle        = s_coord_gate.stats.idle;
+    out->throttled   = s_coord_gate.stats.throttled;
+}
+
+/* Write one EP1 sensor attr to the ZCL table and stage it for this poll's report */
+static void set_sensor_attr(uint16_t attr_id, uint8_t type, void *val, uint8_t len)
+{
+    esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
+        ZB_CLUSTER_LD2450_CONFIG,
+        ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+        attr_id,
+        val, false);
+    if (zcl_batch_add(&s_batch, attr_id, type, val, len)) return;
+
+    ESP_LOGW(TAG, "attr 0x%04x does not fit a batched report", attr_id);
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    /* ZBoss auto-reporting is stopped for this attr: report it on its own */
+    esp_zb_zcl_report_attr_cmd_t cmd = {0};
+    cmd.zcl_basic_cmd.src_endpoint = ZB_EP_MAIN;
+    cmd.address_mode   = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
+    cmd.clusterID      = ZB_CLUSTER_LD2450_CONFIG;
+    cmd.direction      = ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI;
+    cmd.dis_default_resp = 1;
+    cmd.attributeID    = attr_id;
+    s_report_stats.attrs++;
+    if (esp_zb_zcl_report_attr_cmd_req(&cmd) == ESP_OK) {
+        s_report_stats.frames++;
+        coordinator_fallback_note_tx(ZCL_BATCH_HEADER_LEN + ZCL_BATCH_RECORD_HDR + len);
+    } else {
+        s_report_stats.send_errors++;
+    }
+#endif
+}
+
+/* Send everything staged this poll: one Report Attributes command per
+ * frame's worth of records, to the EP1 bindings (the coordinator). */
+static void flush_sensor_reports(void)
+{
+    if (s_batch.count == 0) return;
+
+    s_report_stats.events++;
+    s_report_stats.attrs += s_batch.count;
+
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    uint8_t frame[ZCL_BATCH_MAX_FRAME];
+    uint8_t next = 0;
+    size_t len;
+    while ((len = zcl_batch_build_frame(&s_batch, s_batch_seq, &next, frame)) > 0) {
+        s_batch_seq++;
+        esp_zb_apsde_data_req_t req = {0};
+        req.dst_addr_mode = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT;
+        req.profile_id    = ESP_ZB_AF_HA_PROFILE_ID;
+        req.cluster_id    = ZB_CLUSTER_LD2450_CONFIG;
+        req.src_endpoint  = ZB_EP_MAIN;
+        req.asdu_length   = (uint32_t)len;
+        req.asdu          = frame;
+        req.tx_options    = ESP_ZB_APSDE_TX_OPT_ACK_TX;
+        if (esp_zb_aps_data_request(&req) == ESP_OK) {
+            s_report_stats.frames++;
+            coordinator_fallback_note_tx((uint16_t)len);
+        } else {
+            s_report_stats.send_errors++;
+        }
+    }
+    s_batch_last_ms = occ_clock_ms(NULL);
+#else
+    /* ZBoss reports each changed attr in its own frame */
+    s_report_stats.frames += s_batch.count;
+    for (uint8_t i = 0; i < s_batch.count; i++) {
+        coordinator_fallback_note_tx(ZCL_BATCH_HEADER_LEN + ZCL_BATCH_RECORD_HDR + s_batch.rec[i].len);
+    }
+#endif
 }
 
 static void sensor_poll_cb(uint8_t param)
@@ -175,10 +399,27 @@ static void sensor_poll_cb(uint8_t param)
 
     if (!zigbee_is_network_joined()) return;
 
-    /* Push all config attrs when dirtied by an external source (e.g. web UI) */
-    if (s_config_dirty) {
-        s_config_dirty = false;
-        push_config_attrs();
+    if (nvs_config_generation() != s_cfg_gen) {
+        s_cfg_gen = nvs_config_read(0, sizeof(s_cfg), &s_cfg);
+    }
+
+    /* Push only the config attrs dirtied since the last poll */
+    portENTER_CRITICAL(&s_dirty_lock);
+    uint64_t dirty = s_config_dirty;
+    s_config_dirty = 0;
+    portEXIT_CRITICAL(&s_dirty_lock);
+    if (dirty) {
+        push_config_attrs(dirty);
+    }
+
+    /* Sensor command worker state: written on change, reported by ZBoss */
+    ld2450_cmd_status_t cmd_st;
+    ld2450_cmd_worker_get_status(&cmd_st);
+    if (cmd_st.state != s_last_cmd_state) {
+        s_last_cmd_state = cmd_st.state;
+        esp_zb_zcl_set_attribute_val(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZB_ATTR_SENSOR_CMD_STATUS,
+                                     &s_last_cmd_state, false);
     }
 
     /* Update RTC uptime every poll — pure memory write, no Zigbee traffic */
@@ -190,182 +431,129 @@ static void sensor_poll_cb(uint8_t param)
     ld2450_runtime_cfg_t rt_cfg;
     ld2450_get_runtime_cfg(&rt_cfg);
 
-    /* Get current config and time */
-    nvs_config_t cfg;
-    nvs_config_get(&cfg);
-    uint32_t current_ticks = xTaskGetTickCount();
-    int64_t current_time_us = esp_timer_get_time();
-    bool any_sensor_change = false;
-
-    /* EP 1: Overall occupancy */
-    bool occupied = state.occupied_global;
-    uint32_t main_cooldown_sec = cfg.occupancy_cooldown_sec[0];
-    uint32_t main_cooldown_ticks = pdMS_TO_TICKS(main_cooldown_sec * 1000);
-    int64_t main_delay_us = cfg.occupancy_delay_ms[0] * 1000LL;
-
-    bool raw_was_occupied = s_raw_occupied;
-    s_raw_occupied = occupied;
-    if (occupied != raw_was_occupied) {
-        if (!occupied) {
-            /* State went Occupied → Clear: Cancel pending occupied, start cooldown */
-            s_pending_occupied[0] = false;
-            if (!s_pending_clear[0]) {
-                s_pending_clear[0] = true;
-                s_clear_start_time[0] = current_ticks;
-            }
-        } else {
-            /* State went Clear → Occupied: Cancel pending clear, start delay timer */
-            s_pending_clear[0] = false;
-            if (!s_pending_occupied[0]) {
-                s_pending_occupied[0] = true;
-                s_occupied_start_time[0] = current_time_us;
-            }
+    /* Occupancy timing follows live config; re-derive only on a new generation */
+    if (s_cfg_gen != s_occ_timing_gen) {
+        for (uint8_t i = 0; i < OCCUPANCY_SM_MAX_EPS; i++) {
+            occupancy_sm_set_timing(&s_occ_sm, i,
+                                    s_cfg.occupancy_delay_ms[i],
+                                    (uint32_t)s_cfg.occupancy_cooldown_sec[i] * 1000);
         }
-    }
+        s_occ_timing_gen = s_cfg_gen;
 
-    /* Check for pending Occupied report that has completed delay */
-    if (s_pending_occupied[0] && occupied) {
-        if (main_delay_us == 0 || (current_time_us - s_occupied_start_time[0]) >= main_delay_us) {
-            /* Delay complete and still occupied - report it */
-            uint8_t val = 1;
-            esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
-                ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
-                ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
-                &val, false);
-            s_last_occupied = true;
-            s_last_report_time[0] = current_ticks;
-            s_pending_occupied[0] = false;
-            any_sensor_change = true;
-            coordinator_fallback_on_occupancy_change(ZB_EP_MAIN, true);
-            coordinator_fallback_report_occupancy(ZB_EP_MAIN, true);
+        bool zone_ep_reports = s_cfg.zone_ep_reports != 0;
+        if (zone_ep_reports != s_zone_ep_reports) {
+            s_zone_ep_reports = zone_ep_reports;
+            configure_zone_occupancy_reporting(zone_ep_reports);
+            if (zone_ep_reports) resync_zone_eps();
         }
     }
 
-    /* Check for pending Clear report that has completed cooldown */
-    if (s_pending_clear[0] && !occupied) {
-        if (main_cooldown_ticks == 0 || (current_ticks - s_clear_start_time[0]) >= main_cooldown_ticks) {
-            /* Cooldown complete and still clear - report it */
-            uint8_t val = 0;
-            esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
-                ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
-                ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
-                &val, false);
-            s_last_occupied = false;
-            s_last_report_time[0] = current_ticks;
-            s_pending_clear[0] = false;
-            any_sensor_change = true;
-            coordinator_fallback_on_occupancy_change(ZB_EP_MAIN, false);
-            coordinator_fallback_report_occupancy(ZB_EP_MAIN, false);
-        }
+    /* EP 1 + EPs 2-11: overall and per-zone occupancy */
+    uint32_t raw = state.occupied_global ? 1u : 0u;
+    for (int i = 0; i < 10; i++) {
+        if (state.zone_occupied[i]) raw |= 1u << (i + 1);
     }
+    bool any_sensor_change = occupancy_sm_tick(&s_occ_sm, raw) > 0;
 
-    /* EPs 2-11: Per-zone occupancy */
-    for (int i = 0; i < 10; i++) {
-        bool zone_occ = state.zone_occupied[i];
-        uint32_t zone_cooldown_sec = cfg.occupancy_cooldown_sec[i + 1];
-        uint32_t zone_cooldown_ticks = pdMS_TO_TICKS(zone_cooldown_sec * 1000);
-        int64_t zone_delay_us = cfg.occupancy_delay_ms[i + 1] * 1000LL;
-
-        bool raw_was = s_raw_zone_occ[i];
-        s_raw_zone_occ[i] = zone_occ;
-        if (zone_occ != raw_was) {
-            if (!zone_occ) {
-                /* State went Occupied → Clear: Cancel pending occupied, start cooldown */
-                s_pending_occupied[i + 1] = false;
-                if (!s_pending_clear[i + 1]) {
-                    s_pending_clear[i + 1] = true;
-                    s_clear_start_time[i + 1] = current_ticks;
-                }
-            } else {
-                /* State went Clear → Occupied: Cancel pending clear, start delay timer */
-                s_pending_clear[i + 1] = false;
-                if (!s_pending_occupied[i + 1]) {
-                    s_pending_occupied[i + 1] = true;
-                    s_occupied_start_time[i + 1] = current_time_us;
-                }
-            }
-        }
+    zcl_batch_begin(&s_batch, ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG);
 
-        /* Check for pending Occupied report that has completed delay */
-        if (s_pending_occupied[i + 1] && zone_occ) {
-            if (zone_delay_us == 0 || (current_time_us - s_occupied_start_time[i + 1]) >= zone_delay_us) {
-                /* Delay complete and still occupied - report it */
-                uint8_t val = 1;
-                esp_zb_zcl_set_attribute_val(ZB_EP_ZONE(i),
-                    ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
-                    ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                    ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
-                    &val, false);
-                s_last_zone_occ[i] = true;
-                s_last_report_time[i + 1] = current_ticks;
-                s_pending_occupied[i + 1] = false;
-                any_sensor_change = true;
-                coordinator_fallback_on_occupancy_change(ZB_EP_ZONE(i), true);
-                coordinator_fallback_report_occupancy(ZB_EP_ZONE(i), true);
-            }
-        }
+    /* EP 1: Zone bitmap — one write (and one report) for any number of zone edges */
+    if (s_zone_bitmap != s_zone_bitmap_written) {
+        set_sensor_attr(ZB_ATTR_ZONE_BITMAP, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                        &s_zone_bitmap, sizeof(s_zone_bitmap));
+        s_zone_bitmap_written = s_zone_bitmap;
+    }
 
-        /* Check for pending Clear report that has completed cooldown */
-        if (s_pending_clear[i + 1] && !zone_occ) {
-            if (zone_cooldown_ticks == 0 || (current_ticks - s_clear_start_time[i + 1]) >= zone_cooldown_ticks) {
-                /* Cooldown complete and still clear - report it */
-                uint8_t val = 0;
-                esp_zb_zcl_set_attribute_val(ZB_EP_ZONE(i),
-                    ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING,
-                    ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                    ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID,
-                    &val, false);
-                s_last_zone_occ[i] = false;
-                s_last_report_time[i + 1] = current_ticks;
-                s_pending_clear[i + 1] = false;
-                any_sensor_change = true;
-                coordinator_fallback_on_occupancy_change(ZB_EP_ZONE(i), false);
-                coordinator_fallback_report_occupancy(ZB_EP_ZONE(i), false);
-            }
-        }
+    /* EP 1: Occupancy event log — one write covering every edge this tick */
+    if (s_occ_log_dirty) {
+        uint8_t log[1 + OCC_EVENT_LOG_PAYLOAD_LEN];   /* ZCL octet-string length prefix */
+        log[0] = OCC_EVENT_LOG_PAYLOAD_LEN;
+        occ_event_log_pack(&s_occ_log, occ_clock_ms(NULL), log + 1);
+        set_sensor_attr(ZB_ATTR_OCC_EVENT_LOG, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                        log, sizeof(log));
+        s_occ_log_dirty = false;
     }
 
     /* EP 1: Target count */
     uint8_t count = state.target_count_effective;
     if (count != s_last_target_count) {
-        esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
-            ZB_CLUSTER_LD2450_CONFIG,
-            ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-            ZB_ATTR_TARGET_COUNT,
-            &count, false);
+        set_sensor_attr(ZB_ATTR_TARGET_COUNT, ESP_ZB_ZCL_ATTR_TYPE_U8, &count, sizeof(count));
         s_last_target_count = count;
         any_sensor_change = true;
     }
 
-    /* EP 1: Target coordinates (only if publishing enabled) */
-    if (rt_cfg.publish_coords) {
-        char coords[64];
-        format_coords_string(&state, coords, sizeof(coords));
-        if (memcmp(coords, s_last_coords, sizeof(coords)) != 0) {
-            esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
-                ZB_CLUSTER_LD2450_CONFIG,
-                ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                ZB_ATTR_TARGET_COORDS,
-                coords, false);
-            memcpy(s_last_coords, coords, sizeof(s_last_coords));
+    /* EP 1: Packed target data (only if publishing enabled).  Radar jitter
+     * changes almost every frame, so the gate only lets a frame through when
+     * a target appeared/left or moved past the dead-band, at most once per
+     * min interval.  In adaptive mode the interval follows target motion.
+     * A frame the gate passes still needs a rate limiter token; without one
+     * the gate retries with the newest targets on the next poll. */
+    s_coord_mode = rt_cfg.publish_coords ? s_cfg.publish_coords : COORD_PUBLISH_OFF;
+    if (s_coord_mode != COORD_PUBLISH_OFF) {
+        uint32_t now = occ_clock_ms(NULL);
+        bool send = (s_coord_mode == COORD_PUBLISH_ADAPTIVE)
+            ? coord_report_gate_check_adaptive(&s_coord_gate, state.targets, now,
+                                               s_cfg.coord_deadband_mm)
+            : coord_report_gate_check(&s_coord_gate, state.targets, now,
+                                      s_cfg.coord_deadband_mm,
+                                      s_cfg.coord_min_interval_ms);
+        if (send && !coordinator_fallback_rate_take()) {
+            coord_report_gate_defer(&s_coord_gate);
+            send = false;
+        }
+        if (send) {
+            uint8_t data[1 + COORD_REPORT_PAYLOAD_LEN];   /* ZCL octet-string length prefix */
+            data[0] = COORD_REPORT_PAYLOAD_LEN;
+            coord_report_pack(state.targets, data + 1);
+            set_sensor_attr(ZB_ATTR_TARGET_DATA, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                            data, sizeof(data));
             any_sensor_change = true;
         }
+    } else {
+        /* Report the current position straight away when re-enabled */
+        coord_report_gate_reset(&s_coord_gate);
     }
 
     /* Update min_free_heap only when another sensor value changed this poll cycle */
     if (any_sensor_change) {
         uint32_t heap = esp_get_minimum_free_heap_size();
         if (heap != s_last_min_free_heap) {
-            esp_zb_zcl_set_attribute_val(ZB_EP_MAIN,
-                ZB_CLUSTER_LD2450_CONFIG,
-                ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                ZB_ATTR_MIN_FREE_HEAP,
-                &heap, false);
+            set_sensor_attr(ZB_ATTR_MIN_FREE_HEAP, ESP_ZB_ZCL_ATTR_TYPE_U32, &heap, sizeof(heap));
             s_last_min_free_heap = heap;
         }
+
+        /* Rate limiter counters ride along the same way: throttling itself
+         * must not generate traffic */
+        coordinator_fallback_rate_stats_t rl;
+        coordinator_fallback_get_rate_stats(&rl);
+        if (rl.throttled_occ != s_last_throttled_occ) {
+            set_sensor_attr(ZB_ATTR_THROTTLED_OCC, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                            &rl.throttled_occ, sizeof(rl.throttled_occ));
+            s_last_throttled_occ = rl.throttled_occ;
+        }
+        uint32_t thr_coords = s_coord_gate.stats.throttled;
+        if (thr_coords != s_last_throttled_coords) {
+            set_sensor_attr(ZB_ATTR_THROTTLED_COORDS, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                            &thr_coords, sizeof(thr_coords));
+            s_last_throttled_coords = thr_coords;
+        }
+    }
+
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    /* Keepalive in place of the ZBoss max-interval reports that were stopped.
+     * One packed frame refreshes the count and every zone's occupancy; it is
+     * skipped while other sensor reports keep the coordinator fresh, and its
+     * period is jittered so co-powered sensors do not refresh together. */
+    if (s_batch.count == 0 &&
+        (uint32_t)(occ_clock_ms(NULL) - s_batch_last_ms) >= s_batch_ka_ms) {
+        zcl_batch_add(&s_batch, ZB_ATTR_TARGET_COUNT, ESP_ZB_ZCL_ATTR_TYPE_U8,
+                      &s_last_target_count, sizeof(s_last_target_count));
+        zcl_batch_add(&s_batch, ZB_ATTR_ZONE_BITMAP, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                      &s_zone_bitmap_written, sizeof(s_zone_bitmap_written));
+        s_batch_ka_ms = coordinator_fallback_keepalive_delay_ms(false);
     }
+#endif
+    flush_sensor_reports();
 }
 
 static void configure_reporting_for_diag_attr(uint16_t attr_id, uint16_t max_interval)
@@ -386,19 +574,45 @@ static void configure_reporting_for_diag_attr(uint16_t attr_id, uint16_t max_int
     esp_zb_zcl_update_reporting_info(&rpt);
 }
 
+static void configure_sensor_attr_reporting(uint16_t attr_id, uint16_t max_interval)
+{
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    /* Also clears entries a coordinator configured before batching existed */
+    (void)max_interval;
+    esp_zb_zcl_stop_attr_reporting(ZB_EP_MAIN, ZB_CLUSTER_LD2450_CONFIG, attr_id);
+#else
+    configure_reporting_for_diag_attr(attr_id, max_interval);
+#endif
+}
+
 static void configure_all_reporting(void)
 {
     /* Occupancy reporting is handled by coordinator_fallback_report_occupancy()
      * with explicit ACK tracking and retry.  No auto-report entries here. */
 
+    /* Sensor attrs: report on any change (batched per poll when enabled).
+     * Zone bitmap has a 5-min keepalive; the event log is report-on-change
+     * only and can also be read. */
+    configure_sensor_attr_reporting(ZB_ATTR_TARGET_COUNT,      REPORT_MAX_INTERVAL);
+    configure_sensor_attr_reporting(ZB_ATTR_TARGET_DATA,       REPORT_MAX_INTERVAL);
+    configure_sensor_attr_reporting(ZB_ATTR_ZONE_BITMAP,       REPORT_MAX_INTERVAL);
+    configure_sensor_attr_reporting(ZB_ATTR_OCC_EVENT_LOG,     0);
+
     /* Boot stats: 5-min keepalive guarantees Z2M gets fresh values after any rejoin */
     configure_reporting_for_diag_attr(ZB_ATTR_BOOT_COUNT,      REPORT_MAX_INTERVAL);
     configure_reporting_for_diag_attr(ZB_ATTR_RESET_REASON,    REPORT_MAX_INTERVAL);
     configure_reporting_for_diag_attr(ZB_ATTR_LAST_UPTIME_SEC, REPORT_MAX_INTERVAL);
     /* Min free heap: no keepalive, reported only alongside occupancy/sensor changes */
-    configure_reporting_for_diag_attr(ZB_ATTR_MIN_FREE_HEAP,   0);
+    configure_sensor_attr_reporting(ZB_ATTR_MIN_FREE_HEAP,     0);
+    /* Rate limiter counters: same, alongside other sensor changes only */
+    configure_sensor_attr_reporting(ZB_ATTR_THROTTLED_OCC,     0);
+    configure_sensor_attr_reporting(ZB_ATTR_THROTTLED_COORDS,  0);
     /* Soft fault: report on any change (delta=0) */
     configure_reporting_for_diag_attr(ZB_ATTR_SOFT_FAULT,      0);
+    /* Link stats: updated at the keep-alive cadence, reported when changed */
+    configure_reporting_for_diag_attr(ZB_ATTR_LINK_STATS,      0);
+    /* Sensor command status: report on change */
+    configure_reporting_for_diag_attr(ZB_ATTR_SENSOR_CMD_STATUS, 0);
 
     /* Zone config attrs: no device-side entries needed.
      * Each zone EP has its own cluster instance with only 4 attrs, so Z2M's
@@ -418,11 +632,17 @@ void sensor_bridge_start(void)
     }
     s_started = true;
 
+    occupancy_sm_init(&s_occ_sm, OCCUPANCY_SM_MAX_EPS, occ_clock_ms, occ_report_cb, NULL);
+    occ_event_log_init(&s_occ_log);
+#if CONFIG_LD2450_ZCL_REPORT_BATCHING
+    s_batch_ka_ms = coordinator_fallback_keepalive_delay_ms(true);
+#endif
+
     ESP_LOGI(TAG, "Starting sensor bridge (poll every %d ms)", SENSOR_POLL_INTERVAL_MS);
     configure_all_reporting();
     coordinator_fallback_start_keepalive();
     /* Push real config values on first poll — corrects the max-length padded
      * placeholder used to pre-allocate ZBoss's internal CHAR_STRING buffers. */
-    s_config_dirty = true;
+    sensor_bridge_mark_config_dirty();
     esp_zb_scheduler_alarm(sensor_poll_cb, ALARM_PARAM_POLL, SENSOR_POLL_INTERVAL_MS);
 }
@@ -1,6 +1,11 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "occ_event_log.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -13,16 +18,84 @@ extern "C" {
  */
 void sensor_bridge_start(void);
 
+/* ---- Config attribute dirty bits (one per pushed ZCL attribute group) ---- */
+#define SB_DIRTY_MAX_DISTANCE        (1ULL << 0)
+#define SB_DIRTY_ANGLE_LEFT          (1ULL << 1)
+#define SB_DIRTY_ANGLE_RIGHT         (1ULL << 2)
+#define SB_DIRTY_TRACKING_MODE       (1ULL << 3)
+#define SB_DIRTY_COORD_PUBLISHING    (1ULL << 4)
+#define SB_DIRTY_FALLBACK_MODE       (1ULL << 5)
+#define SB_DIRTY_FALLBACK_ENABLE     (1ULL << 6)
+#define SB_DIRTY_FALLBACK_COOLDOWN   (1ULL << 7)   /* main EP only; zone entries are not pushed */
+#define SB_DIRTY_HARD_TIMEOUT        (1ULL << 8)
+#define SB_DIRTY_ACK_TIMEOUT         (1ULL << 9)
+#define SB_DIRTY_HEARTBEAT_ENABLE    (1ULL << 10)
+#define SB_DIRTY_HEARTBEAT_INTERVAL  (1ULL << 11)
+#define SB_DIRTY_ZONE_EP_REPORTS     (1ULL << 12)
+#define SB_DIRTY_COORD_DEADBAND      (1ULL << 13)
+#define SB_DIRTY_COORD_MIN_INTERVAL  (1ULL << 14)
+#define SB_DIRTY_RATE_LIMIT          (1ULL << 15)  /* rate burst + sustained rate */
+/* Per endpoint index: 0=main, 1-10=zones */
+#define SB_DIRTY_OCC_COOLDOWN(idx)   (1ULL << (16 + (idx)))
+#define SB_DIRTY_OCC_DELAY(idx)      (1ULL << (27 + (idx)))
+/* Per zone 0-9: vertex count + coords CSV */
+#define SB_DIRTY_ZONE_GEOMETRY(n)    (1ULL << (38 + (n)))
+#define SB_DIRTY_HW_FILTER_MODE      (1ULL << 48)
+#define SB_DIRTY_FALLBACK_GROUP      (1ULL << 49)  /* all 11 fallback groups */
+#define SB_DIRTY_ALL                 ((1ULL << 50) - 1)
+
+typedef struct {
+    uint32_t push_cycles;     /* poll cycles that pushed at least one attr */
+    uint32_t attrs_written;   /* esp_zb_zcl_set_attribute_val calls made */
+    uint32_t attrs_skipped;   /* attrs a full push would have written but were clean */
+} sensor_bridge_push_stats_t;
+
+typedef struct {
+    bool     batched;         /* CONFIG_LD2450_ZCL_REPORT_BATCHING */
+    uint32_t events;          /* polls in which at least one EP1 sensor attr changed */
+    uint32_t attrs;           /* sensor attr changes (= frames with per-attr reports) */
+    uint32_t frames;          /* Report Attributes frames sent */
+    uint32_t send_errors;     /* batched frames the APS layer refused */
+} sensor_bridge_report_stats_t;
+
+typedef struct {
+    uint8_t  mode;            /* COORD_PUBLISH_* in effect */
+    uint32_t interval_ms;     /* min interval applied on the last poll */
+    uint32_t sent;            /* target-data frames reported */
+    uint32_t suppressed;      /* frames that changed but were held back */
+    uint32_t idle;            /* empty-room frames skipped */
+    uint32_t throttled;       /* frames held back by the report rate limiter */
+} sensor_bridge_coord_stats_t;
+
 /**
- * @brief Mark device config as dirty so the next poll cycle pushes all
- *        config ZCL attributes to the attribute table.
+ * @brief Mark all config attributes dirty so the next poll cycle pushes
+ *        every config ZCL attribute to the attribute table.
  *
- * Call this whenever config is written from a non-Zigbee source (e.g.
- * the web UI REST API) so Z2M and HA see the updated values.
  * Safe to call from any task/context.
  */
 void sensor_bridge_mark_config_dirty(void);
 
+/**
+ * @brief Mark selected config attributes (SB_DIRTY_* bits) dirty.
+ *
+ * The NVS save layer calls this with the bits for the field it wrote, so
+ * a single change from Z2M, CLI or web only re-pushes that attribute.
+ * Safe to call from any task/context.
+ */
+void sensor_bridge_mark_config_dirty_mask(uint64_t mask);
+
+/** Copy out the config push counters. */
+void sensor_bridge_get_push_stats(sensor_bridge_push_stats_t *out);
+
+/** Copy out the target-data (ZB_ATTR_TARGET_DATA) report counters. */
+void sensor_bridge_get_coord_stats(sensor_bridge_coord_stats_t *out);
+
+/** Copy out the EP1 sensor report counters (frames per event before/after batching). */
+void sensor_bridge_get_report_stats(sensor_bridge_report_stats_t *out);
+
+/** Copy out the occupancy event log (ZB_ATTR_OCC_EVENT_LOG). */
+void sensor_bridge_get_occ_event_log(occ_event_log_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: MIT
+#include "sensor_health.h"
+
+#include <string.h>
+
+void sensor_health_default_cfg(sensor_health_cfg_t *cfg)
+{
+    if (!cfg) return;
+    cfg->gap_ms         = 1000;
+    cfg->stall_ms       = 3000;
+    cfg->garbage_pct    = 20;
+    cfg->min_rate_pct   = 50;
+    cfg->noise_samples  = 5;
+    cfg->backoff_min_ms = 5000;
+    cfg->backoff_max_ms = 300000;
+    cfg->stable_ms      = 60000;
+}
+
+void sensor_health_init(sensor_health_t *h, const sensor_health_cfg_t *cfg, uint32_t now_ms)
+{
+    if (!h) return;
+    memset(h, 0, sizeof(*h));
+    if (cfg) {
+        h->cfg = *cfg;
+    } else {
+        sensor_health_default_cfg(&h->cfg);
+    }
+    if (h->cfg.noise_samples == 0) h->cfg.noise_samples = 1;
+    if (h->cfg.backoff_max_ms < h->cfg.backoff_min_ms) h->cfg.backoff_max_ms = h->cfg.backoff_min_ms;
+
+    h->state = SENSOR_HEALTH_OK;
+    h->start_ms = now_ms;
+    h->good_ms = now_ms;
+    h->backoff_ms = h->cfg.backoff_min_ms;
+    h->rate_pct = 100;
+}
+
+static void log_event(sensor_health_t *h, uint32_t now_ms, uint8_t type, uint32_t value)
+{
+    h->log[h->log_head] = (sensor_health_event_t){ .t_ms = now_ms, .type = type, .value = value };
+    h->log_head = (uint8_t)((h->log_head + 1) % SENSOR_HEALTH_LOG_LEN);
+    if (h->log_count < SENSOR_HEALTH_LOG_LEN) h->log_count++;
+}
+
+/* OK -> faulted: the first restart is due at once */
+static void begin_fault(sensor_health_t *h, uint32_t now_ms)
+{
+    if (h->state != SENSOR_HEALTH_OK) return;
+    h->fault_ms = now_ms;
+    h->next_restart_ms = now_ms;
+    h->attempt = 0;
+}
+
+static void take_baseline(sensor_health_t *h, const sensor_health_sample_t *s)
+{
+    h->have_prev    = true;
+    h->prev_ms      = s->now_ms;
+    h->prev_bytes   = s->bytes;
+    h->prev_frames  = s->frames;
+    h->prev_garbage = s->garbage_bytes;
+    h->prev_pauses  = s->pauses;
+}
+
+uint8_t sensor_health_step(sensor_health_t *h, const sensor_health_sample_t *s)
+{
+    if (!h || !s) return SENSOR_HEALTH_NONE;
+
+    /* Nothing to compare with, or RX was paused for part of the interval */
+    if (!h->have_prev || s->paused || s->pauses != h->prev_pauses) {
+        take_baseline(h, s);
+        return SENSOR_HEALTH_NONE;
+    }
+
+    const uint32_t now    = s->now_ms;
+    const uint32_t dt     = now - h->prev_ms;
+    const uint32_t bytes  = s->bytes - h->prev_bytes;
+    const uint32_t frames = s->frames - h->prev_frames;
+    const uint32_t junk   = s->garbage_bytes - h->prev_garbage;
+    take_baseline(h, s);
+
+    const uint32_t quiet = now - (s->last_frame_ms ? s->last_frame_ms : h->start_ms);
+    const uint32_t expected = (uint32_t)((uint64_t)dt * SENSOR_HEALTH_FRAME_HZ / 1000);
+    uint32_t rate = expected ? (uint32_t)((uint64_t)frames * 100 / expected) : 100;
+    h->rate_pct  = (uint16_t)(rate > 999 ? 999 : rate);
+    h->noise_pct = (uint8_t)(bytes ? (uint64_t)(junk > bytes ? bytes : junk) * 100 / bytes : 0);
+
+    uint8_t action = SENSOR_HEALTH_NONE;
+
+    /* A finished gap.  Expected while a restart or stall is being handled:
+     * those already re-apply, so only an unexplained gap is counted. */
+    if (s->gap_max_ms > h->cfg.gap_ms) {
+        if (s->gap_max_ms > h->longest_gap_ms) h->longest_gap_ms = s->gap_max_ms;
+        if (!h->need_reapply) {
+            h->gaps++;
+            h->need_reapply = true;
+            log_event(h, now, SENSOR_HEALTH_EV_GAP, s->gap_max_ms);
+        }
+    }
+
+    if (quiet >= h->cfg.stall_ms) {
+        h->noisy_run = 0;
+        if (h->state != SENSOR_HEALTH_STALLED) {
+            begin_fault(h, now);
+            h->state = SENSOR_HEALTH_STALLED;
+            h->stalls++;
+            h->need_reapply = true;
+            log_event(h, now, SENSOR_HEALTH_EV_STALL, quiet);
+        }
+    } else if (bytes > 0 &&
+               (h->noise_pct >= h->cfg.garbage_pct || h->rate_pct < h->cfg.min_rate_pct)) {
+        if (h->noisy_run < UINT8_MAX) h->noisy_run++;
+        if (h->noisy_run >= h->cfg.noise_samples && h->state == SENSOR_HEALTH_OK) {
+            begin_fault(h, now);
+            h->state = SENSOR_HEALTH_NOISY;
+            h->noise++;
+            log_event(h, now, SENSOR_HEALTH_EV_NOISE, h->noise_pct);
+        }
+    } else if (frames > 0) {
+        h->noisy_run = 0;
+        if (h->state != SENSOR_HEALTH_OK) {
+            log_event(h, now, SENSOR_HEALTH_EV_RECOVERED, now - h->fault_ms);
+            h->state = SENSOR_HEALTH_OK;
+            h->good_ms = now;
+        }
+        if (h->need_reapply) {
+            h->need_reapply = false;
+            h->reapplies++;
+            log_event(h, now, SENSOR_HEALTH_EV_REAPPLY, 0);
+            action = SENSOR_HEALTH_REAPPLY;
+        }
+        if (now - h->good_ms >= h->cfg.stable_ms) h->backoff_ms = h->cfg.backoff_min_ms;
+    }
+
+    if (h->state != SENSOR_HEALTH_OK && (int32_t)(now - h->next_restart_ms) >= 0) {
+        h->restarts++;
+        h->attempt++;
+        h->need_reapply = true;
+        log_event(h, now, SENSOR_HEALTH_EV_RESTART, h->attempt);
+        h->next_restart_ms = now + h->backoff_ms;
+        h->backoff_ms = (h->backoff_ms > h->cfg.backoff_max_ms / 2)
+            ? h->cfg.backoff_max_ms : h->backoff_ms * 2;
+        action = SENSOR_HEALTH_RESTART;
+    }
+
+    return action;
+}
+
+bool sensor_health_get_event(const sensor_health_t *h, uint8_t idx, sensor_health_event_t *out)
+{
+    if (!h || !out || idx >= h->log_count) return false;
+    uint8_t slot = (uint8_t)((h->log_head + SENSOR_HEALTH_LOG_LEN - 1 - idx) % SENSOR_HEALTH_LOG_LEN);
+    *out = h->log[slot];
+    return true;
+}
+
+const char *sensor_health_state_name(uint8_t state)
+{
+    switch (state) {
+    case SENSOR_HEALTH_OK:      return "ok";
+    case SENSOR_HEALTH_NOISY:   return "noisy";
+    case SENSOR_HEALTH_STALLED: return "stalled";
+    default:                    return "unknown";
+    }
+}
+
+const char *sensor_health_event_name(uint8_t type)
+{
+    switch (type) {
+    case SENSOR_HEALTH_EV_GAP:       return "gap";
+    case SENSOR_HEALTH_EV_STALL:     return "stall";
+    case SENSOR_HEALTH_EV_NOISE:     return "noise";
+    case SENSOR_HEALTH_EV_RESTART:   return "restart";
+    case SENSOR_HEALTH_EV_REAPPLY:   return "reapply";
+    case SENSOR_HEALTH_EV_RECOVERED: return "recovered";
+    default:                         return "unknown";
+    }
+}
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LD2450 health monitor.
+ *
+ * sensor_recovery.c samples the UART counters (ld2450_get_rx_stats()) about
+ * once a second, feeds them here and carries out the returned action.
+ *
+ * The sensor streams a 30-byte frame at 10 Hz.  Each sample is judged on
+ * the frames and bytes received since the previous one:
+ *   - gap:     frames resumed after more than gap_ms without one.  A short
+ *              gap is the sensor rebooting (brown-out, watchdog), which may
+ *              also have reverted its settings.
+ *   - stalled: no frame for stall_ms and still silent.
+ *   - noisy:   garbage above garbage_pct of the bytes received, or frames
+ *              below min_rate_pct of 10 Hz while bytes arrive, for
+ *              noise_samples samples in a row (interference, a loose wire,
+ *              a baud mismatch).
+ *
+ * While stalled or noisy the monitor asks for a sensor restart at once,
+ * then again after backoff_min_ms, doubling up to backoff_max_ms.  The
+ * backoff resets after stable_ms of good samples.  After a gap, a stall
+ * or a restart it asks for the hardware config to be re-applied with the
+ * first good sample, since the sensor may have come back with other
+ * settings.
+ *
+ * Samples taken while RX is paused, or spanning a pause, are not judged:
+ * a config session is neither a gap nor a low frame rate.
+ *
+ * Times are uint32_t milliseconds; elapsed time is computed by unsigned
+ * subtraction so clock wraparound (~49 days) is harmless.
+ */
+
+#define SENSOR_HEALTH_LOG_LEN   8
+#define SENSOR_HEALTH_FRAME_HZ  10
+
+typedef enum {
+    SENSOR_HEALTH_OK = 0,
+    SENSOR_HEALTH_NOISY,
+    SENSOR_HEALTH_STALLED,
+} sensor_health_state_t;
+
+typedef enum {
+    SENSOR_HEALTH_NONE = 0,
+    SENSOR_HEALTH_RESTART,         /* restart the sensor module */
+    SENSOR_HEALTH_REAPPLY,         /* re-send the hardware config */
+} sensor_health_action_t;
+
+typedef enum {
+    SENSOR_HEALTH_EV_GAP = 0,      /* value: gap length, ms */
+    SENSOR_HEALTH_EV_STALL,        /* value: ms since the last frame */
+    SENSOR_HEALTH_EV_NOISE,        /* value: garbage percentage of the last sample */
+    SENSOR_HEALTH_EV_RESTART,      /* value: attempt number since the fault began */
+    SENSOR_HEALTH_EV_REAPPLY,      /* value: 0 */
+    SENSOR_HEALTH_EV_RECOVERED,    /* value: fault duration, ms */
+} sensor_health_event_type_t;
+
+typedef struct {
+    uint32_t gap_ms;               /* default 1000: ten frames missed */
+    uint32_t stall_ms;             /* default 3000 */
+    uint8_t  garbage_pct;          /* default 20 */
+    uint8_t  min_rate_pct;         /* default 50 */
+    uint8_t  noise_samples;        /* default 5 */
+    uint32_t backoff_min_ms;       /* default 5 s */
+    uint32_t backoff_max_ms;       /* default 5 min */
+    uint32_t stable_ms;            /* default 60 s */
+} sensor_health_cfg_t;
+
+/** One reading of the RX counters (see ld2450_rx_stats_t). */
+typedef struct {
+    uint32_t now_ms;
+    uint32_t bytes;                /* cumulative */
+    uint32_t frames;               /* cumulative */
+    uint32_t garbage_bytes;        /* cumulative */
+    uint32_t pauses;               /* cumulative */
+    bool     paused;
+    uint32_t last_frame_ms;        /* last frame or RX resume, 0 = neither yet */
+    uint32_t gap_max_ms;           /* longest gap ended since the previous sample */
+} sensor_health_sample_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t  type;                 /* sensor_health_event_type_t */
+    uint32_t value;
+} sensor_health_event_t;
+
+typedef struct {
+    sensor_health_cfg_t cfg;
+
+    uint8_t  state;                /* sensor_health_state_t */
+    bool     have_prev;
+    uint32_t start_ms;             /* silence before the first frame counts from here */
+    uint32_t prev_ms;
+    uint32_t prev_bytes, prev_frames, prev_garbage, prev_pauses;
+    uint8_t  noisy_run;            /* consecutive noisy samples */
+    bool     need_reapply;
+    uint32_t fault_ms;             /* when the current fault began */
+    uint32_t good_ms;              /* when samples last turned good */
+    uint32_t next_restart_ms;
+    uint32_t backoff_ms;
+    uint32_t attempt;              /* restarts in the current fault */
+
+    /* Last judged sample, for diagnostics */
+    uint16_t rate_pct;             /* frames vs 10 Hz */
+    uint8_t  noise_pct;            /* garbage share of the bytes */
+
+    /* Counters since init */
+    uint32_t gaps, stalls, noise, restarts, reapplies;
+    uint32_t longest_gap_ms;
+
+    sensor_health_event_t log[SENSOR_HEALTH_LOG_LEN];
+    uint8_t  log_head;             /* slot the next event goes into */
+    uint8_t  log_count;
+} sensor_health_t;
+
+/** The defaults listed in sensor_health_cfg_t. */
+void sensor_health_default_cfg(sensor_health_cfg_t *cfg);
+
+/** Start monitoring at now_ms; cfg NULL = defaults. */
+void sensor_health_init(sensor_health_t *h, const sensor_health_cfg_t *cfg, uint32_t now_ms);
+
+/** Judge one sample; returns the sensor_health_action_t to carry out. */
+uint8_t sensor_health_step(sensor_health_t *h, const sensor_health_sample_t *s);
+
+/** Event idx (0 = newest).  Returns false if idx >= log_count. */
+bool sensor_health_get_event(const sensor_health_t *h, uint8_t idx, sensor_health_event_t *out);
+
+/** "ok" / "noisy" / "stalled" */
+const char *sensor_health_state_name(uint8_t state);
+
+/** "gap" / "stall" / "noise" / "restart" / "reapply" / "recovered" */
+const char *sensor_health_event_name(uint8_t type);
+
+#ifdef __cplusplus
+}
+#endif
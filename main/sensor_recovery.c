@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+#include "sensor_recovery.h"
+
+#include "config_api.h"
+#include "ld2450.h"
+#include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "sensor_recovery";
+
+#define RECOVERY_PERIOD_MS  1000
+#define RECOVERY_STACK      3072
+#define RECOVERY_PRIO       3      /* below the command worker */
+
+static sensor_health_t s_health;
+static portMUX_TYPE    s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t    s_task = NULL;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void run_action(uint8_t action)
+{
+    ld2450_cmd_req_t req = {0};
+
+    switch (action) {
+    case SENSOR_HEALTH_RESTART:
+        req.op = LD2450_CMD_OP_RESTART;
+        break;
+    case SENSOR_HEALTH_REAPPLY:
+        /* The sensor may have come back with other settings: send them all */
+        ld2450_cmd_forget_settings();
+        req.op = LD2450_CMD_OP_BATCH;
+        config_api_build_sensor_batch(&req.u.batch);
+        break;
+    default:
+        return;
+    }
+
+    esp_err_t err = ld2450_cmd_submit(&req, NULL, NULL, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s not queued: %s", ld2450_cmd_op_name(req.op), esp_err_to_name(err));
+    }
+}
+
+static void recovery_task(void *arg)
+{
+    (void)arg;
+    TickType_t wake = xTaskGetTickCount();
+
+    for (;;) {
+        xTaskDelayUntil(&wake, pdMS_TO_TICKS(RECOVERY_PERIOD_MS));
+
+        ld2450_rx_stats_t rx;
+        ld2450_get_rx_stats(&rx, true);
+        sensor_health_sample_t smp = {
+            .now_ms        = now_ms(),
+            .bytes         = rx.bytes,
+            .frames        = rx.frames,
+            .garbage_bytes = rx.garbage_bytes,
+            .pauses        = rx.pauses,
+            .paused        = rx.paused,
+            .last_frame_ms = rx.last_frame_ms,
+            .gap_max_ms    = rx.gap_max_ms,
+        };
+
+        portENTER_CRITICAL(&s_lock);
+        uint8_t head = s_health.log_head;
+        uint8_t action = sensor_health_step(&s_health, &smp);
+        sensor_health_t h = s_health;
+        portEXIT_CRITICAL(&s_lock);
+
+        /* Log what this step added, oldest first (a step adds at most three) */
+        uint8_t added = (uint8_t)((h.log_head + SENSOR_HEALTH_LOG_LEN - head) % SENSOR_HEALTH_LOG_LEN);
+        for (int i = added - 1; i >= 0; i--) {
+            sensor_health_event_t ev;
+            if (!sensor_health_get_event(&h, (uint8_t)i, &ev)) continue;
+            ESP_LOGW(TAG, "%s (%u), sensor %s, %u/%u%% frames/garbage",
+                     sensor_health_event_name(ev.type), (unsigned)ev.value,
+                     sensor_health_state_name(h.state), h.rate_pct, h.noise_pct);
+        }
+
+        run_action(action);
+    }
+}
+
+esp_err_t sensor_recovery_start(void)
+{
+    if (s_task) return ESP_OK;  /* already started */
+
+    sensor_health_init(&s_health, NULL, now_ms());
+    BaseType_t ok = xTaskCreate(recovery_task, "sensor_recov", RECOVERY_STACK, NULL,
+                                RECOVERY_PRIO, &s_task);
+    if (ok != pdPASS) {
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void sensor_recovery_get(sensor_health_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_lock);
+    *out = s_health;
+    portEXIT_CRITICAL(&s_lock);
+}
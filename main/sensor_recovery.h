@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "esp_err.h"
+#include "sensor_health.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Automatic LD2450 recovery.
+ *
+ * A low-priority task samples the UART counters once a second and runs
+ * them through the health monitor (sensor_health.h).  A stalled or noisy
+ * sensor is restarted through the command worker, with the monitor's
+ * backoff; once frames flow again after a gap, stall or restart, the saved
+ * hardware config (config_api_build_sensor_batch()) is re-sent with the
+ * command cache forgotten, so nothing is skipped as "already held".
+ *
+ * Events are logged and kept for the CLI (ld health) and /api/stats.
+ */
+
+/** Start monitoring.  Call after the boot config has been applied. */
+esp_err_t sensor_recovery_start(void);
+
+/** Copy out the monitor state, counters and event log. */
+void sensor_recovery_get(sensor_health_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,6 +5,7 @@
  * Handles only LD2450 device endpoints:
  *   GET  /api/config   — full sensor config JSON
  *   POST /api/config   — partial config update
+ *   GET  /api/stats    — Zigbee reporting counters
  *   WS   /ws/targets   — 2 Hz target + occupancy stream
  *
  * All WiFi, OTA, system, and diagnostics endpoints are handled by
@@ -14,7 +15,11 @@
 #include "web_server_base.h"
 
 #include "config_api.h"
+#include "coord_report.h"
+#include "coordinator_fallback.h"
+#include "nvs_config.h"
 #include "sensor_bridge.h"
+#include "sensor_recovery.h"
 #include "version.h"
 #include "zigbee_ota.h"
 #include "ota_check.h"
@@ -22,10 +27,14 @@
 #include "cJSON.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ld2450.h"
+#include "ld2450_cmd_worker.h"
 
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -87,6 +96,178 @@ static esp_err_t handle_get_config(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* ================================================================== */
+/*  GET /api/stats                                                     */
+/* ================================================================== */
+
+/* Sensor command worker status, shared by /api/stats and the "sensor_cmd" SSE topic */
+/* Zone filter plan: what the sensor drops before the firmware's zone checks */
+static void add_hw_filter(cJSON *obj)
+{
+    ld2450_hw_filter_t f;
+    config_api_plan_hw_filter(&f);
+    uint8_t mode;
+    NVS_CONFIG_READ(hw_filter_mode, &mode);
+    cJSON_AddStringToObject(obj, "mode", ld2450_hw_filter_mode_name(mode));
+    cJSON_AddNumberToObject(obj, "zone_type", f.zone_type);
+    cJSON_AddNumberToObject(obj, "area_cm2",  ld2450_hw_filter_area_cm2(&f));
+    cJSON_AddNumberToObject(obj, "range_cm2", ld2450_hw_filter_area_cm2(NULL));
+    cJSON *rects = cJSON_AddArrayToObject(obj, "rects");
+    for (uint8_t i = 0; i < f.count; i++) {
+        cJSON *r = cJSON_CreateArray();
+        cJSON_AddItemToArray(r, cJSON_CreateNumber(f.rect[i].x1));
+        cJSON_AddItemToArray(r, cJSON_CreateNumber(f.rect[i].y1));
+        cJSON_AddItemToArray(r, cJSON_CreateNumber(f.rect[i].x2));
+        cJSON_AddItemToArray(r, cJSON_CreateNumber(f.rect[i].y2));
+        cJSON_AddItemToArray(rects, r);
+    }
+}
+
+static void add_sensor_health(cJSON *obj)
+{
+    ld2450_rx_stats_t rx;
+    sensor_health_t h;
+    ld2450_get_rx_stats(&rx, false);
+    sensor_recovery_get(&h);
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+
+    cJSON_AddStringToObject(obj, "state", sensor_health_state_name(h.state));
+    cJSON_AddNumberToObject(obj, "rate_pct",       h.rate_pct);
+    cJSON_AddNumberToObject(obj, "garbage_pct",    h.noise_pct);
+    cJSON_AddNumberToObject(obj, "frames",         rx.frames);
+    cJSON_AddNumberToObject(obj, "bytes",          rx.bytes);
+    cJSON_AddNumberToObject(obj, "garbage_bytes",  rx.garbage_bytes);
+    cJSON_AddNumberToObject(obj, "bad_frames",     rx.bad_frames);
+    cJSON_AddNumberToObject(obj, "gaps",           h.gaps);
+    cJSON_AddNumberToObject(obj, "longest_gap_ms", h.longest_gap_ms);
+    cJSON_AddNumberToObject(obj, "stalls",         h.stalls);
+    cJSON_AddNumberToObject(obj, "noisy",          h.noise);
+    cJSON_AddNumberToObject(obj, "restarts",       h.restarts);
+    cJSON_AddNumberToObject(obj, "reapplies",      h.reapplies);
+    cJSON *ev = cJSON_AddArrayToObject(obj, "events");
+    sensor_health_event_t e;
+    for (uint8_t i = 0; sensor_health_get_event(&h, i, &e); i++) {
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "type",   sensor_health_event_name(e.type));
+        cJSON_AddNumberToObject(o, "value",  e.value);
+        cJSON_AddNumberToObject(o, "age_ms", now - e.t_ms);
+        cJSON_AddItemToArray(ev, o);
+    }
+}
+
+static void add_sensor_cmd_status(cJSON *obj)
+{
+    static const char *const state_names[] = {"idle", "busy", "failed"};
+    ld2450_cmd_status_t st;
+    ld2450_cmd_worker_get_status(&st);
+    cJSON_AddStringToObject(obj, "state",
+        st.state <= LD2450_CMD_STATE_FAILED ? state_names[st.state] : "idle");
+    cJSON_AddNumberToObject(obj, "pending",   st.pending);
+    cJSON_AddStringToObject(obj, "last_op",   ld2450_cmd_op_name(st.last_op));
+    cJSON_AddStringToObject(obj, "last_err",  esp_err_to_name(st.last_err));
+    cJSON_AddNumberToObject(obj, "last_ms",   st.last_ms);
+    cJSON_AddNumberToObject(obj, "completed", st.completed);
+    cJSON_AddNumberToObject(obj, "failed",    st.failed);
+    cJSON_AddNumberToObject(obj, "rejected",  st.rejected);
+
+    config_api_sensor_stats_t ss;
+    config_api_get_sensor_stats(&ss);
+    cJSON_AddNumberToObject(obj, "changes",   ss.changes);
+    cJSON_AddNumberToObject(obj, "updates",   ss.updates);
+
+    ld2450_sensor_info_t si;
+    ld2450_cmd_get_sensor_info(&si);
+    cJSON_AddNumberToObject(obj, "sessions",  si.sessions);
+    cJSON_AddNumberToObject(obj, "skipped",   si.skipped);
+    cJSON_AddNumberToObject(obj, "drift",     si.drift);
+    if (si.fw_valid) {
+        char fw[24];
+        snprintf(fw, sizeof(fw), "V%u.%02X.%08" PRIX32,
+                 si.fw_major >> 8, si.fw_major & 0xFF, si.fw_minor);
+        cJSON_AddStringToObject(obj, "sensor_fw", fw);
+    }
+}
+
+static esp_err_t handle_get_stats(httpd_req_t *req)
+{
+    static const char *const mode_names[] = {"off", "on", "adaptive"};
+
+    sensor_bridge_coord_stats_t cs;
+    sensor_bridge_push_stats_t ps;
+    sensor_bridge_report_stats_t rs;
+    sensor_bridge_get_coord_stats(&cs);
+    sensor_bridge_get_push_stats(&ps);
+    sensor_bridge_get_report_stats(&rs);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *c = cJSON_AddObjectToObject(root, "coords");
+    cJSON_AddStringToObject(c, "mode",
+        cs.mode <= COORD_PUBLISH_ADAPTIVE ? mode_names[cs.mode] : "off");
+    cJSON_AddNumberToObject(c, "interval_ms", cs.interval_ms);
+    cJSON_AddNumberToObject(c, "sent",        cs.sent);
+    cJSON_AddNumberToObject(c, "suppressed",  cs.suppressed);
+    cJSON_AddNumberToObject(c, "idle",        cs.idle);
+    cJSON_AddNumberToObject(c, "throttled",   cs.throttled);
+
+    cJSON *r = cJSON_AddObjectToObject(root, "reports");
+    cJSON_AddBoolToObject(r, "batched",       rs.batched);
+    cJSON_AddNumberToObject(r, "events",      rs.events);
+    cJSON_AddNumberToObject(r, "attrs",       rs.attrs);
+    cJSON_AddNumberToObject(r, "frames",      rs.frames);
+    cJSON_AddNumberToObject(r, "send_errors", rs.send_errors);
+
+    coordinator_fallback_tx_stats_t ts;
+    coordinator_fallback_get_tx_stats(&ts);
+    cJSON *t = cJSON_AddObjectToObject(root, "airtime");
+    cJSON_AddNumberToObject(t, "frames_hour", ts.frames_hour);
+    cJSON_AddNumberToObject(t, "ms_hour",     ts.airtime_ms_hour);
+    cJSON_AddNumberToObject(t, "frames",      ts.frames_total);
+    cJSON_AddNumberToObject(t, "ka_sent",     ts.ka_sent);
+    cJSON_AddNumberToObject(t, "ka_skipped",  ts.ka_skipped);
+
+    coordinator_fallback_rate_stats_t rl;
+    coordinator_fallback_get_rate_stats(&rl);
+    cJSON *l = cJSON_AddObjectToObject(root, "rate");
+    cJSON_AddNumberToObject(l, "throttled_occ", rl.throttled_occ);
+    cJSON_AddNumberToObject(l, "collapsed_occ", rl.collapsed_occ);
+    cJSON_AddNumberToObject(l, "exempt_occ",    rl.exempt_occ);
+    cJSON_AddNumberToObject(l, "tokens",        rl.tokens);
+
+    coordinator_fallback_link_stats_t ls;
+    coordinator_fallback_get_link_stats(&ls);
+    ack_ep_stats_t lt;
+    ack_stats_totals(&ls.ack, &lt);
+    cJSON *k = cJSON_AddObjectToObject(root, "link");
+    cJSON_AddNumberToObject(k, "samples",        ls.ack.samples);
+    cJSON_AddNumberToObject(k, "p50_ms",         ack_stats_percentile_ms(&ls.ack, 50));
+    cJSON_AddNumberToObject(k, "p99_ms",         ack_stats_percentile_ms(&ls.ack, 99));
+    cJSON_AddNumberToObject(k, "max_ms",         ls.ack.max_ms);
+    cJSON_AddNumberToObject(k, "srtt_ms",        ls.srtt_ms);
+    cJSON_AddNumberToObject(k, "sent",           lt.sent);
+    cJSON_AddNumberToObject(k, "retries",        lt.retries);
+    cJSON_AddNumberToObject(k, "failed",         lt.failed);
+    cJSON_AddNumberToObject(k, "soft_faults",    ls.ack.soft_faults);
+    cJSON_AddNumberToObject(k, "ack_timeout_ms", ls.ack_timeout_ms);
+    cJSON_AddNumberToObject(k, "suggest_ms",     ack_stats_suggest_timeout_ms(&ls.ack));
+    cJSON *h = cJSON_AddArrayToObject(k, "hist");
+    for (int b = 0; b < ACK_HIST_BUCKETS; b++) {
+        cJSON_AddItemToArray(h, cJSON_CreateNumber(ls.ack.hist[b]));
+    }
+
+    cJSON *p = cJSON_AddObjectToObject(root, "config_push");
+    cJSON_AddNumberToObject(p, "cycles",        ps.push_cycles);
+    cJSON_AddNumberToObject(p, "attrs_written", ps.attrs_written);
+    cJSON_AddNumberToObject(p, "attrs_skipped", ps.attrs_skipped);
+
+    add_sensor_cmd_status(cJSON_AddObjectToObject(root, "sensor_cmd"));
+    add_hw_filter(cJSON_AddObjectToObject(root, "hw_filter"));
+    add_sensor_health(cJSON_AddObjectToObject(root, "sensor_health"));
+
+    send_json(req, 200, root);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
 /* ================================================================== */
 /*  POST /api/config                                                   */
 /* ================================================================== */
@@ -108,6 +289,21 @@ static esp_err_t handle_post_config(httpd_req_t *req)
         send_json(req, 400, e); cJSON_Delete(e); return ESP_OK;
     }
 
+    /* Rules first: a bad rule rejects the whole request before anything is applied */
+    cJSON *rules = cJSON_GetObjectItem(root, "rules");
+    if (rules) {
+        char err[80];
+        if (config_api_set_rules(rules, err, sizeof(err)) == ESP_ERR_INVALID_ARG) {
+            cJSON_Delete(root);
+            cJSON *e = cJSON_CreateObject();
+            cJSON_AddStringToObject(e, "error", err);
+            send_json(req, 400, e); cJSON_Delete(e); return ESP_OK;
+        }
+    }
+
+    /* Sensor hardware fields (distance + angles) go out as one LD2450 session */
+    config_api_begin();
+
     cJSON *item;
 #define APPLY_NUM(key, fn, type) \
     if ((item = cJSON_GetObjectItem(root, key)) && cJSON_IsNumber(item)) \
@@ -117,13 +313,19 @@ static esp_err_t handle_post_config(httpd_req_t *req)
     APPLY_NUM("angle_left_deg",         config_api_set_angle_left,         uint8_t);
     APPLY_NUM("angle_right_deg",        config_api_set_angle_right,        uint8_t);
     APPLY_NUM("tracking_mode",          config_api_set_tracking_mode,      uint8_t);
+    APPLY_NUM("hw_filter_mode",         config_api_set_hw_filter_mode,     uint8_t);
     APPLY_NUM("publish_coords",         config_api_set_publish_coords,     uint8_t);
+    APPLY_NUM("coord_deadband_mm",      config_api_set_coord_deadband,     uint16_t);
+    APPLY_NUM("coord_min_interval_ms",  config_api_set_coord_min_interval, uint16_t);
     APPLY_NUM("fallback_mode",          config_api_set_fallback_mode,      uint8_t);
     APPLY_NUM("fallback_enable",        config_api_set_fallback_enable,    uint8_t);
     APPLY_NUM("hard_timeout_sec",       config_api_set_hard_timeout,       uint8_t);
     APPLY_NUM("ack_timeout_ms",         config_api_set_ack_timeout,        uint16_t);
     APPLY_NUM("heartbeat_enable",       config_api_set_heartbeat_enable,   uint8_t);
     APPLY_NUM("heartbeat_interval_sec", config_api_set_heartbeat_interval, uint16_t);
+    APPLY_NUM("zone_ep_reports",        config_api_set_zone_ep_reports,    uint8_t);
+    APPLY_NUM("rate_burst",             config_api_set_rate_burst,         uint8_t);
+    APPLY_NUM("rate_per_min",           config_api_set_rate_per_min,       uint16_t);
 
     if ((item = cJSON_GetObjectItem(root, "occupancy_cooldown_sec")) && cJSON_IsNumber(item))
         config_api_set_occupancy_cooldown(0, (uint16_t)item->valueint);
@@ -131,6 +333,8 @@ static esp_err_t handle_post_config(httpd_req_t *req)
         config_api_set_occupancy_delay(0, (uint16_t)item->valueint);
     if ((item = cJSON_GetObjectItem(root, "fallback_cooldown_sec")) && cJSON_IsNumber(item))
         config_api_set_fallback_cooldown(0, (uint16_t)item->valueint);
+    if ((item = cJSON_GetObjectItem(root, "fallback_group")) && cJSON_IsNumber(item))
+        config_api_set_fallback_group(0, (uint16_t)item->valueint);
 
 #undef APPLY_NUM
 
@@ -155,11 +359,13 @@ static esp_err_t handle_post_config(httpd_req_t *req)
             cJSON *fcool = cJSON_GetObjectItem(z, "fallback_cooldown_sec");
             if (fcool && cJSON_IsNumber(fcool))
                 config_api_set_fallback_cooldown((uint8_t)(i + 1), (uint16_t)fcool->valueint);
+            cJSON *fgrp = cJSON_GetObjectItem(z, "fallback_group");
+            if (fgrp && cJSON_IsNumber(fgrp))
+                config_api_set_fallback_group((uint8_t)(i + 1), (uint16_t)fgrp->valueint);
         }
     }
     cJSON_Delete(root);
-
-    sensor_bridge_mark_config_dirty();
+    config_api_commit();
 
     cJSON *resp = cJSON_CreateObject();
     cJSON_AddStringToObject(resp, "status", "ok");
@@ -244,7 +450,7 @@ static void ws_push_task(void *arg)
 }
 
 /* ================================================================== */
-/*  SSE — OTA status callback + serializer                            */
+/*  SSE — OTA / sensor command status callbacks + serializer          */
 /* ================================================================== */
 
 static void ota_status_cb(zigbee_ota_status_t status, uint8_t pct)
@@ -256,6 +462,12 @@ static void ota_status_cb(zigbee_ota_status_t status, uint8_t pct)
         web_server_base_sse_notify("ota");
 }
 
+static void sensor_cmd_status_cb(const ld2450_cmd_status_t *status)
+{
+    (void)status;
+    web_server_base_sse_notify("sensor_cmd");
+}
+
 static int ld2450_sse_serialize(const char *topic, char *buf, size_t buf_len)
 {
     cJSON *json = NULL;
@@ -269,6 +481,9 @@ static int ld2450_sse_serialize(const char *topic, char *buf, size_t buf_len)
         cJSON_AddStringToObject(json, "current",     plain);
         cJSON_AddStringToObject(json, "latest",      ota_check_latest_version());
         cJSON_AddBoolToObject  (json, "in_progress", zigbee_ota_is_in_progress());
+    } else if (strcmp(topic, "sensor_cmd") == 0) {
+        json = cJSON_CreateObject();
+        add_sensor_cmd_status(json);
     } else {
         return -1;
     }
@@ -308,13 +523,15 @@ esp_err_t web_server_start(void)
 
     web_server_base_register("/api/config",   HTTP_GET,  handle_get_config,  false);
     web_server_base_register("/api/config",   HTTP_POST, handle_post_config, false);
+    web_server_base_register("/api/stats",    HTTP_GET,  handle_get_stats,   false);
     web_server_base_register("/ws/targets",   HTTP_GET,  handle_ws_targets,  true);
 
     xTaskCreate(ws_push_task, "ws_push", 4096, NULL, 4, NULL);
 
-    static const char *const sse_topics[] = {"config", "ota", NULL};
+    static const char *const sse_topics[] = {"config", "ota", "sensor_cmd", NULL};
     web_server_base_sse_register("/api/events", sse_topics, ld2450_sse_serialize);
     zigbee_ota_register_status_callback(ota_status_cb);
+    ld2450_cmd_worker_set_status_cb(sensor_cmd_status_cb);
 
     return ESP_OK;
 }
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+#include <string.h>
+
+#include "zcl_batch.h"
+
+void zcl_batch_begin(zcl_batch_t *b, uint8_t ep, uint16_t cluster)
+{
+    b->ep      = ep;
+    b->cluster = cluster;
+    b->count   = 0;
+    b->used    = 0;
+}
+
+/* Drop record i and close the gap it leaves in data[] */
+static void remove_rec(zcl_batch_t *b, uint8_t i)
+{
+    zcl_batch_rec_t r = b->rec[i];
+    memmove(b->data + r.off, b->data + r.off + r.len, b->used - r.off - r.len);
+    b->used -= r.len;
+    for (uint8_t k = 0; k < b->count; k++) {
+        if (b->rec[k].off > r.off) b->rec[k].off -= r.len;
+    }
+    memmove(&b->rec[i], &b->rec[i + 1], (size_t)(b->count - i - 1) * sizeof(b->rec[0]));
+    b->count--;
+}
+
+bool zcl_batch_add(zcl_batch_t *b, uint16_t attr_id, uint8_t type,
+                   const void *val, uint8_t len)
+{
+    if (ZCL_BATCH_HEADER_LEN + ZCL_BATCH_RECORD_HDR + len > ZCL_BATCH_MAX_FRAME) return false;
+
+    for (uint8_t i = 0; i < b->count; i++) {
+        if (b->rec[i].attr_id != attr_id) continue;
+        if (b->rec[i].len == len) {
+            /* Same size: overwrite in place, keep staging order */
+            b->rec[i].type = type;
+            memcpy(b->data + b->rec[i].off, val, len);
+            return true;
+        }
+        remove_rec(b, i);
+        break;
+    }
+
+    if (b->count >= ZCL_BATCH_MAX_ATTRS || b->used + len > ZCL_BATCH_MAX_DATA) return false;
+
+    zcl_batch_rec_t *r = &b->rec[b->count++];
+    r->attr_id = attr_id;
+    r->type    = type;
+    r->len     = len;
+    r->off     = b->used;
+    memcpy(b->data + b->used, val, len);
+    b->used += len;
+    return true;
+}
+
+size_t zcl_batch_build_frame(const zcl_batch_t *b, uint8_t seq, uint8_t *next,
+                             uint8_t out[ZCL_BATCH_MAX_FRAME])
+{
+    if (*next >= b->count) return 0;
+
+    out[0] = ZCL_BATCH_FC_REPORT;
+    out[1] = seq;
+    out[2] = ZCL_BATCH_CMD_REPORT;
+    size_t pos = ZCL_BATCH_HEADER_LEN;
+
+    while (*next < b->count) {
+        const zcl_batch_rec_t *r = &b->rec[*next];
+        if (pos + ZCL_BATCH_RECORD_HDR + r->len > ZCL_BATCH_MAX_FRAME) break;
+        out[pos++] = (uint8_t)(r->attr_id & 0xFF);
+        out[pos++] = (uint8_t)(r->attr_id >> 8);
+        out[pos++] = r->type;
+        memcpy(out + pos, b->data + r->off, r->len);
+        pos += r->len;
+        (*next)++;
+    }
+    return pos;
+}
+
+uint8_t zcl_batch_frame_count(const zcl_batch_t *b)
+{
+    uint8_t frames = 0;
+    size_t pos = ZCL_BATCH_MAX_FRAME;   /* forces a new frame for the first record */
+    for (uint8_t i = 0; i < b->count; i++) {
+        size_t need = ZCL_BATCH_RECORD_HDR + b->rec[i].len;
+        if (pos + need > ZCL_BATCH_MAX_FRAME) {
+            frames++;
+            pos = ZCL_BATCH_HEADER_LEN;
+        }
+        pos += need;
+    }
+    return frames;
+}
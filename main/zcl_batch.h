@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per-cycle Report Attributes batching.
+ *
+ * One processing cycle stages every attribute change for one endpoint /
+ * cluster; a second write to the same attribute replaces the staged value.
+ * zcl_batch_build_frame() then packs the staged records into as few ZCL
+ * Report Attributes (0x0A) frames as fit the unfragmented APS payload:
+ *   [0] frame control  0x18 (profile-wide, server -> client, no default rsp)
+ *   [1] transaction sequence number
+ *   [2] command id     0x0A
+ *   then per attribute: uint16 attr id, uint8 ZCL type, value (ZCL encoding,
+ *   so strings carry their own length prefix)
+ * Records are emitted in staging order and never split across frames.
+ */
+
+#define ZCL_BATCH_MAX_ATTRS      8
+#define ZCL_BATCH_MAX_DATA       128    /* staged value bytes per cycle */
+#define ZCL_BATCH_MAX_FRAME      80     /* ZCL frame budget: unfragmented APS payload with NWK security */
+#define ZCL_BATCH_HEADER_LEN     3
+#define ZCL_BATCH_RECORD_HDR     3      /* attr id + type */
+
+#define ZCL_BATCH_FC_REPORT      0x18
+#define ZCL_BATCH_CMD_REPORT     0x0A
+
+typedef struct {
+    uint16_t attr_id;
+    uint8_t  type;
+    uint8_t  len;
+    uint8_t  off;         /* into data[] */
+} zcl_batch_rec_t;
+
+typedef struct {
+    uint8_t  ep;
+    uint16_t cluster;
+    uint8_t  count;
+    uint8_t  used;        /* bytes of data[] in use */
+    zcl_batch_rec_t rec[ZCL_BATCH_MAX_ATTRS];
+    uint8_t  data[ZCL_BATCH_MAX_DATA];
+} zcl_batch_t;
+
+/** Start a new cycle for ep/cluster, dropping anything staged. */
+void zcl_batch_begin(zcl_batch_t *b, uint8_t ep, uint16_t cluster);
+
+/**
+ * Stage one attribute value (already in ZCL encoding).  Replaces a value
+ * staged earlier in the cycle for the same attribute.  Returns false if the
+ * record can never fit a frame or the staging area is full; the caller then
+ * falls back to a per-attribute report.
+ */
+bool zcl_batch_add(zcl_batch_t *b, uint16_t attr_id, uint8_t type,
+                   const void *val, uint8_t len);
+
+/**
+ * Build the next frame starting at record *next (0 on the first call) and
+ * advance *next past the records packed.  Returns the frame length, or 0
+ * once every staged record has been emitted.  out must hold
+ * ZCL_BATCH_MAX_FRAME bytes.
+ */
+size_t zcl_batch_build_frame(const zcl_batch_t *b, uint8_t seq, uint8_t *next,
+                             uint8_t out[ZCL_BATCH_MAX_FRAME]);
+
+/** Frames zcl_batch_build_frame() will produce for the staged records. */
+uint8_t zcl_batch_frame_count(const zcl_batch_t *b);
+
+#ifdef __cplusplus
+}
+#endif
@@ -41,8 +41,14 @@ static esp_err_t handle_set_attr_value(const esp_zb_zcl_set_attr_value_message_t
             return config_api_set_angle_right(*(uint8_t *)val);
         case ZB_ATTR_TRACKING_MODE:
             return config_api_set_tracking_mode(*(uint8_t *)val);
+        case ZB_ATTR_HW_FILTER_MODE:
+            return config_api_set_hw_filter_mode(*(uint8_t *)val);
         case ZB_ATTR_COORD_PUBLISHING:
             return config_api_set_publish_coords(*(uint8_t *)val);
+        case ZB_ATTR_COORD_DEADBAND:
+            return config_api_set_coord_deadband(*(uint16_t *)val);
+        case ZB_ATTR_COORD_MIN_INTERVAL:
+            return config_api_set_coord_min_interval(*(uint16_t *)val);
         case ZB_ATTR_OCCUPANCY_COOLDOWN:
             return config_api_set_occupancy_cooldown(0, *(uint16_t *)val);
         case ZB_ATTR_OCCUPANCY_DELAY:
@@ -63,6 +69,12 @@ static esp_err_t handle_set_attr_value(const esp_zb_zcl_set_attr_value_message_t
             return config_api_set_hard_timeout(*(uint8_t *)val);
         case ZB_ATTR_ACK_TIMEOUT_MS:
             return config_api_set_ack_timeout(*(uint16_t *)val);
+        case ZB_ATTR_ZONE_EP_REPORTS:
+            return config_api_set_zone_ep_reports(*(uint8_t *)val);
+        case ZB_ATTR_RATE_BURST:
+            return config_api_set_rate_burst(*(uint8_t *)val);
+        case ZB_ATTR_RATE_SUSTAINED:
+            return config_api_set_rate_per_min(*(uint16_t *)val);
         case ZB_ATTR_DIAG_RESET:
             if (*(uint8_t *)val) crash_diag_reset_boot_count();
             return ESP_OK;
@@ -87,6 +99,14 @@ static esp_err_t handle_set_attr_value(const esp_zb_zcl_set_attr_value_message_t
         return config_api_set_fallback_cooldown((uint8_t)(zone_idx + 1), *(uint16_t *)val);
     }
 
+    /* EP1 fallback group attributes (0x0080 main, 0x0081-0x008A zones) on cluster 0xFC00 */
+    if (ep == ZB_EP_MAIN && cluster == ZB_CLUSTER_LD2450_CONFIG
+            && attr_id >= ZB_ATTR_FALLBACK_GROUP_BASE
+            && attr_id <= ZB_ATTR_FALLBACK_GROUP_BASE + 10) {
+        uint8_t ep_idx = (uint8_t)(attr_id - ZB_ATTR_FALLBACK_GROUP_BASE);
+        return config_api_set_fallback_group(ep_idx, *(uint16_t *)val);
+    }
+
     /* Zone EP config attributes on cluster 0xFC00 (EP2-EP11, one zone per EP) */
     if (ep >= ZB_EP_ZONE_BASE && ep < ZB_EP_ZONE_BASE + ZB_EP_ZONE_COUNT
             && cluster == ZB_CLUSTER_LD2450_CONFIG) {
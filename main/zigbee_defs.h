@@ -19,12 +19,19 @@
 
 /* ---- Attributes on ZB_CLUSTER_LD2450_CONFIG (EP 1) ---- */
 #define ZB_ATTR_TARGET_COUNT           0x0000  /* U8, read-only + reportable */
-#define ZB_ATTR_TARGET_COORDS          0x0001  /* CHAR_STRING, read-only + reportable */
+#define ZB_ATTR_TARGET_COORDS          0x0001  /* CHAR_STRING, read-only (legacy "x,y;x,y", no longer updated) */
+#define ZB_ATTR_ZONE_BITMAP            0x0002  /* U16, read-only + reportable (bit n = zone n+1 occupied) */
+#define ZB_ATTR_TARGET_DATA            0x0003  /* OCTET_STRING, read-only + reportable (packed targets, see coord_report.h) */
+#define ZB_ATTR_COORD_DEADBAND         0x0004  /* U16, read-write (0-1000 mm, target data dead-band) */
+#define ZB_ATTR_COORD_MIN_INTERVAL     0x0005  /* U16, read-write (0-10000 ms, min time between target data reports) */
+#define ZB_ATTR_OCC_EVENT_LOG          0x0006  /* OCTET_STRING, read-only + reportable (timestamped transitions, see occ_event_log.h) */
+#define ZB_ATTR_RATE_BURST             0x0007  /* U8,  read-write (1-100 reports, rate limiter bucket size) */
+#define ZB_ATTR_RATE_SUSTAINED         0x0008  /* U16, read-write (0-3000 reports/min, 0=unlimited) */
 #define ZB_ATTR_MAX_DISTANCE           0x0010  /* U16, read-write (0-6000 mm) */
 #define ZB_ATTR_ANGLE_LEFT             0x0011  /* U8, read-write (0-90 deg) */
 #define ZB_ATTR_ANGLE_RIGHT            0x0012  /* U8, read-write (0-90 deg) */
 #define ZB_ATTR_TRACKING_MODE          0x0020  /* U8, read-write (0=multi, 1=single) */
-#define ZB_ATTR_COORD_PUBLISHING       0x0021  /* U8, read-write (0=off, 1=on) */
+#define ZB_ATTR_COORD_PUBLISHING       0x0021  /* U8, read-write (0=off, 1=on, 2=adaptive) */
 #define ZB_ATTR_OCCUPANCY_COOLDOWN     0x0022  /* U16, read-write (0-300 seconds) */
 #define ZB_ATTR_OCCUPANCY_DELAY        0x0023  /* U16, read-write (0-65535 milliseconds) */
 
@@ -34,6 +41,10 @@
 #define ZB_ATTR_LAST_UPTIME_SEC        0x0032  /* U32, read-only (uptime before last reset) */
 #define ZB_ATTR_MIN_FREE_HEAP          0x0033  /* U32, read-only (min free heap since boot) */
 #define ZB_ATTR_DIAG_RESET             0x0034  /* U8, write-only (write non-zero to reset boot counter) */
+#define ZB_ATTR_THROTTLED_OCC          0x0035  /* U32, read-only + reportable (occupancy reports deferred by the rate limiter) */
+#define ZB_ATTR_THROTTLED_COORDS       0x0036  /* U32, read-only + reportable (target data frames held back by the rate limiter) */
+#define ZB_ATTR_LINK_STATS             0x0037  /* OCTET_STRING, read-only + reportable (ACK latency histogram, retries, soft faults, see ack_stats.h) */
+#define ZB_ATTR_SENSOR_CMD_STATUS      0x0038  /* U8, read-only + reportable (sensor command worker: 0=idle, 1=busy, 2=failed) */
 
 /* ZB_ATTR_RESTART (0x00F0) and ZB_ATTR_FACTORY_RESET (0x00F1) defined in zigbee_ctrl.h */
 
@@ -61,7 +72,10 @@
 #define ZB_ATTR_SOFT_FAULT                 0x002A  /* U8,  R+Report   soft fault counter (firmware-only write; HA observes) */
 #define ZB_ATTR_HARD_TIMEOUT_SEC           0x002B  /* U8,  RW         seconds from first soft fault → hard fallback (default: 10) */
 #define ZB_ATTR_ACK_TIMEOUT_MS             0x002C  /* U16, RW         APS ACK timeout in ms (default: 2000) */
+#define ZB_ATTR_ZONE_EP_REPORTS            0x002D  /* U8,  RW         1=per-zone Occupancy reports on EP2-11 (default), 0=zone bitmap only */
+#define ZB_ATTR_HW_FILTER_MODE             0x002E  /* U8,  RW         sensor zone filter: 0=distance/angle only (default), 1=zones' bounding boxes */
 #define ZB_ATTR_FALLBACK_ZONE_COOL_BASE    0x0070  /* U16, RW         zone N cooldown: base + zone_index (0-9) → 0x0070-0x0079 */
+#define ZB_ATTR_FALLBACK_GROUP_BASE        0x0080  /* U16, RW         fallback group: base + ep_index (0=main, 1-10=zones) → 0x0080-0x008A; 0=bindings */
 
 /* ---- Identity strings ---- */
 #define ZB_MANUFACTURER_NAME           "\x07""LD2450Z"   /* ZCL string: len byte + chars */
@@ -13,7 +13,10 @@
 
 /* Project */
 #include "board_config.h"
+#include "ack_stats.h"
 #include "board_led.h"
+#include "coord_report.h"
+#include "occ_event_log.h"
 #include "coordinator_fallback.h"
 #include "crash_diag.h"
 #include "ld2450_zone_csv.h"
@@ -90,6 +93,38 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
         ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
         empty_str);
 
+    static uint16_t s_zone_bitmap_attr = 0;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_ZONE_BITMAP,
+        ESP_ZB_ZCL_ATTR_TYPE_U16,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_zone_bitmap_attr);
+
+    /* Packed target data: full-length all-zero value (no targets) so ZBoss
+     * sizes the attribute storage for the fixed 19-byte payload */
+    static uint8_t s_target_data_attr[1 + COORD_REPORT_PAYLOAD_LEN] = { COORD_REPORT_PAYLOAD_LEN };
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_TARGET_DATA,
+        ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        s_target_data_attr);
+
+    /* Occupancy event log: fixed-length payload, empty log */
+    static uint8_t s_occ_event_log_attr[1 + OCC_EVENT_LOG_PAYLOAD_LEN] = { OCC_EVENT_LOG_PAYLOAD_LEN };
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_OCC_EVENT_LOG,
+        ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        s_occ_event_log_attr);
+
+    uint16_t init_coord_db = cfg.coord_deadband_mm;
+    uint16_t init_coord_min = cfg.coord_min_interval_ms;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_COORD_DEADBAND,
+        ESP_ZB_ZCL_ATTR_TYPE_U16,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &init_coord_db);
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_COORD_MIN_INTERVAL,
+        ESP_ZB_ZCL_ATTR_TYPE_U16,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &init_coord_min);
+
     esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_MAX_DISTANCE,
         ESP_ZB_ZCL_ATTR_TYPE_U16,
         ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
@@ -110,6 +145,14 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
         ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
         &init_mode);
 
+    /* Sensor zone filter planning (0x002E): range only / zones */
+    static uint8_t s_hw_filter_mode = 0;
+    s_hw_filter_mode = cfg.hw_filter_mode;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_HW_FILTER_MODE,
+        ESP_ZB_ZCL_ATTR_TYPE_U8,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_hw_filter_mode);
+
     esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_COORD_PUBLISHING,
         ESP_ZB_ZCL_ATTR_TYPE_U8,
         ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
@@ -149,6 +192,31 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
         ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
         &diag.min_free_heap);
 
+    /* Rate limiter counters: start at 0 every boot */
+    static uint32_t s_throttled_occ_attr = 0;
+    static uint32_t s_throttled_coords_attr = 0;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_THROTTLED_OCC,
+        ESP_ZB_ZCL_ATTR_TYPE_U32,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_throttled_occ_attr);
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_THROTTLED_COORDS,
+        ESP_ZB_ZCL_ATTR_TYPE_U32,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_throttled_coords_attr);
+
+    /* Link statistics: fixed-length payload, no samples yet */
+    static uint8_t s_link_stats_attr[1 + ACK_STATS_PAYLOAD_LEN] = { ACK_STATS_PAYLOAD_LEN, ACK_STATS_VERSION };
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_LINK_STATS,
+        ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        s_link_stats_attr);
+
+    static uint8_t s_sensor_cmd_status_attr = 0;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_SENSOR_CMD_STATUS,
+        ESP_ZB_ZCL_ATTR_TYPE_U8,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_sensor_cmd_status_attr);
+
     static uint8_t s_diag_reset_attr = 0;
     esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_DIAG_RESET,
         ESP_ZB_ZCL_ATTR_TYPE_U8,
@@ -227,6 +295,28 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
         ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
         &s_ack_to_ms);
 
+    /* Zone reporting mode (0x002D): per-zone EP reports on/off */
+    static uint8_t s_zone_ep_reports = 1;
+    s_zone_ep_reports = cfg.zone_ep_reports;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_ZONE_EP_REPORTS,
+        ESP_ZB_ZCL_ATTR_TYPE_U8,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_zone_ep_reports);
+
+    /* Report rate limiter */
+    static uint8_t  s_rate_burst = 20;
+    static uint16_t s_rate_per_min = 600;
+    s_rate_burst   = cfg.rate_burst;
+    s_rate_per_min = cfg.rate_per_min;
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_RATE_BURST,
+        ESP_ZB_ZCL_ATTR_TYPE_U8,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_rate_burst);
+    esp_zb_custom_cluster_add_custom_attr(custom, ZB_ATTR_RATE_SUSTAINED,
+        ESP_ZB_ZCL_ATTR_TYPE_U16,
+        ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+        &s_rate_per_min);
+
     /* Fallback cooldown attributes (0x0025 = main, 0x0070-0x0079 = zones) */
     static uint16_t s_fb_cool_main = 300;
     static uint16_t s_fb_cool_zone[10] = {300, 300, 300, 300, 300, 300, 300, 300, 300, 300};
@@ -250,6 +340,17 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
             &s_fb_cool_zone[n]);
     }
 
+    /* Fallback group attributes (0x0080 = main, 0x0081-0x008A = zones; 0 = bindings) */
+    static uint16_t s_fb_group[11];
+    memcpy(s_fb_group, cfg.fallback_group, sizeof(s_fb_group));
+    for (int n = 0; n < 11; n++) {
+        esp_zb_custom_cluster_add_custom_attr(custom,
+            ZB_ATTR_FALLBACK_GROUP_BASE + n,
+            ESP_ZB_ZCL_ATTR_TYPE_U16,
+            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+            &s_fb_group[n]);
+    }
+
     /* Assemble cluster list */
     esp_zb_cluster_list_t *cl = esp_zb_zcl_cluster_list_create();
     ESP_ERROR_CHECK(esp_zb_cluster_list_add_basic_cluster(cl, basic, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
@@ -263,6 +364,13 @@ static esp_zb_cluster_list_t *create_main_ep_clusters(void)
     esp_zb_attribute_list_t *on_off_client = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF);
     ESP_ERROR_CHECK(esp_zb_cluster_list_add_on_off_cluster(cl, on_off_client, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE));
 
+    /* Level Control and Scenes CLIENT clusters — targets for local rule
+     * commands (level to bindings/groups, scene recall to groups). */
+    esp_zb_attribute_list_t *level_client = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_level_cluster(cl, level_client, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE));
+    esp_zb_attribute_list_t *scenes_client = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_SCENES);
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_scenes_cluster(cl, scenes_client, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE));
+
     /* Add OTA cluster */
     zigbee_ota_config_t ota_cfg = ZIGBEE_OTA_CONFIG_DEFAULT();
     ota_cfg.manufacturer_code = 0x131B;  /* Espressif */
@@ -383,6 +491,10 @@ static esp_zb_cluster_list_t *create_zone_ep_clusters(int zone_idx)
     esp_zb_attribute_list_t *on_off_client = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF);
     ESP_ERROR_CHECK(esp_zb_cluster_list_add_on_off_cluster(cl, on_off_client, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE));
 
+    /* Level Control CLIENT — local rules with "ep N" send levels to its bindings */
+    esp_zb_attribute_list_t *level_client = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_level_cluster(cl, level_client, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE));
+
     return cl;
 }
 
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+//
+// Assertion harness shared by the host tests in this directory.
+//
+// CHECK(cond, fmt, ...) records a failure and prints where it happened (the
+// first CHECK_PRINT_LIMIT failures only, so a broken invariant inside a long
+// simulation does not flood the log).  main() ends with
+// `return check_result("<module>");`, which prints the PASS / FAIL line that
+// `make -C tools/host_test check` reports.
+#pragma once
+#include <stdio.h>
+
+#define CHECK_PRINT_LIMIT 20
+
+static int g_failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        if (g_failures < CHECK_PRINT_LIMIT) { \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+        } \
+        g_failures++; \
+    } \
+} while (0)
+
+/** Print the verdict for name; returns the process exit status. */
+static inline int check_result(const char *name)
+{
+    if (g_failures) {
+        fprintf(stderr, "FAIL: %s (%d check(s) failed)\n", name, g_failures);
+        return 1;
+    }
+    printf("PASS: %s\n", name);
+    return 0;
+}
@@ -0,0 +1,4 @@
+// SPDX-License-Identifier: MIT
+// Host stub (see README.md): everything is declared in esp_zigbee_core.h
+#pragma once
+#include "esp_zigbee_core.h"
@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of the shared crash_diag component header (see README.md)
+#pragma once
+#include <stdint.h>
+
+void crash_diag_update_uptime(uint32_t uptime_sec);
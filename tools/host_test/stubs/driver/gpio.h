@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: MIT
+// Host stub of driver/gpio.h (see README.md): no pins on the host
+#pragma once
+#include "esp_bit_defs.h"
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC   (-1)
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+// Host stub of driver/uart.h (see README.md): the port type ld2450.h needs,
+// the byte I/O ld2450_cmd.c and the ld2450.c RX task use, and the driver
+// setup ld2450_init() refers to.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"     /* as in ESP-IDF; ld2450.c relies on it */
+
+typedef int uart_port_t;
+
+#define UART_NUM_0          0
+#define UART_NUM_1          1
+#define UART_NUM_MAX        3
+#define UART_PIN_NO_CHANGE  (-1)
+
+typedef enum { UART_DATA_5_BITS, UART_DATA_6_BITS, UART_DATA_7_BITS, UART_DATA_8_BITS } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE, UART_PARITY_EVEN = 2, UART_PARITY_ODD } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 1, UART_STOP_BITS_1_5, UART_STOP_BITS_2 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE, UART_HW_FLOWCTRL_RTS, UART_HW_FLOWCTRL_CTS,
+               UART_HW_FLOWCTRL_CTS_RTS } uart_hw_flowcontrol_t;
+typedef enum { UART_SCLK_DEFAULT } uart_sclk_t;
+
+typedef struct {
+    int                   baud_rate;
+    uart_word_length_t    data_bits;
+    uart_parity_t         parity;
+    uart_stop_bits_t      stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t               rx_flow_ctrl_thresh;
+    uart_sclk_t           source_clk;
+} uart_config_t;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags);
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config);
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num);
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size);
+
+/* ESP-IDF semantics: returns once length bytes are in, or when no further
+ * bytes arrive within ticks_to_wait of the previous ones. */
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait);
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
+int uart_flush_input(uart_port_t uart_num);
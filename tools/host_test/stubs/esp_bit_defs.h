@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of esp_bit_defs.h (see README.md)
+#pragma once
+
+#define BIT1    0x00000002
+#define BIT0    0x00000001
@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of esp_heap_caps.h (see README.md)
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_get_minimum_free_heap_size(void);
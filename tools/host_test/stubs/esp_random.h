@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of esp_random.h (see README.md)
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_random(void);
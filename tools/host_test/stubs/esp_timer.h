@@ -0,0 +1,7 @@
+// SPDX-License-Identifier: MIT
+// Host stub of esp_timer.h (see README.md)
+#pragma once
+#include <stdint.h>
+
+/** Microseconds since boot (the harness's virtual clock). */
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: MIT
+// Host stub of esp_zigbee_core.h and the zcl/aps headers it pulls in (see
+// README.md).  Only what the firmware modules under test use.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+/* ---- Scheduler ---- */
+
+typedef void (*esp_zb_callback_t)(uint8_t param);
+
+/** Run cb(param) after time_ms.  The same (cb, param) may be pending more than once. */
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time_ms);
+
+/** Cancel every pending alarm for (cb, param). */
+void esp_zb_scheduler_alarm_cancel(esp_zb_callback_t cb, uint8_t param);
+
+/* ---- Addressing ---- */
+
+typedef enum {
+    ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT = 0x00,
+    ESP_ZB_APS_ADDR_MODE_16_GROUP_ENDP_NOT_PRESENT = 0x01,
+    ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT           = 0x02,
+    ESP_ZB_APS_ADDR_MODE_64_ENDP_PRESENT           = 0x03,
+} esp_zb_aps_address_mode_t;
+
+typedef union {
+    uint16_t addr_short;
+    uint8_t  addr_long[8];
+} esp_zb_addr_u;
+
+typedef struct {
+    esp_zb_addr_u dst_addr_u;
+    uint8_t       dst_endpoint;
+    uint8_t       src_endpoint;
+} esp_zb_zcl_basic_cmd_t;
+
+/* ---- ZCL ids ---- */
+
+#define ESP_ZB_ZCL_CLUSTER_SERVER_ROLE                   0x01
+#define ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE                   0x02
+#define ESP_ZB_ZCL_CLUSTER_ID_SCENES                     0x0005
+#define ESP_ZB_ZCL_CLUSTER_ID_ON_OFF                     0x0006
+#define ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL              0x0008
+#define ESP_ZB_ZCL_CLUSTER_ID_OCCUPANCY_SENSING          0x0406
+#define ESP_ZB_ZCL_ATTR_OCCUPANCY_SENSING_OCCUPANCY_ID   0x0000
+#define ESP_ZB_ZCL_CMD_DIRECTION_TO_SRV                  0x00
+#define ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI                  0x01
+#define ESP_ZB_ZCL_CMD_ON_OFF_OFF_ID                     0x00
+#define ESP_ZB_ZCL_CMD_ON_OFF_ON_ID                      0x01
+#define ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID                  0x02
+
+#define ESP_ZB_AF_HA_PROFILE_ID                          0x0104
+#define ESP_ZB_ZCL_ATTR_NON_MANUFACTURER_SPECIFIC        0xFFFF
+#define ESP_ZB_ZCL_ATTR_TYPE_U8                          0x20
+#define ESP_ZB_ZCL_ATTR_TYPE_U16                         0x21
+#define ESP_ZB_ZCL_ATTR_TYPE_U32                         0x23
+#define ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING                0x41
+
+typedef uint8_t esp_zb_zcl_status_t;
+
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id,
+                                                 uint8_t cluster_role, uint16_t attr_id,
+                                                 void *value_p, bool check);
+
+/* ---- Reporting ---- */
+
+#define ESP_ZB_ZCL_REPORT_DIRECTION_SEND 0x00
+
+typedef struct {
+    uint8_t  direction;
+    uint8_t  ep;
+    uint16_t cluster_id;
+    uint8_t  cluster_role;
+    uint16_t attr_id;
+    union {
+        struct {
+            uint16_t min_interval;
+            uint16_t max_interval;
+            uint16_t def_min_interval;
+            uint16_t def_max_interval;
+            union {
+                uint32_t u32;
+            } delta;
+        } send_info;
+    } u;
+    struct {
+        uint16_t profile_id;
+    } dst;
+    uint16_t manuf_code;
+} esp_zb_zcl_reporting_info_t;
+
+esp_err_t esp_zb_zcl_update_reporting_info(esp_zb_zcl_reporting_info_t *report_info);
+esp_err_t esp_zb_zcl_stop_attr_reporting(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id);
+
+/* ---- Commands ---- */
+
+typedef struct {
+    esp_zb_zcl_basic_cmd_t    zcl_basic_cmd;
+    esp_zb_aps_address_mode_t address_mode;
+    uint16_t clusterID;
+    uint16_t attributeID;
+    uint8_t  direction;
+    uint8_t  dis_default_resp;
+    uint8_t  manuf_specific;
+    uint16_t manuf_code;
+} esp_zb_zcl_report_attr_cmd_t;
+
+typedef struct {
+    esp_zb_zcl_basic_cmd_t    zcl_basic_cmd;
+    esp_zb_aps_address_mode_t address_mode;
+    uint8_t on_off_cmd_id;
+} esp_zb_zcl_on_off_cmd_t;
+
+typedef struct {
+    esp_zb_zcl_basic_cmd_t    zcl_basic_cmd;
+    esp_zb_aps_address_mode_t address_mode;
+    uint8_t  level;
+    uint16_t transition_time;
+} esp_zb_zcl_move_to_level_cmd_t;
+
+typedef struct {
+    esp_zb_zcl_basic_cmd_t    zcl_basic_cmd;
+    esp_zb_aps_address_mode_t address_mode;
+    uint16_t group_id;
+    uint8_t  scene_id;
+} esp_zb_zcl_scenes_recall_scene_cmd_t;
+
+esp_err_t esp_zb_zcl_report_attr_cmd_req(esp_zb_zcl_report_attr_cmd_t *cmd_req);
+uint8_t   esp_zb_zcl_on_off_cmd_req(esp_zb_zcl_on_off_cmd_t *cmd_req);
+uint8_t   esp_zb_zcl_level_move_to_level_with_onoff_cmd_req(esp_zb_zcl_move_to_level_cmd_t *cmd_req);
+uint8_t   esp_zb_zcl_scenes_recall_scene_cmd_req(esp_zb_zcl_scenes_recall_scene_cmd_t *cmd_req);
+
+/* ---- Send status (APS ACK / failure of an outgoing command) ---- */
+
+#define ESP_ZB_ZCL_ADDR_TYPE_SHORT 0
+
+typedef struct {
+    uint8_t addr_type;
+    union {
+        uint16_t short_addr;
+        uint16_t src_id;
+        uint8_t  ieee_addr[8];
+    } u;
+} esp_zb_zcl_addr_t;
+
+typedef struct {
+    esp_err_t         status;
+    uint8_t           tsn;
+    esp_zb_zcl_addr_t dst_addr;
+    uint8_t           dst_endpoint;
+    uint8_t           src_endpoint;
+} esp_zb_zcl_command_send_status_message_t;
+
+typedef void (*esp_zb_zcl_command_send_status_callback_t)(esp_zb_zcl_command_send_status_message_t message);
+
+void esp_zb_zcl_command_send_status_handler_register(esp_zb_zcl_command_send_status_callback_t cb);
+
+/* ---- APS data ---- */
+
+#define ESP_ZB_APSDE_TX_OPT_ACK_TX 0x04
+
+typedef struct {
+    uint8_t       dst_addr_mode;
+    esp_zb_addr_u dst_addr;
+    uint8_t       dst_endpoint;
+    uint16_t      profile_id;
+    uint16_t      cluster_id;
+    uint8_t       src_endpoint;
+    uint32_t      asdu_length;
+    uint8_t      *asdu;
+    uint8_t       tx_options;
+    bool          use_alias;
+    esp_zb_addr_u alias_src_addr;
+    int           alias_seq_num;
+    uint8_t       radius;
+} esp_zb_apsde_data_req_t;
+
+esp_err_t esp_zb_aps_data_request(esp_zb_apsde_data_req_t *req);
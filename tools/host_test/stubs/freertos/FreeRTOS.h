@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+// Host stub of freertos/FreeRTOS.h (see README.md): one tick per
+// millisecond, single-threaded harnesses, so critical sections are no-ops.
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+
+#define pdFALSE               0
+#define pdTRUE                1
+#define pdPASS                pdTRUE
+#define portMAX_DELAY         ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms)     ((TickType_t)(ms))
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED  0
+#define portENTER_CRITICAL(mux)       ((void)(mux))
+#define portEXIT_CRITICAL(mux)        ((void)(mux))
@@ -0,0 +1,5 @@
+// SPDX-License-Identifier: MIT
+// Host stub of freertos/portmacro.h (see README.md): the port macros live
+// in FreeRTOS.h here
+#pragma once
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of freertos/queue.h (see README.md): the handle type only
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MIT
+// Host stub of freertos/semphr.h (see README.md)
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"     /* reached through queue.h in FreeRTOS */
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
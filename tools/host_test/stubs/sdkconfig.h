@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of the generated sdkconfig.h (see README.md): the project
+// options the modules under test read, at their Kconfig defaults
+#pragma once
+
+#define CONFIG_LD2450_ZCL_REPORT_BATCHING 1
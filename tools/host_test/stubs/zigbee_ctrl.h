@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Host stub of the zigbee_ctrl component header (see README.md)
+#pragma once
+
+#define ZB_ATTR_RESTART          0x00F0
+#define ZB_ATTR_FACTORY_RESET    0x00F1
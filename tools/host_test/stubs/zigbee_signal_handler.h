@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: MIT
+// Host stub of the shared zigbee_signal_handler component header (see
+// README.md)
+#pragma once
+#include <stdbool.h>
+
+#include "esp_zigbee_core.h"
+
+/** True once the device has joined (or rejoined) a network. */
+bool zigbee_is_network_joined(void);
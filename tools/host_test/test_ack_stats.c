@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/ack_stats.c
+//
+// Build: make -C tools/host_test build/test_ack_stats
+// Run:   tools/host_test/build/test_ack_stats [reports]
+//
+// Checks the bucket edges, percentiles, the suggested ACK timeout, the
+// per-endpoint counters and the packed attribute layout, then measures a
+// one-hop and a multi-hop link: the suggested timeout is learned from the
+// first 500 ACKs and compared with the fixed 2000 ms default on the rest,
+// counting ACKs that would arrive after the timeout (false soft faults) and
+// how long a dead coordinator takes to detect.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ack_stats.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* ---- Directed tests ---- */
+
+static void test_buckets(void)
+{
+    static const struct { uint32_t ms; uint8_t b; } cases[] = {
+        {0, 0}, {24, 0}, {25, 1}, {49, 1}, {50, 2}, {99, 2}, {100, 3},
+        {799, 5}, {800, 6}, {3199, 7}, {3200, 8}, {6399, 8}, {6400, 9},
+        {60000, 9}, {UINT32_MAX, 9},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        CHECK(ack_stats_bucket(cases[i].ms) == cases[i].b, "%u ms in bucket %u, want %u",
+              cases[i].ms, ack_stats_bucket(cases[i].ms), cases[i].b);
+    }
+    CHECK(ack_stats_bucket_edge_ms(0) == 25, "edge 0");
+    CHECK(ack_stats_bucket_edge_ms(8) == 6400, "edge 8");
+    CHECK(ack_stats_bucket_edge_ms(200) == ack_stats_bucket_edge_ms(ACK_HIST_BUCKETS - 1), "edge clamp");
+}
+
+static void test_percentiles(void)
+{
+    ack_stats_t s;
+    ack_stats_init(&s);
+    CHECK(ack_stats_percentile_ms(&s, 50) == 0, "empty p50");
+    CHECK(ack_stats_suggest_timeout_ms(&s) == 0, "empty suggestion");
+
+    for (int i = 0; i < 99; i++) ack_stats_acked(&s, 0, 30);
+    ack_stats_acked(&s, 0, 3000);
+    CHECK(ack_stats_percentile_ms(&s, 50) == 50, "p50 %u", ack_stats_percentile_ms(&s, 50));
+    CHECK(ack_stats_percentile_ms(&s, 99) == 50, "p99 %u", ack_stats_percentile_ms(&s, 99));
+    CHECK(ack_stats_percentile_ms(&s, 100) == 3200, "p100 %u", ack_stats_percentile_ms(&s, 100));
+    CHECK(s.max_ms == 3000, "max %u", s.max_ms);
+
+    /* Fast link: suggestion clamps to the floor */
+    CHECK(ack_stats_suggest_timeout_ms(&s) == ACK_TIMEOUT_MIN_MS, "fast suggestion %u",
+          ack_stats_suggest_timeout_ms(&s));
+
+    /* Too few samples: nothing suggested */
+    ack_stats_init(&s);
+    for (int i = 0; i < ACK_STATS_MIN_SAMPLES - 1; i++) ack_stats_acked(&s, 0, 700);
+    CHECK(ack_stats_suggest_timeout_ms(&s) == 0, "suggested from %u samples", s.samples);
+    ack_stats_acked(&s, 0, 700);
+    CHECK(ack_stats_suggest_timeout_ms(&s) == 1600, "suggestion %u", ack_stats_suggest_timeout_ms(&s));
+
+    /* Very slow link: clamps to the ceiling */
+    for (int i = 0; i < 100; i++) ack_stats_acked(&s, 0, 9000);
+    CHECK(ack_stats_suggest_timeout_ms(&s) == ACK_TIMEOUT_MAX_MS, "slow suggestion %u",
+          ack_stats_suggest_timeout_ms(&s));
+}
+
+static void test_counters(void)
+{
+    ack_stats_t s;
+    ack_stats_init(&s);
+    for (int i = 0; i < 1000; i++) ack_stats_sent(&s, 3);
+    for (int i = 0; i < 40; i++) ack_stats_retry(&s, 3);
+    for (int i = 0; i < 7; i++) ack_stats_failed(&s, 3);
+    ack_stats_sent(&s, ACK_STATS_EPS);          /* out of range: ignored */
+    ack_stats_acked(&s, ACK_STATS_EPS, 10);
+    ack_stats_soft_fault(&s);
+
+    ack_ep_stats_t t;
+    ack_stats_totals(&s, &t);
+    CHECK(t.sent == 1000 && t.retries == 40 && t.failed == 7, "totals %u/%u/%u",
+          t.sent, t.retries, t.failed);
+    CHECK(s.samples == 0, "out-of-range ACK counted");
+    CHECK(ack_stats_fail_permille(&s) == 7, "permille %u", ack_stats_fail_permille(&s));
+    CHECK(s.soft_faults == 1, "soft faults %u", s.soft_faults);
+}
+
+static void test_pack(void)
+{
+    ack_stats_t s;
+    ack_stats_init(&s);
+    for (int i = 0; i < 60; i++) ack_stats_acked(&s, 0, 30);
+    for (int i = 0; i < 300; i++) ack_stats_retry(&s, 10);
+    for (int i = 0; i < 5; i++) ack_stats_failed(&s, 1);
+    for (int i = 0; i < 1000; i++) ack_stats_sent(&s, 1);
+    ack_stats_soft_fault(&s);
+    ack_stats_soft_fault(&s);
+
+    uint8_t p[ACK_STATS_PAYLOAD_LEN];
+    memset(p, 0xAA, sizeof(p));
+    ack_stats_pack(&s, 33, p);
+    CHECK(ACK_STATS_PAYLOAD_LEN == 51, "payload len %d", ACK_STATS_PAYLOAD_LEN);
+    CHECK(p[0] == ACK_STATS_VERSION, "version %u", p[0]);
+    CHECK(rd16(p + 1) == 0 && rd16(p + 3) == 60, "hist %u %u", rd16(p + 1), rd16(p + 3));
+    CHECK(rd16(p + 21) == 33, "srtt %u", rd16(p + 21));
+    CHECK(rd16(p + 23) == ACK_TIMEOUT_MIN_MS, "suggest %u", rd16(p + 23));
+    CHECK(rd16(p + 25) == 2, "soft faults %u", rd16(p + 25));
+    CHECK(rd16(p + 27) == 5, "permille %u", rd16(p + 27));
+    CHECK(p[29 + 10] == 255, "retries saturate %u", p[29 + 10]);
+    CHECK(p[29 + 0] == 0, "ep1 retries %u", p[29]);
+    CHECK(p[40 + 1] == 5, "ep2 failed %u", p[40 + 1]);
+    CHECK(p[50] == 0, "ep11 failed %u", p[50]);
+
+    /* Counts past 65535 are scaled together, keeping the shape */
+    s.hist[1] = 200000;
+    s.hist[3] = 1000;
+    ack_stats_pack(&s, 0, p);
+    CHECK(rd16(p + 3) == 50000 && rd16(p + 7) == 250, "scaled %u %u", rd16(p + 3), rd16(p + 7));
+}
+
+/* ---- One-hop vs multi-hop link ---- */
+
+/* Send -> APS ACK latency in ms.  One hop: the coordinator is in range, with
+ * an occasional MAC retry.  Multi hop: three routers on a busy mesh, with
+ * route repairs now and then. */
+static uint32_t one_hop_ms(void)
+{
+    uint32_t ms = 15 + rnd() % 40;
+    if (rnd() % 100 < 2) ms += rnd() % 200;
+    return ms;
+}
+
+static uint32_t multi_hop_ms(void)
+{
+    uint32_t ms = 120 + rnd() % 400;
+    if (rnd() % 100 < 5) ms += rnd() % 2500;
+    return ms;
+}
+
+#define FIXED_TIMEOUT_MS   2000
+#define LEARN_REPORTS      500
+
+static void run_link(const char *name, uint32_t (*latency)(void), uint32_t reports,
+                     uint32_t *suggest_out, uint32_t *late_fixed, uint32_t *late_suggest)
+{
+    ack_stats_t s;
+    ack_stats_init(&s);
+    for (uint32_t i = 0; i < LEARN_REPORTS; i++) {
+        ack_stats_sent(&s, 0);
+        ack_stats_acked(&s, 0, latency());
+    }
+    uint32_t suggest = ack_stats_suggest_timeout_ms(&s);
+
+    *late_fixed = *late_suggest = 0;
+    for (uint32_t i = 0; i < reports; i++) {
+        uint32_t ms = latency();
+        if (ms >= FIXED_TIMEOUT_MS) (*late_fixed)++;
+        if (ms >= suggest) (*late_suggest)++;
+        ack_stats_acked(&s, 0, ms);
+    }
+    *suggest_out = suggest;
+
+    printf("  %-10s p50 <%5u  p99 <%5u  max %5u  %7u ms %10u %8u ms %10u\n", name,
+           ack_stats_percentile_ms(&s, 50), ack_stats_percentile_ms(&s, 99), s.max_ms,
+           FIXED_TIMEOUT_MS, *late_fixed, suggest, *late_suggest);
+}
+
+static void test_links(uint32_t reports)
+{
+    printf("link: timeout learned from %u ACKs, evaluated on %u reports\n", LEARN_REPORTS, reports);
+    printf("  %-10s %-36s %10s %10s %11s %10s\n", "link", "latency (ms)", "fixed", "late",
+           "suggested", "late");
+
+    uint32_t s1, f1, l1, s2, f2, l2;
+    run_link("one hop", one_hop_ms, reports, &s1, &f1, &l1);
+    run_link("multi hop", multi_hop_ms, reports, &s2, &f2, &l2);
+
+    printf("  dead coordinator detected after %u ms (one hop) / %u ms (multi hop) "
+           "instead of %u ms\n", s1, s2, FIXED_TIMEOUT_MS);
+
+    CHECK(s1 > 0 && s1 < FIXED_TIMEOUT_MS, "one-hop suggestion %u", s1);
+    CHECK(l1 * 1000 <= reports, "one hop: %u late of %u at %u ms", l1, reports, s1);
+    CHECK(s2 > FIXED_TIMEOUT_MS, "multi-hop suggestion %u", s2);
+    CHECK(l2 < f2, "multi hop: suggested %u late vs fixed %u", l2, f2);
+    CHECK(l2 * 1000 <= reports * 2, "multi hop: %u late of %u at %u ms", l2, reports, s2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t reports = 20000;
+    if (argc > 1) reports = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_buckets();
+    test_percentiles();
+    test_counters();
+    test_pack();
+    test_links(reports);
+
+    return check_result("ack_stats");
+}
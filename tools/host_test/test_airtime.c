@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/airtime.c
+//
+// Build: make -C tools/host_test build/test_airtime
+// Run:   tools/host_test/build/test_airtime [devices]
+//
+// Checks the per-frame airtime estimate, the rolling one-hour window and the
+// jittered period, then simulates a room full of sensors powered up by the
+// same breaker and compares their keep-alive traffic: the previous burst of
+// 11 occupancy reports every 5 minutes from boot vs. one randomly phased,
+// jittered EP1 refresh (skipped after recent activity) plus the packed zone
+// bitmap frame.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "airtime.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+#define OCC_REPORT_ZCL_LEN   7     /* coordinator_fallback.c */
+#define BITMAP_KA_ZCL_LEN    12    /* batched count + zone bitmap frame */
+
+/* ---- Directed tests ---- */
+
+static void test_frame_estimate(void)
+{
+    /* 7-byte occupancy report: 58 bytes on air + ACK */
+    CHECK(airtime_frame_us(OCC_REPORT_ZCL_LEN) == 58 * 32 + AIRTIME_ACK_US,
+          "occ report %u us", airtime_frame_us(OCC_REPORT_ZCL_LEN));
+    /* Largest unfragmented frame stays under the 127-byte PSDU + SHR/PHR */
+    CHECK(AIRTIME_FRAME_OVERHEAD + 80 <= 127 + 6, "80-byte ZCL frame does not fit");
+}
+
+static void test_rolling_hour(void)
+{
+    airtime_t a;
+    uint32_t frames, us;
+    airtime_init(&a, 1000);
+
+    /* One frame a minute for two hours: the window always holds ~60 */
+    for (uint32_t m = 0; m < 120; m++) {
+        airtime_add(&a, 1000 + m * 60000u, OCC_REPORT_ZCL_LEN);
+        airtime_last_hour(&a, 1000 + m * 60000u, &frames, &us);
+        uint32_t expect = m < 60 ? m + 1 : 0;
+        if (expect) CHECK(frames == expect, "minute %u: %u frames", m, frames);
+        else CHECK(frames >= 55 && frames <= 60, "minute %u: %u frames", m, frames);
+        CHECK(us == frames * airtime_frame_us(OCC_REPORT_ZCL_LEN), "minute %u: %u us", m, us);
+    }
+    CHECK(a.total_frames == 120, "total %u", a.total_frames);
+
+    /* Long silence empties the window; the clock may wrap */
+    airtime_last_hour(&a, 1000 + 120 * 60000u + 2 * 3600000u, &frames, &us);
+    CHECK(frames == 0 && us == 0, "silent hour: %u frames", frames);
+    airtime_init(&a, 0xFFFF0000u);
+    airtime_add(&a, 0xFFFF0000u, 3);
+    airtime_add(&a, 0x00100000u, 3);
+    airtime_last_hour(&a, 0x00100000u, &frames, NULL);
+    CHECK(frames == 2, "across wrap: %u frames", frames);
+}
+
+static void test_jitter(void)
+{
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (int i = 0; i < 100000; i++) {
+        uint32_t p = airtime_jittered_period(300000, 30000, rnd());
+        if (p < lo) lo = p;
+        if (p > hi) hi = p;
+    }
+    CHECK(lo >= 270000 && hi <= 330000, "period range %u-%u", lo, hi);
+    CHECK(lo < 271000 && hi > 329000, "jitter not spread: %u-%u", lo, hi);
+    CHECK(airtime_jittered_period(300000, 0, rnd()) == 300000, "zero jitter");
+}
+
+/* ---- Co-powered room simulation ---- */
+
+#define SIM_HOURS        6
+#define SIM_MS           (SIM_HOURS * 3600000u)
+#define SIM_BIN_MS       100                     /* collision window */
+#define SIM_BINS         (SIM_MS / SIM_BIN_MS)
+
+typedef struct {
+    uint32_t peak;             /* most keep-alive frames in one 100 ms window */
+    uint32_t busy_bins;        /* windows with more than one keep-alive frame */
+    uint32_t ms_per_hour;      /* keep-alive airtime per device per hour */
+} room_result_t;
+
+static void bin_frame(uint16_t *bins, airtime_t *a, uint32_t t, uint16_t zcl_len)
+{
+    if (t >= SIM_MS) return;
+    bins[t / SIM_BIN_MS]++;
+    airtime_add(a, t, zcl_len);
+}
+
+static room_result_t simulate_room(uint32_t devices, bool spread)
+{
+    uint16_t *bins = calloc(SIM_BINS, sizeof(*bins));
+    uint64_t total_us = 0;
+
+    for (uint32_t d = 0; d < devices; d++) {
+        airtime_t a;
+        airtime_init(&a, 0);
+        uint32_t boot = rnd() % 2000;              /* same breaker: boots within 2 s */
+
+        /* EP1 activity: occupancy reports at random, ~6 per hour */
+        uint32_t last_activity = 0;
+        uint32_t next_activity = boot + rnd() % 1200000;
+
+        if (!spread) {
+            for (uint32_t t = boot + 300000; t < SIM_MS; t += 300000) {
+                for (uint32_t ep = 0; ep < 11; ep++) {
+                    bin_frame(bins, &a, t + ep * 5, OCC_REPORT_ZCL_LEN);
+                }
+                bin_frame(bins, &a, t + 60, BITMAP_KA_ZCL_LEN);
+            }
+        } else {
+            uint32_t t_ep1 = boot + rnd() % 300000;
+            uint32_t t_bmp = boot + rnd() % 300000;
+            while (t_ep1 < SIM_MS || t_bmp < SIM_MS) {
+                uint32_t t = t_ep1 < t_bmp ? t_ep1 : t_bmp;
+                while (next_activity <= t) {
+                    last_activity = next_activity;
+                    next_activity += 60000 + rnd() % 1080000;
+                }
+                bool recent = last_activity && t - last_activity < 150000;
+                if (t == t_ep1) {
+                    if (!recent) bin_frame(bins, &a, t, OCC_REPORT_ZCL_LEN);
+                    t_ep1 += airtime_jittered_period(300000, 30000, rnd());
+                } else {
+                    if (!recent) bin_frame(bins, &a, t, BITMAP_KA_ZCL_LEN);
+                    t_bmp += airtime_jittered_period(300000, 30000, rnd());
+                }
+            }
+        }
+        total_us += a.total_us;
+    }
+
+    room_result_t r = {0};
+    for (uint32_t b = 0; b < SIM_BINS; b++) {
+        if (bins[b] > r.peak) r.peak = bins[b];
+        if (bins[b] > 1) r.busy_bins++;
+    }
+    r.ms_per_hour = (uint32_t)(total_us / devices / SIM_HOURS / 1000);
+    free(bins);
+    return r;
+}
+
+static void test_room(uint32_t devices)
+{
+    room_result_t burst  = simulate_room(devices, false);
+    room_result_t spread = simulate_room(devices, true);
+
+    printf("room: %u sensors powered up together, %u h, keep-alive traffic only\n",
+           devices, SIM_HOURS);
+    printf("  %-34s %14s %20s %16s\n", "policy", "peak/100 ms", "windows >1 frame", "airtime/dev/h");
+    printf("  %-34s %14u %20u %13u ms\n", "11-EP burst every 5 min from boot",
+           burst.peak, burst.busy_bins, burst.ms_per_hour);
+    printf("  %-34s %14u %20u %13u ms\n", "EP1 + packed bitmap, jittered",
+           spread.peak, spread.busy_bins, spread.ms_per_hour);
+
+    CHECK(spread.peak * 10 < burst.peak, "peak %u vs %u", spread.peak, burst.peak);
+    CHECK(spread.ms_per_hour * 4 < burst.ms_per_hour, "airtime %u vs %u ms/h",
+          spread.ms_per_hour, burst.ms_per_hour);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t devices = 40;
+    if (argc > 1) devices = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_frame_estimate();
+    test_rolling_hour();
+    test_jitter();
+    test_room(devices);
+
+    return check_result("airtime");
+}
@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test + benchmark for main/coord_report.c
+//
+// Build: make -C tools/host_test build/test_coord_report
+// Run:   tools/host_test/build/test_coord_report
+//
+// Checks the packed wire layout, the dead-band / min-interval gate and the
+// motion-adaptive mode, then replays a synthetic 10 Hz tracking trace
+// (walking, sitting with radar jitter, empty room) through the legacy ASCII
+// policy (report whenever the "x,y;x,y" string changes), the fixed-rate gate
+// and the adaptive gate, and compares report rates, attribute bytes and CPU
+// time per poll.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "coord_report.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void set_target(ld2450_target_t *t, bool present, int x, int y, int speed)
+{
+    t->present = present;
+    t->x_mm    = present ? (int16_t)x : 0;
+    t->y_mm    = present ? (int16_t)y : 0;
+    t->speed   = present ? (int16_t)speed : 0;
+}
+
+/* ---- Directed tests ---- */
+
+static void test_pack_layout(void)
+{
+    ld2450_target_t t[3];
+    set_target(&t[0], true, -1234, 2500, -16);
+    set_target(&t[1], false, 0, 0, 0);
+    set_target(&t[2], true, 300, 6000, 100);
+
+    uint8_t out[COORD_REPORT_PAYLOAD_LEN];
+    coord_report_pack(t, out);
+
+    static const uint8_t expect[COORD_REPORT_PAYLOAD_LEN] = {
+        0x05,
+        0x2E, 0xFB,  0xC4, 0x09,  0xF0, 0xFF,   /* -1234, 2500, -16 */
+        0x00, 0x00,  0x00, 0x00,  0x00, 0x00,
+        0x2C, 0x01,  0x70, 0x17,  0x64, 0x00,   /* 300, 6000, 100 */
+    };
+    CHECK(COORD_REPORT_PAYLOAD_LEN == 19, "payload is %d bytes", COORD_REPORT_PAYLOAD_LEN);
+    CHECK(memcmp(out, expect, sizeof(expect)) == 0, "packed layout mismatch");
+}
+
+static void test_deadband_and_interval(void)
+{
+    coord_report_gate_t g;
+    ld2450_target_t t[3];
+    memset(t, 0, sizeof(t));
+    coord_report_gate_reset(&g);
+
+    set_target(&t[0], true, 1000, 2000, 0);
+    CHECK(coord_report_gate_check(&g, t, 0, 50, 500), "first value not sent");
+
+    set_target(&t[0], true, 1040, 2000, 0);
+    CHECK(!coord_report_gate_check(&g, t, 1000, 50, 500), "sub-dead-band move sent");
+    set_target(&t[0], true, 1000, 1950, 0);
+    CHECK(!coord_report_gate_check(&g, t, 1100, 50, 500), "move equal to dead-band sent");
+    set_target(&t[0], true, 1000, 1949, 0);
+    CHECK(coord_report_gate_check(&g, t, 1200, 50, 500), "move past dead-band not sent");
+
+    /* Large move inside the interval waits, then goes out */
+    set_target(&t[0], true, 3000, 3000, 0);
+    CHECK(!coord_report_gate_check(&g, t, 1600, 50, 500), "sent inside min interval");
+    CHECK(coord_report_gate_check(&g, t, 1700, 50, 500), "not sent after min interval");
+
+    /* Presence change with no movement */
+    set_target(&t[1], true, 3000, 3000, 0);
+    CHECK(coord_report_gate_check(&g, t, 2200, 50, 500), "new target not sent");
+    set_target(&t[1], false, 0, 0, 0);
+    CHECK(coord_report_gate_check(&g, t, 2700, 50, 500), "target leaving not sent");
+
+    /* Slow drift accumulates against the last *sent* position */
+    int sent = 0;
+    for (int i = 1; i <= 30; i++) {
+        set_target(&t[0], true, 3000 + i * 10, 3000, 0);
+        if (coord_report_gate_check(&g, t, 2700 + i * 100, 50, 0)) sent++;
+    }
+    CHECK(sent == 5, "drift of 300 mm in 10 mm steps sent %d times, expected 5", sent);
+
+    /* Zero dead-band / interval: any movement is reported */
+    coord_report_gate_reset(&g);
+    CHECK(coord_report_gate_check(&g, t, 0, 0, 0), "reset gate did not send");
+    set_target(&t[0], true, 3301, 3000, 0);
+    CHECK(coord_report_gate_check(&g, t, 0, 0, 0), "1 mm move with dead-band 0 not sent");
+    CHECK(!coord_report_gate_check(&g, t, 0, 0, 0), "unchanged value sent");
+
+    /* Interval check is wrap-safe */
+    coord_report_gate_reset(&g);
+    coord_report_gate_check(&g, t, 0xFFFFFF00u, 50, 500);
+    set_target(&t[0], true, 9000, 3000, 0);
+    CHECK(!coord_report_gate_check(&g, t, 0x00000010u, 50, 500), "early send across wrap");
+    CHECK(coord_report_gate_check(&g, t, 0x00000200u, 50, 500), "no send across wrap");
+}
+
+static void test_adaptive(void)
+{
+    coord_report_gate_t g;
+    ld2450_target_t t[3];
+    memset(t, 0, sizeof(t));
+    coord_report_gate_reset(&g);
+
+    /* Fast walker crossing the field of view (no radial speed): once the
+     * smoothed track has warmed up, every frame goes out */
+    uint32_t now = 0, sent = 0;
+    for (int k = 0; k < 50; k++, now += 100) {
+        set_target(&t[0], true, -3000 + k * 150, 3000, 0);   /* 1.5 m/s */
+        if (coord_report_gate_check_adaptive(&g, t, now, 50) && k >= 10) sent++;
+    }
+    CHECK(sent == 40, "fast walker: %u/40 frames sent", sent);
+    CHECK(g.interval_ms == COORD_ADAPTIVE_MIN_MS, "fast walker interval %u", g.interval_ms);
+
+    /* Person stops and sits: the interval decays to the slow rate */
+    for (int k = 0; k < 100; k++, now += 100) {
+        set_target(&t[0], true, 4500 + (int)(rnd() % 41) - 20, 3000 + (int)(rnd() % 41) - 20, 0);
+        coord_report_gate_check_adaptive(&g, t, now, 50);
+    }
+    CHECK(g.interval_ms >= 2000, "seated interval only %u ms", g.interval_ms);
+
+    /* Radial approach is picked up from the radar speed on the first frame */
+    set_target(&t[0], true, 4500, 2900, -150);
+    CHECK(coord_report_gate_check_adaptive(&g, t, now, 50) || g.interval_ms == COORD_ADAPTIVE_MIN_MS,
+          "radial speed ignored (interval %u)", g.interval_ms);
+    CHECK(g.interval_ms == COORD_ADAPTIVE_MIN_MS, "radial interval %u", g.interval_ms);
+
+    /* Room empties: one empty frame, then nothing */
+    uint32_t before = g.stats.sent;
+    for (int k = 0; k < 50; k++) {
+        now += 100;
+        set_target(&t[0], false, 0, 0, 0);
+        coord_report_gate_check_adaptive(&g, t, now, 50);
+    }
+    CHECK(g.stats.sent == before + 1, "empty room sent %u frames", g.stats.sent - before);
+    CHECK(g.stats.idle >= 48, "empty room idle count %u", g.stats.idle);
+
+    /* Stats survive a reset */
+    uint32_t total = g.stats.sent;
+    coord_report_gate_reset(&g);
+    CHECK(g.stats.sent == total, "reset cleared stats");
+}
+
+/* ---- Trace comparison against the legacy ASCII policy ---- */
+
+/* Copy of the former sensor_bridge format_coords_string(), kept here as the
+ * baseline for the comparison below. */
+static int legacy_format(const ld2450_target_t *t, char *buf, size_t buf_size)
+{
+    char tmp[48];
+    int pos = 0;
+    for (int i = 0; i < 3; i++) {
+        if (t[i].present) {
+            if (pos > 0) pos += snprintf(tmp + pos, sizeof(tmp) - pos, ";");
+            pos += snprintf(tmp + pos, sizeof(tmp) - pos, "%d,%d",
+                            (int)t[i].x_mm, (int)t[i].y_mm);
+        }
+    }
+    memset(buf, 0, buf_size);
+    buf[0] = (char)pos;
+    memcpy(buf + 1, tmp, pos);
+    return pos;
+}
+
+/* Radar frame for tick k of a repeating 3-minute scene:
+ *   phase 0 (60 s): one person walks a 4 m line and back (~0.8 m/s)
+ *   phase 1 (60 s): two people sit still
+ *   phase 2 (60 s): empty room
+ * Every present target carries +/-35 mm measurement jitter. */
+#define PHASE_TICKS  600
+
+static int trace_phase(uint32_t k)
+{
+    return (int)((k / PHASE_TICKS) % 3);
+}
+
+static void trace_frame(uint32_t k, ld2450_target_t t[3])
+{
+    int jx0 = (int)(rnd() % 71) - 35, jy0 = (int)(rnd() % 71) - 35;
+    int jx1 = (int)(rnd() % 71) - 35, jy1 = (int)(rnd() % 71) - 35;
+    memset(t, 0, 3 * sizeof(*t));
+
+    switch (trace_phase(k)) {
+    case 0: {
+        int phase = (int)(k % 100);                 /* 10 s round trip */
+        int walk  = phase < 50 ? phase * 80 : (100 - phase) * 80;
+        set_target(&t[0], true, -2000 + walk + jx0, 2500 + jy0, 0);
+        break;
+    }
+    case 1:
+        set_target(&t[0], true, -800 + jx0, 2200 + jy0, 0);
+        set_target(&t[1], true, 1200 + jx1, 3800 + jy1, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+/* ZCL Report Attributes frame: ZCL header (3) + attr id (2) + type (1)
+ * + string length byte (1) + payload */
+#define ZCL_REPORT_OVERHEAD  7
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+enum { POLICY_LEGACY, POLICY_FIXED, POLICY_ADAPTIVE, POLICY_COUNT };
+static const char *const POLICY_NAME[POLICY_COUNT] = { "legacy ascii", "fixed gate", "adaptive" };
+
+typedef struct {
+    uint32_t reports[3];   /* per trace phase */
+    uint32_t bytes;
+    double   ns_per_poll;
+} trace_result_t;
+
+static void run_trace(int policy, uint32_t ticks, uint32_t seed, trace_result_t *r)
+{
+    ld2450_target_t t[3];
+    char last_ascii[64] = {0}, ascii[64];
+    uint8_t packed[COORD_REPORT_PAYLOAD_LEN];
+    coord_report_gate_t g;
+
+    memset(r, 0, sizeof(*r));
+    coord_report_gate_reset(&g);
+    memset(&g.stats, 0, sizeof(g.stats));
+    g_rng = seed;
+
+    double t0 = now_sec();
+    for (uint32_t k = 0; k < ticks; k++) {
+        trace_frame(k, t);
+        bool send;
+        int len = COORD_REPORT_PAYLOAD_LEN;
+        if (policy == POLICY_LEGACY) {
+            len = legacy_format(t, ascii, sizeof(ascii));
+            send = memcmp(ascii, last_ascii, sizeof(ascii)) != 0;
+            if (send) memcpy(last_ascii, ascii, sizeof(ascii));
+        } else if (policy == POLICY_FIXED) {
+            send = coord_report_gate_check(&g, t, k * 100, 50, 500);
+            if (send) coord_report_pack(t, packed);
+        } else {
+            send = coord_report_gate_check_adaptive(&g, t, k * 100, 50);
+            if (send) coord_report_pack(t, packed);
+        }
+        if (send) {
+            r->reports[trace_phase(k)]++;
+            r->bytes += ZCL_REPORT_OVERHEAD + len;
+        }
+    }
+    r->ns_per_poll = (now_sec() - t0) * 1e9 / ticks;
+}
+
+static void test_trace_compare(uint32_t ticks)
+{
+    trace_result_t r[POLICY_COUNT];
+    uint32_t seed = g_rng;
+    double secs = ticks / 10.0;
+    double phase_secs = secs / 3;
+
+    printf("trace: %u frames (%.0f s: 1/3 walking, 1/3 seated x2, 1/3 empty)\n", ticks, secs);
+    printf("  %-12s  walk/s  sit/s empty/s     B/s  ns/poll\n", "policy");
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        run_trace(p, ticks, seed, &r[p]);
+        printf("  %-12s %7.2f %6.2f %7.2f %7.1f %8.1f\n", POLICY_NAME[p],
+               r[p].reports[0] / phase_secs, r[p].reports[1] / phase_secs,
+               r[p].reports[2] / phase_secs, r[p].bytes / secs, r[p].ns_per_poll);
+    }
+
+    uint32_t total[POLICY_COUNT];
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        total[p] = r[p].reports[0] + r[p].reports[1] + r[p].reports[2];
+    }
+    CHECK(total[POLICY_FIXED] * 3 < total[POLICY_LEGACY],
+          "fixed gate sent %u reports vs legacy %u, expected < 1/3",
+          total[POLICY_FIXED], total[POLICY_LEGACY]);
+    CHECK(r[POLICY_FIXED].reports[0] <= ticks / 15 + 1, "fixed gate exceeded 2 reports/s");
+
+    /* Adaptive: faster than the fixed rate while walking, far slower while
+     * seated, silent when empty (one frame per empty spell) */
+    CHECK(r[POLICY_ADAPTIVE].reports[0] > r[POLICY_FIXED].reports[0] * 2,
+          "adaptive walking %u vs fixed %u", r[POLICY_ADAPTIVE].reports[0], r[POLICY_FIXED].reports[0]);
+    CHECK(r[POLICY_ADAPTIVE].reports[1] * 4 < r[POLICY_FIXED].reports[1],
+          "adaptive seated %u vs fixed %u", r[POLICY_ADAPTIVE].reports[1], r[POLICY_FIXED].reports[1]);
+    CHECK(r[POLICY_ADAPTIVE].reports[2] <= ticks / (3 * PHASE_TICKS) + 1,
+          "adaptive empty room sent %u", r[POLICY_ADAPTIVE].reports[2]);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 540000;
+    if (argc > 1) ticks = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_pack_layout();
+    test_deadband_and_interval();
+    test_adaptive();
+    test_trace_compare(ticks);
+
+    return check_result("coord_report");
+}
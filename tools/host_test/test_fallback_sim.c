@@ -0,0 +1,630 @@
+// SPDX-License-Identifier: MIT
+//
+// Host simulation of main/coordinator_fallback.c
+//
+// Build: make -C tools/host_test build/test_fallback_sim
+// Run:   tools/host_test/build/test_fallback_sim [hours] [-v]
+//
+// Runs coordinator_fallback.c unchanged against a fake Zigbee stack: a
+// virtual clock, the esp_zb_scheduler_alarm() scheduler and a programmable
+// link that answers every occupancy report with a send status (ACK after a
+// latency, or FAIL once APS gives up, or nothing at all).  A few endpoints
+// change occupancy the way rooms do, HA sends heartbeats and clears hard
+// fallback once it sees the flag, and the coordinator can drop off the air
+// (radio outage) or stay on the air with HA stopped (software outage).
+//
+// Each loss profile is simulated for [hours] (default one week) and reports
+// retries, soft/hard fallbacks while the coordinator was actually fine
+// (false fallbacks), retry queue occupancy, peak pending alarms and, for the
+// outage profiles, time from the outage to soft and hard fallback.
+//
+// The module is #included rather than linked so the harness can reset its
+// statics between profiles and read the retry queue (s_q) directly.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "coordinator_fallback.c"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* Uniform in [mean/2, 3*mean/2] */
+static uint32_t around(uint32_t mean)
+{
+    return mean / 2 + (mean ? rnd() % (mean + 1) : 0);
+}
+
+/* ================================================================== */
+/*  Virtual clock, logging, esp_random                                  */
+/* ================================================================== */
+
+static uint64_t g_now_us;
+static int      g_log_level = ESP_LOG_NONE;
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)g_now_us;
+}
+
+uint32_t esp_random(void)
+{
+    return rnd();
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if ((int)level > g_log_level) return;
+    static const char lv[] = "NEWIDV";
+    printf("[%10.3f] %c %s: ", (double)g_now_us / 1e6, lv[level], tag);
+    va_list ap;
+    va_start(ap, format);
+    vprintf(format, ap);
+    va_end(ap);
+    printf("\n");
+}
+
+/* ================================================================== */
+/*  Fake scheduler                                                      */
+/* ================================================================== */
+
+/* Firmware alarms and the harness's own events share one queue, ordered by
+ * time and then by scheduling order, like the ZBOSS alarm list. */
+#define SIM_MAX_ALARMS 128
+
+typedef struct {
+    uint64_t          at_us;
+    uint64_t          seq;
+    esp_zb_callback_t cb;
+    uint8_t           param;
+    bool              sim;      /* harness event, not a firmware alarm */
+} sim_alarm_t;
+
+static sim_alarm_t g_alarm[SIM_MAX_ALARMS];
+static int         g_alarms;
+static uint64_t    g_seq;
+static int         g_fw_alarms;       /* firmware alarms pending */
+static int         g_fw_alarms_peak;
+
+static void alarm_add(esp_zb_callback_t cb, uint8_t param, uint32_t ms, bool sim)
+{
+    if (g_alarms == SIM_MAX_ALARMS) {
+        CHECK(false, "alarm queue full");
+        return;
+    }
+    g_alarm[g_alarms++] = (sim_alarm_t){ g_now_us + (uint64_t)ms * 1000, g_seq++, cb, param, sim };
+    if (!sim && ++g_fw_alarms > g_fw_alarms_peak) g_fw_alarms_peak = g_fw_alarms;
+}
+
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time_ms)
+{
+    alarm_add(cb, param, time_ms, false);
+}
+
+void esp_zb_scheduler_alarm_cancel(esp_zb_callback_t cb, uint8_t param)
+{
+    for (int i = 0; i < g_alarms; ) {
+        if (!g_alarm[i].sim && g_alarm[i].cb == cb && g_alarm[i].param == param) {
+            g_alarm[i] = g_alarm[--g_alarms];
+            g_fw_alarms--;
+        } else {
+            i++;
+        }
+    }
+}
+
+static void sim_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t ms)
+{
+    alarm_add(cb, param, ms, true);
+}
+
+/* Run the earliest alarm due by end_us; false (clock at end_us) if none */
+static bool sim_step(uint64_t end_us)
+{
+    int best = -1;
+    for (int i = 0; i < g_alarms; i++) {
+        if (best < 0 || g_alarm[i].at_us < g_alarm[best].at_us
+                || (g_alarm[i].at_us == g_alarm[best].at_us && g_alarm[i].seq < g_alarm[best].seq)) {
+            best = i;
+        }
+    }
+    if (best < 0 || g_alarm[best].at_us > end_us) {
+        g_now_us = end_us;
+        return false;
+    }
+    sim_alarm_t a = g_alarm[best];
+    g_alarm[best] = g_alarm[--g_alarms];
+    if (!a.sim) g_fw_alarms--;
+    g_now_us = a.at_us;
+    a.cb(a.param);
+    return true;
+}
+
+/* ================================================================== */
+/*  Fake nvs_config                                                     */
+/* ================================================================== */
+
+static struct {
+    uint32_t     generation;
+    nvs_config_t cfg;
+} g_snap;
+
+esp_err_t nvs_config_get(nvs_config_t *out)
+{
+    *out = g_snap.cfg;
+    return ESP_OK;
+}
+
+uint32_t nvs_config_generation(void)
+{
+    return g_snap.generation;
+}
+
+uint32_t nvs_config_read(size_t offset, size_t len, void *out)
+{
+    memcpy(out, (const uint8_t *)&g_snap.cfg + offset, len);
+    return g_snap.generation;
+}
+
+#define SAVE(fn, type, field) \
+    esp_err_t fn(type v) { g_snap.cfg.field = v; g_snap.generation++; return ESP_OK; }
+
+SAVE(nvs_config_save_fallback_mode,      uint8_t,  fallback_mode)
+SAVE(nvs_config_save_fallback_enable,    uint8_t,  fallback_enable)
+SAVE(nvs_config_save_hard_timeout_sec,   uint8_t,  hard_timeout_sec)
+SAVE(nvs_config_save_ack_timeout_ms,     uint16_t, ack_timeout_ms)
+SAVE(nvs_config_save_heartbeat_enable,   uint8_t,  heartbeat_enable)
+SAVE(nvs_config_save_heartbeat_interval, uint16_t, heartbeat_interval_sec)
+
+/* ================================================================== */
+/*  Link and coordinator model                                          */
+/* ================================================================== */
+
+typedef enum {
+    OUTAGE_NONE = 0,
+    OUTAGE_RADIO,              /* coordinator off the air: every report fails */
+    OUTAGE_SOFTWARE,           /* radio ACKs, HA stopped: no heartbeats, no clear */
+} outage_kind_t;
+
+typedef struct {
+    const char *name;
+    uint8_t  loss_pct;         /* report lost (APS gave up), per report */
+    uint8_t  burst_loss_pct;   /* same, inside an interference burst */
+    uint32_t burst_every_s;    /* mean time between bursts (0 = none) */
+    uint32_t burst_len_s;      /* mean burst length */
+    uint16_t ack_ms;           /* mean send -> ACK latency */
+    uint16_t fail_ms;          /* send -> FAIL status when the report is lost */
+    uint8_t  no_status_pct;    /* send status never delivered */
+    uint8_t  outage;           /* outage_kind_t */
+    uint32_t outage_every_s;   /* outage start period (first at half a period) */
+    uint32_t outage_len_s;
+    uint16_t heartbeat_sec;    /* 0 = watchdog off */
+} sim_profile_t;
+
+#define HA_CLEAR_S          30     /* HA clears hard fallback this long after seeing it */
+#define SIM_ACTIVE_EPS      4      /* EP1 + zones 1-3 see people */
+
+static const sim_profile_t *g_prof;
+static esp_zb_zcl_command_send_status_callback_t g_status_cb;
+static bool     g_radio_up, g_ha_up;
+static bool     g_in_burst;
+static uint64_t g_burst_switch_us;
+static uint8_t  g_occ[RQ_EP_COUNT];
+static uint8_t  g_soft_attr;
+static uint8_t  g_fb_attr;
+
+typedef struct {
+    uint32_t reports;          /* report frames handed to the stack */
+    uint32_t lost;
+    uint32_t transitions;
+    uint32_t onoff;            /* fallback On/Off commands */
+    uint32_t onoff_false;      /* ... while the coordinator was fine */
+    uint32_t soft;             /* soft fallback episodes */
+    uint32_t soft_false;
+    uint32_t hard;             /* hard fallback entries */
+    uint32_t hard_false;
+    uint32_t clears;
+    uint32_t outages;
+    uint32_t detected;         /* outages that reached hard fallback */
+    uint64_t ttf_soft_sum_ms, ttf_hard_sum_ms;
+    uint32_t ttf_soft_n;
+    uint32_t ttf_soft_max_ms, ttf_hard_max_ms;
+    uint64_t busy_slot_us;     /* integral of non-idle queue slots over time */
+    uint8_t  busy_peak;
+    uint8_t  in_flight_peak;
+} sim_result_t;
+
+static sim_result_t g_res;
+static uint64_t     g_outage_t0_us;
+static bool         g_outage_soft_seen, g_outage_hard_seen;
+
+static bool coordinator_fine(void)
+{
+    return g_radio_up && g_ha_up;
+}
+
+/* Interference bursts: alternate good / bad spells of random length */
+static bool link_lost(void)
+{
+    if (g_prof->burst_every_s) {
+        while (g_now_us >= g_burst_switch_us) {
+            g_in_burst = !g_in_burst;
+            uint32_t s = around(g_in_burst ? g_prof->burst_len_s : g_prof->burst_every_s);
+            g_burst_switch_us += (uint64_t)(s ? s : 1) * 1000000;
+        }
+    }
+    uint8_t pct = g_in_burst ? g_prof->burst_loss_pct : g_prof->loss_pct;
+    return rnd() % 100 < pct;
+}
+
+static void status_deliver_cb(uint8_t param)
+{
+    esp_zb_zcl_command_send_status_message_t msg = {0};
+    msg.status             = (param & 0x80) ? ESP_OK : ESP_FAIL;
+    msg.dst_addr.addr_type = ESP_ZB_ZCL_ADDR_TYPE_SHORT;
+    msg.dst_addr.u.short_addr = 0x0000;
+    msg.dst_endpoint       = 1;
+    msg.src_endpoint       = param & 0x7F;
+    if (g_status_cb) g_status_cb(msg);
+}
+
+void esp_zb_zcl_command_send_status_handler_register(esp_zb_zcl_command_send_status_callback_t cb)
+{
+    g_status_cb = cb;
+}
+
+esp_err_t esp_zb_zcl_report_attr_cmd_req(esp_zb_zcl_report_attr_cmd_t *cmd_req)
+{
+    uint8_t ep = cmd_req->zcl_basic_cmd.src_endpoint;
+    g_res.reports++;
+    bool lost = !g_radio_up || link_lost();
+    if (lost) g_res.lost++;
+    if (rnd() % 100 < g_prof->no_status_pct) return ESP_OK;
+
+    uint32_t ms = lost ? g_prof->fail_ms : around(g_prof->ack_ms);
+    sim_alarm(status_deliver_cb, (uint8_t)(ep | (lost ? 0 : 0x80)), ms);
+    return ESP_OK;
+}
+
+static void count_onoff(void)
+{
+    g_res.onoff++;
+    if (coordinator_fine()) g_res.onoff_false++;
+}
+
+uint8_t esp_zb_zcl_on_off_cmd_req(esp_zb_zcl_on_off_cmd_t *cmd_req)
+{
+    (void)cmd_req;
+    count_onoff();
+    return 0;
+}
+
+uint8_t esp_zb_zcl_level_move_to_level_with_onoff_cmd_req(esp_zb_zcl_move_to_level_cmd_t *cmd_req)
+{
+    (void)cmd_req;
+    count_onoff();
+    return 0;
+}
+
+uint8_t esp_zb_zcl_scenes_recall_scene_cmd_req(esp_zb_zcl_scenes_recall_scene_cmd_t *cmd_req)
+{
+    (void)cmd_req;
+    count_onoff();
+    return 0;
+}
+
+static void ha_clear_cb(uint8_t param)
+{
+    (void)param;
+    if (!coordinator_fine() || !coordinator_fallback_is_active()) return;
+    g_res.clears++;
+    coordinator_fallback_clear();
+}
+
+static uint32_t since_outage_ms(void)
+{
+    return (uint32_t)((g_now_us - g_outage_t0_us) / 1000);
+}
+
+/* Soft fault counter and fallback flag, as HA would see them */
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id,
+                                                 uint8_t cluster_role, uint16_t attr_id,
+                                                 void *value_p, bool check)
+{
+    (void)cluster_role;
+    (void)check;
+    if (endpoint != ZB_EP_MAIN || cluster_id != ZB_CLUSTER_LD2450_CONFIG) return 0;
+    uint8_t v = *(const uint8_t *)value_p;
+    bool in_outage = g_prof->outage != OUTAGE_NONE && !coordinator_fine();
+
+    if (attr_id == ZB_ATTR_SOFT_FAULT) {
+        if (g_soft_attr == 0 && v != 0) {
+            g_res.soft++;
+            if (coordinator_fine()) g_res.soft_false++;
+            if (in_outage && !g_outage_soft_seen) {
+                g_outage_soft_seen = true;
+                uint32_t ms = since_outage_ms();
+                g_res.ttf_soft_sum_ms += ms;
+                g_res.ttf_soft_n++;
+                if (ms > g_res.ttf_soft_max_ms) g_res.ttf_soft_max_ms = ms;
+            }
+        }
+        g_soft_attr = v;
+    } else if (attr_id == ZB_ATTR_FALLBACK_MODE) {
+        if (g_fb_attr == 0 && v != 0) {
+            g_res.hard++;
+            if (coordinator_fine()) {
+                g_res.hard_false++;
+                sim_alarm(ha_clear_cb, 0, HA_CLEAR_S * 1000);
+            }
+            if (in_outage && !g_outage_hard_seen) {
+                g_outage_hard_seen = true;
+                g_res.detected++;
+                uint32_t ms = since_outage_ms();
+                g_res.ttf_hard_sum_ms += ms;
+                if (ms > g_res.ttf_hard_max_ms) g_res.ttf_hard_max_ms = ms;
+            }
+        }
+        g_fb_attr = v;
+    }
+    return 0;
+}
+
+/* ---- Coordinator side: outages and heartbeats ---- */
+
+static void outage_end_cb(uint8_t param)
+{
+    (void)param;
+    g_radio_up = g_ha_up = true;
+    if (coordinator_fallback_is_active()) sim_alarm(ha_clear_cb, 0, HA_CLEAR_S * 1000);
+}
+
+static void outage_start_cb(uint8_t param)
+{
+    (void)param;
+    g_res.outages++;
+    g_outage_t0_us     = g_now_us;
+    g_outage_soft_seen = g_outage_hard_seen = false;
+    if (g_prof->outage == OUTAGE_RADIO) g_radio_up = false;
+    else                                g_ha_up    = false;
+    sim_alarm(outage_end_cb, 0, g_prof->outage_len_s * 1000);
+    sim_alarm(outage_start_cb, 0, g_prof->outage_every_s * 1000);
+}
+
+static void heartbeat_cb(uint8_t param)
+{
+    (void)param;
+    if (coordinator_fine() && !link_lost()) coordinator_fallback_heartbeat();
+    sim_alarm(heartbeat_cb, 0, (uint32_t)g_prof->heartbeat_sec * 1000);
+}
+
+/* ---- Room model: occupancy transitions in the order sensor_bridge makes them ---- */
+
+static void occupancy_cb(uint8_t ep_idx)
+{
+    uint8_t ep = ep_idx + 1;
+    g_occ[ep_idx] = !g_occ[ep_idx];
+    g_res.transitions++;
+    coordinator_fallback_report_occupancy(ep, g_occ[ep_idx]);
+    coordinator_fallback_on_occupancy_change(ep, g_occ[ep_idx]);
+
+    uint32_t dwell_s;
+    if (g_occ[ep_idx]) {
+        /* one visit in five is a walk-through, the rest stay a while */
+        dwell_s = (rnd() % 5 == 0) ? 3 + rnd() % 30 : 120 + rnd() % 1080;
+    } else {
+        dwell_s = 60 + rnd() % 2400;
+    }
+    sim_alarm(occupancy_cb, ep_idx, dwell_s * 1000);
+}
+
+/* ================================================================== */
+/*  Simulation run                                                      */
+/* ================================================================== */
+
+/* Module statics that coordinator_fallback_init() leaves alone (it runs once
+ * per boot on the device) */
+static void module_reset(void)
+{
+    s_soft_fault_count     = 0;
+    s_hard_timeout_pending = false;
+    s_ka_sent = s_ka_skipped = 0;
+    s_rl_drain_pending = false;
+    s_rl_throttled = s_rl_collapsed = s_rl_exempt = 0;
+    s_rule_occ = s_rule_fb = 0;
+    s_rule_fired = 0;
+}
+
+static void config_defaults(const sim_profile_t *p)
+{
+    memset(&g_snap, 0, sizeof(g_snap));
+    g_snap.generation = 1;
+    nvs_config_t *c = &g_snap.cfg;
+    for (int i = 0; i < 11; i++) c->fallback_cooldown_sec[i] = 300;
+    c->fallback_enable        = 1;
+    c->hard_timeout_sec       = 10;
+    c->ack_timeout_ms         = 2000;
+    c->heartbeat_enable       = p->heartbeat_sec ? 1 : 0;
+    c->heartbeat_interval_sec = p->heartbeat_sec ? p->heartbeat_sec : 120;
+    c->rate_burst             = 20;
+    c->rate_per_min           = 600;
+    local_rules_init(&c->rules);
+}
+
+static void sim_run(const sim_profile_t *p, uint32_t hours)
+{
+    g_rng = 0x2450u;
+    g_prof = p;
+    g_now_us = 1000000;
+    g_alarms = 0;
+    g_fw_alarms = g_fw_alarms_peak = 0;
+    g_radio_up = g_ha_up = true;
+    g_in_burst = false;
+    g_burst_switch_us = g_now_us + (uint64_t)around(p->burst_every_s) * 1000000;
+    g_soft_attr = g_fb_attr = 0;
+    memset(g_occ, 0, sizeof(g_occ));
+    memset(&g_res, 0, sizeof(g_res));
+
+    config_defaults(p);
+    module_reset();
+    coordinator_fallback_init();
+    coordinator_fallback_start_keepalive();
+
+    for (uint8_t i = 0; i < SIM_ACTIVE_EPS; i++) sim_alarm(occupancy_cb, i, 1000 + rnd() % 600000);
+    if (p->heartbeat_sec) sim_alarm(heartbeat_cb, 0, (uint32_t)p->heartbeat_sec * 1000);
+    if (p->outage) sim_alarm(outage_start_cb, 0, p->outage_every_s * 500);
+
+    uint64_t end_us = g_now_us + (uint64_t)hours * 3600 * 1000000;
+    uint8_t  busy = 0;
+    for (;;) {
+        uint64_t before = g_now_us;
+        bool more = sim_step(end_us);
+        g_res.busy_slot_us += (uint64_t)busy * (g_now_us - before);
+        if (!more) break;
+
+        busy = 0;
+        for (int i = 0; i < RQ_EP_COUNT; i++) {
+            if (s_q.slot[i].state != RQ_IDLE) busy++;
+        }
+        if (busy > g_res.busy_peak) g_res.busy_peak = busy;
+        if (s_q.in_flight > g_res.in_flight_peak) g_res.in_flight_peak = s_q.in_flight;
+    }
+}
+
+static void print_result(const sim_profile_t *p, uint32_t hours)
+{
+    const sim_result_t *r = &g_res;
+    const rq_stats_t *q = &s_q.stats;
+    double h = hours;
+    printf("  %-14s %7u %6.2f%% %5u %7.3f %7.3f %6u %5.2f %3u %3u %4d",
+           p->name, r->reports,
+           q->sent ? 100.0 * q->retries / q->sent : 0.0, q->exhausted,
+           r->soft_false / h, r->hard_false / h, r->onoff_false,
+           (double)r->busy_slot_us / ((double)hours * 3600e6), r->busy_peak, r->in_flight_peak,
+           g_fw_alarms_peak);
+    if (r->outages) {
+        printf("  %3u/%-3u %6.1f %6.1f %6.1f %6.1f",
+               r->detected, r->outages,
+               r->ttf_soft_n ? r->ttf_soft_sum_ms / 1000.0 / r->ttf_soft_n : 0.0,
+               r->ttf_soft_max_ms / 1000.0,
+               r->detected ? r->ttf_hard_sum_ms / 1000.0 / r->detected : 0.0,
+               r->ttf_hard_max_ms / 1000.0);
+    }
+    printf("\n");
+}
+
+/* ================================================================== */
+/*  Profiles                                                            */
+/* ================================================================== */
+
+enum { P_CLEAN, P_LOSS5, P_LOSS20, P_BURSTY, P_MULTIHOP, P_RADIO, P_SOFTWARE, P_COUNT };
+
+static const sim_profile_t k_profiles[P_COUNT] = {
+    [P_CLEAN]    = { .name = "clean",      .ack_ms = 30,  .fail_ms = 1600 },
+    [P_LOSS5]    = { .name = "loss 5%",    .loss_pct = 5,  .ack_ms = 30, .fail_ms = 1600 },
+    [P_LOSS20]   = { .name = "loss 20%",   .loss_pct = 20, .ack_ms = 30, .fail_ms = 1600 },
+    [P_BURSTY]   = { .name = "bursty",     .loss_pct = 1, .burst_loss_pct = 90,
+                     .burst_every_s = 1800, .burst_len_s = 20, .ack_ms = 30, .fail_ms = 1600 },
+    [P_MULTIHOP] = { .name = "multi-hop",  .loss_pct = 3, .ack_ms = 400, .fail_ms = 6000,
+                     .no_status_pct = 1 },
+    [P_RADIO]    = { .name = "radio out",  .ack_ms = 30, .fail_ms = 1600,
+                     .outage = OUTAGE_RADIO, .outage_every_s = 7200, .outage_len_s = 600 },
+    [P_SOFTWARE] = { .name = "HA down",    .ack_ms = 30, .fail_ms = 1600, .heartbeat_sec = 60,
+                     .outage = OUTAGE_SOFTWARE, .outage_every_s = 10800, .outage_len_s = 900 },
+};
+
+static void check_profile(int i, uint32_t hours)
+{
+    const sim_profile_t *p = &k_profiles[i];
+    const sim_result_t  *r = &g_res;
+    const rq_stats_t    *q = &s_q.stats;
+
+    CHECK(r->transitions > hours * 10, "%s: only %u transitions", p->name, r->transitions);
+    CHECK(!coordinator_fallback_is_active() || !coordinator_fine(),
+          "%s: hard fallback still active with the coordinator up", p->name);
+    CHECK(r->in_flight_peak <= RQ_MAX_IN_FLIGHT, "%s: %u in flight", p->name, r->in_flight_peak);
+
+    switch (i) {
+    case P_CLEAN:
+        CHECK(q->retries == 0 && q->exhausted == 0, "%s: %u retries %u exhausted",
+              p->name, q->retries, q->exhausted);
+        CHECK(q->acked == q->sent, "%s: %u of %u ACKed", p->name, q->acked, q->sent);
+        CHECK(r->soft == 0 && r->hard == 0 && r->onoff == 0, "%s: %u soft %u hard %u On/Off",
+              p->name, r->soft, r->hard, r->onoff);
+        break;
+    case P_LOSS5:
+        /* four losses in a row: a handful per year */
+        CHECK(r->hard_false == 0, "%s: %u false hard fallbacks", p->name, r->hard_false);
+        CHECK(q->exhausted * 1000 <= q->enqueued, "%s: %u exhausted of %u",
+              p->name, q->exhausted, q->enqueued);
+        break;
+    case P_LOSS20:
+    case P_BURSTY:
+    case P_MULTIHOP:
+        /* every false hard fallback was cleared again by HA */
+        CHECK(r->clears == r->hard_false, "%s: %u false hard, %u cleared",
+              p->name, r->hard_false, r->clears);
+        CHECK(r->soft_false <= q->exhausted, "%s: %u soft from %u exhausted",
+              p->name, r->soft_false, q->exhausted);
+        break;
+    case P_RADIO:
+        CHECK(r->soft_false == 0 && r->hard_false == 0, "%s: %u/%u false fallbacks",
+              p->name, r->soft_false, r->hard_false);
+        CHECK(r->detected == r->outages, "%s: %u of %u outages detected",
+              p->name, r->detected, r->outages);
+        /* next report (keep-alive at most 5.5 min away) + 4 x FAIL + backoff */
+        CHECK(r->ttf_soft_max_ms <= (OCC_KEEPALIVE_MS + OCC_KEEPALIVE_JITTER_MS) + 20000,
+              "%s: soft fallback %u ms after the outage", p->name, r->ttf_soft_max_ms);
+        CHECK(r->ttf_hard_max_ms <= r->ttf_soft_max_ms + 10000 + 100 || r->detected == 0,
+              "%s: hard %u ms vs soft %u ms", p->name, r->ttf_hard_max_ms, r->ttf_soft_max_ms);
+        CHECK(r->clears == r->detected, "%s: %u detected, %u cleared", p->name, r->detected, r->clears);
+        CHECK(r->onoff > 0, "%s: no On/Off sent during outages", p->name);
+        break;
+    case P_SOFTWARE:
+        CHECK(r->soft == 0, "%s: %u soft fallbacks with the radio up", p->name, r->soft);
+        CHECK(r->hard_false == 0, "%s: %u false hard fallbacks", p->name, r->hard_false);
+        CHECK(r->detected == r->outages, "%s: %u of %u outages detected",
+              p->name, r->detected, r->outages);
+        CHECK(r->ttf_hard_max_ms <= 2u * p->heartbeat_sec * 1000, "%s: hard %u ms after HA stopped",
+              p->name, r->ttf_hard_max_ms);
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t hours = 168;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) g_log_level = ESP_LOG_INFO;
+        else hours = (uint32_t)strtoul(argv[i], NULL, 0);
+    }
+    if (hours == 0) hours = 1;
+
+    printf("fallback sim: %u h per profile, %d active endpoints, hard timeout 10 s, "
+           "HA clears after %d s\n", hours, SIM_ACTIVE_EPS, HA_CLEAR_S);
+    printf("  %-14s %7s %7s %5s %7s %7s %6s %5s %3s %3s %4s  %7s %6s %6s %6s %6s\n",
+           "profile", "reports", "retry", "exh", "fsoft/h", "fhard/h", "fOnOff",
+           "q avg", "max", "inf", "alrm", "outages", "soft s", "max", "hard s", "max");
+
+    clock_t t0 = clock();
+    for (int i = 0; i < P_COUNT; i++) {
+        sim_run(&k_profiles[i], hours);
+        print_result(&k_profiles[i], hours);
+        check_profile(i, hours);
+    }
+    double wall_ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+    printf("  %u simulated hours in %.0f ms\n", hours * P_COUNT, wall_ms);
+
+    return check_result("fallback_sim");
+}
@@ -0,0 +1,407 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test + benchmark: components/ld2450/ld2450_cmd.c against the sensor
+// emulator in tools/ld2450_emu
+//
+// Build: make -C tools/host_test build/test_ld2450_cmd_emu
+// Run:   tools/host_test/build/test_ld2450_cmd_emu [-v]
+//
+// ld2450_cmd.c runs unchanged on a virtual clock: uart_read_bytes(),
+// uart_write_bytes() and vTaskDelay() move bytes to and from the emulator
+// and advance time, so command framing, ACK parsing and timeouts are
+// exercised exactly as on the device, in milliseconds of virtual time.
+// uart_read_bytes() keeps ESP-IDF's semantics (return when the buffer is
+// full or the line has been idle for the timeout), which is what decides
+// how long an ACK read takes.
+//
+// The benchmark section prints config-session durations and RX blackouts
+// (ld2450_rx_pause() to ld2450_rx_resume()) for typical command mixes.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ld2450.h"
+#include "ld2450_cmd.h"
+#include "ld2450_emu.h"
+#include "ld2450_parser.h"
+#include "esp_log.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "check.h"
+
+static bool g_verbose = false;
+
+// ---------------------------------------------------------------------------
+// Virtual platform
+// ---------------------------------------------------------------------------
+
+static uint32_t g_now = 1000;
+static ld2450_emu_t g_emu;
+
+static uint32_t g_pause_at;
+static uint32_t g_pauses;
+static uint32_t g_blackout_last, g_blackout_max;
+static bool     g_paused;
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)level;
+    if (!g_verbose) return;     /* the timeouts below are expected */
+    va_list ap;
+    va_start(ap, format);
+    printf("[%6u] %s: ", g_now, tag);
+    vprintf(format, ap);
+    printf("\n");
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    default:                       return "ESP_ERR_?";
+    }
+}
+
+static struct host_semaphore { int dummy; } g_mutex;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return &g_mutex; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t t) { (void)s; (void)t; return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { (void)s; return pdTRUE; }
+
+TickType_t xTaskGetTickCount(void) { return g_now; }
+void vTaskDelay(TickType_t ticks) { g_now += ticks; }
+
+uart_port_t ld2450_get_uart_port(void) { return 1; }
+
+void ld2450_rx_pause(void)
+{
+    g_paused = true;
+    g_pauses++;
+    g_pause_at = g_now;
+}
+
+void ld2450_rx_resume(void)
+{
+    g_paused = false;
+    g_blackout_last = g_now - g_pause_at;
+    if (g_blackout_last > g_blackout_max) g_blackout_max = g_blackout_last;
+}
+
+int uart_write_bytes(uart_port_t port, const void *src, size_t size)
+{
+    (void)port;
+    ld2450_emu_rx(&g_emu, g_now, (const uint8_t *)src, size);
+    return (int)size;
+}
+
+int uart_flush_input(uart_port_t port)
+{
+    (void)port;
+    uint8_t junk[256];
+    while (ld2450_emu_tx(&g_emu, g_now, junk, sizeof(junk)) > 0) {}
+    return 0;
+}
+
+int uart_read_bytes(uart_port_t port, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    (void)port;
+    uint8_t *out = (uint8_t *)buf;
+    uint32_t got = 0;
+    uint32_t idle_from = g_now;
+    for (;;) {
+        size_t n = ld2450_emu_tx(&g_emu, g_now, out + got, length - got);
+        if (n > 0) idle_from = g_now;
+        got += (uint32_t)n;
+        if (got >= length) return (int)got;
+
+        /* Wait for the next chunk; give up after ticks_to_wait of silence.
+         * next_ms may be a frame slot that stays silent, hence idle_from. */
+        uint32_t next = ld2450_emu_next_ms(&g_emu, g_now);
+        if (next - idle_from > ticks_to_wait) {
+            g_now = idle_from + ticks_to_wait;
+            return (int)got;
+        }
+        g_now = next > g_now ? next : g_now + 1;
+    }
+}
+
+/* Let the sensor stream for ms, discarding what it sends (the RX task) */
+static void idle(uint32_t ms)
+{
+    uint8_t junk[256];
+    uint32_t end = g_now + ms;
+    while ((int32_t)(end - g_now) > 0) {
+        g_now += 10;
+        while (ld2450_emu_tx(&g_emu, g_now, junk, sizeof(junk)) > 0) {}
+    }
+}
+
+/* Fresh sensor, and a command cache that knows nothing about it */
+static void reset(const ld2450_emu_faults_t *faults)
+{
+    ld2450_emu_init(&g_emu, faults, g_now);
+    ld2450_cmd_init();
+    ld2450_cmd_forget_settings();
+    g_pauses = 0;
+    g_blackout_max = 0;
+    idle(500);
+}
+
+static ld2450_emu_faults_t faults_default(void)
+{
+    ld2450_emu_faults_t f;
+    ld2450_emu_default_faults(&f);
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+// Protocol
+// ---------------------------------------------------------------------------
+
+static void test_query_reads_sensor(void)
+{
+    ld2450_emu_faults_t f = faults_default();
+    reset(&f);
+
+    CHECK(ld2450_cmd_query() == ESP_OK, "query failed");
+    ld2450_sensor_info_t info;
+    ld2450_cmd_get_sensor_info(&info);
+    CHECK(info.fw_valid && info.fw_major == 0x0102 && info.fw_minor == 0x22062416,
+          "fw %04X %08X", info.fw_major, (unsigned)info.fw_minor);
+    CHECK(info.mac_valid && memcmp(info.mac, g_emu.set.mac, 6) == 0, "mac");
+    CHECK(info.region_valid && info.zone_type == 0, "zone");
+    CHECK(info.tracking == 0, "tracking %d", info.tracking);
+    CHECK(g_emu.stats.sessions == 1 && !g_emu.config_mode, "one closed session");
+    CHECK(g_emu.stats.bad_commands == 0, "framing errors %u", g_emu.stats.bad_commands);
+}
+
+static void test_batch_applies_then_skips(void)
+{
+    ld2450_emu_faults_t f = faults_default();
+    reset(&f);
+
+    ld2450_hw_filter_t filt;
+    ld2450_hw_filter_plan_range(5000, 60, 60, &filt);
+    ld2450_cmd_batch_t b;
+    ld2450_cmd_batch_init(&b);
+    ld2450_cmd_batch_add_bluetooth(&b, false);
+    ld2450_cmd_batch_add_single_target(&b);
+    ld2450_cmd_batch_add_filter(&b, &filt);
+
+    CHECK(ld2450_cmd_batch_run(&b) == ESP_OK, "batch failed");
+    CHECK(!g_emu.set.bluetooth, "bluetooth still on");
+    CHECK(g_emu.set.tracking == 1, "tracking %u", g_emu.set.tracking);
+    CHECK(g_emu.set.zone[0] == 1, "zone type %u", g_emu.set.zone[0]);
+    for (uint8_t i = 0; i < filt.count; i++) {
+        const uint8_t *p = &g_emu.set.zone[2 + i * 8];
+        CHECK((int16_t)(p[0] | (p[1] << 8)) == filt.rect[i].x1 &&
+              (int16_t)(p[6] | (p[7] << 8)) == filt.rect[i].y2, "rect %u", i);
+    }
+    CHECK(g_emu.stats.sessions == 1 && !g_emu.config_mode, "sessions %u", g_emu.stats.sessions);
+
+    /* Everything is cached now: no session, no pause */
+    uint32_t cmds = g_emu.stats.commands, pauses = g_pauses;
+    CHECK(ld2450_cmd_batch_run(&b) == ESP_OK, "second batch failed");
+    CHECK(g_emu.stats.commands == cmds && g_pauses == pauses, "second batch reached the sensor");
+}
+
+static void test_ack_timeout(void)
+{
+    ld2450_emu_faults_t f = faults_default();
+    f.drop_ack_pct = 100;
+    f.drop_ack_cmd = 0xC2;
+    reset(&f);
+
+    ld2450_hw_filter_t filt;
+    ld2450_hw_filter_plan_range(3000, 45, 45, &filt);
+    uint32_t t0 = g_now;
+    esp_err_t err = ld2450_cmd_set_filter(&filt);
+    CHECK(err == ESP_ERR_TIMEOUT, "got %s", esp_err_to_name(err));
+    CHECK(g_now - t0 >= 500, "gave up after %u ms", g_now - t0);
+    CHECK(!g_emu.config_mode, "left in config mode");
+    CHECK(!g_paused, "RX left paused");
+
+    /* Lost ACK, applied command: the cache must not claim it */
+    ld2450_sensor_info_t info;
+    ld2450_cmd_get_sensor_info(&info);
+    CHECK(!info.region_valid || info.zone_type == 0, "cached an unacknowledged filter");
+}
+
+static void test_nak_and_silence(void)
+{
+    ld2450_emu_faults_t f = faults_default();
+    f.nak_pct = 100;
+    reset(&f);
+    esp_err_t err = ld2450_cmd_set_single_target();
+    CHECK(err == ESP_FAIL, "nak: got %s", esp_err_to_name(err));
+    CHECK(g_emu.set.tracking == 2, "applied despite NAK");
+
+    f = faults_default();
+    f.drop_ack_pct = 100;
+    reset(&f);
+    uint32_t t0 = g_now;
+    err = ld2450_cmd_set_multi_target();
+    CHECK(err == ESP_ERR_TIMEOUT, "silent: got %s", esp_err_to_name(err));
+    CHECK(g_now - t0 >= 500 && g_now - t0 < 1000, "silent sensor held the UART %u ms", g_now - t0);
+}
+
+static void test_restart_and_factory_reset(void)
+{
+    ld2450_emu_faults_t f = faults_default();
+    reset(&f);
+
+    CHECK(ld2450_cmd_set_single_target() == ESP_OK, "single");
+    CHECK(ld2450_cmd_factory_reset() == ESP_OK, "factory reset");
+    CHECK(g_emu.set.tracking == 1, "reset before restart");
+    /* The sensor reboots after the restart ACK, so the disable-config that
+     * follows goes unanswered: the session ends on exit_config()'s three
+     * retries and a second restart, about 3 s in all */
+    uint32_t t0 = g_now;
+    CHECK(ld2450_cmd_restart() == ESP_OK, "restart");
+    CHECK(g_emu.stats.restarts == 1, "restarts %u", g_emu.stats.restarts);
+    CHECK(g_now - t0 < 3500, "restart held the UART %u ms", g_now - t0);
+    if (g_verbose) printf("restart held the UART %u ms\n", g_now - t0);
+    uint32_t frames = g_emu.stats.frames;
+    idle(500);
+    CHECK(g_emu.stats.frames > frames, "no frames after reboot");
+    CHECK(g_emu.set.tracking == 2, "factory reset not applied");
+
+    /* The cache knows the reset reverted everything */
+    ld2450_sensor_info_t info;
+    ld2450_cmd_get_sensor_info(&info);
+    CHECK(info.tracking == -1 && !info.region_valid, "cache survived factory reset");
+}
+
+// ---------------------------------------------------------------------------
+// Parser resilience
+// ---------------------------------------------------------------------------
+
+static void test_parser_on_faulty_stream(void)
+{
+    static const ld2450_emu_key_t script[] = {
+        {    0, 0, true, -1500, 2000,  20 },
+        {    0, 1, true,  1200, 3500,   0 },
+        { 5000, 0, true,  1500, 4000, -20 },
+    };
+    ld2450_emu_faults_t f = faults_default();
+    f.corrupt_pct = 10;
+    f.garbage_pct = 20;
+    f.seed = 7;
+    ld2450_emu_init(&g_emu, &f, g_now);
+    ld2450_emu_set_script(&g_emu, script, 3, 5000);
+
+    ld2450_parser_t *p = ld2450_parser_create();
+    uint32_t mismatches = 0, checked = 0;
+    uint8_t buf[97];                     /* odd size: frames split across reads */
+    for (int i = 0; i < 600; i++) {
+        g_now += 100;
+        size_t n;
+        while ((n = ld2450_emu_tx(&g_emu, g_now, buf, sizeof(buf))) > 0) {
+            if (!ld2450_parser_feed(p, buf, n)) continue;
+            const ld2450_report_t *r = ld2450_parser_get_report(p);
+            ld2450_emu_key_t want[LD2450_EMU_TARGETS];
+            ld2450_emu_targets_at(&g_emu, g_emu.last_frame_ms, want);
+            checked++;
+            for (int t = 0; t < 2; t++) {
+                if (!r->targets[t].present || r->targets[t].x_mm != want[t].x_mm ||
+                    r->targets[t].y_mm != want[t].y_mm || r->targets[t].speed != want[t].speed) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    ld2450_parser_stats_t st;
+    ld2450_parser_get_stats(p, &st);
+    ld2450_parser_destroy(p);
+
+    CHECK(g_emu.stats.corrupted > 0 && g_emu.stats.garbage_bytes > 0, "no faults injected");
+    CHECK(st.frames == g_emu.stats.frames - g_emu.stats.corrupted,
+          "parsed %u of %u good frames", st.frames, g_emu.stats.frames - g_emu.stats.corrupted);
+    CHECK(st.bad_frames == g_emu.stats.corrupted, "bad %u, corrupted %u",
+          st.bad_frames, g_emu.stats.corrupted);
+    CHECK(st.garbage_bytes >= g_emu.stats.garbage_bytes, "garbage %u < %u",
+          st.garbage_bytes, g_emu.stats.garbage_bytes);
+    CHECK(checked > 100 && mismatches == 0, "%u of %u reports decoded wrong", mismatches, checked);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+typedef enum { MIX_ONE, MIX_BATCH, MIX_QUERY } mix_t;
+
+static uint32_t run_mix(mix_t mix, bool stream_in_config, uint32_t ack_delay_ms, uint32_t *session_ms)
+{
+    ld2450_emu_faults_t f = faults_default();
+    f.stream_in_config = stream_in_config;
+    f.ack_delay_ms = ack_delay_ms;
+    reset(&f);
+    ld2450_cmd_query();                  /* firmware/MAC read once, as after boot */
+    g_emu.stats.session_ms_max = 0;
+    g_blackout_max = 0;
+
+    ld2450_hw_filter_t filt;
+    ld2450_hw_filter_plan_range(4000, 50, 50, &filt);
+    ld2450_cmd_batch_t b;
+    ld2450_cmd_batch_init(&b);
+    switch (mix) {
+    case MIX_ONE:
+        ld2450_cmd_batch_add_filter(&b, &filt);
+        ld2450_cmd_batch_run(&b);
+        break;
+    case MIX_BATCH:
+        ld2450_cmd_batch_add_bluetooth(&b, false);
+        ld2450_cmd_batch_add_single_target(&b);
+        ld2450_cmd_batch_add_filter(&b, &filt);
+        ld2450_cmd_batch_run(&b);
+        break;
+    case MIX_QUERY:
+        ld2450_cmd_query();
+        break;
+    }
+    *session_ms = g_emu.stats.session_ms_max;
+    return g_blackout_max;
+}
+
+static void bench(void)
+{
+    static const char *const names[] = {"1 command", "3-command batch", "read-back"};
+    static const uint32_t k_acks[] = {3, 5, 6};     /* including enable/disable-config */
+    printf("\nconfig session / RX blackout (virtual ms, ACK after 20 ms)\n");
+    printf("  %-16s %-24s %-24s\n", "", "silent in config mode", "streaming in config mode");
+    for (int m = MIX_ONE; m <= MIX_QUERY; m++) {
+        uint32_t s_quiet, s_stream;
+        uint32_t b_quiet  = run_mix((mix_t)m, false, 20, &s_quiet);
+        uint32_t b_stream = run_mix((mix_t)m, true,  20, &s_stream);
+        printf("  %-16s %6u / %-15u %6u / %u\n", names[m], s_quiet, b_quiet, s_stream, b_stream);
+
+        /* Each ACK read ends by its 500 ms deadline, plus 50 ms between commands */
+        CHECK(b_quiet <= k_acks[m] * 550u + 100u, "%s blackout %u", names[m], b_quiet);
+        CHECK(b_stream < b_quiet, "%s: streaming did not shorten the session", names[m]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    g_verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+
+    test_query_reads_sensor();
+    test_batch_applies_then_skips();
+    test_ack_timeout();
+    test_nak_and_silence();
+    test_restart_and_factory_reset();
+    test_parser_on_faulty_stream();
+    bench();
+
+    return check_result("ld2450_cmd_emu");
+}
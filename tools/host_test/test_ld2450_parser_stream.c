@@ -75,7 +75,16 @@ int main(void)
     feed_and_count(p, bad, 30);               // should NOT parse
     feed_and_count(p, f1, 30);                // should parse
 
+    // Counters: every byte of the garbage and of the bad frame is dropped
+    ld2450_parser_stats_t st;
+    ld2450_parser_get_stats(p, &st);
     ld2450_parser_destroy(p);
+    if (st.bytes != 156 || st.frames != 4 || st.garbage_bytes != 36 || st.bad_frames != 1) {
+        fprintf(stderr, "FAIL: stats bytes=%u frames=%u garbage=%u bad=%u\n",
+                (unsigned)st.bytes, (unsigned)st.frames,
+                (unsigned)st.garbage_bytes, (unsigned)st.bad_frames);
+        return 3;
+    }
 
     // Expectations:
     // - after split frame: parsed=1
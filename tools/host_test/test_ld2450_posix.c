@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test: the ld2450 component on tools/posix_port, talking to the
+// sensor emulator over a real pseudo-terminal
+//
+// Build: make -C tools/host_test build/test_ld2450_posix
+// Run:   tools/host_test/build/test_ld2450_posix [-v]
+//
+// What ld2450d runs, minus the socket: the UART task, parser, zone
+// evaluation, command module and worker, on threads and a tty, against the
+// emulator served from a thread here.  Real time, about 10 s.
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ld2450.h"
+#include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
+#include "ld2450_emu.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "check.h"
+
+static bool g_verbose = false;
+
+// ---------------------------------------------------------------------------
+// Emulator on the master side of a pty
+// ---------------------------------------------------------------------------
+
+static ld2450_emu_t g_emu;
+static pthread_mutex_t g_emu_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_master = -1;
+
+/* Two people standing still: one in zone 1, one outside it */
+static const ld2450_emu_key_t k_script[] = {
+    { 0, 0, true,  -500, 1500, 0 },
+    { 0, 1, true,  2000, 4000, 0 },
+};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void *emu_thread(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_emu_lock);
+        uint32_t now = now_ms();
+        int wait = (int)(ld2450_emu_next_ms(&g_emu, now) - now);
+        pthread_mutex_unlock(&g_emu_lock);
+        if (wait < 0) wait = 0;
+        if (wait > 20) wait = 20;
+
+        struct pollfd pfd = { .fd = g_master, .events = POLLIN };
+        int pr = poll(&pfd, 1, wait);
+        uint8_t buf[512];
+        pthread_mutex_lock(&g_emu_lock);
+        now = now_ms();
+        if (pr > 0 && (pfd.revents & POLLIN)) {
+            ssize_t n = read(g_master, buf, sizeof(buf));
+            if (n > 0) ld2450_emu_rx(&g_emu, now, buf, (size_t)n);
+        }
+        size_t n;
+        while ((n = ld2450_emu_tx(&g_emu, now, buf, sizeof(buf))) > 0) {
+            if (write(g_master, buf, n) < 0) break;
+        }
+        pthread_mutex_unlock(&g_emu_lock);
+    }
+    return NULL;
+}
+
+static const char *emu_start(void)
+{
+    g_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (g_master < 0 || grantpt(g_master) != 0 || unlockpt(g_master) != 0) return NULL;
+    ld2450_emu_faults_t f;
+    ld2450_emu_default_faults(&f);
+    ld2450_emu_init(&g_emu, &f, now_ms());
+    ld2450_emu_set_script(&g_emu, k_script, 2, 0);
+    pthread_t th;
+    if (pthread_create(&th, NULL, emu_thread, NULL) != 0) return NULL;
+    pthread_detach(th);
+    return ptsname(g_master);
+}
+
+static ld2450_emu_settings_t emu_settings(void)
+{
+    pthread_mutex_lock(&g_emu_lock);
+    ld2450_emu_settings_t s = g_emu.set;
+    pthread_mutex_unlock(&g_emu_lock);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Port primitives
+// ---------------------------------------------------------------------------
+
+static volatile int g_notified;
+
+static void notify_task(void *arg)
+{
+    SemaphoreHandle_t done = arg;
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) == 1) g_notified = 1;
+    xSemaphoreGive(done);
+    vTaskDelete(NULL);
+}
+
+static void test_port_primitives(void)
+{
+    /* Timeouts are in milliseconds and measured on the monotonic clock */
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    TickType_t t0 = xTaskGetTickCount();
+    CHECK(xSemaphoreTake(sem, pdMS_TO_TICKS(50)) == pdFALSE, "empty binary semaphore taken");
+    TickType_t dt = xTaskGetTickCount() - t0;
+    CHECK(dt >= 50 && dt < 150, "50 ms timeout took %u ms", (unsigned)dt);
+    CHECK(xSemaphoreGive(sem) == pdTRUE && xSemaphoreGive(sem) == pdFALSE, "binary counts past 1");
+
+    /* Queues copy items and refuse when full */
+    QueueHandle_t q = xQueueCreate(2, sizeof(uint32_t));
+    uint32_t a = 1, b = 2, c = 3, out = 0;
+    CHECK(xQueueSend(q, &a, 0) && xQueueSend(q, &b, 0) && !xQueueSend(q, &c, 0), "queue bounds");
+    CHECK(uxQueueMessagesWaiting(q) == 2, "waiting %u", (unsigned)uxQueueMessagesWaiting(q));
+    CHECK(xQueueReceive(q, &out, 0) && out == 1, "fifo order");
+    vQueueDelete(q);
+
+    /* Task notifications wake the task they are given to */
+    TaskHandle_t task = NULL;
+    CHECK(xTaskCreate(notify_task, "notify", 2048, sem, 5, &task) == pdPASS && task, "create");
+    xSemaphoreTake(sem, 0);
+    xTaskNotifyGive(task);
+    CHECK(xSemaphoreTake(sem, pdMS_TO_TICKS(1000)) == pdTRUE && g_notified, "notify lost");
+    vSemaphoreDelete(sem);
+}
+
+// ---------------------------------------------------------------------------
+// Component on the pty
+// ---------------------------------------------------------------------------
+
+static void test_stream_and_zones(void)
+{
+    CHECK(ld2450_wait_for_first_frame(2000) == ESP_OK, "no first frame");
+    vTaskDelay(pdMS_TO_TICKS(300));
+
+    ld2450_state_t st;
+    ld2450_get_state(&st);
+    CHECK(st.occupied_global && st.target_count_raw == 2, "count %u", st.target_count_raw);
+    CHECK(st.targets[0].x_mm == -500 && st.targets[0].y_mm == 1500, "t0 %d,%d",
+          st.targets[0].x_mm, st.targets[0].y_mm);
+    CHECK(st.targets[1].x_mm == 2000 && st.targets[1].y_mm == 4000, "t1 %d,%d",
+          st.targets[1].x_mm, st.targets[1].y_mm);
+    CHECK(st.zone_bitmap == 0x1, "zones 0x%03X", st.zone_bitmap);
+
+    ld2450_rx_stats_t rx;
+    ld2450_get_rx_stats(&rx, true);
+    CHECK(rx.frames >= 3 && rx.bad_frames == 0 && rx.garbage_bytes == 0,
+          "frames %u bad %u garbage %u", rx.frames, rx.bad_frames, rx.garbage_bytes);
+}
+
+static void test_rx_pause_is_prompt(void)
+{
+    /* ld2450_rx_pause() gives up after 200 ms and the session starts anyway;
+     * if the RX task is still inside a read then, it can eat the first ACK */
+    uint32_t worst = 0;
+    for (int i = 0; i < 20; i++) {
+        vTaskDelay(pdMS_TO_TICKS(37 + i * 11));         /* land anywhere in a frame period */
+        int64_t t0 = esp_timer_get_time();
+        ld2450_rx_pause();
+        uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+        ld2450_rx_resume();
+        if (ms > worst) worst = ms;
+    }
+    CHECK(worst < 150, "RX pause took %u ms", worst);
+    if (g_verbose) printf("slowest RX pause %u ms\n", worst);
+}
+
+static void test_commands_through_worker(void)
+{
+    ld2450_cmd_req_t q = { .op = LD2450_CMD_OP_QUERY };
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = ld2450_cmd_submit_wait(&q);
+    CHECK(err == ESP_OK, "query: %s", esp_err_to_name(err));
+    if (g_verbose) printf("query took %lld ms\n", (long long)((esp_timer_get_time() - t0) / 1000));
+
+    ld2450_sensor_info_t info;
+    ld2450_cmd_get_sensor_info(&info);
+    ld2450_emu_settings_t set = emu_settings();
+    CHECK(info.fw_valid && info.fw_minor == set.fw_minor, "fw");
+    CHECK(info.mac_valid && memcmp(info.mac, set.mac, 6) == 0, "mac");
+
+    ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_BATCH };
+    ld2450_cmd_batch_init(&req.u.batch);
+    ld2450_cmd_batch_add_single_target(&req.u.batch);
+    ld2450_cmd_batch_add_distance_angle(&req.u.batch, 3000, 60, 60);
+    CHECK(ld2450_cmd_submit_wait(&req) == ESP_OK, "batch");
+    set = emu_settings();
+    CHECK(set.tracking == 1 && set.zone[0] == 1, "tracking %u zone type %u", set.tracking, set.zone[0]);
+
+    /* The stream comes back after the session; the far target is filtered */
+    vTaskDelay(pdMS_TO_TICKS(400));
+    ld2450_state_t st;
+    ld2450_get_state(&st);
+    CHECK(st.target_count_raw == 1 && st.targets[0].y_mm == 1500, "count %u y %d",
+          st.target_count_raw, st.targets[0].y_mm);
+
+    ld2450_cmd_status_t cs;
+    ld2450_cmd_worker_get_status(&cs);
+    CHECK(cs.completed == 2 && cs.failed == 0, "completed %u failed %u", cs.completed, cs.failed);
+}
+
+int main(int argc, char **argv)
+{
+    g_verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    esp_log_level_set("*", g_verbose ? ESP_LOG_DEBUG : ESP_LOG_NONE);
+
+    test_port_primitives();
+
+    const char *tty = emu_start();
+    if (!tty) {
+        printf("FAIL: ld2450_posix (no pty: %s)\n", strerror(errno));
+        return 1;
+    }
+    uart_posix_set_device(UART_NUM_1, tty);
+    ld2450_config_t cfg = { .uart_num = UART_NUM_1, .baud_rate = 256000, .rx_buf_size = 2048 };
+    ld2450_zone_t zone1 = {
+        .vertex_count = 4,
+        .v = { { -1000, 500 }, { 1000, 500 }, { 1000, 2500 }, { -1000, 2500 } },
+    };
+    CHECK(ld2450_init(&cfg) == ESP_OK && ld2450_cmd_init() == ESP_OK &&
+          ld2450_cmd_worker_start() == ESP_OK, "init");
+    CHECK(ld2450_set_zone(0, &zone1) == ESP_OK, "zone");
+
+    test_stream_and_zones();
+    test_rx_pause_is_prompt();
+    test_commands_through_worker();
+
+    return check_result("ld2450_posix");
+}
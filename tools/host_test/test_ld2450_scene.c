@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test + benchmark: the scene generator in tools/ld2450_scene, and
+// the parser and zone geometry scored against its ground truth
+//
+// Build: make -C tools/host_test build/test_ld2450_scene
+// Run:   tools/host_test/build/test_ld2450_scene [-v]
+//
+// Every preset is streamed through ld2450_parser_feed() a frame at a time.
+// The test part checks the stream decodes to exactly the slots the truth
+// says are filled, and that the radar model does what it claims (occlusion,
+// dropouts, the 3-target cap, ghosts, determinism).
+//
+// The benchmark part scores what the firmware gets against where people
+// really are, per preset:
+//   targets: a reported target within 600 mm of a person is a hit, else a
+//            false target (ghost); precision, recall of people in view,
+//            and position RMSE of the hits
+//   zones:   per-frame occupancy of the desk/sofa/door zones of
+//            test_pipeline_sim from the raw targets (no hold times, see
+//            test_pipeline_sim for those) vs from the true positions;
+//            precision, recall, and entry latency (true entry to first
+//            reported frame inside)
+// plus generator + parser throughput.
+#define _POSIX_C_SOURCE 199309L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "ld2450_parser.h"
+#include "ld2450_scene.h"
+#include "ld2450_zone.h"
+#include "check.h"
+
+static bool g_verbose = false;
+
+#define MATCH_MM    600
+#define ZONES       3
+
+/* Desk, sofa, door: the room of test_pipeline_sim and the presets */
+static const ld2450_zone_t k_zones[ZONES] = {
+    { 4, { { -1500, 1000 }, {    0, 1000 }, {    0, 2500 }, { -1500, 2500 } } },
+    { 4, { {   500, 3000 }, { 2500, 3000 }, { 2500, 4500 }, {   500, 4500 } } },
+    { 4, { { -2500, 4500 }, { -1500, 4500 }, { -1500, 5500 }, { -2500, 5500 } } },
+};
+
+static size_t load(const char *name, ld2450_scene_person_t *people, ld2450_scene_radar_t *radar)
+{
+    size_t n = ld2450_scene_preset(name, people, radar);
+    CHECK(n > 0, "no preset %s", name);
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Generator
+// ---------------------------------------------------------------------------
+
+static void test_stream_decodes_to_truth(void)
+{
+    const char *name;
+    for (size_t i = 0; (name = ld2450_scene_preset_name(i, NULL)) != NULL; i++) {
+        ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+        ld2450_scene_radar_t radar;
+        size_t n = load(name, people, &radar);
+        ld2450_scene_t s;
+        ld2450_scene_init(&s, people, n, &radar);
+        ld2450_parser_t *p = ld2450_parser_create();
+        uint32_t end = ld2450_scene_end_ms(people, n) + 1000;
+        unsigned bad = 0, far = 0, roundtrip = 0;
+
+        while (s.next_ms < end) {
+            uint8_t f[LD2450_SCENE_FRAME_LEN];
+            ld2450_scene_truth_t t;
+            ld2450_scene_frame(&s, f, &t);
+            if (!ld2450_parser_feed(p, f, sizeof(f))) {
+                bad++;
+                continue;
+            }
+            const ld2450_report_t *r = ld2450_parser_get_report(p);
+
+            bool want[LD2450_SCENE_SLOTS] = { false };
+            int16_t wx[LD2450_SCENE_SLOTS] = { 0 }, wy[LD2450_SCENE_SLOTS] = { 0 };
+            for (uint8_t k = 0; k < t.n; k++) {
+                if (t.person[k].state != LD2450_SCENE_SEEN) continue;
+                want[t.person[k].slot] = true;
+                wx[t.person[k].slot] = t.person[k].x_mm;
+                wy[t.person[k].slot] = t.person[k].y_mm;
+            }
+            if (t.ghost_slot >= 0) {
+                want[t.ghost_slot] = true;
+                wx[t.ghost_slot] = t.ghost_x_mm;
+                wy[t.ghost_slot] = t.ghost_y_mm;
+            }
+            for (int k = 0; k < LD2450_SCENE_SLOTS; k++) {
+                if (r->targets[k].present != want[k]) bad++;
+                else if (want[k] && (abs(r->targets[k].x_mm - wx[k]) > 500 ||
+                                     abs(r->targets[k].y_mm - wy[k]) > 500)) far++;
+            }
+
+            char line[512];
+            ld2450_scene_truth_t back;
+            if (ld2450_scene_truth_format(&t, line, sizeof(line)) < 0 ||
+                !ld2450_scene_truth_parse(line, &back) || memcmp(&back, &t, sizeof(t)) != 0) {
+                roundtrip++;
+            }
+        }
+        ld2450_parser_stats_t st;
+        ld2450_parser_get_stats(p, &st);
+        CHECK(bad == 0 && st.frames == s.stats.frames && st.garbage_bytes == 0,
+              "%s: %u slot mismatches, %u of %u frames parsed", name, bad, st.frames, s.stats.frames);
+        CHECK(far == 0, "%s: %u targets beyond 500 mm of the truth", name, far);
+        CHECK(roundtrip == 0, "%s: %u truth lines do not round-trip", name, roundtrip);
+        ld2450_parser_destroy(p);
+    }
+}
+
+static uint32_t stream_hash(const char *name, uint32_t seed, ld2450_scene_stats_t *stats)
+{
+    ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+    ld2450_scene_radar_t radar;
+    size_t n = load(name, people, &radar);
+    radar.seed = seed;
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, people, n, &radar);
+    uint32_t h = 2166136261u;                   /* FNV-1a */
+    for (int i = 0; i < 600; i++) {
+        uint8_t f[LD2450_SCENE_FRAME_LEN];
+        ld2450_scene_frame(&s, f, NULL);
+        for (size_t k = 0; k < sizeof(f); k++) h = (h ^ f[k]) * 16777619u;
+    }
+    *stats = s.stats;
+    return h;
+}
+
+static void test_radar_model(void)
+{
+    ld2450_scene_stats_t a, b;
+    CHECK(stream_hash("crowd", 7, &a) == stream_hash("crowd", 7, &b), "same seed, different stream");
+    CHECK(stream_hash("crowd", 7, &a) != stream_hash("crowd", 8, &b), "seed ignored");
+
+    stream_hash("occlude", 2450, &a);
+    CHECK(a.occluded >= 10, "occlude: %u occluded person-frames", a.occluded);
+    stream_hash("sit", 2450, &a);
+    CHECK(a.lost >= 50 && a.occluded * 10 < a.seen, "sit: lost %u occluded %u", a.lost, a.occluded);
+    stream_hash("ghosts", 2450, &a);
+    CHECK(a.ghost_frames >= 20, "ghosts: %u ghost frames", a.ghost_frames);
+    stream_hash("crowd", 2450, &a);
+    CHECK(a.capped > 0, "crowd: never more than 3 in view");
+    stream_hash("walk", 2450, &a);
+    CHECK(a.ghost_frames == 0 && a.capped == 0 && a.occluded == 0, "walk: ghosts %u capped %u occluded %u",
+          a.ghost_frames, a.capped, a.occluded);
+
+    /* Walking towards the sensor reads as negative speed, as on the module */
+    ld2450_scene_person_t in = { 1, 0, 1000, 2, { { 0, 4000, 0 }, { 0, 1000, 0 } } };
+    ld2450_scene_radar_t quiet;
+    ld2450_scene_default_radar(&quiet);
+    quiet.jitter_mm = 0;
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, &in, 1, &quiet);
+    ld2450_parser_t *p = ld2450_parser_create();
+    uint8_t f[LD2450_SCENE_FRAME_LEN];
+    for (int i = 0; i < 15; i++) {
+        ld2450_scene_frame(&s, f, NULL);
+        ld2450_parser_feed(p, f, sizeof(f));
+    }
+    const ld2450_report_t *r = ld2450_parser_get_report(p);
+    CHECK(r->targets[0].present && r->targets[0].speed == -100 && r->targets[0].y_mm == 2600,
+          "speed %d y %d", r->targets[0].speed, r->targets[0].y_mm);
+    ld2450_parser_destroy(p);
+
+    /* Out of view: beyond 60 degrees */
+    ld2450_scene_person_t side = { 1, 0, 1000, 1, { { 3000, 1000, 5000 } } };
+    ld2450_scene_init(&s, &side, 1, &quiet);
+    ld2450_scene_truth_t t;
+    ld2450_scene_frame(&s, f, &t);
+    CHECK(t.n == 1 && t.person[0].state == LD2450_SCENE_OUT_OF_VIEW, "state %u", t.person[0].state);
+}
+
+static void test_truth_parse_rejects(void)
+{
+    ld2450_scene_truth_t t;
+    CHECK(ld2450_scene_truth_parse("1200 1:-750,1750:0 2:1500,3750:o g:2000,400:1", &t) &&
+          t.t_ms == 1200 && t.n == 2 && t.person[0].x_mm == -750 && t.person[0].slot == 0 &&
+          t.person[1].state == LD2450_SCENE_OCCLUDED && t.ghost_slot == 1, "valid line");
+    CHECK(!ld2450_scene_truth_parse("", &t), "empty");
+    CHECK(!ld2450_scene_truth_parse("100 1:5,5:x", &t), "bad state");
+    CHECK(!ld2450_scene_truth_parse("100 g:1,1:3", &t), "ghost slot 3");
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t hits, false_targets, in_view;
+    double   sq_err;
+    uint32_t zone_tp[ZONES], zone_fp[ZONES], zone_fn[ZONES];
+    uint32_t entries, entries_missed;
+    uint64_t latency_sum;
+    uint32_t latency_max;
+} score_t;
+
+static bool in_zone(int z, int16_t x, int16_t y)
+{
+    ld2450_point_t pt = { x, y };
+    return ld2450_zone_contains_point(&k_zones[z], pt);
+}
+
+static void score_preset(const char *name, score_t *sc)
+{
+    ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+    ld2450_scene_radar_t radar;
+    size_t n = load(name, people, &radar);
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, people, n, &radar);
+    ld2450_parser_t *p = ld2450_parser_create();
+    uint32_t end = ld2450_scene_end_ms(people, n) + 2000;
+
+    bool was_true[ZONES] = { false };
+    uint32_t pending_since[ZONES] = { 0 };
+    bool pending[ZONES] = { false };
+    memset(sc, 0, sizeof(*sc));
+
+    while (s.next_ms < end) {
+        uint8_t f[LD2450_SCENE_FRAME_LEN];
+        ld2450_scene_truth_t t;
+        ld2450_scene_frame(&s, f, &t);
+        ld2450_parser_feed(p, f, sizeof(f));
+        const ld2450_report_t *r = ld2450_parser_get_report(p);
+
+        /* Targets: greedy nearest match to people in view */
+        bool used[LD2450_SCENE_PEOPLE_MAX] = { false };
+        for (uint8_t k = 0; k < t.n; k++) {
+            if (t.person[k].state != LD2450_SCENE_OUT_OF_VIEW) sc->in_view++;
+        }
+        for (int k = 0; k < LD2450_SCENE_SLOTS; k++) {
+            if (!r->targets[k].present) continue;
+            int best = -1;
+            double best_d = MATCH_MM;
+            for (uint8_t j = 0; j < t.n; j++) {
+                if (used[j] || t.person[j].state == LD2450_SCENE_OUT_OF_VIEW) continue;
+                double d = hypot(r->targets[k].x_mm - t.person[j].x_mm, r->targets[k].y_mm - t.person[j].y_mm);
+                if (d <= best_d) {
+                    best_d = d;
+                    best = j;
+                }
+            }
+            if (best < 0) {
+                sc->false_targets++;
+            } else {
+                used[best] = true;
+                sc->hits++;
+                sc->sq_err += best_d * best_d;
+            }
+        }
+
+        /* Zones: raw per-frame occupancy */
+        for (int z = 0; z < ZONES; z++) {
+            bool truth = false, seen = false;
+            for (uint8_t j = 0; j < t.n; j++) {
+                if (t.person[j].state != LD2450_SCENE_OUT_OF_VIEW && in_zone(z, t.person[j].x_mm, t.person[j].y_mm)) {
+                    truth = true;
+                }
+            }
+            for (int k = 0; k < LD2450_SCENE_SLOTS; k++) {
+                if (r->targets[k].present && in_zone(z, r->targets[k].x_mm, r->targets[k].y_mm)) seen = true;
+            }
+            if (truth && seen)  sc->zone_tp[z]++;
+            if (!truth && seen) sc->zone_fp[z]++;
+            if (truth && !seen) sc->zone_fn[z]++;
+
+            if (truth && !was_true[z]) {
+                sc->entries++;
+                pending[z] = true;
+                pending_since[z] = t.t_ms;
+            }
+            if (pending[z] && seen) {
+                uint32_t lat = t.t_ms - pending_since[z];
+                sc->latency_sum += lat;
+                if (lat > sc->latency_max) sc->latency_max = lat;
+                pending[z] = false;
+            } else if (pending[z] && !truth) {
+                sc->entries_missed++;               /* left again before being seen */
+                pending[z] = false;
+            }
+            was_true[z] = truth;
+        }
+    }
+    for (int z = 0; z < ZONES; z++) {
+        if (pending[z]) sc->entries_missed++;
+    }
+    ld2450_parser_destroy(p);
+}
+
+static double ratio(uint32_t num, uint32_t den)
+{
+    return den ? (double)num / den : 1.0;
+}
+
+static void bench(void)
+{
+    printf("\nscenes vs ground truth (targets within %d mm; zones per 100 ms frame, raw)\n", MATCH_MM);
+    printf("  %-8s %6s %6s %6s %5s   %6s %6s %8s %8s %7s\n", "", "prec", "recall", "rmse", "false",
+           "z.prec", "z.rec", "entries", "lat.avg", "lat.max");
+
+    const char *name;
+    score_t walk = { 0 }, ghosts = { 0 };
+    for (size_t i = 0; (name = ld2450_scene_preset_name(i, NULL)) != NULL; i++) {
+        score_t sc;
+        score_preset(name, &sc);
+        uint32_t tp = 0, fp = 0, fn = 0;
+        for (int z = 0; z < ZONES; z++) {
+            tp += sc.zone_tp[z];
+            fp += sc.zone_fp[z];
+            fn += sc.zone_fn[z];
+        }
+        uint32_t entered = sc.entries - sc.entries_missed;
+        printf("  %-8s %6.3f %6.3f %4.0fmm %5u   %6.3f %6.3f %4u/%-3u %6.0fms %5ums\n", name,
+               ratio(sc.hits, sc.hits + sc.false_targets), ratio(sc.hits, sc.in_view),
+               sc.hits ? sqrt(sc.sq_err / sc.hits) : 0.0, sc.false_targets,
+               ratio(tp, tp + fp), ratio(tp, tp + fn), entered, sc.entries,
+               entered ? (double)sc.latency_sum / entered : 0.0, sc.latency_max);
+
+        if (strcmp(name, "walk") == 0) walk = sc;
+        if (strcmp(name, "ghosts") == 0) ghosts = sc;
+        CHECK(ratio(sc.hits, sc.hits + sc.false_targets) > 0.60, "%s: precision", name);
+        CHECK(ratio(sc.hits, sc.in_view) > 0.60, "%s: recall", name);
+        CHECK(sc.hits && sqrt(sc.sq_err / sc.hits) < 150.0, "%s: rmse", name);
+    }
+    CHECK(walk.false_targets == 0 && ratio(walk.hits, walk.in_view) > 0.95 && walk.latency_max <= 300,
+          "walk: false %u recall %.3f latency %u", walk.false_targets,
+          ratio(walk.hits, walk.in_view), walk.latency_max);
+    CHECK(ghosts.false_targets > 0, "ghosts scored no false targets");
+
+    /* Throughput: generating and parsing a long random scene */
+    ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+    size_t n = ld2450_scene_random(people, LD2450_SCENE_PEOPLE_MAX, 600000, 99);
+    ld2450_scene_radar_t radar;
+    ld2450_scene_default_radar(&radar);
+    radar.ghost_pct = 2;
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, people, n, &radar);
+    ld2450_parser_t *p = ld2450_parser_create();
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint32_t parsed = 0;
+    while (s.next_ms < 600000) {
+        uint8_t f[LD2450_SCENE_FRAME_LEN];
+        ld2450_scene_frame(&s, f, NULL);
+        parsed += ld2450_parser_feed(p, f, sizeof(f));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("  random, 8 people, 10 min: %u frames in %.3f s (%.0f frames/s)\n\n",
+           parsed, sec, sec > 0 ? parsed / sec : 0.0);
+    CHECK(parsed == s.stats.frames, "parsed %u of %u", parsed, s.stats.frames);
+    if (g_verbose) {
+        printf("  person-frames: seen %u occluded %u lost %u capped %u out of view %u, ghost frames %u\n",
+               s.stats.seen, s.stats.occluded, s.stats.lost, s.stats.capped, s.stats.out_of_view,
+               s.stats.ghost_frames);
+    }
+    ld2450_parser_destroy(p);
+}
+
+int main(int argc, char **argv)
+{
+    g_verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+
+    test_stream_decodes_to_truth();
+    test_radar_model();
+    test_truth_parse_rejects();
+    bench();
+
+    return check_result("ld2450_scene");
+}
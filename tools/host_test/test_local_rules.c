@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/local_rules.c
+//
+// Build: make -C tools/host_test build/test_local_rules
+// Run:   tools/host_test/build/test_local_rules [transitions]
+//
+// Checks parsing (good and bad rules), the canonical text round trip, table
+// validation and edge-triggered evaluation including the fallback / always
+// split, then replays random occupancy transitions against a rule table and
+// compares each rule's fire count with a brute-force reference, and counts
+// frames and latency against the coordinator round trip it replaces.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "local_rules.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+#define Z(n) ((uint16_t)(1u << (n)))
+
+/* ---- Parsing ---- */
+
+static void test_parse(void)
+{
+    local_rule_t r;
+    const char *err;
+
+    CHECK(local_rule_parse("z2 !z5 -> level 40 group 0x0003", &r, &err), "example 1: %s", err);
+    CHECK(r.occ_mask == Z(2) && r.clear_mask == Z(5) && r.any_mask == 0, "masks %x %x %x",
+          r.occ_mask, r.clear_mask, r.any_mask);
+    CHECK(r.action == LR_ACT_LEVEL && r.arg == 40, "level %u %u", r.action, r.arg);
+    CHECK(r.dst_mode == LR_DST_GROUP && r.dst == 3, "dst %u %u", r.dst_mode, r.dst);
+    CHECK(r.flags == 0, "flags %u", r.flags);
+
+    CHECK(local_rule_parse("ANY -> Scene 1 Group 3 always", &r, &err), "example 2: %s", err);
+    CHECK(r.any_mask == LR_ZONES_MASK && r.action == LR_ACT_SCENE && r.arg == 1, "scene rule");
+    CHECK(r.flags & LR_FLAG_ALWAYS, "always flag");
+
+    CHECK(local_rule_parse("none -> off", &r, &err), "none: %s", err);
+    CHECK(r.clear_mask == LR_ALL_MASK && r.dst_mode == LR_DST_BINDING && r.dst == 1, "none -> off ep 1");
+
+    CHECK(local_rule_parse("  main  z1|z3|z10 then toggle ep 4 ", &r, &err), "or: %s", err);
+    CHECK(r.occ_mask == Z(0) && r.any_mask == (Z(1) | Z(3) | Z(10)), "or masks %x %x",
+          r.occ_mask, r.any_mask);
+    CHECK(r.action == LR_ACT_TOGGLE && r.dst == 4, "toggle ep 4");
+
+    CHECK(local_rule_parse("z1 -> level 100% group 65527", &r, &err), "pct: %s", err);
+    CHECK(r.arg == 100 && r.dst == 0xFFF7, "level 100 group 0xfff7");
+
+    static const char *const bad[] = {
+        "",                              /* empty */
+        "z2 level 40",                   /* no arrow */
+        "-> on",                         /* no condition */
+        "z11 -> on",                     /* no such zone */
+        "z0 -> on",
+        "kitchen -> on",
+        "z2 !z2 -> on",                  /* contradiction */
+        "z1|z2 z3|z4 -> on",             /* two '|' terms */
+        "z1|bogus -> on",
+        "z1 ->",                         /* no action */
+        "z1 -> dim",
+        "z1 -> level",
+        "z1 -> level 101",
+        "z1 -> scene 4",                 /* scene without group */
+        "z1 -> scene 4 ep 2 group",
+        "z1 -> on group 0",
+        "z1 -> on group 0xFFF8",
+        "z1 -> on ep 12",
+        "z1 -> on now",
+        "z1 z2 z3 z4 z5 z6 z7 z8 z9 z10 main !z1 !z2 -> level 50 group 0x1234 always always always always",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        err = NULL;
+        CHECK(!local_rule_parse(bad[i], &r, &err), "accepted \"%s\"", bad[i]);
+        CHECK(err != NULL && err[0] != '\0', "no message for \"%s\"", bad[i]);
+    }
+}
+
+/* ---- Canonical text ---- */
+
+static void test_format(void)
+{
+    static const struct { const char *in, *out; } cases[] = {
+        {"z2 !z5 -> level 40 group 0x0003", "z2 !z5 -> level 40 group 0x0003"},
+        {"any -> scene 1 group 3 always",   "any -> scene 1 group 0x0003 always"},
+        {"none -> off",                     "none -> off ep 1"},
+        {"!z3 main z1|z3 -> toggle ep 4",   "main !z3 z1|z3 -> toggle ep 4"},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        local_rule_t r, r2;
+        const char *err;
+        char text[LOCAL_RULE_TEXT_MAX + 32];
+        CHECK(local_rule_parse(cases[i].in, &r, &err), "parse \"%s\": %s", cases[i].in, err);
+        local_rule_format(&r, text, sizeof(text));
+        CHECK(strcmp(text, cases[i].out) == 0, "format \"%s\", want \"%s\"", text, cases[i].out);
+        CHECK(local_rule_parse(text, &r2, &err), "reparse \"%s\": %s", text, err);
+        CHECK(memcmp(&r, &r2, sizeof(r)) == 0, "round trip of \"%s\"", cases[i].in);
+    }
+
+    /* Short buffer: truncated, still terminated */
+    local_rule_t r;
+    char small[8];
+    local_rule_parse("z1 z2 z3 -> on", &r, NULL);
+    local_rule_format(&r, small, sizeof(small));
+    CHECK(strlen(small) == sizeof(small) - 1, "truncated \"%s\"", small);
+}
+
+/* ---- Table ---- */
+
+static void test_table(void)
+{
+    local_rules_t t;
+    local_rule_t r;
+    local_rules_init(&t);
+    CHECK(local_rules_valid(&t), "empty table invalid");
+
+    for (int i = 0; i < LOCAL_RULES_MAX; i++) {
+        char text[32];
+        snprintf(text, sizeof(text), "z%d -> level %d", i % 10 + 1, i);
+        CHECK(local_rule_parse(text, &r, NULL), "parse %s", text);
+        CHECK(local_rules_add(&t, &r), "add %d", i);
+    }
+    CHECK(!local_rules_add(&t, &r), "added past LOCAL_RULES_MAX");
+    CHECK(local_rules_valid(&t), "full table invalid");
+
+    CHECK(local_rules_remove(&t, 0), "remove first");
+    CHECK(t.count == LOCAL_RULES_MAX - 1 && t.rule[0].arg == 1, "shifted %u %u", t.count, t.rule[0].arg);
+    CHECK(!local_rules_remove(&t, t.count), "removed past the end");
+    CHECK(t.rule[t.count].action == LR_ACT_NONE, "tail not cleared");
+
+    /* Corrupted blobs are rejected as a whole */
+    local_rules_t bad = t;
+    bad.version = LOCAL_RULES_VERSION + 1;
+    CHECK(!local_rules_valid(&bad), "wrong version accepted");
+    bad = t;
+    bad.count = LOCAL_RULES_MAX + 1;
+    CHECK(!local_rules_valid(&bad), "count overflow accepted");
+    bad = t;
+    bad.rule[3].occ_mask = 0x0800;
+    CHECK(!local_rules_valid(&bad), "mask outside EP1-11 accepted");
+    bad = t;
+    bad.rule[3].dst = 12;
+    CHECK(!local_rules_valid(&bad), "binding ep 12 accepted");
+    bad = t;
+    bad.rule[3].action = LR_ACT_SCENE + 1;
+    CHECK(!local_rules_valid(&bad), "unknown action accepted");
+}
+
+/* ---- Evaluation ---- */
+
+static void test_eval(void)
+{
+    local_rules_t t;
+    local_rule_t r;
+    local_rules_init(&t);
+    local_rule_parse("z2 !z5 -> level 40 group 3", &r, NULL);        /* rule 0 */
+    local_rules_add(&t, &r);
+    local_rule_parse("any -> scene 1 group 3 always", &r, NULL);     /* rule 1 */
+    local_rules_add(&t, &r);
+    local_rule_parse("none -> off always", &r, NULL);                /* rule 2 */
+    local_rules_add(&t, &r);
+
+    CHECK(local_rules_eval(&t, 0, Z(2), true) == 0x3, "z2 enters: %x", local_rules_eval(&t, 0, Z(2), true));
+    CHECK(local_rules_eval(&t, 0, Z(2), false) == 0x2, "z2 enters, not in fallback");
+    CHECK(local_rules_eval(&t, Z(2), Z(2), true) == 0, "no change fired");
+
+    /* Still true: no refire on an unrelated change */
+    CHECK(local_rules_eval(&t, Z(2), Z(2) | Z(3), true) == 0, "refired");
+    /* z5 makes rule 0 false, clearing it makes it true again */
+    CHECK(local_rules_eval(&t, Z(2), Z(2) | Z(5), true) == 0, "z5 enters");
+    CHECK(local_rules_eval(&t, Z(2) | Z(5), Z(2), true) == 0x1, "z5 leaves");
+
+    /* Main sensor alone is not "any" zone */
+    CHECK(local_rules_eval(&t, 0, Z(0), true) == 0, "main fired 'any'");
+    CHECK(local_rules_eval(&t, Z(0), 0, true) == 0x4, "all clear");
+    CHECK(local_rules_eval(&t, Z(4), 0, false) == 0x4, "all clear, always");
+}
+
+/* ---- Random transitions vs a reference ---- */
+
+/* Reference condition, written term by term from the text grammar */
+static bool ref_match(const char *text, uint16_t bits)
+{
+    char buf[LOCAL_RULE_TEXT_MAX + 1];
+    strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    char *arrow = strstr(buf, "->");
+    if (arrow) *arrow = '\0';
+
+    for (char *tok = strtok(buf, " "); tok; tok = strtok(NULL, " ")) {
+        bool ok = false;
+        if (strcmp(tok, "any") == 0) {
+            ok = (bits & 0x07FE) != 0;
+        } else if (strcmp(tok, "none") == 0) {
+            ok = bits == 0;
+        } else if (strchr(tok, '|')) {
+            for (char *p = tok; *p; ) {
+                int n = (*p == 'm') ? 0 : atoi(p + 1);
+                if (bits & (1u << n)) ok = true;
+                p = strchr(p, '|');
+                if (!p) break;
+                p++;
+            }
+        } else {
+            bool neg = tok[0] == '!';
+            const char *t = tok + (neg ? 1 : 0);
+            int n = (*t == 'm') ? 0 : atoi(t + 1);
+            ok = ((bits >> n) & 1) != neg;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+/* Frames and latency for one "turn the lights on" transition:
+ *   coordinator: report to the coordinator (+ APS ACK), automation runs,
+ *                command to the group, i.e. two radio hops through the
+ *                coordinator plus its automation engine
+ *   local rule:  one group-cast frame straight from the sensor */
+#define HOP_MS          15
+#define COORD_RULE_MS   150   /* coordinator automation + scheduling */
+
+static void test_random(uint32_t transitions)
+{
+    static const char *const texts[] = {
+        "z2 !z5 -> level 40 group 0x0003",
+        "any -> scene 1 group 3",
+        "none -> off",
+        "main z1|z2 -> on ep 2 always",
+        "z3 z4 !main -> toggle",
+        "!z1 !z2 !z3 -> off group 0x0010",
+    };
+    const int n = (int)(sizeof(texts) / sizeof(texts[0]));
+
+    local_rules_t t;
+    local_rules_init(&t);
+    for (int i = 0; i < n; i++) {
+        local_rule_t r;
+        const char *err;
+        CHECK(local_rule_parse(texts[i], &r, &err), "parse \"%s\": %s", texts[i], err);
+        local_rules_add(&t, &r);
+    }
+
+    uint32_t fired[LOCAL_RULES_MAX] = {0}, ref[LOCAL_RULES_MAX] = {0};
+    uint16_t bits = 0;
+    for (uint32_t k = 0; k < transitions; k++) {
+        /* One endpoint flips per transition, as the per-EP SMs do */
+        uint16_t next = bits ^ (uint16_t)(1u << (rnd() % 11));
+        bool fallback = (k / 1000) % 2 == 1;   /* alternate 1000-transition fallback stretches */
+        uint16_t f = local_rules_eval(&t, bits, next, fallback);
+        for (int i = 0; i < n; i++) {
+            if (f & (1u << i)) fired[i]++;
+            bool always = strstr(texts[i], "always") != NULL;
+            if ((fallback || always) && ref_match(texts[i], next) && !ref_match(texts[i], bits)) ref[i]++;
+        }
+        bits = next;
+    }
+
+    uint32_t total = 0;
+    printf("rules: %u random transitions, half in fallback\n", transitions);
+    for (int i = 0; i < n; i++) {
+        printf("  %-36s fired %6u\n", texts[i], fired[i]);
+        CHECK(fired[i] == ref[i], "rule %d fired %u, reference %u", i + 1, fired[i], ref[i]);
+        total += fired[i];
+    }
+    CHECK(total > 0, "nothing fired");
+
+    /* Per fired rule: coordinator path = report + ACK + command, local = command */
+    uint32_t coord_frames = total * 3, local_frames = total;
+    printf("  frames: %u via coordinator, %u local (%.0f%% fewer)\n", coord_frames, local_frames,
+           100.0 * (coord_frames - local_frames) / coord_frames);
+    printf("  latency per action: ~%u ms via coordinator, ~%u ms local\n",
+           2 * HOP_MS + COORD_RULE_MS, HOP_MS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t transitions = 100000;
+    if (argc > 1) transitions = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_parse();
+    test_format();
+    test_table();
+    test_eval();
+    test_random(transitions);
+
+    return check_result("local_rules");
+}
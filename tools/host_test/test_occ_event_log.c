@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/occ_event_log.c
+//
+// Build: make -C tools/host_test build/test_occ_event_log
+// Run:   tools/host_test/build/test_occ_event_log [events]
+//
+// Checks ring order and the packed wire layout, then simulates a congested
+// mesh: every transition is sent as its own Occupancy report with a random
+// delivery delay (and some lost), and the event-log attribute is reported
+// alongside.  Transition spacing as seen by the coordinator is compared for
+// both: receipt time of the individual reports vs. the timeline rebuilt
+// from the event log (each report chained onto entries already held).
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "occ_event_log.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* ---- Directed tests ---- */
+
+static void test_ring_order(void)
+{
+    occ_event_log_t log;
+    occ_event_t e;
+    occ_event_log_init(&log);
+    CHECK(!occ_event_log_get(&log, 0, &e), "empty log returned an entry");
+
+    for (int i = 0; i < OCC_EVENT_LOG_LEN + 3; i++) {
+        occ_event_log_add(&log, (uint8_t)(1 + i % 11), i & 1, 1000u * (uint32_t)i);
+    }
+    CHECK(log.count == OCC_EVENT_LOG_LEN, "count %u", log.count);
+    CHECK(log.seq == OCC_EVENT_LOG_LEN + 3, "seq %u", log.seq);
+
+    /* Newest first, oldest three dropped */
+    for (int i = 0; i < OCC_EVENT_LOG_LEN; i++) {
+        int n = OCC_EVENT_LOG_LEN + 2 - i;
+        CHECK(occ_event_log_get(&log, (uint8_t)i, &e), "entry %d missing", i);
+        CHECK(e.t_ms == 1000u * (uint32_t)n && e.ep == 1 + n % 11 && e.occupied == (n & 1),
+              "entry %d: ep %u occ %d t %u", i, e.ep, e.occupied, e.t_ms);
+    }
+    CHECK(!occ_event_log_get(&log, OCC_EVENT_LOG_LEN, &e), "read past count");
+}
+
+static void test_pack_layout(void)
+{
+    occ_event_log_t log;
+    occ_event_log_init(&log);
+    occ_event_log_add(&log, 1, true, 0xFFFFFF00u);   /* before the clock wraps */
+    occ_event_log_add(&log, 4, false, 0x00000100u);
+
+    uint8_t out[OCC_EVENT_LOG_PAYLOAD_LEN];
+    occ_event_log_pack(&log, 0x00000300u, out);
+
+    static const uint8_t expect[OCC_EVENT_LOG_HEADER_LEN + 2 * OCC_EVENT_LOG_ENTRY_LEN] = {
+        0x02, 0x00,                    /* seq */
+        0x02,                          /* count */
+        0x00, 0x03, 0x00, 0x00,        /* now_ms */
+        0x04,       0x00, 0x02, 0x00, 0x00,   /* ep 4 clear, 512 ms ago */
+        0x81,       0x00, 0x04, 0x00, 0x00,   /* ep 1 occupied, 1024 ms ago (across wrap) */
+    };
+    CHECK(OCC_EVENT_LOG_PAYLOAD_LEN == 47, "payload is %d bytes", OCC_EVENT_LOG_PAYLOAD_LEN);
+    CHECK(memcmp(out, expect, sizeof(expect)) == 0, "packed layout mismatch");
+    for (size_t i = sizeof(expect); i < sizeof(out); i++) {
+        CHECK(out[i] == 0, "unused byte %zu = 0x%02x", i, out[i]);
+    }
+}
+
+/* ---- Congested mesh simulation ---- */
+
+typedef struct {
+    uint32_t t_ms;        /* true event time on the device */
+    uint32_t rx_ms;       /* when the individual report arrived (0 = lost) */
+    bool     from_log;    /* timeline rebuilt from an event-log report */
+    uint32_t log_ms;      /* time rebuilt from the log (coordinator clock) */
+} sim_event_t;
+
+static void test_congested_mesh(uint32_t n)
+{
+    sim_event_t *ev = calloc(n, sizeof(*ev));
+    occ_event_log_t log;
+    occ_event_log_init(&log);
+
+    uint32_t now = 1000, lost = 0;
+    uint16_t last_seq = 0;
+    bool have_any = false;
+
+    for (uint32_t i = 0; i < n; i++) {
+        /* Transitions 0.2-20 s apart */
+        now += 200 + rnd() % 19800;
+        ev[i].t_ms = now;
+        occ_event_log_add(&log, (uint8_t)(1 + rnd() % 11), rnd() & 1, now);
+
+        /* Individual report: 0-4 s delivery delay, 10 % lost */
+        if (rnd() % 10 == 0) lost++;
+        else ev[i].rx_ms = now + rnd() % 4000;
+
+        /* Event-log report for this write: same channel, same delay model */
+        if (rnd() % 10 == 0) continue;
+        uint32_t rx = now + rnd() % 4000;
+        uint8_t buf[OCC_EVENT_LOG_PAYLOAD_LEN];
+        occ_event_log_pack(&log, now, buf);
+
+        uint16_t seq = (uint16_t)(buf[0] | (buf[1] << 8));
+        CHECK(get_u32(buf + 3) == now, "now_ms %u != %u", get_u32(buf + 3), now);
+
+        /* Coordinator side: entries it already holds (seq <= last_seq) pin
+         * the packet to the existing timeline; only a packet with no known
+         * entry (first one, or OCC_EVENT_LOG_LEN reports lost in a row) is
+         * anchored to its receipt time. */
+        uint32_t anchor = rx;
+        uint8_t fresh = buf[2];
+        for (uint8_t k = 0; k < buf[2]; k++) {
+            if (have_any && (uint16_t)(last_seq - (uint16_t)(seq - k)) < 0x8000u) {
+                uint32_t age = get_u32(buf + OCC_EVENT_LOG_HEADER_LEN + k * OCC_EVENT_LOG_ENTRY_LEN + 1);
+                anchor = ev[i - k].log_ms + age;
+                fresh = k;
+                break;
+            }
+        }
+        for (uint8_t k = 0; k < fresh; k++) {
+            uint32_t idx = i - k;
+            uint32_t age = get_u32(buf + OCC_EVENT_LOG_HEADER_LEN + k * OCC_EVENT_LOG_ENTRY_LEN + 1);
+            CHECK(age == now - ev[idx].t_ms, "event %u age %u, expected %u", idx, age, now - ev[idx].t_ms);
+            ev[idx].from_log = true;
+            ev[idx].log_ms   = anchor - age;
+        }
+        last_seq = seq;
+        have_any = true;
+    }
+
+    /* Spacing error between consecutive events, in the coordinator's view */
+    uint64_t err_rx = 0, err_log = 0;
+    uint32_t pairs_rx = 0, pairs_log = 0, max_rx = 0, max_log = 0, missing_log = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        int32_t truth = (int32_t)(ev[i].t_ms - ev[i - 1].t_ms);
+        if (ev[i].rx_ms && ev[i - 1].rx_ms) {
+            uint32_t e = (uint32_t)abs((int32_t)(ev[i].rx_ms - ev[i - 1].rx_ms) - truth);
+            err_rx += e; pairs_rx++;
+            if (e > max_rx) max_rx = e;
+        }
+        if (ev[i].from_log && ev[i - 1].from_log) {
+            uint32_t e = (uint32_t)abs((int32_t)(ev[i].log_ms - ev[i - 1].log_ms) - truth);
+            err_log += e; pairs_log++;
+            if (e > max_log) max_log = e;
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) if (!ev[i].from_log) missing_log++;
+
+    printf("mesh: %u transitions, 0-4 s delivery delay, 10%% reports lost\n", n);
+    printf("  %-16s  missing  mean spacing err  max spacing err\n", "source");
+    printf("  %-16s %8u %14.1f ms %14u ms\n", "occupancy rx",
+           lost, pairs_rx ? (double)err_rx / pairs_rx : 0.0, max_rx);
+    printf("  %-16s %8u %14.1f ms %14u ms\n", "event log",
+           missing_log, pairs_log ? (double)err_log / pairs_log : 0.0, max_log);
+
+    /* Losing the log report only matters if OCC_EVENT_LOG_LEN reports in a
+     * row are lost; with 10 % loss that is effectively never. */
+    CHECK(missing_log == 0, "%u events never reached the coordinator via the log", missing_log);
+    /* Chained from one anchor, the rebuilt timeline keeps exact spacing */
+    CHECK(err_log == 0, "log spacing error %llu ms", (unsigned long long)err_log);
+    free(ev);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t events = 100000;
+    if (argc > 1) events = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_ring_order();
+    test_pack_layout();
+    test_congested_mesh(events);
+
+    return check_result("occ_event_log");
+}
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test + benchmark for main/occupancy_sm.c
+//
+// Build: make -C tools/host_test build/test_occupancy_sm
+// Run:   tools/host_test/build/test_occupancy_sm [ticks]
+//
+// Drives the state machine with a simulated clock.  Every report is checked
+// against a shadow model of the raw input:
+//   - safety:   a report always matches the current raw state, and the raw
+//               state has been stable for at least delay/cooldown
+//   - liveness: once the raw state has been stable for delay/cooldown, the
+//               reported state catches up on that same tick
+// The benchmark section times occupancy_sm_tick() with a no-op callback.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "occupancy_sm.h"
+#include "check.h"
+
+#define EPS  OCCUPANCY_SM_MAX_EPS
+
+static uint32_t g_now_ms;
+
+static uint32_t sim_clock(void *ctx)
+{
+    (void)ctx;
+    return g_now_ms;
+}
+
+/* xorshift32: deterministic, seedable, no libc rand() state */
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* ---- Shadow model ---- */
+
+typedef struct {
+    bool     raw;
+    uint32_t stable_since_ms;   /* time of the last raw edge */
+    bool     reported;
+    uint32_t reports;
+    uint32_t fired_this_tick;
+} shadow_t;
+
+static shadow_t g_shadow[EPS];
+static occupancy_sm_t g_sm;
+
+static void model_report_cb(uint8_t idx, bool occupied, void *ctx)
+{
+    (void)ctx;
+    shadow_t *s = &g_shadow[idx];
+    const occupancy_sm_ep_t *e = &g_sm.ep[idx];
+    uint32_t need = occupied ? e->delay_ms : e->cooldown_ms;
+    uint32_t stable = g_now_ms - s->stable_since_ms;
+
+    CHECK(idx < EPS, "report for idx %u", idx);
+    CHECK(occupied == s->raw, "ep%u reported %d while raw=%d", idx, occupied, s->raw);
+    CHECK(stable >= need, "ep%u reported %d after %u ms, need %u ms",
+          idx, occupied, stable, need);
+    CHECK(s->fired_this_tick == 0, "ep%u reported twice in one tick", idx);
+
+    s->reported = occupied;
+    s->reports++;
+    s->fired_this_tick++;
+}
+
+static void sim_tick(uint32_t raw_bitmap)
+{
+    for (int i = 0; i < EPS; i++) {
+        bool r = (raw_bitmap >> i) & 1u;
+        if (r != g_shadow[i].raw) {
+            g_shadow[i].raw = r;
+            g_shadow[i].stable_since_ms = g_now_ms;
+        }
+        g_shadow[i].fired_this_tick = 0;
+    }
+
+    occupancy_sm_tick(&g_sm, raw_bitmap);
+
+    for (int i = 0; i < EPS; i++) {
+        const shadow_t *s = &g_shadow[i];
+        const occupancy_sm_ep_t *e = &g_sm.ep[i];
+        uint32_t need = s->raw ? e->delay_ms : e->cooldown_ms;
+        uint32_t stable = g_now_ms - s->stable_since_ms;
+        CHECK(occupancy_sm_reported(&g_sm, i) == s->reported,
+              "ep%u reported-state mismatch", i);
+        if (stable >= need) {
+            CHECK(s->reported == s->raw,
+                  "ep%u stuck: raw=%d stable %u ms (need %u) but reported=%d",
+                  i, s->raw, stable, need, s->reported);
+        }
+    }
+}
+
+static void sim_reset(uint32_t start_ms)
+{
+    g_now_ms = start_ms;
+    memset(g_shadow, 0, sizeof(g_shadow));
+    for (int i = 0; i < EPS; i++) g_shadow[i].stable_since_ms = start_ms;
+    occupancy_sm_init(&g_sm, EPS, sim_clock, model_report_cb, NULL);
+}
+
+/* ---- Directed tests ---- */
+
+/* Regression: occupancy that clears inside the delay window must cancel the
+ * pending Occupied report, so the next detection waits the full delay again. */
+static void test_delay_cancel_not_stuck(void)
+{
+    sim_reset(1000);
+    occupancy_sm_set_timing(&g_sm, 0, 1000, 60000);
+
+    sim_tick(1);                      /* edge at t=1000 */
+    g_now_ms += 300; sim_tick(0);     /* clears before delay expires */
+    CHECK(g_shadow[0].reports == 0, "report fired inside delay window");
+
+    g_now_ms += 5000; sim_tick(1);    /* new detection at t=6300 */
+    CHECK(g_shadow[0].reports == 0, "stale pending_occupied fired immediately");
+
+    g_now_ms += 900; sim_tick(1);
+    CHECK(g_shadow[0].reports == 0, "fired before full delay");
+    g_now_ms += 100; sim_tick(1);
+    CHECK(g_shadow[0].reports == 1 && g_shadow[0].reported, "did not fire after delay");
+}
+
+static void test_cooldown_cancel(void)
+{
+    sim_reset(0);
+    occupancy_sm_set_timing(&g_sm, 3, 0, 10000);
+
+    sim_tick(1u << 3);
+    CHECK(g_shadow[3].reported, "zero delay should report on first tick");
+    g_now_ms += 100;  sim_tick(0);
+    g_now_ms += 9000; sim_tick(1u << 3);   /* back before cooldown expires */
+    g_now_ms += 20000; sim_tick(1u << 3);
+    CHECK(g_shadow[3].reported, "cooldown cancel lost occupied state");
+    g_now_ms += 100;  sim_tick(0);
+    g_now_ms += 9999; sim_tick(0);
+    CHECK(g_shadow[3].reported, "clear reported before cooldown");
+    g_now_ms += 1;    sim_tick(0);
+    CHECK(!g_shadow[3].reported, "clear not reported at cooldown");
+}
+
+static void test_clock_wraparound(void)
+{
+    sim_reset(0xFFFFFF00u);
+    occupancy_sm_set_timing(&g_sm, 0, 500, 0);
+
+    sim_tick(1);
+    for (int i = 0; i < 4; i++) { g_now_ms += 100; sim_tick(1); }
+    CHECK(g_shadow[0].reports == 0, "fired early across wrap");
+    g_now_ms += 100; sim_tick(1);
+    CHECK(g_shadow[0].reports == 1, "did not fire across wrap");
+}
+
+/* ---- Randomised soak ---- */
+
+static void test_random_soak(uint32_t ticks)
+{
+    sim_reset(rnd());
+    for (int i = 0; i < EPS; i++) {
+        /* Mix of zero, short and long timings, as seen in real configs */
+        uint32_t d = (rnd() % 4 == 0) ? 0 : rnd() % 3000;
+        uint32_t c = (rnd() % 4 == 0) ? 0 : (rnd() % 30) * 1000;
+        occupancy_sm_set_timing(&g_sm, i, d, c);
+    }
+
+    uint32_t raw = 0;
+    for (uint32_t t = 0; t < ticks; t++) {
+        /* 100 ms poll with +/-20 ms scheduler jitter */
+        g_now_ms += 80 + rnd() % 41;
+
+        /* Each EP flips with a per-EP probability; bursts of flicker are
+         * interleaved with long stable stretches. */
+        for (int i = 0; i < EPS; i++) {
+            uint32_t p = (t / 5000 + i) % 3 == 0 ? 4 : 200;
+            if (rnd() % p == 0) raw ^= 1u << i;
+        }
+
+        /* Occasionally retune an EP mid-run (live config change) */
+        if (rnd() % 50000 == 0) {
+            int i = rnd() % EPS;
+            occupancy_sm_set_timing(&g_sm, i, rnd() % 3000, (rnd() % 30) * 1000);
+        }
+
+        sim_tick(raw);
+        if (g_failures >= CHECK_PRINT_LIMIT) break;
+    }
+
+    uint32_t total = 0;
+    for (int i = 0; i < EPS; i++) total += g_shadow[i].reports;
+    printf("soak: %u ticks x %d EPs, %u reports\n", ticks, EPS, total);
+}
+
+/* ---- Benchmark ---- */
+
+static void noop_report_cb(uint8_t idx, bool occupied, void *ctx)
+{
+    (void)idx; (void)occupied;
+    (*(uint32_t *)ctx)++;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(uint32_t ticks)
+{
+    static uint32_t raws[4096];
+    for (int i = 0; i < 4096; i++) {
+        raws[i] = (rnd() % 8 == 0) ? rnd() & 0x7FF : raws[i ? i - 1 : 0];
+    }
+
+    uint32_t reports = 0;
+    occupancy_sm_t sm;
+    g_now_ms = 0;
+    occupancy_sm_init(&sm, EPS, sim_clock, noop_report_cb, &reports);
+    for (int i = 0; i < EPS; i++) occupancy_sm_set_timing(&sm, i, 500, 2000);
+
+    double t0 = now_sec();
+    for (uint32_t t = 0; t < ticks; t++) {
+        g_now_ms += 100;
+        occupancy_sm_tick(&sm, raws[t & 4095]);
+    }
+    double dt = now_sec() - t0;
+
+    printf("bench: %u ticks in %.3f s, %.1f ns/tick (%.1f ns/EP), %u reports\n",
+           ticks, dt, dt * 1e9 / ticks, dt * 1e9 / ticks / EPS, reports);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = 2000000;
+    if (argc > 1) ticks = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_delay_cancel_not_stuck();
+    test_cooldown_cancel();
+    test_clock_wraparound();
+    test_random_soak(ticks);
+
+    if (g_failures) return check_result("occupancy_sm");
+
+    bench(ticks * 5);
+    return check_result("occupancy_sm");
+}
@@ -0,0 +1,1046 @@
+// SPDX-License-Identifier: MIT
+//
+// Host simulation of the sensing pipeline: sensor bytes in, Zigbee reports out
+//
+// Build: make -C tools/host_test build/test_pipeline_sim
+// Run:   tools/host_test/build/test_pipeline_sim [-u] [-v] [-g golden_dir] [scenario...]
+//        tools/host_test/build/test_pipeline_sim -s script.txt | -S preset[:seed] | -r capture.bin [-T truth.txt]
+//                                                [-z N:CSV]... [-d ms] [-c s] [-t ms]
+//
+// Runs the firmware from the UART to the Zigbee stack unchanged, in one
+// thread of virtual time: the ld2450.c RX task (parser, tracking mode, zone
+// evaluation), and sensor_bridge.c with its poll alarm, occupancy delay /
+// cooldown, zone bitmap, event log, target-data gate and per-poll report
+// batching.  The sensor is the emulator in tools/ld2450_emu playing a
+// keyframe script, a scene from tools/ld2450_scene (several people, with
+// occlusion, dropouts and ghosts), or a raw capture of sensor bytes.
+//
+// Only one task blocks, the RX task in uart_read_bytes(), so that is where
+// the rest of the device runs: the fake UART advances the clock to the next
+// sensor byte, firing esp_zb_scheduler_alarm() callbacks (the 100 ms
+// sensor_bridge poll) on the way.  The poll starts half a frame after the
+// sensor's first frame.
+//
+// The Zigbee side is a stub that records what would go on the air:
+// coordinator_fallback_report_occupancy() (one Occupancy report per EP,
+// without fallback or ACK tracking; occupancy reports take a rate limiter
+// token but are never held back) and esp_zb_aps_data_request() (the batched
+// EP1 Report Attributes frames, decoded).  Keepalives are fixed at 5 min.
+//
+// Each scenario prints a timeline of those reports and a summary: per EP,
+// how long after a person really entered (left) the area it was reported
+// occupied (clear), entries missed or bridged by the cooldown, and reports
+// per minute.  Ground truth comes from the script or the scene; captures
+// get latency figures only with a truth file (-T, as ld2450_scene_gen
+// writes next to its streams).  Built-in scenarios are compared with the golden files
+// in golden/ (-u rewrites them after an intended behaviour change); each
+// runs in its own process, so the firmware's statics start clean.
+//
+// Custom runs: -s takes an emulator keyframe script ("t_ms slot x y [speed]"
+// / "t_ms slot -", see ld2450_emu.h), -S a scene preset (ld2450_scene_gen -l
+// lists them) with an optional radar seed, -r raw sensor bytes (e.g. cat of
+// the UART) played as one 30-byte frame per 100 ms.  -z sets zone N (1-10) as
+// "x0,y0,x1,y1,...", -d/-c the occupancy delay (ms) and cooldown (s) of
+// every EP, -t the duration (default: script end + 10 s, scene end + 5 s,
+// or the capture).
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ld2450.h"
+#include "ld2450_cmd_worker.h"
+#include "ld2450_emu.h"
+#include "ld2450_scene.h"
+#include "ld2450_zone.h"
+#include "ld2450_zone_csv.h"
+#include "coord_report.h"
+#include "coordinator_fallback.h"
+#include "crash_diag.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_config.h"
+#include "rate_limit.h"
+#include "sensor_bridge.h"
+#include "zcl_batch.h"
+#include "zigbee_defs.h"
+#include "zigbee_signal_handlers.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "check.h"
+
+static bool g_verbose = false;
+
+#define SIM_ZONES        10
+#define SIM_EPS          (1 + SIM_ZONES)
+#define SIM_TRUTH_STEP   10          /* ms between ground-truth samples */
+#define SIM_BRIDGE_START (LD2450_EMU_FRAME_MS / 2)
+#define SIM_KEEPALIVE_MS 300000u
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char *name;
+    const char *about;
+    const ld2450_emu_key_t *keys;
+    size_t   nkeys;
+    uint32_t duration_ms;
+    const char *zones[SIM_ZONES];   /* CSV, NULL = off */
+    uint16_t delay_ms;              /* every EP */
+    uint16_t cooldown_sec;          /* every EP */
+    uint8_t  publish_coords;        /* COORD_PUBLISH_* */
+    uint8_t  garbage_pct;           /* emulator line noise */
+    uint8_t  corrupt_pct;
+    const char *scene;              /* ld2450_scene preset instead of keys */
+} scenario_t;
+
+/* A room seen from the sensor on the wall: x across, y into the room */
+#define ZONE_DESK   "-1500,1000,0,1000,0,2500,-1500,2500"
+#define ZONE_SOFA   "500,3000,2500,3000,2500,4500,500,4500"
+#define ZONE_DOOR   "-2500,4500,-1500,4500,-1500,5500,-2500,5500"
+
+/* In at the door, over to the desk, sit, and back out */
+static const ld2450_emu_key_t k_walk[] = {
+    {  2000, 0, true,  -2000, 5000,  60 },
+    {  8000, 0, true,   -750, 1750,  60 },
+    {  8100, 0, true,   -750, 1750,   0 },
+    { 20000, 0, true,   -750, 1750,   0 },
+    { 20100, 0, true,   -750, 1750, -60 },
+    { 26000, 0, true,  -2000, 5000, -60 },
+    { 27000, 0, false,     0,    0,   0 },
+};
+
+/* One person at the desk throughout, a second one via the sofa */
+static const ld2450_emu_key_t k_two[] = {
+    {  1000, 0, true,   -750, 1750,   0 },
+    { 30000, 0, true,   -800, 1700,   0 },
+    { 31000, 0, false,     0,    0,   0 },
+    {  5000, 1, true,  -2000, 5000,  50 },
+    {  9000, 1, true,   1500, 3750,  50 },
+    {  9100, 1, true,   1500, 3750,   0 },
+    { 16000, 1, true,   1500, 3750,   0 },
+    { 16100, 1, true,   1500, 3750, -50 },
+    { 20000, 1, true,  -2000, 5000, -50 },
+    { 20500, 1, false,     0,    0,   0 },
+};
+
+/* A quick cut across the sofa corner (shorter than the delay), then a stay at the desk */
+static const ld2450_emu_key_t k_brief[] = {
+    {  1000, 0, true,   2800, 2700, 120 },
+    {  1600, 0, true,   1800, 3300, 120 },
+    {  2200, 0, true,    800, 2700, 120 },
+    {  4000, 0, true,   -750, 1750, 100 },
+    {  4100, 0, true,   -750, 1750,   0 },
+    { 15000, 0, true,   -750, 1750,   0 },
+    { 15100, 0, false,     0,    0,   0 },
+};
+
+/* Sitting still at the desk; the radar loses the target twice briefly and
+ * once for longer than the cooldown */
+static const ld2450_emu_key_t k_dropout[] = {
+    {  1000, 0, true,   -750, 1750,   0 },
+    {  6000, 0, false,     0,    0,   0 },
+    {  6500, 0, true,   -750, 1750,   0 },
+    { 12000, 0, false,     0,    0,   0 },
+    { 13200, 0, true,   -760, 1740,   0 },
+    { 20000, 0, false,     0,    0,   0 },
+    { 24000, 0, true,   -740, 1760,   0 },
+    { 30000, 0, false,     0,    0,   0 },
+};
+
+/* Walking loops round the room, for the target-data report rate */
+static const ld2450_emu_key_t k_roam[] = {
+    {  1000, 0, true,  -2000, 5000, 80 },
+    {  6000, 0, true,   1500, 3750, 80 },
+    { 11000, 0, true,   1500, 1500, 80 },
+    { 16000, 0, true,   -750, 1750, 80 },
+    { 21000, 0, true,  -2000, 5000, 80 },
+    { 26000, 0, true,   1500, 3750, 80 },
+    { 31000, 0, true,   1500, 1500, 80 },
+    { 36000, 0, true,   -750, 1750,  0 },
+    { 46000, 0, true,   -750, 1750,  0 },
+    { 46100, 0, false,     0,    0,  0 },
+};
+
+#define KEYS(k)  (k), sizeof(k) / sizeof((k)[0])
+
+static const scenario_t k_scenarios[] = {
+    { "walk_through", "firmware defaults (250 ms delay, no cooldown)",
+      KEYS(k_walk), 35000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 250, 0, COORD_PUBLISH_OFF, 0, 0, NULL },
+    { "two_people", "second person comes and goes, 3 s cooldown",
+      KEYS(k_two), 35000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 250, 3, COORD_PUBLISH_OFF, 0, 0, NULL },
+    { "brief_pass", "1 s delay filters a 600 ms pass through the sofa zone",
+      KEYS(k_brief), 20000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 1000, 0, COORD_PUBLISH_OFF, 0, 0, NULL },
+    { "dropout", "2 s cooldown bridges 0.5 s and 1.2 s target loss, not 4 s",
+      KEYS(k_dropout), 35000, { ZONE_DESK }, 250, 2, COORD_PUBLISH_OFF, 0, 0, NULL },
+    { "noisy_line", "walk_through with line noise and corrupted frames",
+      KEYS(k_walk), 35000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 250, 0, COORD_PUBLISH_OFF, 20, 5, NULL },
+    { "roam_coords", "adaptive target-data publishing while walking",
+      KEYS(k_roam), 50000, { ZONE_DESK, ZONE_SOFA }, 250, 5, COORD_PUBLISH_ADAPTIVE, 0, 0, NULL },
+    { "scene_sit", "two people sitting, still-target dropouts and a shadowed door, 2 s cooldown",
+      NULL, 0, 55000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 250, 2, COORD_PUBLISH_OFF, 0, 0, "sit" },
+    { "scene_crowd", "six people coming and going, occlusion and ghosts, 3 s cooldown",
+      NULL, 0, 75000, { ZONE_DESK, ZONE_SOFA, ZONE_DOOR }, 250, 3, COORD_PUBLISH_OFF, 0, 0, "crowd" },
+};
+
+#define SCENARIO_COUNT (sizeof(k_scenarios) / sizeof(k_scenarios[0]))
+
+// ---------------------------------------------------------------------------
+// Virtual clock, scheduler, FreeRTOS
+// ---------------------------------------------------------------------------
+
+static uint32_t g_now;
+static uint32_t g_end;
+
+#define SIM_MAX_ALARMS 32
+
+typedef struct {
+    uint32_t          at;
+    uint32_t          seq;
+    esp_zb_callback_t cb;
+    uint8_t           param;
+} sim_alarm_t;
+
+static sim_alarm_t g_alarm[SIM_MAX_ALARMS];
+static int      g_alarms;
+static uint32_t g_seq;
+
+static void finish(void);
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)g_now * 1000;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if (!g_verbose) return;
+    static const char lv[] = "NEWIDV";
+    va_list ap;
+    va_start(ap, format);
+    fprintf(stderr, "[%6u] %c %s: ", g_now, lv[level], tag);
+    vfprintf(stderr, format, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char *file, int line,
+                             const char *function, const char *expression)
+{
+    printf("FAIL: ESP_ERROR_CHECK %s = %d at %s:%d\n", expression, rc, file, line);
+    exit(1);
+}
+
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time_ms)
+{
+    if (g_alarms == SIM_MAX_ALARMS) {
+        CHECK(false, "alarm queue full");
+        return;
+    }
+    g_alarm[g_alarms++] = (sim_alarm_t){ g_now + time_ms, g_seq++, cb, param };
+}
+
+void esp_zb_scheduler_alarm_cancel(esp_zb_callback_t cb, uint8_t param)
+{
+    for (int i = 0; i < g_alarms; ) {
+        if (g_alarm[i].cb == cb && g_alarm[i].param == param) {
+            g_alarm[i] = g_alarm[--g_alarms];
+        } else {
+            i++;
+        }
+    }
+}
+
+/* Run every alarm due up to t, in time then scheduling order, and stop the
+ * run once the scenario is over */
+static void advance_to(uint32_t t)
+{
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < g_alarms; i++) {
+            if (g_alarm[i].at > t) continue;
+            if (next < 0 || g_alarm[i].at < g_alarm[next].at ||
+                (g_alarm[i].at == g_alarm[next].at && g_alarm[i].seq < g_alarm[next].seq)) {
+                next = i;
+            }
+        }
+        if (next < 0) break;
+        esp_zb_callback_t cb = g_alarm[next].cb;
+        uint8_t param = g_alarm[next].param;
+        if (g_alarm[next].at > g_now) g_now = g_alarm[next].at;
+        g_alarm[next] = g_alarm[--g_alarms];
+        if (g_now >= g_end) finish();
+        cb(param);
+    }
+    if (t > g_now) g_now = t;
+    if (g_now >= g_end) finish();
+}
+
+static TaskFunction_t g_task_fn;
+static void          *g_task_arg;
+static EventBits_t    g_event_bits;
+
+TickType_t xTaskGetTickCount(void) { return g_now; }
+void vTaskDelay(TickType_t ticks) { advance_to(g_now + ticks); }
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       uint32_t priority, TaskHandle_t *out)
+{
+    /* The one task there is (the RX task); main() runs it */
+    g_task_fn = fn;
+    g_task_arg = arg;
+    if (out) *out = (TaskHandle_t)&g_task_fn;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) { finish(); }
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    CHECK(false, "RX task paused: nothing resumes it here");
+    finish();
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) { return pdPASS; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return (SemaphoreHandle_t)&g_event_bits; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { return pdTRUE; }
+
+EventGroupHandle_t xEventGroupCreate(void) { return (EventGroupHandle_t)&g_event_bits; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    return g_event_bits |= bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    return g_event_bits;
+}
+
+// ---------------------------------------------------------------------------
+// Sensor: emulator or capture behind the UART
+// ---------------------------------------------------------------------------
+
+static ld2450_emu_t g_emu;
+static bool     g_use_emu;
+static uint8_t *g_cap;              /* captures and scenes */
+static size_t   g_cap_len, g_cap_pos;
+
+static ld2450_scene_truth_t *g_truth;   /* per 100 ms frame, for scenes and -T */
+static size_t   g_truth_n;
+
+static uint8_t  g_rx[LD2450_EMU_OUT_MAX];
+static size_t   g_rx_len;
+
+/* Move what the sensor has sent by now into the UART RX buffer */
+static void sensor_pull(void)
+{
+    if (g_use_emu) {
+        g_rx_len += ld2450_emu_tx(&g_emu, g_now, g_rx + g_rx_len, sizeof(g_rx) - g_rx_len);
+        return;
+    }
+    size_t due = (size_t)(g_now / LD2450_EMU_FRAME_MS + 1) * LD2450_EMU_FRAME_LEN;
+    if (due > g_cap_len) due = g_cap_len;
+    while (g_cap_pos < due && g_rx_len < sizeof(g_rx)) g_rx[g_rx_len++] = g_cap[g_cap_pos++];
+}
+
+static uint32_t sensor_next_ms(void)
+{
+    if (g_use_emu) return ld2450_emu_next_ms(&g_emu, g_now);
+    if (g_cap_pos >= g_cap_len) return UINT32_MAX;
+    return (uint32_t)(g_cap_pos / LD2450_EMU_FRAME_LEN) * LD2450_EMU_FRAME_MS;
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) { return ESP_OK; }
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num)
+{
+    return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+{
+    sensor_pull();
+    *size = g_rx_len;
+    return ESP_OK;
+}
+
+/* ESP-IDF semantics: return once length bytes are in, or after
+ * ticks_to_wait without a new byte */
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    uint8_t *out = buf;
+    uint32_t got = 0;
+    uint32_t idle_from = g_now;
+
+    for (;;) {
+        sensor_pull();
+        uint32_t take = g_rx_len < length - got ? (uint32_t)g_rx_len : length - got;
+        if (take) {
+            memcpy(out + got, g_rx, take);
+            memmove(g_rx, g_rx + take, g_rx_len - take);
+            g_rx_len -= take;
+            got += take;
+            idle_from = g_now;
+        }
+        if (got == length || g_now - idle_from >= ticks_to_wait) return (int)got;
+
+        uint32_t until = idle_from + ticks_to_wait;
+        uint32_t next = sensor_next_ms();
+        if (next < until) until = next;
+        advance_to(until > g_now ? until : g_now + 1);
+    }
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    if (g_use_emu) ld2450_emu_rx(&g_emu, g_now, src, size);
+    return (int)size;
+}
+
+int uart_flush_input(uart_port_t uart_num)
+{
+    g_rx_len = 0;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Device services sensor_bridge.c expects
+// ---------------------------------------------------------------------------
+
+static struct {
+    uint32_t     generation;
+    nvs_config_t cfg;
+} g_snap;
+static rate_limit_t g_rate;
+
+uint32_t nvs_config_generation(void) { return g_snap.generation; }
+
+uint32_t nvs_config_read(size_t offset, size_t len, void *out)
+{
+    memcpy(out, (const uint8_t *)&g_snap.cfg + offset, len);
+    return g_snap.generation;
+}
+
+bool zigbee_is_network_joined(void) { return true; }
+void crash_diag_update_uptime(uint32_t uptime_sec) { }
+uint32_t esp_get_minimum_free_heap_size(void) { return 180000; }
+
+void ld2450_cmd_worker_get_status(ld2450_cmd_status_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->state = LD2450_CMD_STATE_IDLE;
+}
+
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id,
+                                                 uint8_t cluster_role, uint16_t attr_id,
+                                                 void *value_p, bool check)
+{
+    return 0;
+}
+
+esp_err_t esp_zb_zcl_update_reporting_info(esp_zb_zcl_reporting_info_t *report_info) { return ESP_OK; }
+
+esp_err_t esp_zb_zcl_stop_attr_reporting(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// What goes on the air
+// ---------------------------------------------------------------------------
+
+#define SIM_MAX_REPORTS 2048
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t  ep;
+    bool     occupied;
+} occ_report_t;
+
+static occ_report_t g_occ[SIM_MAX_REPORTS];
+static int      g_occ_count;
+static uint32_t g_frames;           /* EP1 Report Attributes frames */
+static uint32_t g_coord_frames;     /* ... carrying target data */
+static char    *g_out;              /* timeline + summary */
+static size_t   g_out_len;
+static FILE    *g_tl;
+
+void coordinator_fallback_on_occupancy_change(uint8_t endpoint, bool occupied) { }
+void coordinator_fallback_start_keepalive(void) { }
+uint32_t coordinator_fallback_keepalive_delay_ms(bool first) { return SIM_KEEPALIVE_MS; }
+void coordinator_fallback_note_tx(uint16_t zcl_len) { }
+
+void coordinator_fallback_get_rate_stats(coordinator_fallback_rate_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+bool coordinator_fallback_rate_take(void)
+{
+    return rate_limit_take_above(&g_rate, g_rate.burst / 2, g_now);
+}
+
+void coordinator_fallback_report_occupancy(uint8_t ep, bool occupied)
+{
+    rate_limit_take(&g_rate, g_now);
+    if (g_occ_count < SIM_MAX_REPORTS) {
+        g_occ[g_occ_count++] = (occ_report_t){ g_now, ep, occupied };
+    }
+    fprintf(g_tl, "%8u  ep%-2u %s\n", g_now, ep, occupied ? "occupied" : "clear");
+}
+
+static uint32_t get_le(const uint8_t *p, int n)
+{
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+/* Per-attribute fallback for a record that did not fit the batch: the sim's
+ * attrs always fit, so reaching it is a bug */
+esp_err_t esp_zb_zcl_report_attr_cmd_req(esp_zb_zcl_report_attr_cmd_t *cmd_req)
+{
+    CHECK(false, "sensor attr fell back to a per-attribute report");
+    return ESP_OK;
+}
+
+/* Decode an EP1 Report Attributes frame into one timeline line */
+esp_err_t esp_zb_aps_data_request(esp_zb_apsde_data_req_t *req)
+{
+    const uint8_t *f = req->asdu;
+    uint32_t len = req->asdu_length;
+    CHECK(len >= ZCL_BATCH_HEADER_LEN && f[0] == ZCL_BATCH_FC_REPORT && f[2] == ZCL_BATCH_CMD_REPORT,
+          "not a Report Attributes frame");
+    g_frames++;
+
+    fprintf(g_tl, "%8u  ep%-2u report", g_now, req->src_endpoint);
+    for (uint32_t o = ZCL_BATCH_HEADER_LEN; o + ZCL_BATCH_RECORD_HDR <= len; ) {
+        uint16_t attr = (uint16_t)get_le(&f[o], 2);
+        uint8_t type = f[o + 2];
+        const uint8_t *v = &f[o + ZCL_BATCH_RECORD_HDR];
+        uint32_t vlen = type == ESP_ZB_ZCL_ATTR_TYPE_U8  ? 1 :
+                        type == ESP_ZB_ZCL_ATTR_TYPE_U16 ? 2 :
+                        type == ESP_ZB_ZCL_ATTR_TYPE_U32 ? 4 : 1u + v[0];
+        switch (attr) {
+        case ZB_ATTR_TARGET_COUNT:   fprintf(g_tl, " count=%u", v[0]); break;
+        case ZB_ATTR_ZONE_BITMAP:    fprintf(g_tl, " zones=0x%03x", (unsigned)get_le(v, 2)); break;
+        case ZB_ATTR_TARGET_DATA:
+            fprintf(g_tl, " targets=%u", (unsigned)__builtin_popcount(v[1]));
+            g_coord_frames++;
+            break;
+        case ZB_ATTR_OCC_EVENT_LOG:  fprintf(g_tl, " log"); break;
+        case ZB_ATTR_MIN_FREE_HEAP:  fprintf(g_tl, " heap"); break;
+        default:                     fprintf(g_tl, " 0x%04x", attr); break;
+        }
+        o += ZCL_BATCH_RECORD_HDR + vlen;
+    }
+    fprintf(g_tl, "\n");
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Ground truth and summary
+// ---------------------------------------------------------------------------
+
+static ld2450_zone_t g_zones[SIM_ZONES];
+static const scenario_t *g_sc;
+
+static uint32_t point_bits(int16_t x_mm, int16_t y_mm)
+{
+    ld2450_point_t p = { x_mm, y_mm };
+    uint32_t bits = 1;
+    for (int z = 0; z < SIM_ZONES; z++) {
+        if (ld2450_zone_contains_point(&g_zones[z], p)) bits |= 1u << (z + 1);
+    }
+    return bits;
+}
+
+/* Bit 0 = someone in the room, bit n = someone in zone n, at time t.  A
+ * scene's people count while the radar cannot see them (occluded, lost,
+ * beyond the third target), but not outside its field of view. */
+static uint32_t truth_at(uint32_t t)
+{
+    uint32_t bits = 0;
+    if (g_truth) {
+        size_t k = t / LD2450_SCENE_FRAME_MS;
+        if (k >= g_truth_n) return 0;
+        for (uint8_t i = 0; i < g_truth[k].n; i++) {
+            const ld2450_scene_truth_person_t *p = &g_truth[k].person[i];
+            if (p->state != LD2450_SCENE_OUT_OF_VIEW) bits |= point_bits(p->x_mm, p->y_mm);
+        }
+        return bits;
+    }
+    ld2450_emu_key_t tg[LD2450_EMU_TARGETS];
+    ld2450_emu_targets_at(&g_emu, t, tg);
+    for (int i = 0; i < LD2450_EMU_TARGETS; i++) {
+        if (tg[i].present) bits |= point_bits(tg[i].x_mm, tg[i].y_mm);
+    }
+    return bits;
+}
+
+typedef struct {
+    uint32_t entries, reported, missed, bridged;
+    uint32_t on_sum, on_max, on_n;
+    uint32_t off_sum, off_max, off_n;
+} ep_summary_t;
+
+static void lat_add(uint32_t *sum, uint32_t *max, uint32_t *n, uint32_t v)
+{
+    *sum += v;
+    if (v > *max) *max = v;
+    (*n)++;
+}
+
+/* Reported state of ep just before t */
+static bool reported_before(uint8_t ep, uint32_t t)
+{
+    bool occ = false;
+    for (int i = 0; i < g_occ_count && g_occ[i].t_ms < t; i++) {
+        if (g_occ[i].ep == ep) occ = g_occ[i].occupied;
+    }
+    return occ;
+}
+
+/* First report of ep with this value in [from, to) */
+static int first_report(uint8_t ep, bool occupied, uint32_t from, uint32_t to)
+{
+    for (int i = 0; i < g_occ_count; i++) {
+        if (g_occ[i].ep == ep && g_occ[i].occupied == occupied &&
+            g_occ[i].t_ms >= from && g_occ[i].t_ms < to) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void summarize_ep(uint8_t idx, ep_summary_t *s)
+{
+    uint8_t ep = idx == 0 ? ZB_EP_MAIN : ZB_EP_ZONE(idx - 1);
+    memset(s, 0, sizeof(*s));
+
+    for (int i = 0; i < g_occ_count; i++) {
+        if (g_occ[i].ep == ep && g_occ[i].occupied) s->reported++;
+    }
+    if (!g_use_emu && !g_truth) return;
+
+    /* Truth edges on a 10 ms grid; each is answered by the first matching
+     * report before the opposite edge's successor */
+    bool prev = false;
+    for (uint32_t t = 0; t < g_end; t += SIM_TRUTH_STEP) {
+        bool cur = (truth_at(t) >> idx) & 1;
+        if (cur == prev) continue;
+        prev = cur;
+
+        uint32_t next = g_end;      /* next edge in the same direction */
+        bool mid = cur;
+        for (uint32_t u = t + SIM_TRUTH_STEP; u < g_end; u += SIM_TRUTH_STEP) {
+            bool b = (truth_at(u) >> idx) & 1;
+            if (b != mid && b == cur) { next = u; break; }
+            mid = b;
+        }
+
+        if (cur) {
+            s->entries++;
+            if (reported_before(ep, t)) {
+                s->bridged++;
+                continue;
+            }
+            int r = first_report(ep, true, t, next);
+            if (r < 0) {
+                s->missed++;
+                continue;
+            }
+            lat_add(&s->on_sum, &s->on_max, &s->on_n, g_occ[r].t_ms - t);
+        } else {
+            int r = first_report(ep, false, t, next);
+            if (r >= 0) lat_add(&s->off_sum, &s->off_max, &s->off_n, g_occ[r].t_ms - t);
+        }
+    }
+}
+
+static void print_summary(FILE *f)
+{
+    fprintf(f, "# ep  entries  reported  missed  bridged  trigger avg/max ms  clear avg/max ms\n");
+    for (uint8_t idx = 0; idx < SIM_EPS; idx++) {
+        if (idx > 0 && g_zones[idx - 1].vertex_count < 3) continue;
+        ep_summary_t s;
+        summarize_ep(idx, &s);
+        fprintf(f, "# %2u  %7u  %8u  %6u  %7u", idx == 0 ? ZB_EP_MAIN : ZB_EP_ZONE(idx - 1),
+                s.entries, s.reported, s.missed, s.bridged);
+        if (s.on_n) {
+            fprintf(f, "  %8u/%-8u", s.on_sum / s.on_n, s.on_max);
+        } else {
+            fprintf(f, "  %17s", "-");
+        }
+        if (s.off_n) {
+            fprintf(f, "  %7u/%u", s.off_sum / s.off_n, s.off_max);
+        } else {
+            fprintf(f, "  %7s", "-");
+        }
+        fprintf(f, "\n");
+    }
+
+    ld2450_rx_stats_t rx;
+    ld2450_get_rx_stats(&rx, false);
+    double min = g_end / 60000.0;
+    fprintf(f, "# frames %u bad %u garbage %u\n", rx.frames, rx.bad_frames, rx.garbage_bytes);
+    fprintf(f, "# reports: %d occupancy + %u EP1 (%u target data) in %.1f s = %.1f/min\n",
+            g_occ_count, g_frames, g_coord_frames, g_end / 1000.0,
+            (g_occ_count + g_frames) / min);
+}
+
+// ---------------------------------------------------------------------------
+// Running one scenario
+// ---------------------------------------------------------------------------
+
+static char g_golden_dir[256];
+static bool g_update;
+
+static bool set_zone_csv(int n, const char *csv, nvs_config_t *cfg)
+{
+    ld2450_zone_t z = { .vertex_count = 0 };
+    int pairs = csv_count_pairs(csv);
+    if (pairs < 3 || pairs > MAX_ZONE_VERTICES) return false;
+    z.vertex_count = (uint8_t)pairs;
+    if (!csv_to_zone(csv, &z) || ld2450_set_zone((size_t)n, &z) != ESP_OK) return false;
+    g_zones[n] = z;
+    cfg->zones[n] = z;
+    return true;
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)n + 1);
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    if (buf) buf[n] = '\0';
+    if (len) *len = (size_t)n;
+    return buf;
+}
+
+/* Render a scene into the capture buffer, with its truth */
+static bool scene_load(const char *preset, long seed, uint32_t duration_ms)
+{
+    static ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+    ld2450_scene_radar_t radar;
+    size_t n = ld2450_scene_preset(preset, people, &radar);
+    if (!n) return false;
+    if (seed >= 0) radar.seed = (uint32_t)seed;
+
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, people, n, &radar);
+    g_truth_n = duration_ms / LD2450_SCENE_FRAME_MS + 1;
+    g_truth = calloc(g_truth_n, sizeof(*g_truth));
+    g_cap = malloc(g_truth_n * LD2450_SCENE_FRAME_LEN);
+    if (!g_truth || !g_cap) return false;
+    for (size_t k = 0; k < g_truth_n; k++) {
+        ld2450_scene_frame(&s, g_cap + k * LD2450_SCENE_FRAME_LEN, &g_truth[k]);
+    }
+    g_cap_len = g_truth_n * LD2450_SCENE_FRAME_LEN;
+    g_use_emu = false;
+    return true;
+}
+
+/* Truth lines for a capture, indexed by frame; returns the bad line or 0 */
+static int truth_load(char *text, size_t frames)
+{
+    g_truth_n = frames;
+    g_truth = calloc(frames ? frames : 1, sizeof(*g_truth));
+    int line = 0;
+    for (char *l = text, *nl; l && *l; l = nl ? nl + 1 : NULL) {
+        nl = strchr(l, '\n');
+        if (nl) *nl = '\0';
+        line++;
+        if (l[0] == '#' || l[0] == '\0') continue;
+        ld2450_scene_truth_t t;
+        if (!ld2450_scene_truth_parse(l, &t)) return line;
+        size_t k = t.t_ms / LD2450_SCENE_FRAME_MS;
+        if (k < frames) g_truth[k] = t;
+    }
+    return 0;
+}
+
+/* Called from wherever the clock passes the end: print, compare, exit */
+static void finish(void)
+{
+    print_summary(g_tl);
+    fclose(g_tl);
+
+    if (!g_sc->name[0]) {
+        fputs(g_out, stdout);
+        exit(g_failures ? 1 : 0);
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/pipeline_%s.txt", g_golden_dir, g_sc->name);
+    if (g_update) {
+        FILE *f = fopen(path, "w");
+        CHECK(f && fputs(g_out, f) >= 0 && fclose(f) == 0, "%s: %s", path, strerror(errno));
+    } else {
+        char *want = read_file(path, NULL);
+        if (!want) {
+            CHECK(false, "%s: %s (run with -u to create)", path, strerror(errno));
+        } else if (strcmp(want, g_out) != 0) {
+            /* Point at the first line that differs */
+            const char *a = want, *b = g_out;
+            int line = 1;
+            while (*a && *a == *b) {
+                if (*a == '\n') line++;
+                a++;
+                b++;
+            }
+            while (a > want && a[-1] != '\n') a--, b--;
+            CHECK(false, "%s: differs at line %d\n  want: %.*s\n  got:  %.*s", path, line,
+                  (int)strcspn(a, "\n"), a, (int)strcspn(b, "\n"), b);
+            if (g_verbose) fputs(g_out, stdout);
+        }
+        free(want);
+    }
+
+    /* The summary lines are the benchmark figures */
+    const char *sum = strstr(g_out, "# ep ");
+    printf("%s: %s\n%s", g_sc->name, g_sc->about, sum ? sum : "");
+    exit(g_failures ? 1 : 0);
+}
+
+static void run_scenario(const scenario_t *sc, const char *zone_args[SIM_ZONES])
+{
+    g_sc = sc;
+    g_end = sc->duration_ms;
+    g_tl = open_memstream(&g_out, &g_out_len);
+
+    nvs_config_t *cfg = &g_snap.cfg;
+    cfg->publish_coords = sc->publish_coords;
+    cfg->coord_deadband_mm = 50;
+    cfg->coord_min_interval_ms = 500;
+    cfg->max_distance_mm = 6000;
+    cfg->zone_ep_reports = 1;
+    cfg->rate_burst = RATE_LIMIT_BURST_DEFAULT;
+    cfg->rate_per_min = RATE_LIMIT_PER_MIN_DEFAULT;
+    for (int i = 0; i < SIM_EPS; i++) {
+        cfg->occupancy_delay_ms[i] = sc->delay_ms;
+        cfg->occupancy_cooldown_sec[i] = sc->cooldown_sec;
+    }
+    g_snap.generation = 1;
+    rate_limit_init(&g_rate, cfg->rate_burst, cfg->rate_per_min, 0);
+
+    ld2450_config_t ucfg = { .uart_num = UART_NUM_1, .tx_gpio = 0, .rx_gpio = 1,
+                             .baud_rate = 256000, .rx_buf_size = 2048 };
+    CHECK(ld2450_init(&ucfg) == ESP_OK && g_task_fn, "ld2450_init");
+    ld2450_set_publish_coords(sc->publish_coords != COORD_PUBLISH_OFF);
+    for (int n = 0; n < SIM_ZONES; n++) {
+        const char *csv = zone_args && zone_args[n] ? zone_args[n] : sc->zones[n];
+        if (csv && !set_zone_csv(n, csv, cfg)) {
+            printf("FAIL: pipeline_sim zone %d: bad CSV \"%s\"\n", n + 1, csv);
+            exit(2);
+        }
+    }
+
+    if (sc->scene && !g_cap && !scene_load(sc->scene, -1, sc->duration_ms)) {
+        printf("FAIL: pipeline_sim no scene \"%s\"\n", sc->scene);
+        exit(2);
+    }
+    if (g_use_emu) {
+        ld2450_emu_faults_t f;
+        ld2450_emu_default_faults(&f);
+        f.garbage_pct = sc->garbage_pct;
+        f.corrupt_pct = sc->corrupt_pct;
+        f.seed = 2450;
+        ld2450_emu_init(&g_emu, &f, 0);
+        ld2450_emu_set_script(&g_emu, sc->keys, sc->nkeys, 0);
+    }
+
+    fprintf(g_tl, "# pipeline_sim %s: %s\n", sc->name[0] ? sc->name : "custom", sc->about);
+    fprintf(g_tl, "# delay %u ms, cooldown %u s, coords %u, poll at +%u ms\n",
+            sc->delay_ms, sc->cooldown_sec, sc->publish_coords, SIM_BRIDGE_START);
+    fprintf(g_tl, "#   t_ms  ep   event\n");
+
+    /* The bridge joins half a frame after the sensor starts streaming */
+    advance_to(SIM_BRIDGE_START);
+    sensor_bridge_start();
+    g_task_fn(g_task_arg);      /* returns only through finish() */
+    finish();
+}
+
+static int run_forked(const scenario_t *sc, const char *zone_args[SIM_ZONES])
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        printf("FAIL: pipeline_sim fork: %s\n", strerror(errno));
+        return 1;
+    }
+    if (pid == 0) run_scenario(sc, zone_args);
+    int st = 0;
+    waitpid(pid, &st, 0);
+    return WIFEXITED(st) ? WEXITSTATUS(st) : 1;
+}
+
+int main(int argc, char **argv)
+{
+    /* Golden files live next to this source unless -g says otherwise */
+    const char *src = __FILE__;
+    const char *slash = strrchr(src, '/');
+    snprintf(g_golden_dir, sizeof(g_golden_dir), "%.*s%sgolden",
+             slash ? (int)(slash - src) : 0, src, slash ? "/" : "");
+
+    const char *script_path = NULL, *cap_path = NULL, *truth_path = NULL;
+    char scene[32] = "";
+    long scene_seed = -1;
+    const char *zone_args[SIM_ZONES] = { 0 };
+    scenario_t custom = { .name = "", .about = "", .delay_ms = 250 };
+    bool custom_zones = false;
+    const char *only[SCENARIO_COUNT];
+    size_t n_only = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "-v") == 0) {
+            g_verbose = true;
+        } else if (strcmp(a, "-u") == 0) {
+            g_update = true;
+        } else if (strcmp(a, "-g") == 0 && v) {
+            snprintf(g_golden_dir, sizeof(g_golden_dir), "%s", v);
+            i++;
+        } else if (strcmp(a, "-s") == 0 && v) {
+            script_path = v;
+            i++;
+        } else if (strcmp(a, "-r") == 0 && v) {
+            cap_path = v;
+            i++;
+        } else if (strcmp(a, "-S") == 0 && v) {
+            snprintf(scene, sizeof(scene), "%.*s", (int)strcspn(v, ":"), v);
+            if (strchr(v, ':')) scene_seed = strtol(strchr(v, ':') + 1, NULL, 0);
+            i++;
+        } else if (strcmp(a, "-T") == 0 && v) {
+            truth_path = v;
+            i++;
+        } else if (strcmp(a, "-z") == 0 && v) {
+            int n = atoi(v);
+            const char *csv = strchr(v, ':');
+            if (n < 1 || n > SIM_ZONES || !csv) {
+                fprintf(stderr, "-z N:x0,y0,x1,y1,... with N 1-%d\n", SIM_ZONES);
+                return 2;
+            }
+            zone_args[n - 1] = csv + 1;
+            custom_zones = true;
+            i++;
+        } else if (strcmp(a, "-d") == 0 && v) {
+            custom.delay_ms = (uint16_t)atoi(v);
+            i++;
+        } else if (strcmp(a, "-c") == 0 && v) {
+            custom.cooldown_sec = (uint16_t)atoi(v);
+            i++;
+        } else if (strcmp(a, "-t") == 0 && v) {
+            custom.duration_ms = (uint32_t)atoi(v);
+            i++;
+        } else if (a[0] != '-' && n_only < SCENARIO_COUNT) {
+            only[n_only++] = a;
+        } else {
+            fprintf(stderr, "usage: %s [-u] [-v] [-g golden_dir] [scenario...]\n"
+                            "       %s -s script | -S preset[:seed] | -r capture [-T truth]\n"
+                            "          [-z N:CSV]... [-d ms] [-c s] [-t ms]\n",
+                    argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (scene[0]) {
+        ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+        ld2450_scene_radar_t radar;
+        size_t n = ld2450_scene_preset(scene, people, &radar);
+        if (!n) {
+            fprintf(stderr, "%s: no such scene\n", scene);
+            return 2;
+        }
+        if (!custom.duration_ms) custom.duration_ms = ld2450_scene_end_ms(people, n) + 5000;
+        if (!scene_load(scene, scene_seed, custom.duration_ms)) return 2;
+        custom.about = scene;
+        return run_forked(&custom, custom_zones ? zone_args : NULL);
+    }
+    if (script_path || cap_path) {
+        size_t len = 0;
+        char *data = read_file(script_path ? script_path : cap_path, &len);
+        if (!data) {
+            fprintf(stderr, "%s: %s\n", script_path ? script_path : cap_path, strerror(errno));
+            return 2;
+        }
+        if (script_path) {
+            static ld2450_emu_key_t keys[LD2450_EMU_SCRIPT_MAX];
+            int n = ld2450_emu_parse_script(data, keys, LD2450_EMU_SCRIPT_MAX);
+            if (n <= 0) {
+                fprintf(stderr, "%s:%d: bad keyframe\n", script_path, -n);
+                return 2;
+            }
+            custom.keys = keys;
+            custom.nkeys = (size_t)n;
+            custom.about = script_path;
+            g_use_emu = true;
+            if (!custom.duration_ms) custom.duration_ms = keys[n - 1].t_ms + 10000;
+        } else {
+            g_cap = (uint8_t *)data;
+            g_cap_len = len;
+            custom.about = cap_path;
+            if (!custom.duration_ms) {
+                custom.duration_ms = (uint32_t)(len / LD2450_EMU_FRAME_LEN + 1) * LD2450_EMU_FRAME_MS;
+            }
+            char *text = truth_path ? read_file(truth_path, NULL) : NULL;
+            if (truth_path && !text) {
+                fprintf(stderr, "%s: %s\n", truth_path, strerror(errno));
+                return 2;
+            }
+            int bad = text ? truth_load(text, custom.duration_ms / LD2450_EMU_FRAME_MS + 1) : 0;
+            if (bad) {
+                fprintf(stderr, "%s:%d: bad truth line\n", truth_path, bad);
+                return 2;
+            }
+        }
+        return run_forked(&custom, custom_zones ? zone_args : NULL);
+    }
+
+    g_use_emu = true;
+    int failed = 0;
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        bool pick = n_only == 0;
+        for (size_t j = 0; j < n_only; j++) pick |= strcmp(only[j], k_scenarios[i].name) == 0;
+        if (pick && run_forked(&k_scenarios[i], NULL) != 0) failed++;
+    }
+
+    if (failed) {
+        printf("FAIL: pipeline_sim (%d scenario%s)\n", failed, failed == 1 ? "" : "s");
+        return 1;
+    }
+    printf("PASS: pipeline_sim%s\n", g_update ? " (golden files updated)" : "");
+    return 0;
+}
@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/rate_limit.c
+//
+// Build: make -C tools/host_test build/test_rate_limit
+// Run:   tools/host_test/build/test_rate_limit [seconds]
+//
+// Checks the bucket arithmetic (burst, refill, wait time, reconfiguration,
+// clock wrap), then replays a flickering zone boundary with zero cooldown on
+// eight zones through the occupancy policy used by coordinator_fallback.c:
+// first transition after a quiet spell exempt, later ones deferred until a
+// token is free and sent with the newest value, or dropped if the zone
+// flickered back.  Reports are counted with and without the limiter, and the
+// value last sent for each zone must match the zone's final state.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "rate_limit.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* ---- Directed tests ---- */
+
+static void test_burst_and_refill(void)
+{
+    rate_limit_t rl;
+    rate_limit_init(&rl, 5, 60, 1000);      /* one token per second */
+
+    for (int i = 0; i < 5; i++) CHECK(rate_limit_take(&rl, 1000), "burst token %d", i);
+    CHECK(!rate_limit_take(&rl, 1000), "6th token in the same ms");
+    CHECK(rate_limit_wait_ms(&rl, 1000) == 1000, "wait %u", rate_limit_wait_ms(&rl, 1000));
+    CHECK(rate_limit_wait_ms(&rl, 1400) == 600, "wait %u", rate_limit_wait_ms(&rl, 1400));
+    CHECK(!rate_limit_take(&rl, 1999), "token before 1 s");
+    CHECK(rate_limit_take(&rl, 2000), "token at 1 s");
+
+    /* Long idle refills to burst, never beyond */
+    CHECK(rate_limit_tokens(&rl, 3600000) == 5, "tokens after idle %u", rate_limit_tokens(&rl, 3600000));
+
+    /* Slow rates keep fractional progress: 7/min = one token per 8572 ms */
+    rate_limit_init(&rl, 1, 7, 0);
+    CHECK(rate_limit_take(&rl, 0), "first token");
+    uint32_t t = 0;
+    while (!rate_limit_take(&rl, t)) t += 100;
+    CHECK(t == 8600, "7/min refill at %u ms", t);
+}
+
+static void test_disabled_and_set(void)
+{
+    rate_limit_t rl;
+    rate_limit_init(&rl, 2, 0, 0);
+    for (int i = 0; i < 1000; i++) CHECK(rate_limit_take(&rl, 0), "unlimited take %d", i);
+    CHECK(rate_limit_wait_ms(&rl, 0) == 0, "unlimited wait");
+
+    /* Enabling keeps the earned tokens, clamped to the new burst */
+    rate_limit_init(&rl, 20, 600, 0);
+    rate_limit_set(&rl, 3, 600, 0);
+    CHECK(rate_limit_tokens(&rl, 0) == 3, "clamped to %u", rate_limit_tokens(&rl, 0));
+    rate_limit_set(&rl, 10, 600, 0);
+    CHECK(rate_limit_tokens(&rl, 0) == 3, "raised burst keeps %u", rate_limit_tokens(&rl, 0));
+    rate_limit_set(&rl, 0, 600, 0);
+    CHECK(rl.burst == 1, "burst 0 becomes 1");
+
+    /* A reserve keeps the last tokens for plain takes */
+    rate_limit_init(&rl, 4, 60, 0);
+    CHECK(rate_limit_take_above(&rl, 2, 0), "above reserve 1");
+    CHECK(rate_limit_take_above(&rl, 2, 0), "above reserve 2");
+    CHECK(!rate_limit_take_above(&rl, 2, 0), "into the reserve");
+    CHECK(rate_limit_take(&rl, 0) && rate_limit_take(&rl, 0), "reserve left for take");
+    CHECK(!rate_limit_take_above(&rl, 2, 2999), "reserve refilling");
+    CHECK(rate_limit_take_above(&rl, 2, 3000), "above reserve again");
+
+    /* Clock wrap */
+    rate_limit_init(&rl, 1, 60, 0xFFFFFF00u);
+    CHECK(rate_limit_take(&rl, 0xFFFFFF00u), "pre-wrap");
+    CHECK(!rate_limit_take(&rl, 0x00000100u), "512 ms across wrap");
+    CHECK(rate_limit_take(&rl, 0x00000300u), "1024 ms across wrap");
+}
+
+/* ---- Flickering zones, zero cooldown ---- */
+
+/* Mirrors coordinator_fallback_report_occupancy() / rl_drain_cb() */
+#define SETTLE_MS    10000
+#define EPS          11
+#define POLL_MS      100
+
+typedef struct {
+    bool     deferred;
+    uint8_t  value;          /* newest value while deferred */
+    uint8_t  sent_value;     /* value last reported */
+    uint32_t change_ms;
+    bool     any;
+} ep_t;
+
+typedef struct {
+    rate_limit_t rl;
+    bool         limit;
+    ep_t         ep[EPS];
+    uint32_t     sent;
+    uint32_t     throttled;
+    uint32_t     collapsed;
+    uint32_t     exempt;
+    uint32_t     peak_1s;        /* most reports in any one-second window */
+    uint32_t     win_start, win_count;
+    uint32_t     drain_at;       /* 0 = no drain scheduled */
+} policy_t;
+
+static void p_send(policy_t *p, uint8_t i, uint8_t v, uint32_t now)
+{
+    p->ep[i].sent_value = v;
+    p->ep[i].change_ms  = now;
+    p->ep[i].any        = true;
+    p->sent++;
+    if (now - p->win_start >= 1000) { p->win_start = now; p->win_count = 0; }
+    if (++p->win_count > p->peak_1s) p->peak_1s = p->win_count;
+}
+
+static void p_schedule(policy_t *p, uint32_t now)
+{
+    if (!p->drain_at) p->drain_at = now + rate_limit_wait_ms(&p->rl, now) + 1;
+}
+
+static void p_report(policy_t *p, uint8_t i, uint8_t v, uint32_t now)
+{
+    ep_t *e = &p->ep[i];
+    if (!p->limit) { p_send(p, i, v, now); return; }
+    if (e->deferred) { e->value = v; return; }
+    if (!e->any || now - e->change_ms >= SETTLE_MS) {
+        if (!rate_limit_take(&p->rl, now)) p->exempt++;
+    } else if (!rate_limit_take(&p->rl, now)) {
+        e->deferred = true;
+        e->value    = v;
+        p->throttled++;
+        p_schedule(p, now);
+        return;
+    }
+    p_send(p, i, v, now);
+}
+
+static void p_drain(policy_t *p, uint32_t now)
+{
+    if (!p->drain_at || now < p->drain_at) return;
+    p->drain_at = 0;
+    for (uint8_t i = 0; i < EPS; i++) {
+        ep_t *e = &p->ep[i];
+        if (!e->deferred) continue;
+        if (e->value == e->sent_value) { e->deferred = false; p->collapsed++; continue; }
+        if (!rate_limit_take(&p->rl, now)) { p_schedule(p, now); break; }
+        e->deferred = false;
+        p_send(p, i, e->value, now);
+    }
+}
+
+static void test_flicker(uint32_t seconds)
+{
+    policy_t off, on;
+    memset(&off, 0, sizeof(off));
+    memset(&on, 0, sizeof(on));
+    on.limit = true;
+    rate_limit_init(&on.rl, RATE_LIMIT_BURST_DEFAULT, RATE_LIMIT_PER_MIN_DEFAULT, 0);
+
+    /* Zones 2-9 sit on a boundary: occupancy toggles every 1-3 radar frames.
+     * EP1 and zone 10 see ordinary entries, each exactly once. */
+    uint8_t  state[EPS] = {0};
+    uint32_t next_flip[EPS];
+    for (int i = 0; i < EPS; i++) next_flip[i] = UINT32_MAX;
+    for (int i = 2; i <= 9; i++) next_flip[i] = 1000 + rnd() % 300;
+
+    uint32_t end_ms   = seconds * 1000u;
+    uint32_t entry_ms[2] = { end_ms / 3, end_ms / 2 };
+    uint8_t  entry_ep[2] = { 0, 10 };
+    uint32_t entry_latency[2] = { UINT32_MAX, UINT32_MAX };
+
+    for (uint32_t t = 0; t < end_ms + 30000; t += POLL_MS) {
+        for (int k = 0; k < 2; k++) {
+            if (t == entry_ms[k]) {
+                state[entry_ep[k]] = 1;
+                p_report(&off, entry_ep[k], 1, t);
+                uint32_t before = on.sent;
+                p_report(&on, entry_ep[k], 1, t);
+                if (on.sent > before) entry_latency[k] = 0;
+            }
+        }
+        for (int i = 0; i < EPS; i++) {
+            if (t < end_ms && t >= next_flip[i]) {
+                state[i] ^= 1;
+                p_report(&off, i, state[i], t);
+                p_report(&on, i, state[i], t);
+                next_flip[i] = t + POLL_MS * (1 + rnd() % 3);
+            }
+        }
+        p_drain(&on, t);
+    }
+
+    printf("flicker: 8 boundary zones toggling every 100-300 ms for %u s, cooldown 0, "
+           "limiter %u burst / %u per min\n",
+           seconds, RATE_LIMIT_BURST_DEFAULT, RATE_LIMIT_PER_MIN_DEFAULT);
+    printf("  %-18s %10s %12s %12s %12s\n", "policy", "reports", "peak/s", "throttled", "collapsed");
+    printf("  %-18s %10u %12u %12s %12s\n", "no limiter", off.sent, off.peak_1s, "-", "-");
+    printf("  %-18s %10u %12u %12u %12u\n", "token bucket", on.sent, on.peak_1s,
+           on.throttled, on.collapsed);
+
+    uint32_t budget = RATE_LIMIT_BURST_DEFAULT +
+                      (uint32_t)((uint64_t)(end_ms + 30000) * RATE_LIMIT_PER_MIN_DEFAULT / 60000) + 2;
+    CHECK(on.sent <= budget, "sent %u over budget %u", on.sent, budget);
+    CHECK(on.peak_1s <= RATE_LIMIT_BURST_DEFAULT + RATE_LIMIT_PER_MIN_DEFAULT / 60 + 2,
+          "peak %u/s", on.peak_1s);
+    CHECK(on.sent * 2 < off.sent, "limiter sent %u vs %u", on.sent, off.sent);
+    for (int k = 0; k < 2; k++) {
+        CHECK(entry_latency[k] == 0, "entry on ep%u delayed during flood", entry_ep[k] + 1);
+    }
+    for (int i = 0; i < EPS; i++) {
+        CHECK(!on.ep[i].deferred, "ep%d still deferred after the flood", i + 1);
+        if (on.ep[i].any) {
+            CHECK(on.ep[i].sent_value == state[i], "ep%d ends at %u, reported %u",
+                  i + 1, state[i], on.ep[i].sent_value);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = 120;
+    if (argc > 1) seconds = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_burst_and_refill();
+    test_disabled_and_set();
+    test_flicker(seconds);
+
+    return check_result("rate_limit");
+}
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/report_queue.c
+//
+// Build: make -C tools/host_test build/test_report_queue
+// Run:   tools/host_test/build/test_report_queue [keepalive_bursts]
+//
+// Checks coalescing, priority order, in-flight pacing and the ACK-latency
+// driven backoff, then replays keep-alive bursts over a lossy, serialised
+// radio link with an occupancy transition landing shortly after each burst.
+// Transition delivery latency is compared for the previous behaviour (every
+// report sent at once, one FIFO) and the paced priority queue, both with the
+// latency-driven backoff, on a one-hop and a multi-hop link.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "report_queue.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* ---- Directed tests ---- */
+
+static void test_priority_and_pacing(void)
+{
+    rq_t q;
+    rq_init(&q, 2);
+
+    /* Keep-alive burst on all endpoints: only two go out */
+    for (uint8_t i = 0; i < RQ_EP_COUNT; i++) rq_enqueue(&q, i, 0, RQ_PRIO_KEEPALIVE);
+    CHECK(rq_pop(&q, 0) == 0 && rq_pop(&q, 0) == 1, "keep-alives not FIFO");
+    CHECK(rq_pop(&q, 0) == RQ_NONE, "in-flight cap not enforced");
+
+    /* A transition on a queued endpoint jumps the keep-alives */
+    rq_enqueue(&q, 7, 1, RQ_PRIO_TRANSITION);
+    CHECK(q.slot[7].prio == RQ_PRIO_TRANSITION && q.slot[7].value == 1, "slot not upgraded");
+    uint32_t retry = 0;
+    CHECK(rq_on_status(&q, 0, true, 30, &retry) == RQ_DONE, "ack ep0");
+    CHECK(rq_pop(&q, 30) == 7, "transition not sent first");
+
+    /* Transition on an in-flight endpoint waits for its completion */
+    rq_enqueue(&q, 1, 1, RQ_PRIO_TRANSITION);
+    CHECK(q.slot[1].pending_supersede, "in-flight supersede not recorded");
+    CHECK(rq_on_status(&q, 1, true, 40, &retry) == RQ_DONE, "ack ep1");
+    CHECK(q.slot[1].state == RQ_QUEUED && q.slot[1].value == 1, "supersede not re-queued");
+    CHECK(rq_pop(&q, 40) == 1, "superseding transition not next");
+
+    /* Remaining keep-alives drain in order; nothing was dropped */
+    CHECK(rq_on_status(&q, 7, true, 50, &retry) == RQ_DONE, "ack ep7");
+    CHECK(rq_on_status(&q, 1, true, 50, &retry) == RQ_DONE, "ack ep1 again");
+    uint8_t expect[] = {2, 3, 4, 5, 6, 8, 9, 10};
+    for (size_t k = 0; k < sizeof(expect); k++) {
+        uint8_t i = rq_pop(&q, 60);
+        CHECK(i == expect[k], "drain %zu: ep_idx %u, expected %u", k, i, expect[k]);
+        rq_on_status(&q, i, true, 70, &retry);
+    }
+    CHECK(rq_pop(&q, 70) == RQ_NONE && q.in_flight == 0, "queue not empty");
+    CHECK(q.stats.sent == RQ_EP_COUNT + 1, "sent %u", q.stats.sent);
+
+    /* A keep-alive never downgrades a queued transition */
+    rq_enqueue(&q, 3, 1, RQ_PRIO_TRANSITION);
+    rq_enqueue(&q, 3, 1, RQ_PRIO_KEEPALIVE);
+    CHECK(q.slot[3].prio == RQ_PRIO_TRANSITION, "transition downgraded");
+
+    /* Stale status and guard expiry */
+    CHECK(rq_on_status(&q, 5, true, 80, &retry) == RQ_STALE, "stale status accepted");
+    CHECK(rq_pop(&q, 80) == 3, "pop ep3");
+    CHECK(rq_expire(&q, 3) && q.in_flight == 0 && q.slot[3].state == RQ_IDLE, "expire");
+    CHECK(!rq_expire(&q, 3), "double expire");
+}
+
+static void test_backoff(void)
+{
+    rq_t q;
+    uint32_t retry = 0;
+    rq_init(&q, 2);
+
+    /* Before any ACK: 250/500/1000 ms, then exhausted */
+    rq_enqueue(&q, 0, 1, RQ_PRIO_TRANSITION);
+    static const uint32_t init_delays[RQ_MAX_RETRIES] = {250, 500, 1000};
+    for (int a = 0; a < RQ_MAX_RETRIES; a++) {
+        CHECK(rq_pop(&q, 0) == 0, "pop attempt %d", a);
+        CHECK(rq_on_status(&q, 0, false, 10, &retry) == RQ_RETRY, "retry %d", a);
+        CHECK(retry == init_delays[a], "attempt %d delay %u", a, retry);
+        CHECK(rq_pop(&q, 0) == RQ_NONE, "sent during backoff");
+        rq_retry_due(&q, 0);
+    }
+    CHECK(rq_pop(&q, 0) == 0, "final attempt");
+    CHECK(rq_on_status(&q, 0, false, 10, &retry) == RQ_EXHAUSTED, "not exhausted");
+    CHECK(q.slot[0].state == RQ_IDLE, "exhausted slot not idle");
+
+    /* Fast link: RTO settles near the floor */
+    for (int n = 0; n < 50; n++) {
+        rq_enqueue(&q, 1, 0, RQ_PRIO_KEEPALIVE);
+        rq_pop(&q, 1000u * n);
+        rq_on_status(&q, 1, true, 1000u * n + 30 + rnd() % 10, &retry);
+    }
+    CHECK(rq_srtt_ms(&q) >= 30 && rq_srtt_ms(&q) < 40, "srtt %u", rq_srtt_ms(&q));
+    CHECK(rq_rto_ms(&q) == RQ_RTO_MIN_MS, "fast rto %u", rq_rto_ms(&q));
+
+    /* Slow, jittery multi-hop link: RTO grows above the fixed schedule */
+    for (int n = 0; n < 50; n++) {
+        rq_enqueue(&q, 1, 0, RQ_PRIO_KEEPALIVE);
+        rq_pop(&q, 1000u * n);
+        rq_on_status(&q, 1, true, 1000u * n + 400 + rnd() % 200, &retry);
+    }
+    uint32_t rto = rq_rto_ms(&q);
+    CHECK(rto > 500 && rto <= RQ_RTO_MAX_MS, "slow rto %u", rto);
+    rq_enqueue(&q, 2, 1, RQ_PRIO_TRANSITION);
+    rq_pop(&q, 0);
+    rq_on_status(&q, 2, false, 10, &retry);
+    CHECK(retry == rto, "first retry %u != rto %u", retry, rto);
+
+    /* Lower ceiling (ack_timeout_ms): RTO and backoff clamp to it */
+    rq_set_rto_max(&q, 500);
+    CHECK(rq_rto_ms(&q) == 500, "capped rto %u", rq_rto_ms(&q));
+    rq_retry_due(&q, 2);
+    rq_pop(&q, 0);
+    rq_on_status(&q, 2, false, 10, &retry);
+    CHECK(retry == 1000, "capped backoff %u", retry);
+    rq_set_rto_max(&q, 10);
+    CHECK(q.rto_max_ms == RQ_RTO_MIN_MS, "ceiling below floor %u", q.rto_max_ms);
+
+    /* Failure while a newer value waits: the retry carries the new value */
+    rq_init(&q, 2);
+    rq_enqueue(&q, 4, 1, RQ_PRIO_TRANSITION);
+    rq_pop(&q, 0);
+    rq_enqueue(&q, 4, 0, RQ_PRIO_TRANSITION);
+    CHECK(rq_on_status(&q, 4, false, 10, &retry) == RQ_RETRY, "retry");
+    CHECK(q.slot[4].value == 0 && !q.slot[4].pending_supersede, "supersede not folded into retry");
+}
+
+/* ---- Keep-alive burst simulation ---- */
+
+#define SIM_AIRTIME_MS    12     /* frame + MAC ACK on the shared channel */
+#define SIM_FAIL_MS       1200   /* APS ACK wait before a failed status */
+
+typedef struct {
+    uint32_t mean_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+    uint32_t undelivered;
+    uint32_t exhausted;
+} sim_result_t;
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static sim_result_t simulate(uint32_t bursts, uint32_t lat_min, uint32_t lat_span,
+                             uint8_t max_in_flight, bool prio, uint32_t seed)
+{
+    rq_t q;
+    rq_init(&q, max_in_flight);
+    g_rng = seed;
+
+    uint32_t status_at[RQ_EP_COUNT], retry_at[RQ_EP_COUNT];
+    bool     status_ok[RQ_EP_COUNT];
+    uint32_t *lat = calloc(bursts, sizeof(*lat));
+    uint32_t n_lat = 0, undelivered = 0;
+    uint8_t  occ[RQ_EP_COUNT] = {0};
+
+    for (uint32_t b = 0; b < bursts; b++) {
+        /* The link is idle between bursts, so each one restarts the clock */
+        uint32_t t0 = 1000, chan_free = 0;
+        memset(status_at, 0, sizeof(status_at));
+        memset(retry_at, 0, sizeof(retry_at));
+        uint32_t t_tr = t0 + rnd() % 500;
+        uint8_t  tr_ep = (uint8_t)(rnd() % RQ_EP_COUNT);
+        bool     pending_tr = false, burst_done = false;
+        uint32_t tr_start = 0;
+
+        for (uint32_t t = t0; t < t0 + 60000 && !(burst_done && !pending_tr && t > t_tr); t++) {
+            if (t == t0) {
+                for (uint8_t i = 0; i < RQ_EP_COUNT; i++) rq_enqueue(&q, i, occ[i], RQ_PRIO_KEEPALIVE);
+            }
+            if (t == t_tr) {
+                occ[tr_ep] ^= 1;
+                rq_enqueue(&q, tr_ep, occ[tr_ep], prio ? RQ_PRIO_TRANSITION : RQ_PRIO_KEEPALIVE);
+                pending_tr = true;
+                tr_start = t;
+            }
+            for (uint8_t i = 0; i < RQ_EP_COUNT; i++) {
+                if (status_at[i] == t && q.slot[i].state == RQ_IN_FLIGHT) {
+                    uint8_t val = q.slot[i].value;
+                    uint32_t retry;
+                    rq_result_t r = rq_on_status(&q, i, status_ok[i], t, &retry);
+                    if (r == RQ_RETRY) retry_at[i] = t + retry;
+                    if (pending_tr && i == tr_ep && r == RQ_DONE && val == occ[tr_ep]) {
+                        lat[n_lat++] = t - tr_start;
+                        pending_tr = false;
+                    }
+                    if (pending_tr && i == tr_ep && r == RQ_EXHAUSTED) {
+                        pending_tr = false;
+                        undelivered++;
+                    }
+                }
+                if (retry_at[i] == t) {
+                    retry_at[i] = 0;
+                    rq_retry_due(&q, i);
+                }
+            }
+            uint8_t i;
+            while ((i = rq_pop(&q, t)) != RQ_NONE) {
+                /* Serialised channel, lat_min + 0..lat_span ms end-to-end, 10 % lost */
+                uint32_t tx_end = (chan_free > t ? chan_free : t) + SIM_AIRTIME_MS;
+                chan_free = tx_end;
+                status_ok[i] = rnd() % 10 != 0;
+                status_at[i] = status_ok[i] ? tx_end + lat_min + rnd() % lat_span : t + SIM_FAIL_MS;
+            }
+            burst_done = q.in_flight == 0 && q.head[0] == RQ_NONE && q.head[1] == RQ_NONE
+                         && q.head[2] == RQ_NONE;
+            for (uint8_t k = 0; k < RQ_EP_COUNT; k++) if (retry_at[k]) burst_done = false;
+        }
+        if (pending_tr) undelivered++;
+    }
+
+    sim_result_t res = {0};
+    uint64_t sum = 0;
+    for (uint32_t k = 0; k < n_lat; k++) sum += lat[k];
+    qsort(lat, n_lat, sizeof(*lat), cmp_u32);
+    if (n_lat) {
+        res.mean_ms = (uint32_t)(sum / n_lat);
+        res.p99_ms  = lat[(n_lat * 99) / 100];
+        res.max_ms  = lat[n_lat - 1];
+    }
+    res.undelivered = undelivered;
+    res.exhausted   = q.stats.exhausted;
+    free(lat);
+    return res;
+}
+
+static void run_scenario(const char *name, uint32_t bursts, uint32_t lat_min, uint32_t lat_span)
+{
+    sim_result_t legacy = simulate(bursts, lat_min, lat_span, RQ_EP_COUNT, false, 0x2450u);
+    sim_result_t paced  = simulate(bursts, lat_min, lat_span, RQ_MAX_IN_FLIGHT, true, 0x2450u);
+
+    printf("%s (%u-%u ms ACK latency, 10%% loss)\n", name, lat_min, lat_min + lat_span);
+    printf("  %-28s %8s %8s %8s %10s %9s\n", "policy", "mean", "p99", "max", "undeliv.", "exhausted");
+    printf("  %-28s %6u ms %6u ms %6u ms %10u %9u\n", "all at once, one FIFO",
+           legacy.mean_ms, legacy.p99_ms, legacy.max_ms, legacy.undelivered, legacy.exhausted);
+    printf("  %-28s %6u ms %6u ms %6u ms %10u %9u\n", "paced, transitions first",
+           paced.mean_ms, paced.p99_ms, paced.max_ms, paced.undelivered, paced.exhausted);
+
+    CHECK(paced.mean_ms < legacy.mean_ms, "%s: priority queue mean %u >= legacy %u",
+          name, paced.mean_ms, legacy.mean_ms);
+    /* A transition is only ever lost to exhausted retries (soft fallback) */
+    CHECK(paced.undelivered <= paced.exhausted, "%s: %u transitions lost, %u exhausted",
+          name, paced.undelivered, paced.exhausted);
+}
+
+static void test_keepalive_bursts(uint32_t bursts)
+{
+    printf("keep-alive bursts: %u x 11 reports, one transition 0-500 ms after each\n", bursts);
+    run_scenario("one hop", bursts, 20, 180);
+    run_scenario("multi-hop", bursts, 150, 450);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t bursts = 10000;
+    if (argc > 1) bursts = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_priority_and_pacing();
+    test_backoff();
+    test_keepalive_bursts(bursts);
+
+    return check_result("report_queue");
+}
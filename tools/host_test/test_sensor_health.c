@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/sensor_health.c
+//
+// Build: make -C tools/host_test build/test_sensor_health
+// Run:   tools/host_test/build/test_sensor_health
+//
+// A simulated sensor produces the RX counters the UART task keeps (frames,
+// bytes, garbage, pauses, last frame time, longest gap) in 100 ms steps, and
+// the monitor samples them once a second like sensor_recovery.c does.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "sensor_health.h"
+#include "check.h"
+
+typedef enum {
+    SIM_FRAMES,     /* 10 Hz, clean */
+    SIM_SILENT,     /* nothing on the wire */
+    SIM_NOISY,      /* 10 Hz with two garbage bytes per frame byte */
+    SIM_SLOW,       /* 3 Hz, clean */
+    SIM_PAUSED,     /* RX paused for a config session */
+} sim_mode_t;
+
+typedef struct {
+    uint32_t now;
+    uint32_t bytes, frames, garbage, pauses;
+    bool     paused;
+    uint32_t last_frame_ms, gap_max_ms;
+    uint32_t next_sample;
+    sensor_health_t h;
+    uint32_t restarts, reapplies;       /* actions returned */
+    uint32_t restart_at[16];
+} sim_t;
+
+static void sim_init(sim_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->now = 1000;
+    s->next_sample = s->now + 1000;
+    sensor_health_init(&s->h, NULL, s->now);
+}
+
+static void sim_frame(sim_t *s)
+{
+    if (s->last_frame_ms && s->now - s->last_frame_ms > s->gap_max_ms) {
+        s->gap_max_ms = s->now - s->last_frame_ms;
+    }
+    s->last_frame_ms = s->now;
+    s->frames++;
+    s->bytes += 30;
+}
+
+static void sim_sample(sim_t *s)
+{
+    sensor_health_sample_t smp = {
+        .now_ms        = s->now,
+        .bytes         = s->bytes,
+        .frames        = s->frames,
+        .garbage_bytes = s->garbage,
+        .pauses        = s->pauses,
+        .paused        = s->paused,
+        .last_frame_ms = s->last_frame_ms,
+        .gap_max_ms    = s->gap_max_ms,
+    };
+    s->gap_max_ms = 0;
+    uint8_t a = sensor_health_step(&s->h, &smp);
+    if (a == SENSOR_HEALTH_RESTART) {
+        if (s->restarts < 16) s->restart_at[s->restarts] = s->now;
+        s->restarts++;
+    } else if (a == SENSOR_HEALTH_REAPPLY) {
+        s->reapplies++;
+    }
+}
+
+static void sim_run(sim_t *s, sim_mode_t mode, uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += 100) {
+        s->now += 100;
+        uint32_t tick = s->now / 100;
+
+        bool was_paused = s->paused;
+        s->paused = (mode == SIM_PAUSED);
+        if (s->paused && !was_paused) s->pauses++;
+        if (!s->paused && was_paused && s->last_frame_ms) s->last_frame_ms = s->now;
+
+        switch (mode) {
+        case SIM_FRAMES:
+            sim_frame(s);
+            break;
+        case SIM_NOISY:
+            sim_frame(s);
+            s->bytes += 60;
+            s->garbage += 60;
+            break;
+        case SIM_SLOW:
+            if (tick % 10 == 0 || tick % 10 == 3 || tick % 10 == 6) sim_frame(s);
+            break;
+        default:
+            break;
+        }
+
+        if (s->now >= s->next_sample) {
+            sim_sample(s);
+            s->next_sample += 1000;
+        }
+    }
+}
+
+static void test_healthy_stream(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 120000);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.restarts == 0 && s.reapplies == 0, "actions %u/%u", s.restarts, s.reapplies);
+    CHECK(s.h.log_count == 0, "events %u", s.h.log_count);
+    CHECK(s.h.rate_pct >= 90 && s.h.rate_pct <= 110, "rate %u", s.h.rate_pct);
+}
+
+static void test_reboot_gap_reapplies(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 10000);
+    sim_run(&s, SIM_SILENT, 1500);      /* sensor reboots */
+    sim_run(&s, SIM_FRAMES, 10000);
+    CHECK(s.h.gaps == 1, "gaps %u", s.h.gaps);
+    CHECK(s.h.longest_gap_ms >= 1500 && s.h.longest_gap_ms <= 1700, "longest %u", s.h.longest_gap_ms);
+    CHECK(s.reapplies == 1, "reapplies %u", s.reapplies);
+    CHECK(s.restarts == 0, "restarts %u", s.restarts);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "state %s", sensor_health_state_name(s.h.state));
+
+    sensor_health_event_t ev;
+    CHECK(sensor_health_get_event(&s.h, 0, &ev) && ev.type == SENSOR_HEALTH_EV_REAPPLY, "newest");
+    CHECK(sensor_health_get_event(&s.h, 1, &ev) && ev.type == SENSOR_HEALTH_EV_GAP, "oldest");
+    CHECK(!sensor_health_get_event(&s.h, 2, &ev), "only two events");
+}
+
+static void test_short_gap_ignored(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 10000);
+    sim_run(&s, SIM_SILENT, 600);
+    sim_run(&s, SIM_FRAMES, 10000);
+    CHECK(s.h.gaps == 0 && s.reapplies == 0, "gaps %u reapplies %u", s.h.gaps, s.reapplies);
+}
+
+static void test_stall_backoff_and_recovery(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 10000);
+    uint32_t silent_from = s.now;
+    sim_run(&s, SIM_SILENT, 700000);
+
+    CHECK(s.h.state == SENSOR_HEALTH_STALLED, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.h.stalls == 1, "stalls %u", s.h.stalls);
+    CHECK(s.restarts >= 2, "restarts %u", s.restarts);
+
+    /* First restart once stall_ms has passed, then 5 s doubling to 5 min */
+    uint32_t first = s.restart_at[0] - silent_from;
+    CHECK(first >= 3000 && first <= 4000, "first restart after %u ms", first);
+    uint32_t want = 5000;
+    for (uint32_t i = 1; i < s.restarts && i < 16; i++) {
+        uint32_t d = s.restart_at[i] - s.restart_at[i - 1];
+        CHECK(d >= want && d < want + 1000, "restart %u after %u ms, want %u", i, d, want);
+        want = want * 2 > 300000 ? 300000 : want * 2;
+    }
+    CHECK(want == 300000, "backoff never reached the cap");
+    CHECK(s.reapplies == 0, "reapplied while silent");
+
+    /* Frames resume: one recovery and one re-apply, no more restarts */
+    uint32_t restarts = s.restarts;
+    sim_run(&s, SIM_FRAMES, 30000);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.reapplies == 1, "reapplies %u", s.reapplies);
+    CHECK(s.restarts == restarts, "restarted after recovery");
+    CHECK(s.h.gaps == 0, "restart gap counted as gap");
+
+    /* Backoff resets after stable_ms of good frames */
+    CHECK(s.h.backoff_ms == 300000, "backoff %u before stable", s.h.backoff_ms);
+    sim_run(&s, SIM_FRAMES, 40000);
+    CHECK(s.h.backoff_ms == 5000, "backoff %u after stable", s.h.backoff_ms);
+}
+
+static void test_noise_restarts(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 10000);
+    sim_run(&s, SIM_NOISY, 3000);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "noisy too early");
+    sim_run(&s, SIM_NOISY, 3000);
+    CHECK(s.h.state == SENSOR_HEALTH_NOISY, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.h.noise == 1 && s.restarts == 1, "noise %u restarts %u", s.h.noise, s.restarts);
+    CHECK(s.h.noise_pct >= 60 && s.h.noise_pct <= 70, "noise_pct %u", s.h.noise_pct);
+
+    sim_run(&s, SIM_FRAMES, 5000);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.reapplies == 1, "reapplies %u", s.reapplies);
+}
+
+static void test_low_rate_is_noisy(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 5000);
+    sim_run(&s, SIM_SLOW, 10000);
+    CHECK(s.h.state == SENSOR_HEALTH_NOISY, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.h.rate_pct == 30, "rate %u", s.h.rate_pct);
+}
+
+static void test_pause_is_not_a_gap(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 10000);
+    for (int i = 0; i < 5; i++) {
+        sim_run(&s, SIM_PAUSED, 4000);    /* longer than stall_ms */
+        sim_run(&s, SIM_FRAMES, 2300);
+    }
+    sim_run(&s, SIM_FRAMES, 5000);
+    CHECK(s.h.state == SENSOR_HEALTH_OK, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.h.log_count == 0, "events %u", s.h.log_count);
+    CHECK(s.restarts == 0 && s.reapplies == 0, "actions %u/%u", s.restarts, s.reapplies);
+}
+
+static void test_never_seen_sensor(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_SILENT, 10000);
+    CHECK(s.h.state == SENSOR_HEALTH_STALLED, "state %s", sensor_health_state_name(s.h.state));
+    CHECK(s.restarts == 2, "restarts %u", s.restarts);
+}
+
+static void test_event_ring_wraps(void)
+{
+    sim_t s;
+    sim_init(&s);
+    sim_run(&s, SIM_FRAMES, 3000);
+    for (int i = 0; i < 6; i++) {
+        sim_run(&s, SIM_SILENT, 1500);
+        sim_run(&s, SIM_FRAMES, 3000);
+    }
+    CHECK(s.h.gaps == 6 && s.reapplies == 6, "gaps %u reapplies %u", s.h.gaps, s.reapplies);
+    CHECK(s.h.log_count == SENSOR_HEALTH_LOG_LEN, "count %u", s.h.log_count);
+
+    sensor_health_event_t prev, ev;
+    CHECK(sensor_health_get_event(&s.h, 0, &prev), "newest");
+    for (uint8_t i = 1; i < SENSOR_HEALTH_LOG_LEN; i++) {
+        CHECK(sensor_health_get_event(&s.h, i, &ev), "entry %u", i);
+        CHECK(ev.t_ms <= prev.t_ms, "entry %u out of order", i);
+        CHECK(ev.type != prev.type, "entry %u not alternating", i);
+        prev = ev;
+    }
+}
+
+int main(void)
+{
+    test_healthy_stream();
+    test_reboot_gap_reapplies();
+    test_short_gap_ignored();
+    test_stall_backoff_and_recovery();
+    test_noise_restarts();
+    test_low_rate_is_noisy();
+    test_pause_is_not_a_gap();
+    test_never_seen_sensor();
+    test_event_ring_wraps();
+
+    return check_result("sensor_health");
+}
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test for main/zcl_batch.c
+//
+// Build: make -C tools/host_test build/test_zcl_batch
+// Run:   tools/host_test/build/test_zcl_batch [cycles]
+//
+// Checks the Report Attributes frame layout, same-attribute replacement and
+// frame splitting, then replays a synthetic poll trace that stages the EP1
+// sensor attributes the way sensor_bridge.c does and compares APS frames per
+// real-world event: one report per changed attribute (ZBoss per-attribute
+// reporting) vs. one batched report per cycle.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "zcl_batch.h"
+#include "check.h"
+
+static uint32_t g_rng = 0x2450u;
+static uint32_t rnd(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* ZCL type ids used by the EP1 sensor attributes */
+#define T_U8      0x20
+#define T_U16     0x21
+#define T_U32     0x23
+#define T_OCTET   0x41
+
+/* EP1 sensor attribute ids / encoded sizes (see zigbee_defs.h) */
+#define A_COUNT   0x0000
+#define A_BITMAP  0x0002
+#define A_DATA    0x0003
+#define A_EVLOG   0x0006
+#define A_HEAP    0x0033
+#define DATA_LEN  (1 + 19)    /* octet string: length prefix + packed targets */
+#define EVLOG_LEN (1 + 47)
+
+/* ---- Directed tests ---- */
+
+static void test_frame_layout(void)
+{
+    zcl_batch_t b;
+    zcl_batch_begin(&b, 1, 0xFC00);
+
+    uint8_t count = 2;
+    uint16_t bitmap = 0x0105;
+    uint8_t data[4] = {3, 0xAA, 0xBB, 0xCC};
+    CHECK(zcl_batch_add(&b, A_COUNT, T_U8, &count, 1), "add count");
+    CHECK(zcl_batch_add(&b, A_BITMAP, T_U16, &bitmap, 2), "add bitmap");
+    CHECK(zcl_batch_add(&b, A_DATA, T_OCTET, data, sizeof(data)), "add data");
+
+    /* Same attribute again in the cycle: last value wins, order kept */
+    count = 3;
+    CHECK(zcl_batch_add(&b, A_COUNT, T_U8, &count, 1), "re-add count");
+    CHECK(b.count == 3, "staged %u records", b.count);
+
+    uint8_t out[ZCL_BATCH_MAX_FRAME];
+    uint8_t next = 0;
+    size_t len = zcl_batch_build_frame(&b, 0x42, &next, out);
+    static const uint8_t expect[] = {
+        0x18, 0x42, 0x0A,
+        0x00, 0x00, 0x20, 0x03,
+        0x02, 0x00, 0x21, 0x05, 0x01,
+        0x03, 0x00, 0x41, 0x03, 0xAA, 0xBB, 0xCC,
+    };
+    CHECK(len == sizeof(expect) && memcmp(out, expect, len) == 0, "frame layout mismatch (len %zu)", len);
+    CHECK(zcl_batch_build_frame(&b, 0x43, &next, out) == 0, "extra frame");
+    CHECK(zcl_batch_frame_count(&b) == 1, "frame count %u", zcl_batch_frame_count(&b));
+
+    /* Replacing with a different length moves the record to the end */
+    uint8_t longer[6] = {5, 1, 2, 3, 4, 5};
+    CHECK(zcl_batch_add(&b, A_DATA, T_OCTET, longer, sizeof(longer)), "re-add longer data");
+    CHECK(b.count == 3 && b.rec[2].attr_id == A_DATA && b.used == 1 + 2 + 6, "relayout after resize");
+    next = 0;
+    len = zcl_batch_build_frame(&b, 0, &next, out);
+    CHECK(memcmp(out + len - 6, longer, 6) == 0, "resized value not packed");
+}
+
+static void test_split_and_limits(void)
+{
+    zcl_batch_t b;
+    uint8_t evlog[EVLOG_LEN] = {47}, data[DATA_LEN] = {19};
+    uint8_t count = 1;
+    uint16_t bitmap = 1;
+    uint32_t heap = 123456;
+
+    zcl_batch_begin(&b, 1, 0xFC00);
+    zcl_batch_add(&b, A_BITMAP, T_U16,  &bitmap, 2);
+    zcl_batch_add(&b, A_EVLOG,  T_OCTET, evlog, sizeof(evlog));
+    zcl_batch_add(&b, A_COUNT,  T_U8,    &count, 1);
+    zcl_batch_add(&b, A_DATA,   T_OCTET, data, sizeof(data));
+    zcl_batch_add(&b, A_HEAP,   T_U32,   &heap, 4);
+    CHECK(zcl_batch_frame_count(&b) == 2, "5 sensor attrs in %u frames", zcl_batch_frame_count(&b));
+
+    uint8_t out[ZCL_BATCH_MAX_FRAME], next = 0, frames = 0, seen = 0;
+    size_t len;
+    while ((len = zcl_batch_build_frame(&b, frames, &next, out)) > 0) {
+        CHECK(len <= ZCL_BATCH_MAX_FRAME, "frame %u is %zu bytes", frames, len);
+        for (size_t pos = ZCL_BATCH_HEADER_LEN; pos < len; seen++) {
+            uint16_t id = (uint16_t)(out[pos] | (out[pos + 1] << 8));
+            CHECK(id == b.rec[seen].attr_id, "record %u out of order", seen);
+            pos += ZCL_BATCH_RECORD_HDR + b.rec[seen].len;
+        }
+        frames++;
+    }
+    CHECK(frames == 2 && seen == 5, "%u frames, %u records", frames, seen);
+
+    /* A record that can never fit a frame is refused */
+    uint8_t huge[ZCL_BATCH_MAX_FRAME] = {0};
+    CHECK(!zcl_batch_add(&b, 0x0100, T_OCTET, huge, ZCL_BATCH_MAX_FRAME - 5), "oversize record accepted");
+
+    /* Staging area full */
+    zcl_batch_begin(&b, 1, 0xFC00);
+    for (uint16_t i = 0; i < ZCL_BATCH_MAX_ATTRS; i++) {
+        CHECK(zcl_batch_add(&b, i, T_U8, &count, 1), "add %u", i);
+    }
+    CHECK(!zcl_batch_add(&b, 0x00FF, T_U8, &count, 1), "add past ZCL_BATCH_MAX_ATTRS");
+    CHECK(zcl_batch_add(&b, 0x0003, T_U8, &count, 1), "replace in a full batch");
+}
+
+/* ---- Trace comparison ---- */
+
+static void test_trace(uint32_t cycles)
+{
+    zcl_batch_t b;
+    uint8_t evlog[EVLOG_LEN] = {47}, data[DATA_LEN] = {19};
+    uint8_t count = 0;
+    uint16_t bitmap = 0;
+    uint32_t heap = 200000;
+
+    uint32_t events = 0, attrs = 0, frames = 0, bytes_before = 0, bytes_after = 0;
+    uint32_t multi = 0;
+
+    for (uint32_t t = 0; t < cycles; t++) {
+        zcl_batch_begin(&b, 1, 0xFC00);
+
+        /* 10 Hz poll.  Occupancy edges (~1 per 30 s) update bitmap + event
+         * log and usually the target count; target data goes out on about
+         * one poll in five while someone moves. */
+        bool edge   = rnd() % 300 == 0;
+        bool moving = (t / 600) % 2 == 0;
+        if (edge) {
+            bitmap ^= (uint16_t)(1u << (rnd() % 10));
+            zcl_batch_add(&b, A_BITMAP, T_U16, &bitmap, 2);
+            zcl_batch_add(&b, A_EVLOG, T_OCTET, evlog, sizeof(evlog));
+        }
+        if (edge ? rnd() % 4 != 0 : rnd() % 200 == 0) {
+            count = (uint8_t)((count + 1) % 4);
+            zcl_batch_add(&b, A_COUNT, T_U8, &count, 1);
+        }
+        if (moving && rnd() % 5 == 0) {
+            data[1] = (uint8_t)rnd();
+            zcl_batch_add(&b, A_DATA, T_OCTET, data, sizeof(data));
+        }
+        if (b.count > 0 && rnd() % 8 == 0) {   /* heap rides along with other changes */
+            heap -= 16;
+            zcl_batch_add(&b, A_HEAP, T_U32, &heap, 4);
+        }
+        if (b.count == 0) continue;
+
+        events++;
+        attrs += b.count;
+        if (b.count > 1) multi++;
+        for (uint8_t i = 0; i < b.count; i++) {
+            bytes_before += ZCL_BATCH_HEADER_LEN + ZCL_BATCH_RECORD_HDR + b.rec[i].len;
+        }
+
+        uint8_t out[ZCL_BATCH_MAX_FRAME], next = 0;
+        size_t len;
+        while ((len = zcl_batch_build_frame(&b, (uint8_t)frames, &next, out)) > 0) {
+            frames++;
+            bytes_after += (uint32_t)len;
+        }
+    }
+
+    printf("trace: %u poll cycles, %u with sensor changes (%u multi-attribute)\n",
+           cycles, events, multi);
+    printf("  %-22s %8s %12s %10s\n", "policy", "frames", "frames/event", "ZCL bytes");
+    printf("  %-22s %8u %12.3f %10u\n", "per-attribute reports", attrs, (double)attrs / events, bytes_before);
+    printf("  %-22s %8u %12.3f %10u\n", "batched per cycle", frames, (double)frames / events, bytes_after);
+
+    CHECK(frames < attrs, "batching sent %u frames for %u attrs", frames, attrs);
+    CHECK(frames >= events, "fewer frames than events");
+    CHECK(bytes_after + 3 * (attrs - frames) == bytes_before, "byte accounting");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t cycles = 1000000;
+    if (argc > 1) cycles = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    test_frame_layout();
+    test_split_and_limits();
+    test_trace(cycles);
+
+    return check_result("zcl_batch");
+}
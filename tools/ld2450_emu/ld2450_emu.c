@@ -0,0 +1,498 @@
+// SPDX-License-Identifier: MIT
+#include "ld2450_emu.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t k_data_header[4] = {0xAA, 0xFF, 0x03, 0x00};
+static const uint8_t k_cmd_header[4]  = {0xFD, 0xFC, 0xFB, 0xFA};
+static const uint8_t k_cmd_footer[4]  = {0x04, 0x03, 0x02, 0x01};
+
+#define CMD_ENABLE_CONF   0xFF
+#define CMD_DISABLE_CONF  0xFE
+#define CMD_SINGLE_TARGET 0x80
+#define CMD_MULTI_TARGET  0x90
+#define CMD_QUERY_TRACK   0x91
+#define CMD_READ_FW       0xA0
+#define CMD_FACTORY_RESET 0xA2
+#define CMD_RESTART       0xA3
+#define CMD_BLUETOOTH     0xA4
+#define CMD_READ_MAC      0xA5
+#define CMD_QUERY_ZONE    0xC1
+#define CMD_SET_ZONE      0xC2
+
+#define CMD_VALUE_MAX     (sizeof(((ld2450_emu_t *)0)->cmd) - 12)
+
+static const ld2450_emu_settings_t k_factory = {
+    .tracking  = 2,
+    .bluetooth = true,
+    .fw_type   = 0x0000,
+    .fw_major  = 0x0102,
+    .fw_minor  = 0x22062416,
+    .mac       = {0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65},
+};
+
+void ld2450_emu_default_faults(ld2450_emu_faults_t *f)
+{
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    f->drop_ack_cmd = -1;
+    f->ack_delay_ms = 20;
+    f->reboot_ms    = 1200;
+    f->seed         = 1;
+}
+
+void ld2450_emu_init(ld2450_emu_t *e, const ld2450_emu_faults_t *faults, uint32_t now_ms)
+{
+    if (!e) return;
+    memset(e, 0, sizeof(*e));
+    if (faults) {
+        e->faults = *faults;
+    } else {
+        ld2450_emu_default_faults(&e->faults);
+    }
+    e->set = k_factory;
+    e->rng = e->faults.seed ? e->faults.seed : 1;
+    e->start_ms = now_ms;
+    e->next_frame_ms = now_ms + LD2450_EMU_FRAME_MS;
+}
+
+void ld2450_emu_set_script(ld2450_emu_t *e, const ld2450_emu_key_t *keys, size_t n, uint32_t loop_ms)
+{
+    if (!e) return;
+    e->script = keys;
+    e->script_len = keys ? n : 0;
+    e->script_loop_ms = loop_ms;
+}
+
+/* xorshift32: reproducible across hosts */
+static uint32_t rnd(ld2450_emu_t *e)
+{
+    uint32_t x = e->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    e->rng = x;
+    return x;
+}
+
+static bool chance(ld2450_emu_t *e, uint8_t pct)
+{
+    return pct > 0 && (pct >= 100 || rnd(e) % 100 < pct);
+}
+
+/* ---- Output queue ---- */
+
+/* Bytes leave in order: one queued behind later-due bytes waits for them */
+static void out_push(ld2450_emu_t *e, uint32_t due_ms, const uint8_t *b, size_t n)
+{
+    if (e->out_len > 0) {
+        size_t tail = (e->out_head + e->out_len - 1) % LD2450_EMU_OUT_MAX;
+        if ((int32_t)(e->out_due[tail] - due_ms) > 0) due_ms = e->out_due[tail];
+    }
+    for (size_t i = 0; i < n && e->out_len < LD2450_EMU_OUT_MAX; i++) {
+        size_t slot = (e->out_head + e->out_len) % LD2450_EMU_OUT_MAX;
+        e->out[slot] = b[i];
+        e->out_due[slot] = due_ms;
+        e->out_len++;
+    }
+}
+
+/* ---- Targets ---- */
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static int16_t get_i16(const uint8_t *p)
+{
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+/* Sign-magnitude with the top bit on negative values, the inverse of
+ * ld2450_parser.c's decode_signed_upstream() */
+static uint16_t enc_signed(int16_t v)
+{
+    return v < 0 ? (uint16_t)(0x8000 | (uint16_t)(-v)) : (uint16_t)v;
+}
+
+void ld2450_emu_targets_at(const ld2450_emu_t *e, uint32_t t_ms, ld2450_emu_key_t out[LD2450_EMU_TARGETS])
+{
+    memset(out, 0, LD2450_EMU_TARGETS * sizeof(out[0]));
+    if (!e || !e->script_len) return;
+
+    uint32_t t = t_ms - e->start_ms;
+    if (e->script_loop_ms) t %= e->script_loop_ms;
+
+    for (uint8_t slot = 0; slot < LD2450_EMU_TARGETS; slot++) {
+        const ld2450_emu_key_t *cur = NULL, *next = NULL;
+        for (size_t i = 0; i < e->script_len; i++) {
+            const ld2450_emu_key_t *k = &e->script[i];
+            if (k->slot != slot) continue;
+            if (k->t_ms <= t) {
+                cur = k;
+            } else {
+                next = k;
+                break;
+            }
+        }
+        if (!cur || !cur->present) continue;
+
+        out[slot] = *cur;
+        out[slot].t_ms = t;
+        if (next && next->present && next->t_ms > cur->t_ms) {
+            int32_t span = (int32_t)(next->t_ms - cur->t_ms);
+            int32_t done = (int32_t)(t - cur->t_ms);
+            out[slot].x_mm  = (int16_t)(cur->x_mm  + (int32_t)(next->x_mm  - cur->x_mm)  * done / span);
+            out[slot].y_mm  = (int16_t)(cur->y_mm  + (int32_t)(next->y_mm  - cur->y_mm)  * done / span);
+            out[slot].speed = (int16_t)(cur->speed + (int32_t)(next->speed - cur->speed) * done / span);
+        }
+    }
+}
+
+/* The sensor's own zone filter (0xC2) */
+static bool filter_passes(const ld2450_emu_t *e, int16_t x, int16_t y)
+{
+    uint16_t type = (uint16_t)(e->set.zone[0] | (e->set.zone[1] << 8));
+    if (type != 1 && type != 2) return true;
+
+    bool inside = false;
+    for (int i = 0; i < 3 && !inside; i++) {
+        const uint8_t *p = &e->set.zone[2 + i * 8];
+        int16_t x1 = get_i16(p), y1 = get_i16(p + 2), x2 = get_i16(p + 4), y2 = get_i16(p + 6);
+        if (x1 == 0 && y1 == 0 && x2 == 0 && y2 == 0) continue;
+        if (x1 > x2) { int16_t t = x1; x1 = x2; x2 = t; }
+        if (y1 > y2) { int16_t t = y1; y1 = y2; y2 = t; }
+        inside = x >= x1 && x <= x2 && y >= y1 && y <= y2;
+    }
+    return type == 1 ? inside : !inside;
+}
+
+static void emit_frame(ld2450_emu_t *e, uint32_t t)
+{
+    ld2450_emu_key_t tg[LD2450_EMU_TARGETS];
+    ld2450_emu_targets_at(e, t, tg);
+
+    uint8_t f[LD2450_EMU_FRAME_LEN] = {0};
+    memcpy(f, k_data_header, 4);
+    uint8_t o = 4;
+    bool one = false;
+    for (int i = 0; i < LD2450_EMU_TARGETS; i++, o += 8) {
+        if (!tg[i].present || (e->set.tracking == 1 && one)) continue;
+        if (!filter_passes(e, tg[i].x_mm, tg[i].y_mm)) continue;
+        int16_t y = tg[i].y_mm < 0 ? 0 : tg[i].y_mm;
+        put_u16(&f[o + 0], enc_signed(tg[i].x_mm));
+        put_u16(&f[o + 2], (uint16_t)(0x8000 + y));
+        put_u16(&f[o + 4], enc_signed(tg[i].speed));
+        put_u16(&f[o + 6], 360);                /* distance resolution, mm */
+        one = true;
+    }
+    f[28] = 0x55;
+    f[29] = 0xCC;
+
+    if (chance(e, e->faults.corrupt_pct)) {
+        f[29] = 0x00;
+        e->stats.corrupted++;
+    }
+
+    if (e->last_frame_ms && t - e->last_frame_ms > e->stats.blackout_ms_max) {
+        e->stats.blackout_ms_max = t - e->last_frame_ms;
+    }
+    e->last_frame_ms = t;
+    e->stats.frames++;
+    out_push(e, t, f, sizeof(f));
+}
+
+static bool streaming_at(const ld2450_emu_t *e, uint32_t t)
+{
+    if ((int32_t)(t - e->silent_until_ms) < 0) return false;
+    if (e->config_mode && !e->faults.stream_in_config) return false;
+    if (e->faults.stall_for_ms &&
+        t - e->start_ms >= e->faults.stall_at_ms &&
+        t - e->start_ms <  e->faults.stall_at_ms + e->faults.stall_for_ms) {
+        return false;
+    }
+    return true;
+}
+
+/* Produce every frame slot up to now */
+static void advance(ld2450_emu_t *e, uint32_t now_ms)
+{
+    while ((int32_t)(now_ms - e->next_frame_ms) >= 0) {
+        uint32_t t = e->next_frame_ms;
+        e->next_frame_ms += LD2450_EMU_FRAME_MS;
+
+        if (chance(e, e->faults.garbage_pct)) {
+            uint8_t junk[32];
+            uint8_t n = (uint8_t)(1 + rnd(e) % sizeof(junk));
+            for (uint8_t i = 0; i < n; i++) junk[i] = (uint8_t)rnd(e);
+            e->stats.garbage_bytes += n;
+            out_push(e, t, junk, n);
+        }
+        if (streaming_at(e, t)) emit_frame(e, t);
+    }
+}
+
+/* ---- Commands ---- */
+
+static void end_session(ld2450_emu_t *e, uint32_t now_ms)
+{
+    if (!e->config_mode) return;
+    uint32_t d = now_ms - e->config_since_ms;
+    e->stats.session_ms_total += d;
+    if (d > e->stats.session_ms_max) e->stats.session_ms_max = d;
+    e->config_mode = false;
+}
+
+static void send_ack(ld2450_emu_t *e, uint32_t due_ms, uint8_t cmd, bool ok,
+                     const uint8_t *data, uint8_t data_len)
+{
+    uint8_t a[4 + 2 + 4 + 32 + 4];
+    size_t n = 0;
+    memcpy(&a[n], k_cmd_header, 4); n += 4;
+    put_u16(&a[n], (uint16_t)(4 + data_len)); n += 2;
+    a[n++] = cmd;
+    a[n++] = 0x01;
+    a[n++] = ok ? 0x00 : 0x01;
+    a[n++] = 0x00;
+    if (data_len) {
+        memcpy(&a[n], data, data_len);
+        n += data_len;
+    }
+    memcpy(&a[n], k_cmd_footer, 4); n += 4;
+
+    e->stats.acks++;
+    if (!ok) e->stats.naks++;
+    out_push(e, due_ms, a, n);
+}
+
+static void handle_command(ld2450_emu_t *e, uint32_t now_ms, uint8_t cmd,
+                           const uint8_t *value, uint16_t value_len)
+{
+    uint8_t data[32];
+    uint8_t data_len = 0;
+    uint32_t due = now_ms + e->faults.ack_delay_ms +
+                   (e->faults.ack_jitter_ms ? rnd(e) % (e->faults.ack_jitter_ms + 1) : 0);
+
+    e->stats.commands++;
+
+    /* Rebooting: nobody is listening */
+    if ((int32_t)(now_ms - e->silent_until_ms) < 0) return;
+
+    bool ok = e->config_mode || cmd == CMD_ENABLE_CONF;
+    if (ok && chance(e, e->faults.nak_pct)) ok = false;
+
+    if (ok) {
+        switch (cmd) {
+        case CMD_ENABLE_CONF:
+            if (!e->config_mode) {
+                e->config_mode = true;
+                e->config_since_ms = now_ms;
+                e->stats.sessions++;
+            }
+            put_u16(&data[0], 0x0001);           /* protocol version */
+            put_u16(&data[2], 0x0040);           /* buffer size */
+            data_len = 4;
+            break;
+        case CMD_DISABLE_CONF:
+            end_session(e, now_ms);
+            break;
+        case CMD_SINGLE_TARGET:
+            e->set.tracking = 1;
+            break;
+        case CMD_MULTI_TARGET:
+            e->set.tracking = 2;
+            break;
+        case CMD_QUERY_TRACK:
+            put_u16(data, e->set.tracking);
+            data_len = 2;
+            break;
+        case CMD_READ_FW:
+            put_u16(&data[0], e->set.fw_type);
+            put_u16(&data[2], e->set.fw_major);
+            put_u16(&data[4], (uint16_t)(e->set.fw_minor & 0xFFFF));
+            put_u16(&data[6], (uint16_t)(e->set.fw_minor >> 16));
+            data_len = 8;
+            break;
+        case CMD_READ_MAC:
+            memcpy(data, e->set.mac, 6);
+            data_len = 6;
+            break;
+        case CMD_BLUETOOTH:
+            ok = value_len >= 2;
+            if (ok) e->set.bluetooth = value[0] != 0;
+            break;
+        case CMD_FACTORY_RESET:
+            e->reset_pending = true;
+            break;
+        case CMD_RESTART:
+            break;
+        case CMD_QUERY_ZONE:
+            memcpy(data, e->set.zone, sizeof(e->set.zone));
+            data_len = sizeof(e->set.zone);
+            break;
+        case CMD_SET_ZONE:
+            ok = value_len == sizeof(e->set.zone);
+            if (ok) memcpy(e->set.zone, value, sizeof(e->set.zone));
+            break;
+        default:
+            ok = false;
+            break;
+        }
+    }
+
+    bool dropped = (e->faults.drop_ack_cmd < 0 || e->faults.drop_ack_cmd == cmd) &&
+                   chance(e, e->faults.drop_ack_pct);
+    if (dropped) {
+        e->stats.acks_dropped++;
+    } else {
+        send_ack(e, due, cmd, ok, data, ok ? data_len : 0);
+    }
+
+    if (ok && cmd == CMD_RESTART) {
+        /* Reboot once the ACK is out: silent, then streaming outside config mode */
+        end_session(e, now_ms);
+        e->silent_until_ms = due + e->faults.reboot_ms;
+        e->next_frame_ms = e->silent_until_ms;
+        if (e->reset_pending) {
+            ld2450_emu_settings_t keep = e->set;
+            e->set = k_factory;
+            memcpy(e->set.mac, keep.mac, sizeof(keep.mac));
+            e->reset_pending = false;
+        }
+        e->stats.restarts++;
+    }
+}
+
+void ld2450_emu_rx(ld2450_emu_t *e, uint32_t now_ms, const uint8_t *data, size_t len)
+{
+    if (!e || !data) return;
+    advance(e, now_ms);
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+
+        /* Header, resynchronising on a mismatch */
+        if (e->cmd_len < 4) {
+            if (b == k_cmd_header[e->cmd_len]) {
+                e->cmd[e->cmd_len++] = b;
+            } else {
+                if (e->cmd_len > 0) e->stats.bad_commands++;
+                e->cmd_len = (b == k_cmd_header[0]) ? 1 : 0;
+                if (e->cmd_len) e->cmd[0] = b;
+            }
+            continue;
+        }
+
+        e->cmd[e->cmd_len++] = b;
+        if (e->cmd_len < 6) continue;
+
+        uint16_t intra = (uint16_t)(e->cmd[4] | (e->cmd[5] << 8));
+        if (intra < 2 || intra > CMD_VALUE_MAX + 2) {
+            e->stats.bad_commands++;
+            e->cmd_len = 0;
+            continue;
+        }
+        uint16_t total = (uint16_t)(4 + 2 + intra + 4);
+        if (e->cmd_len < total) continue;
+
+        if (memcmp(&e->cmd[total - 4], k_cmd_footer, 4) != 0 || e->cmd[7] != 0x00) {
+            e->stats.bad_commands++;
+        } else {
+            handle_command(e, now_ms, e->cmd[6], &e->cmd[8], (uint16_t)(intra - 2));
+        }
+        e->cmd_len = 0;
+    }
+}
+
+size_t ld2450_emu_tx(ld2450_emu_t *e, uint32_t now_ms, uint8_t *out, size_t max)
+{
+    if (!e || !out) return 0;
+    advance(e, now_ms);
+
+    size_t n = 0;
+    while (n < max && e->out_len > 0 && (int32_t)(now_ms - e->out_due[e->out_head]) >= 0) {
+        out[n++] = e->out[e->out_head];
+        e->out_head = (e->out_head + 1) % LD2450_EMU_OUT_MAX;
+        e->out_len--;
+    }
+    return n;
+}
+
+uint32_t ld2450_emu_next_ms(ld2450_emu_t *e, uint32_t now_ms)
+{
+    if (!e) return now_ms;
+    advance(e, now_ms);
+    if (e->out_len > 0) {
+        uint32_t due = e->out_due[e->out_head];
+        return (int32_t)(due - now_ms) > 0 ? due : now_ms;
+    }
+    return e->next_frame_ms;
+}
+
+/* ---- Script text ---- */
+
+static bool parse_long(const char **p, long *out)
+{
+    char *end;
+    while (**p == ' ' || **p == '\t') (*p)++;
+    *out = strtol(*p, &end, 10);
+    if (end == *p) return false;
+    *p = end;
+    return true;
+}
+
+int ld2450_emu_parse_script(const char *text, ld2450_emu_key_t *out, size_t max)
+{
+    if (!text || !out) return 0;
+
+    size_t n = 0;
+    int line = 0;
+    uint32_t last_t = 0;
+    const char *p = text;
+
+    while (*p) {
+        line++;
+        const char *eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+        char buf[128];
+        if (len >= sizeof(buf)) return -line;
+        memcpy(buf, p, len);
+        buf[len] = '\0';
+        p = eol ? eol + 1 : p + len;
+
+        char *hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        const char *q = buf;
+        while (*q && isspace((unsigned char)*q)) q++;
+        if (!*q) continue;
+
+        long t, slot, x, y, speed = 0;
+        if (!parse_long(&q, &t) || !parse_long(&q, &slot)) return -line;
+        if (t < 0 || (uint32_t)t < last_t || slot < 0 || slot >= LD2450_EMU_TARGETS) return -line;
+        if (n >= max) return -line;
+
+        ld2450_emu_key_t k = { .t_ms = (uint32_t)t, .slot = (uint8_t)slot };
+        while (*q == ' ' || *q == '\t') q++;
+        if (q[0] == '-' && (q[1] == '\0' || isspace((unsigned char)q[1]))) {
+            q++;
+        } else {
+            if (!parse_long(&q, &x) || !parse_long(&q, &y)) return -line;
+            parse_long(&q, &speed);
+            if (x < -6000 || x > 6000 || y < 0 || y > 6000) return -line;
+            k.present = true;
+            k.x_mm = (int16_t)x;
+            k.y_mm = (int16_t)y;
+            k.speed = (int16_t)speed;
+        }
+        while (*q && isspace((unsigned char)*q)) q++;
+        if (*q) return -line;
+
+        out[n++] = k;
+        last_t = k.t_ms;
+    }
+    return (int)n;
+}
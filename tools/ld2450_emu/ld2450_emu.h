@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LD2450 sensor emulator core.
+ *
+ * Pure C, no OS dependencies and no clock of its own: the caller passes
+ * the time into every call.  ld2450_emu_pty.c serves it on a Linux
+ * pseudo-terminal in real time, and tools/host_test/test_ld2450_cmd_emu.c
+ * runs it in-process under a virtual clock against ld2450_cmd.c.
+ *
+ * Data frames (AA FF 03 00 ... 55 CC) go out every 100 ms, with the
+ * targets of a keyframe script encoded the way ld2450_parser.c decodes
+ * them, after the sensor's own zone filter and tracking mode.
+ *
+ * Command frames (FD FC FB FA len cmd 00 value 04 03 02 01) are answered
+ * after ack_delay_ms with an ACK in the same framing (cmd | 0x0100, status,
+ * data).  Outside config mode only enable-config is accepted; the others
+ * get a failure status.  Data frames stop while in config mode unless
+ * stream_in_config is set.  Restart ACKs, then the sensor is silent for
+ * reboot_ms and comes back out of config mode; factory reset takes effect
+ * at that restart, as on the real module.
+ *
+ * Faults are injected with a seeded PRNG, so a run is reproducible.
+ */
+
+#define LD2450_EMU_TARGETS      3
+#define LD2450_EMU_FRAME_MS     100
+#define LD2450_EMU_FRAME_LEN    30
+#define LD2450_EMU_SCRIPT_MAX   256     /* keyframes */
+#define LD2450_EMU_OUT_MAX      4096    /* queued output bytes */
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t  slot;              /* 0..2 */
+    bool     present;
+    int16_t  x_mm, y_mm;
+    int16_t  speed;             /* cm/s, as the sensor reports it */
+} ld2450_emu_key_t;
+
+typedef struct {
+    uint8_t  drop_ack_pct;      /* ACKs never sent */
+    int16_t  drop_ack_cmd;      /* -1 = any command, else only this command id */
+    uint8_t  nak_pct;           /* ACKs with a failure status */
+    uint8_t  corrupt_pct;       /* data frames with a broken end marker */
+    uint8_t  garbage_pct;       /* chance per frame slot of a 1-32 byte noise burst */
+    uint32_t ack_delay_ms;      /* command to ACK, default 20 */
+    uint32_t ack_jitter_ms;     /* plus 0..jitter */
+    uint32_t reboot_ms;         /* silence after restart, default 1200 */
+    uint32_t stall_at_ms;       /* stop streaming at this time ... */
+    uint32_t stall_for_ms;      /* ... for this long (0 = never) */
+    bool     stream_in_config;  /* keep sending data frames in config mode */
+    uint32_t seed;              /* PRNG seed, 0 = 1 */
+} ld2450_emu_faults_t;
+
+typedef struct {
+    uint32_t frames;            /* data frames sent (including corrupted ones) */
+    uint32_t corrupted;
+    uint32_t garbage_bytes;
+    uint32_t commands;          /* command frames received */
+    uint32_t bad_commands;      /* framing errors in received bytes */
+    uint32_t acks;
+    uint32_t acks_dropped;
+    uint32_t naks;
+    uint32_t sessions;          /* enable-config ... disable-config */
+    uint32_t session_ms_max;    /* longest time in config mode */
+    uint32_t session_ms_total;
+    uint32_t blackout_ms_max;   /* longest gap between two data frames */
+    uint32_t restarts;
+} ld2450_emu_stats_t;
+
+/* What the sensor holds ("NVRAM") */
+typedef struct {
+    uint8_t  tracking;          /* 1 = single, 2 = multi */
+    bool     bluetooth;
+    uint8_t  zone[26];          /* 0xC2 payload: type(2) + 3 x (x1 y1 x2 y2) */
+    uint16_t fw_type, fw_major;
+    uint32_t fw_minor;
+    uint8_t  mac[6];
+} ld2450_emu_settings_t;
+
+typedef struct {
+    ld2450_emu_faults_t   faults;
+    ld2450_emu_settings_t set;
+    ld2450_emu_stats_t    stats;
+
+    const ld2450_emu_key_t *script;
+    size_t   script_len;
+    uint32_t script_loop_ms;    /* script period, 0 = hold the last keyframe */
+
+    uint32_t start_ms;          /* script time 0 */
+    bool     config_mode;
+    uint32_t config_since_ms;
+    bool     reset_pending;     /* factory reset at next restart */
+    uint32_t silent_until_ms;   /* rebooting */
+    uint32_t next_frame_ms;
+    uint32_t last_frame_ms;     /* 0 = none yet */
+    uint32_t rng;
+
+    /* Command being received */
+    uint8_t  cmd[64];
+    uint16_t cmd_len;
+
+    /* Output queue: bytes and the time each becomes readable */
+    uint8_t  out[LD2450_EMU_OUT_MAX];
+    uint32_t out_due[LD2450_EMU_OUT_MAX];
+    size_t   out_head, out_len;
+} ld2450_emu_t;
+
+/** Defaults: no faults, 20 ms ACKs, 1200 ms reboot, multi-target, BT on, no filter. */
+void ld2450_emu_default_faults(ld2450_emu_faults_t *f);
+
+/** Start streaming at now_ms.  faults NULL = defaults. */
+void ld2450_emu_init(ld2450_emu_t *e, const ld2450_emu_faults_t *faults, uint32_t now_ms);
+
+/**
+ * Targets to report: keyframes sorted by time, linearly interpolated per
+ * slot between a keyframe and the slot's next one (a slot is absent before
+ * its first keyframe and after a not-present one).  loop_ms > 0 replays the
+ * script with that period.  The array must outlive the emulator.
+ */
+void ld2450_emu_set_script(ld2450_emu_t *e, const ld2450_emu_key_t *keys, size_t n, uint32_t loop_ms);
+
+/**
+ * Parse a keyframe script: one "t_ms slot x_mm y_mm [speed]" per line, or
+ * "t_ms slot -" to remove the target; '#' starts a comment.  Returns the
+ * number of keyframes, or -(line number) of the first bad line.
+ */
+int ld2450_emu_parse_script(const char *text, ld2450_emu_key_t *out, size_t max);
+
+/** Bytes the host sent to the sensor (commands). */
+void ld2450_emu_rx(ld2450_emu_t *e, uint32_t now_ms, const uint8_t *data, size_t len);
+
+/** Copy out up to max bytes readable at now_ms; returns the count. */
+size_t ld2450_emu_tx(ld2450_emu_t *e, uint32_t now_ms, uint8_t *out, size_t max);
+
+/** When the next byte becomes readable, assuming no further input. */
+uint32_t ld2450_emu_next_ms(ld2450_emu_t *e, uint32_t now_ms);
+
+/** Targets the script puts in the room at t_ms (before filter and tracking mode). */
+void ld2450_emu_targets_at(const ld2450_emu_t *e, uint32_t t_ms, ld2450_emu_key_t out[LD2450_EMU_TARGETS]);
+
+#ifdef __cplusplus
+}
+#endif
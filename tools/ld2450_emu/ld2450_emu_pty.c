@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: MIT
+//
+// LD2450 emulator on a Linux pseudo-terminal.
+//
+// Build: gcc -O2 -std=c11 -Wall -Wextra -Itools/ld2450_emu tools/ld2450_emu/ld2450_emu.c
+//            tools/ld2450_emu/ld2450_emu_pty.c -o /tmp/ld2450_emu
+// Run:   /tmp/ld2450_emu [options]
+//
+// Prints the slave device path (and symlinks it with -l), then serves the
+// emulated sensor on it in real time until interrupted or --duration ends:
+// data frames every 100 ms from the script, ACKs to configuration commands,
+// and any faults asked for.  Anything that opens the slave at 256000 8N1 in
+// raw mode can talk to it.  Counters are printed on exit (and on SIGUSR1).
+//
+// Options:
+//   -s, --script FILE     keyframes "t_ms slot x_mm y_mm [speed]" / "t_ms slot -"
+//       --loop MS         replay the script every MS (default: hold the end)
+//   -l, --link PATH       symlink PATH to the slave device
+//   -d, --duration S      exit after S seconds
+//       --ack-delay MS    command to ACK (default 20)
+//       --ack-jitter MS   plus 0..MS
+//       --drop-ack PCT    ACKs lost
+//       --drop-cmd ID     ... only for this command id (hex, e.g. 0xC2)
+//       --nak PCT         ACKs with failure status
+//       --corrupt PCT     data frames with a broken end marker
+//       --garbage PCT     chance per frame slot of a noise burst
+//       --reboot MS       silence after a restart command (default 1200)
+//       --stall AT:FOR    stop streaming at AT ms for FOR ms
+//       --stream-config   keep streaming in config mode
+//       --seed N          fault PRNG seed
+//   -v                    log every command and ACK
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ld2450_emu.h"
+
+static volatile sig_atomic_t g_stop = 0;
+static volatile sig_atomic_t g_dump = 0;
+
+static void on_signal(int sig)
+{
+    if (sig == SIGUSR1) g_dump = 1;
+    else                g_stop = 1;
+}
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static void print_stats(const ld2450_emu_t *e)
+{
+    const ld2450_emu_stats_t *s = &e->stats;
+    fprintf(stderr,
+            "frames %u (corrupted %u), garbage %u B, blackout max %u ms\n"
+            "commands %u (bad %u), acks %u (naks %u, dropped %u)\n"
+            "sessions %u, config mode max %u ms, avg %u ms, restarts %u\n"
+            "sensor: tracking=%s bt=%s zone_type=%u\n",
+            s->frames, s->corrupted, s->garbage_bytes, s->blackout_ms_max,
+            s->commands, s->bad_commands, s->acks, s->naks, s->acks_dropped,
+            s->sessions, s->session_ms_max, s->sessions ? s->session_ms_total / s->sessions : 0,
+            s->restarts,
+            e->set.tracking == 1 ? "single" : "multi", e->set.bluetooth ? "on" : "off",
+            (unsigned)(e->set.zone[0] | (e->set.zone[1] << 8)));
+}
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = n >= 0 ? malloc((size_t)n + 1) : NULL;
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    if (buf) buf[n] = '\0';
+    fclose(f);
+    return buf;
+}
+
+/* One person walking in and out again, then standing still */
+static const ld2450_emu_key_t k_default_script[] = {
+    {     0, 0, true, -2000, 4500,   0 },
+    {  4000, 0, true,     0, 1500, -40 },
+    {  8000, 0, true,  1800, 3000,  30 },
+    { 12000, 0, true,  1800, 3000,   0 },
+    { 15000, 0, false,    0,    0,   0 },
+};
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-s script] [--loop ms] [-l link] [-d seconds] [--ack-delay ms]\n"
+            "          [--ack-jitter ms] [--drop-ack pct] [--drop-cmd id] [--nak pct]\n"
+            "          [--corrupt pct] [--garbage pct] [--reboot ms] [--stall at:for]\n"
+            "          [--stream-config] [--seed n] [-v]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    ld2450_emu_faults_t faults;
+    ld2450_emu_default_faults(&faults);
+    const char *script_path = NULL, *link_path = NULL;
+    uint32_t loop_ms = 0, duration_s = 0;
+    int verbose = 0;
+
+    static const struct option opts[] = {
+        {"script",        required_argument, 0, 's'},
+        {"loop",          required_argument, 0, 'L'},
+        {"link",          required_argument, 0, 'l'},
+        {"duration",      required_argument, 0, 'd'},
+        {"ack-delay",     required_argument, 0, 'a'},
+        {"ack-jitter",    required_argument, 0, 'j'},
+        {"drop-ack",      required_argument, 0, 'D'},
+        {"drop-cmd",      required_argument, 0, 'C'},
+        {"nak",           required_argument, 0, 'n'},
+        {"corrupt",       required_argument, 0, 'c'},
+        {"garbage",       required_argument, 0, 'g'},
+        {"reboot",        required_argument, 0, 'r'},
+        {"stall",         required_argument, 0, 'S'},
+        {"stream-config", no_argument,       0, 'K'},
+        {"seed",          required_argument, 0, 'R'},
+        {0, 0, 0, 0},
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "s:l:d:v", opts, NULL)) != -1) {
+        switch (c) {
+        case 's': script_path = optarg; break;
+        case 'L': loop_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'l': link_path = optarg; break;
+        case 'd': duration_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'a': faults.ack_delay_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'j': faults.ack_jitter_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'D': faults.drop_ack_pct = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'C': faults.drop_ack_cmd = (int16_t)strtol(optarg, NULL, 0); break;
+        case 'n': faults.nak_pct = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'c': faults.corrupt_pct = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'g': faults.garbage_pct = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'r': faults.reboot_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'S':
+            if (sscanf(optarg, "%u:%u", &faults.stall_at_ms, &faults.stall_for_ms) != 2) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'K': faults.stream_in_config = true; break;
+        case 'R': faults.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'v': verbose = 1; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    static ld2450_emu_key_t keys[LD2450_EMU_SCRIPT_MAX];
+    const ld2450_emu_key_t *script = k_default_script;
+    size_t script_len = sizeof(k_default_script) / sizeof(k_default_script[0]);
+    if (script_path) {
+        char *text = read_file(script_path);
+        if (!text) {
+            fprintf(stderr, "%s: %s\n", script_path, strerror(errno));
+            return 1;
+        }
+        int n = ld2450_emu_parse_script(text, keys, LD2450_EMU_SCRIPT_MAX);
+        free(text);
+        if (n < 0) {
+            fprintf(stderr, "%s:%d: bad keyframe\n", script_path, -n);
+            return 1;
+        }
+        script = keys;
+        script_len = (size_t)n;
+    } else if (!loop_ms) {
+        loop_ms = 20000;
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    const char *slave = ptsname(master);
+
+    /* Hold the slave open in raw mode: no echo or line discipline, and the
+     * master does not see EIO between clients */
+    int hold = open(slave, O_RDWR | O_NOCTTY);
+    if (hold < 0) {
+        perror(slave);
+        return 1;
+    }
+    struct termios tio;
+    tcgetattr(hold, &tio);
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B230400);     /* nearest standard rate; a pty ignores it */
+    cfsetospeed(&tio, B230400);
+    tcsetattr(hold, TCSANOW, &tio);
+
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(slave, link_path) != 0) {
+            perror(link_path);
+            return 1;
+        }
+    }
+    printf("%s\n", link_path ? link_path : slave);
+    fflush(stdout);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGUSR1, on_signal);
+
+    static ld2450_emu_t emu;
+    uint32_t start = now_ms();
+    ld2450_emu_init(&emu, &faults, start);
+    ld2450_emu_set_script(&emu, script, script_len, loop_ms);
+
+    uint32_t acks = 0, cmds = 0;
+    while (!g_stop) {
+        uint32_t now = now_ms();
+        if (duration_s && now - start >= duration_s * 1000u) break;
+
+        uint32_t next = ld2450_emu_next_ms(&emu, now);
+        int wait = (int)(next - now);
+        if (wait < 0) wait = 0;
+        if (wait > 100) wait = 100;
+
+        struct pollfd pfd = { .fd = master, .events = POLLIN };
+        int pr = poll(&pfd, 1, wait);
+        now = now_ms();
+        if (pr > 0 && (pfd.revents & POLLIN)) {
+            uint8_t in[256];
+            ssize_t n = read(master, in, sizeof(in));
+            if (n > 0) ld2450_emu_rx(&emu, now, in, (size_t)n);
+        }
+
+        uint8_t out[512];
+        size_t n;
+        while ((n = ld2450_emu_tx(&emu, now, out, sizeof(out))) > 0) {
+            if (write(master, out, n) < 0 && errno != EAGAIN) {
+                perror("write");
+                g_stop = 1;
+                break;
+            }
+        }
+
+        if (verbose && (emu.stats.commands != cmds || emu.stats.acks != acks)) {
+            fprintf(stderr, "[%6u ms] commands %u acks %u%s\n", now - start,
+                    emu.stats.commands, emu.stats.acks, emu.config_mode ? " (config mode)" : "");
+            cmds = emu.stats.commands;
+            acks = emu.stats.acks;
+        }
+        if (g_dump) {
+            g_dump = 0;
+            print_stats(&emu);
+        }
+    }
+
+    print_stats(&emu);
+    if (link_path) unlink(link_path);
+    close(hold);
+    close(master);
+    return 0;
+}
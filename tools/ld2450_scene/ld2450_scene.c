@@ -0,0 +1,550 @@
+// SPDX-License-Identifier: MIT
+#include "ld2450_scene.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI  3.14159265358979323846
+
+void ld2450_scene_default_radar(ld2450_scene_radar_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->jitter_mm      = 40;
+    r->body_mm        = 500;
+    r->still_drop_pct = 2;
+    r->still_drop_ms  = 800;
+    r->ghost_pct      = 0;
+    r->ghost_ms       = 1000;
+    r->wall_mm        = 2500;
+    r->seed           = 1;
+}
+
+void ld2450_scene_init(ld2450_scene_t *s, const ld2450_scene_person_t *people, size_t n,
+                       const ld2450_scene_radar_t *radar)
+{
+    memset(s, 0, sizeof(*s));
+    s->people = people;
+    s->n_people = n < LD2450_SCENE_PEOPLE_MAX ? n : LD2450_SCENE_PEOPLE_MAX;
+    if (radar) {
+        s->radar = *radar;
+    } else {
+        ld2450_scene_default_radar(&s->radar);
+    }
+    s->rng = s->radar.seed ? s->radar.seed : 1;
+}
+
+/* xorshift32, as in ld2450_emu: reproducible across hosts */
+static uint32_t rnd(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool chance(ld2450_scene_t *s, uint8_t pct)
+{
+    return pct > 0 && (pct >= 100 || rnd(&s->rng) % 100 < pct);
+}
+
+/* Standard normal (Box-Muller) */
+static double gauss(ld2450_scene_t *s)
+{
+    double u1 = (rnd(&s->rng) + 1.0) / 4294967297.0;
+    double u2 = rnd(&s->rng) / 4294967296.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+}
+
+/* Burst length: whole frames, 1 up to max_ms */
+static uint32_t burst_ms(ld2450_scene_t *s, uint16_t max_ms)
+{
+    uint32_t frames = max_ms / LD2450_SCENE_FRAME_MS;
+    return LD2450_SCENE_FRAME_MS * (1 + (frames > 1 ? rnd(&s->rng) % frames : 0));
+}
+
+/* ---- People ---- */
+
+static uint32_t walk_ms(const ld2450_scene_wp_t *a, const ld2450_scene_wp_t *b, uint16_t speed)
+{
+    double d = hypot(b->x_mm - a->x_mm, b->y_mm - a->y_mm);
+    return (uint32_t)(d * 1000.0 / (speed ? speed : 1));
+}
+
+bool ld2450_scene_person_at(const ld2450_scene_person_t *p, uint32_t t_ms,
+                            int16_t *x_mm, int16_t *y_mm, bool *moving)
+{
+    if (!p->n_wp || t_ms < p->enter_ms) return false;
+
+    uint32_t at = p->enter_ms;
+    for (uint8_t i = 0; i < p->n_wp; i++) {
+        const ld2450_scene_wp_t *w = &p->wp[i];
+        uint32_t leave = at + w->dwell_ms;
+        if (t_ms < leave || (i + 1 == p->n_wp && t_ms == leave && w->dwell_ms == 0)) {
+            *x_mm = w->x_mm;
+            *y_mm = w->y_mm;
+            *moving = false;
+            return true;
+        }
+        if (i + 1 == p->n_wp) return false;
+
+        const ld2450_scene_wp_t *n = &p->wp[i + 1];
+        uint32_t span = walk_ms(w, n, p->speed_mm_s);
+        if (t_ms < leave + span) {
+            double f = (double)(t_ms - leave) / span;
+            *x_mm = (int16_t)lround(w->x_mm + f * (n->x_mm - w->x_mm));
+            *y_mm = (int16_t)lround(w->y_mm + f * (n->y_mm - w->y_mm));
+            *moving = true;
+            return true;
+        }
+        at = leave + span;
+    }
+    return false;
+}
+
+uint32_t ld2450_scene_end_ms(const ld2450_scene_person_t *people, size_t n)
+{
+    uint32_t end = 0;
+    for (size_t k = 0; k < n; k++) {
+        const ld2450_scene_person_t *p = &people[k];
+        uint32_t at = p->enter_ms;
+        for (uint8_t i = 0; i < p->n_wp; i++) {
+            at += p->wp[i].dwell_ms;
+            if (i + 1 < p->n_wp) at += walk_ms(&p->wp[i], &p->wp[i + 1], p->speed_mm_s);
+        }
+        if (at > end) end = at;
+    }
+    return end;
+}
+
+/* ---- Radar ---- */
+
+static double range_of(int16_t x, int16_t y)
+{
+    return hypot(x, y);
+}
+
+static double bearing_deg(int16_t x, int16_t y)
+{
+    return atan2(x, y) * 180.0 / PI;
+}
+
+static bool in_view(int16_t x, int16_t y)
+{
+    return y > 0 && range_of(x, y) <= LD2450_SCENE_RANGE_MM &&
+           fabs(bearing_deg(x, y)) <= LD2450_SCENE_FOV_DEG;
+}
+
+static int16_t clamp16(double v, int16_t lo, int16_t hi)
+{
+    long r = lround(v);
+    return (int16_t)(r < lo ? lo : r > hi ? hi : r);
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/* Sign-magnitude with the top bit on negative values (see ld2450_emu.c) */
+static uint16_t enc_signed(int16_t v)
+{
+    return v < 0 ? (uint16_t)(0x8000 | (uint16_t)(-v)) : (uint16_t)v;
+}
+
+typedef struct {
+    bool    present;
+    int16_t x, y;
+    double  range, bearing;
+    int16_t speed;          /* cm/s, positive moving away */
+} cand_t;
+
+void ld2450_scene_frame(ld2450_scene_t *s, uint8_t out[LD2450_SCENE_FRAME_LEN],
+                        ld2450_scene_truth_t *truth)
+{
+    const ld2450_scene_radar_t *r = &s->radar;
+    uint32_t t = s->next_ms;
+    s->next_ms += LD2450_SCENE_FRAME_MS;
+
+    cand_t c[LD2450_SCENE_PEOPLE_MAX] = { 0 };
+    uint8_t state[LD2450_SCENE_PEOPLE_MAX];
+
+    /* Where everyone is, and who the radar can see at all */
+    for (size_t i = 0; i < s->n_people; i++) {
+        bool moving = false;
+        c[i].present = ld2450_scene_person_at(&s->people[i], t, &c[i].x, &c[i].y, &moving);
+        if (!c[i].present) {
+            s->lost_until[i] = 0;
+            continue;
+        }
+        c[i].range = range_of(c[i].x, c[i].y);
+        c[i].bearing = bearing_deg(c[i].x, c[i].y);
+
+        int16_t px, py;
+        bool pm;
+        if (t >= LD2450_SCENE_FRAME_MS &&
+            ld2450_scene_person_at(&s->people[i], t - LD2450_SCENE_FRAME_MS, &px, &py, &pm)) {
+            c[i].speed = (int16_t)lround(c[i].range - range_of(px, py));   /* mm per 100 ms = cm/s */
+        }
+
+        state[i] = LD2450_SCENE_SEEN;
+        if (!in_view(c[i].x, c[i].y)) {
+            state[i] = LD2450_SCENE_OUT_OF_VIEW;
+        } else if (moving) {
+            s->lost_until[i] = 0;
+        } else if (t < s->lost_until[i]) {
+            state[i] = LD2450_SCENE_LOST;
+        } else if (chance(s, r->still_drop_pct)) {
+            s->lost_until[i] = t + burst_ms(s, r->still_drop_ms);
+            state[i] = LD2450_SCENE_LOST;
+        }
+    }
+
+    /* Radio shadow: at least a body behind someone nearer, within the
+     * angle that person covers */
+    if (r->body_mm) {
+        for (size_t b = 0; b < s->n_people; b++) {
+            if (!c[b].present || state[b] != LD2450_SCENE_SEEN) continue;
+            for (size_t a = 0; a < s->n_people; a++) {
+                if (a == b || !c[a].present || state[a] == LD2450_SCENE_OUT_OF_VIEW) continue;
+                if (c[a].range > c[b].range - r->body_mm) continue;
+                double half = atan2(r->body_mm / 2.0, c[a].range) * 180.0 / PI;
+                if (fabs(c[a].bearing - c[b].bearing) < half) {
+                    state[b] = LD2450_SCENE_OCCLUDED;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Three targets at most: the nearest */
+    for (;;) {
+        int seen = 0, far = -1;
+        for (size_t i = 0; i < s->n_people; i++) {
+            if (!c[i].present || state[i] != LD2450_SCENE_SEEN) continue;
+            seen++;
+            if (far < 0 || c[i].range > c[far].range) far = (int)i;
+        }
+        if (seen <= LD2450_SCENE_SLOTS) break;
+        state[far] = LD2450_SCENE_CAPPED;
+    }
+
+    /* Slots: keep the seen, free the rest, then seat newcomers; a ghost
+     * gives way to a person */
+    bool ghost_on = t < s->ghost_until;
+    int8_t slot_of[LD2450_SCENE_PEOPLE_MAX];
+    for (size_t i = 0; i < s->n_people; i++) slot_of[i] = -1;
+    for (int k = 0; k < LD2450_SCENE_SLOTS; k++) {
+        uint8_t owner = s->slot_owner[k];
+        bool keep = false;
+        if (owner == LD2450_SCENE_GHOST_ID) {
+            keep = ghost_on;
+        } else if (owner) {
+            for (size_t i = 0; i < s->n_people; i++) {
+                if (s->people[i].id == owner && c[i].present && state[i] == LD2450_SCENE_SEEN) {
+                    slot_of[i] = (int8_t)k;
+                    keep = true;
+                }
+            }
+        }
+        if (!keep) s->slot_owner[k] = 0;
+    }
+    for (size_t i = 0; i < s->n_people; i++) {
+        if (!c[i].present || state[i] != LD2450_SCENE_SEEN || slot_of[i] >= 0) continue;
+        int k = -1;
+        for (int j = 0; j < LD2450_SCENE_SLOTS && k < 0; j++) {
+            if (!s->slot_owner[j]) k = j;
+        }
+        for (int j = 0; j < LD2450_SCENE_SLOTS && k < 0; j++) {
+            if (s->slot_owner[j] == LD2450_SCENE_GHOST_ID) k = j;
+        }
+        if (k < 0) continue;                        /* cannot happen after the cap */
+        s->slot_owner[k] = s->people[i].id;
+        slot_of[i] = (int8_t)k;
+    }
+
+    /* Ghosts: a reflection of someone seen, mirrored off the nearer side
+     * wall, or a stray point when that lands out of view */
+    if (!ghost_on && chance(s, r->ghost_pct)) {
+        int src = -1, n_seen = 0;
+        for (size_t i = 0; i < s->n_people; i++) {
+            if (slot_of[i] >= 0 && rnd(&s->rng) % (uint32_t)++n_seen == 0) src = (int)i;
+        }
+        int16_t gx, gy;
+        if (src >= 0) {
+            gx = (int16_t)(c[src].x >= 0 ? 2 * r->wall_mm - c[src].x : -2 * r->wall_mm - c[src].x);
+            gy = c[src].y;
+        }
+        if (src < 0 || !in_view(gx, gy)) {
+            gy = (int16_t)(800 + rnd(&s->rng) % 4700);
+            int16_t w = (int16_t)(gy * 7 / 5 < 2400 ? gy * 7 / 5 : 2400);
+            gx = (int16_t)((int32_t)(rnd(&s->rng) % (uint32_t)(2 * w + 1)) - w);
+        }
+        s->ghost_x_mm = gx;
+        s->ghost_y_mm = gy;
+        s->ghost_until = t + burst_ms(s, r->ghost_ms);
+        ghost_on = true;
+    }
+    int8_t ghost_slot = -1;
+    if (ghost_on) {
+        for (int k = 0; k < LD2450_SCENE_SLOTS; k++) {
+            if (s->slot_owner[k] == LD2450_SCENE_GHOST_ID) ghost_slot = (int8_t)k;
+        }
+        for (int k = 0; ghost_slot < 0 && k < LD2450_SCENE_SLOTS; k++) {
+            if (!s->slot_owner[k]) {
+                s->slot_owner[k] = LD2450_SCENE_GHOST_ID;
+                ghost_slot = (int8_t)k;
+            }
+        }
+    }
+
+    /* The frame, with jitter growing with range */
+    memset(out, 0, LD2450_SCENE_FRAME_LEN);
+    out[0] = 0xAA; out[1] = 0xFF; out[2] = 0x03; out[3] = 0x00;
+    out[28] = 0x55; out[29] = 0xCC;
+    for (size_t i = 0; i < s->n_people; i++) {
+        if (slot_of[i] < 0) continue;
+        double sigma = r->jitter_mm * (0.5 + c[i].range / LD2450_SCENE_RANGE_MM);
+        int16_t x = clamp16(c[i].x + sigma * gauss(s), -LD2450_SCENE_RANGE_MM, LD2450_SCENE_RANGE_MM);
+        int16_t y = clamp16(c[i].y + sigma * gauss(s), 0, LD2450_SCENE_RANGE_MM);
+        uint8_t *o = &out[4 + 8 * slot_of[i]];
+        put_u16(o + 0, enc_signed(x));
+        put_u16(o + 2, (uint16_t)(0x8000 + y));
+        put_u16(o + 4, enc_signed(c[i].speed));
+        put_u16(o + 6, 360);
+    }
+    if (ghost_slot >= 0) {
+        double sigma = 2.0 * r->jitter_mm;
+        int16_t x = clamp16(s->ghost_x_mm + sigma * gauss(s), -LD2450_SCENE_RANGE_MM, LD2450_SCENE_RANGE_MM);
+        int16_t y = clamp16(s->ghost_y_mm + sigma * gauss(s), 0, LD2450_SCENE_RANGE_MM);
+        uint8_t *o = &out[4 + 8 * ghost_slot];
+        put_u16(o + 0, enc_signed(x));
+        put_u16(o + 2, (uint16_t)(0x8000 + y));
+        put_u16(o + 6, 360);
+        s->stats.ghost_frames++;
+    }
+
+    /* Truth and counters */
+    s->stats.frames++;
+    if (truth) {
+        memset(truth, 0, sizeof(*truth));
+        truth->t_ms = t;
+        truth->ghost_slot = ghost_slot;
+        if (ghost_slot >= 0) {
+            truth->ghost_x_mm = s->ghost_x_mm;
+            truth->ghost_y_mm = s->ghost_y_mm;
+        }
+    }
+    for (size_t i = 0; i < s->n_people; i++) {
+        if (!c[i].present) continue;
+        uint32_t *count[] = { &s->stats.seen, &s->stats.occluded, &s->stats.lost,
+                              &s->stats.capped, &s->stats.out_of_view };
+        (*count[state[i]])++;
+        if (!truth) continue;
+        ld2450_scene_truth_person_t *p = &truth->person[truth->n++];
+        p->id = s->people[i].id;
+        p->x_mm = c[i].x;
+        p->y_mm = c[i].y;
+        p->state = state[i];
+        p->slot = slot_of[i];
+    }
+}
+
+/* ---- Random scenes ---- */
+
+static void random_point(uint32_t *rng, int16_t *x, int16_t *y)
+{
+    *y = (int16_t)(800 + rnd(rng) % 4700);
+    int16_t w = (int16_t)(*y * 7 / 5 < 2400 ? *y * 7 / 5 : 2400);   /* inside +-54 degrees */
+    *x = (int16_t)((int32_t)(rnd(rng) % (uint32_t)(2 * w + 1)) - w);
+}
+
+size_t ld2450_scene_random(ld2450_scene_person_t *out, size_t n, uint32_t duration_ms, uint32_t seed)
+{
+    uint32_t rng = seed ? seed : 1;
+    if (n > LD2450_SCENE_PEOPLE_MAX) n = LD2450_SCENE_PEOPLE_MAX;
+
+    for (size_t i = 0; i < n; i++) {
+        ld2450_scene_person_t *p = &out[i];
+        memset(p, 0, sizeof(*p));
+        p->id = (uint8_t)(i + 1);
+        p->enter_ms = duration_ms > 3 ? rnd(&rng) % (duration_ms * 2 / 3) / 100 * 100 : 0;
+        p->speed_mm_s = (uint16_t)(600 + rnd(&rng) % 801);
+        p->n_wp = (uint8_t)(2 + rnd(&rng) % 4);
+        for (uint8_t k = 0; k < p->n_wp; k++) {
+            random_point(&rng, &p->wp[k].x_mm, &p->wp[k].y_mm);
+            bool last = k + 1 == p->n_wp;
+            bool sit = rnd(&rng) % 100 < 40;
+            p->wp[k].dwell_ms = last ? 0 : sit ? 5000 + rnd(&rng) % 15001 : rnd(&rng) % 1001;
+        }
+    }
+    return n;
+}
+
+/* ---- Presets ----
+ * The room of tools/host_test/test_pipeline_sim.c: door at (-2000, 5000),
+ * desk zone round (-750, 1750), sofa zone round (1500, 3750). */
+
+typedef struct {
+    const char *name;
+    const char *desc;
+    const ld2450_scene_person_t *people;
+    uint8_t  n;
+    uint8_t  random_n;          /* > 0: ld2450_scene_random() with this many people */
+    uint32_t random_ms;
+    uint16_t jitter_mm;
+    uint8_t  still_drop_pct;
+    uint8_t  ghost_pct;
+} preset_t;
+
+static const ld2450_scene_person_t k_walk[] = {
+    { 1, 1000, 1000, 4, {
+        { -2000, 5000,     0 },
+        {  -750, 1750, 12000 },
+        {  -800, 2200,  1000 },
+        { -2000, 5000,     0 } } },
+};
+
+static const ld2450_scene_person_t k_sit[] = {
+    { 1,  500, 900, 3, { { -2000, 5000, 0 }, {  -750, 1750, 40000 }, { -2000, 5000, 0 } } },
+    { 2, 3000, 900, 3, { { -2000, 5000, 0 }, {  1500, 3750, 35000 }, { -2000, 5000, 0 } } },
+};
+
+static const ld2450_scene_person_t k_cross[] = {
+    { 1, 1000, 1200, 4, { { -2000, 2000, 0 }, { 2000, 4000, 500 }, { -2000, 4000, 500 }, { 2000, 1500, 0 } } },
+    { 2, 2000, 1000, 4, { {  2000, 2000, 0 }, { -1500, 1500, 500 }, { 1500, 4500, 500 }, { -2000, 5000, 0 } } },
+};
+
+/* Someone stands at 1.5 m; someone else walks along the back wall behind them */
+static const ld2450_scene_person_t k_occlude[] = {
+    { 1,  500, 800, 2, { {     0, 1500, 20000 }, { -2000, 5000, 0 } } },
+    { 2, 2000, 800, 3, { { -2200, 4500, 1000 }, {  2200, 4500, 1000 }, { -2200, 4500, 0 } } },
+};
+
+/* Walking close to the right-hand wall, where reflections are strongest */
+static const ld2450_scene_person_t k_ghosts[] = {
+    { 1, 1000, 700, 4, { { 2000, 1000, 0 }, { 2000, 4500, 3000 }, { 2000, 1500, 3000 }, { 2000, 4000, 0 } } },
+};
+
+#define PEOPLE(p)  (p), (uint8_t)(sizeof(p) / sizeof((p)[0]))
+
+static const preset_t k_presets[] = {
+    { "walk",    "in at the door, 12 s at the desk, out again",
+      PEOPLE(k_walk),    0, 0,     40, 2,  0 },
+    { "sit",     "two people sitting still for 35-40 s, frequent dropouts",
+      PEOPLE(k_sit),     0, 0,     30, 6,  0 },
+    { "cross",   "two people crossing zone boundaries and each other's paths",
+      PEOPLE(k_cross),   0, 0,     40, 2,  0 },
+    { "occlude", "a walker passing behind someone standing still",
+      PEOPLE(k_occlude), 0, 0,     40, 2,  0 },
+    { "ghosts",  "a walker along the side wall with multipath ghosts",
+      PEOPLE(k_ghosts),  0, 0,     40, 2,  8 },
+    { "crowd",   "six people coming and going over a minute, more than 3 at once",
+      NULL, 0,           6, 60000, 50, 3,  3 },
+};
+
+#define PRESET_COUNT (sizeof(k_presets) / sizeof(k_presets[0]))
+
+size_t ld2450_scene_preset(const char *name, ld2450_scene_person_t *people,
+                           ld2450_scene_radar_t *radar)
+{
+    for (size_t i = 0; i < PRESET_COUNT; i++) {
+        const preset_t *p = &k_presets[i];
+        if (strcmp(p->name, name) != 0) continue;
+
+        ld2450_scene_default_radar(radar);
+        radar->jitter_mm = p->jitter_mm;
+        radar->still_drop_pct = p->still_drop_pct;
+        radar->ghost_pct = p->ghost_pct;
+        radar->seed = 2450;
+        if (p->random_n) return ld2450_scene_random(people, p->random_n, p->random_ms, 2450);
+        memcpy(people, p->people, p->n * sizeof(*people));
+        return p->n;
+    }
+    return 0;
+}
+
+const char *ld2450_scene_preset_name(size_t i, const char **desc)
+{
+    if (i >= PRESET_COUNT) return NULL;
+    if (desc) *desc = k_presets[i].desc;
+    return k_presets[i].name;
+}
+
+/* ---- Truth text ---- */
+
+static const char k_state_tag[] = "?olcv";      /* SEEN is the slot digit */
+
+int ld2450_scene_truth_format(const ld2450_scene_truth_t *t, char *buf, size_t len)
+{
+    size_t o = 0;
+    int n = snprintf(buf, len, "%u", t->t_ms);
+    if (n < 0 || (size_t)n >= len) return -1;
+    o = (size_t)n;
+
+    for (uint8_t i = 0; i < t->n; i++) {
+        const ld2450_scene_truth_person_t *p = &t->person[i];
+        char tag = p->state == LD2450_SCENE_SEEN ? (char)('0' + p->slot) : k_state_tag[p->state];
+        n = snprintf(buf + o, len - o, " %u:%d,%d:%c", p->id, p->x_mm, p->y_mm, tag);
+        if (n < 0 || (size_t)n >= len - o) return -1;
+        o += (size_t)n;
+    }
+    if (t->ghost_slot >= 0) {
+        n = snprintf(buf + o, len - o, " g:%d,%d:%d", t->ghost_x_mm, t->ghost_y_mm, t->ghost_slot);
+        if (n < 0 || (size_t)n >= len - o) return -1;
+        o += (size_t)n;
+    }
+    return (int)o;
+}
+
+bool ld2450_scene_truth_parse(const char *line, ld2450_scene_truth_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->ghost_slot = -1;
+
+    char *end;
+    t->t_ms = (uint32_t)strtoul(line, &end, 10);
+    if (end == line) return false;
+
+    const char *p = end;
+    for (;;) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p || *p == '\n' || *p == '\r') return true;
+
+        int x, y, used = 0;
+        if (p[0] == 'g') {
+            int slot;
+            if (sscanf(p, "g:%d,%d:%d%n", &x, &y, &slot, &used) != 3 || slot < 0 || slot >= LD2450_SCENE_SLOTS) {
+                return false;
+            }
+            t->ghost_slot = (int8_t)slot;
+            t->ghost_x_mm = (int16_t)x;
+            t->ghost_y_mm = (int16_t)y;
+        } else {
+            unsigned id;
+            char tag;
+            if (sscanf(p, "%u:%d,%d:%c%n", &id, &x, &y, &tag, &used) != 4 ||
+                t->n >= LD2450_SCENE_PEOPLE_MAX) {
+                return false;
+            }
+            ld2450_scene_truth_person_t *q = &t->person[t->n++];
+            q->id = (uint8_t)id;
+            q->x_mm = (int16_t)x;
+            q->y_mm = (int16_t)y;
+            q->slot = -1;
+            if (tag >= '0' && tag < '0' + LD2450_SCENE_SLOTS) {
+                q->state = LD2450_SCENE_SEEN;
+                q->slot = (int8_t)(tag - '0');
+            } else {
+                const char *s = strchr(k_state_tag + 1, tag);
+                if (!s || !tag) return false;
+                q->state = (uint8_t)(s - k_state_tag);
+            }
+        }
+        p += used;
+    }
+}
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Synthetic LD2450 scenes: people moving through a room, as the radar
+ * would report them.
+ *
+ * Pure C, no OS dependencies and no clock of its own, like ld2450_emu.
+ * ld2450_scene_gen.c writes scenes to files (sensor bytes + ground truth),
+ * tools/host_test/test_ld2450_scene.c scores the parser and zone engine
+ * against the truth, and tools/host_test/test_pipeline_sim.c plays scenes
+ * into the firmware.
+ *
+ * The sensor sits at the origin looking along +y; x is across the room.
+ * Each person follows waypoints: they appear at the first one, stay for
+ * its dwell time (sitting or standing), walk to the next at their speed,
+ * and so on; after the last dwell they are gone.
+ *
+ * Every 100 ms ld2450_scene_frame() produces one 30-byte data frame, in
+ * the encoding ld2450_parser_feed() decodes, and the ground truth for it.
+ * Between the people and the frame sits a radar model, seeded so a run is
+ * reproducible:
+ *   - position jitter, Gaussian, growing with range
+ *   - field of view: 6 m, +-60 degrees
+ *   - occlusion: a person in the radio shadow of a nearer one is not seen
+ *   - dropouts: a still person is lost now and then, for a few frames
+ *   - the 3-target limit: the nearest three are reported
+ *   - ghosts: multipath reflections, mirrored off a side wall, for a
+ *     burst of frames
+ *   - slots: a person keeps their slot while seen, as on the module
+ */
+
+#define LD2450_SCENE_FRAME_MS     100
+#define LD2450_SCENE_FRAME_LEN    30
+#define LD2450_SCENE_SLOTS        3
+#define LD2450_SCENE_PEOPLE_MAX   8
+#define LD2450_SCENE_WP_MAX       8
+#define LD2450_SCENE_RANGE_MM     6000
+#define LD2450_SCENE_FOV_DEG      60
+#define LD2450_SCENE_GHOST_ID     0xFF
+
+typedef struct {
+    int16_t  x_mm, y_mm;
+    uint32_t dwell_ms;          /* time spent here before moving on */
+} ld2450_scene_wp_t;
+
+typedef struct {
+    uint8_t  id;                /* 1-254, shown in the truth */
+    uint32_t enter_ms;          /* appears at wp[0] */
+    uint16_t speed_mm_s;        /* walking speed between waypoints */
+    uint8_t  n_wp;
+    ld2450_scene_wp_t wp[LD2450_SCENE_WP_MAX];
+} ld2450_scene_person_t;
+
+typedef struct {
+    uint16_t jitter_mm;         /* position noise (1 sigma) at 3 m; half at the sensor, 1.5x at 6 m */
+    uint16_t body_mm;           /* shadow width of a person, 0 = no occlusion */
+    uint8_t  still_drop_pct;    /* chance per frame that a still person is lost ... */
+    uint16_t still_drop_ms;     /* ... for 100 ms up to this long */
+    uint8_t  ghost_pct;         /* chance per frame that a ghost burst starts */
+    uint16_t ghost_ms;          /* ... lasting 100 ms up to this long */
+    uint16_t wall_mm;           /* side walls at x = +-wall_mm (ghost mirror) */
+    uint32_t seed;              /* PRNG seed, 0 = 1 */
+} ld2450_scene_radar_t;
+
+/* What happened to a person in one frame */
+typedef enum {
+    LD2450_SCENE_SEEN = 0,      /* reported, in slot */
+    LD2450_SCENE_OCCLUDED,      /* behind a nearer person */
+    LD2450_SCENE_LOST,          /* still-target dropout */
+    LD2450_SCENE_CAPPED,        /* a fourth target or more */
+    LD2450_SCENE_OUT_OF_VIEW,   /* beyond range or angle */
+} ld2450_scene_state_t;
+
+typedef struct {
+    uint8_t  id;
+    int16_t  x_mm, y_mm;        /* true position */
+    uint8_t  state;             /* ld2450_scene_state_t */
+    int8_t   slot;              /* SEEN: 0-2, else -1 */
+} ld2450_scene_truth_person_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t  n;                 /* people in the room */
+    ld2450_scene_truth_person_t person[LD2450_SCENE_PEOPLE_MAX];
+    int8_t   ghost_slot;        /* -1 = no ghost this frame */
+    int16_t  ghost_x_mm, ghost_y_mm;
+} ld2450_scene_truth_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t seen;              /* person-frames by state */
+    uint32_t occluded;
+    uint32_t lost;
+    uint32_t capped;
+    uint32_t out_of_view;
+    uint32_t ghost_frames;
+} ld2450_scene_stats_t;
+
+typedef struct {
+    const ld2450_scene_person_t *people;
+    size_t   n_people;
+    ld2450_scene_radar_t radar;
+    ld2450_scene_stats_t stats;
+
+    uint32_t rng;
+    uint32_t next_ms;           /* time of the next frame */
+    uint8_t  slot_owner[LD2450_SCENE_SLOTS];    /* person id, GHOST_ID, 0 = free */
+    uint32_t lost_until[LD2450_SCENE_PEOPLE_MAX];
+    uint32_t ghost_until;
+    int16_t  ghost_x_mm, ghost_y_mm;
+} ld2450_scene_t;
+
+/** Defaults: 40 mm jitter, 500 mm bodies, 2 %/800 ms still dropouts, no ghosts, 2.5 m walls. */
+void ld2450_scene_default_radar(ld2450_scene_radar_t *r);
+
+/** Start a scene at t = 0.  radar NULL = defaults.  people must outlive the scene. */
+void ld2450_scene_init(ld2450_scene_t *s, const ld2450_scene_person_t *people, size_t n,
+                       const ld2450_scene_radar_t *radar);
+
+/**
+ * Produce the next frame (at s->next_ms, then 100 ms later, ...) and its
+ * truth (NULL if not wanted).  Frames must be taken in order.
+ */
+void ld2450_scene_frame(ld2450_scene_t *s, uint8_t out[LD2450_SCENE_FRAME_LEN],
+                        ld2450_scene_truth_t *truth);
+
+/** Where a person is at t_ms, before the radar.  False if not in the room. */
+bool ld2450_scene_person_at(const ld2450_scene_person_t *p, uint32_t t_ms,
+                            int16_t *x_mm, int16_t *y_mm, bool *moving);
+
+/** When the last person leaves. */
+uint32_t ld2450_scene_end_ms(const ld2450_scene_person_t *people, size_t n);
+
+/**
+ * n people (at most LD2450_SCENE_PEOPLE_MAX) coming and going at random
+ * over duration_ms: each walks 2-5 waypoints in view, sitting a while at
+ * some of them.  Reproducible for a seed.  Returns the number made.
+ */
+size_t ld2450_scene_random(ld2450_scene_person_t *out, size_t n, uint32_t duration_ms, uint32_t seed);
+
+/**
+ * Built-in scenes, by name (see ld2450_scene.c).  Fills people (room for
+ * LD2450_SCENE_PEOPLE_MAX) and radar; returns the number of people, or 0
+ * for an unknown name.
+ */
+size_t ld2450_scene_preset(const char *name, ld2450_scene_person_t *people,
+                           ld2450_scene_radar_t *radar);
+
+/** Name of preset i, NULL past the last.  desc (optional) gets a one-line description. */
+const char *ld2450_scene_preset_name(size_t i, const char **desc);
+
+/*
+ * Ground truth as text, one line per frame:
+ *   t_ms [id:x,y:S]... [g:x,y:slot]
+ * S is the slot (0-2) of a person seen, or o (occluded), l (lost),
+ * c (capped), v (out of view); g is a ghost.  '#' lines are comments.
+ */
+
+/** Format one truth line (without newline).  Returns the length, or -1 if it does not fit. */
+int ld2450_scene_truth_format(const ld2450_scene_truth_t *t, char *buf, size_t len);
+
+/** Parse one truth line.  False on a malformed line. */
+bool ld2450_scene_truth_parse(const char *line, ld2450_scene_truth_t *t);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+//
+// Synthetic LD2450 scenes to files: the sensor byte stream and its ground
+// truth.
+//
+// Build: gcc -O2 -std=c11 -Wall -Wextra -Itools/ld2450_scene tools/ld2450_scene/ld2450_scene.c
+//            tools/ld2450_scene/ld2450_scene_gen.c -lm -o /tmp/ld2450_scene_gen
+// Run:   /tmp/ld2450_scene_gen -p crowd -o crowd.bin -T crowd.txt
+//
+// The stream is 30-byte data frames back to back, one per 100 ms, as
+// captured off the UART: ld2450_parser_feed() takes it as it is, and
+// test_pipeline_sim plays it with -r (and scores against it with -T).
+// The truth file has one line per frame (format in ld2450_scene.h).
+//
+// Options:
+//   -p, --preset NAME     built-in scene (-l lists them)
+//   -n, --people N        N people at random instead (1-8)
+//   -t, --duration MS     length (default: until the last person leaves; 60000 with -n)
+//       --seed N          radar seed, and the scene's with -n
+//       --jitter MM       position noise at 3 m
+//       --loss PCT        still-target dropout chance per frame
+//       --ghost PCT       ghost burst chance per frame
+//       --no-occlusion    people do not hide each other
+//   -o, --out FILE        byte stream ("-" = stdout)
+//   -T, --truth FILE      ground truth ("-" = stdout)
+//   -l, --list            list the presets
+//   -v                    counters on stderr
+#define _DEFAULT_SOURCE
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ld2450_scene.h"
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s (-p preset | -n people) [-t ms] [--seed n] [--jitter mm] [--loss pct]\n"
+            "          [--ghost pct] [--no-occlusion] [-o stream] [-T truth] [-l] [-v]\n", argv0);
+}
+
+static FILE *open_out(const char *path, const char *mode)
+{
+    if (strcmp(path, "-") == 0) return stdout;
+    FILE *f = fopen(path, mode);
+    if (!f) perror(path);
+    return f;
+}
+
+int main(int argc, char **argv)
+{
+    const char *preset = NULL, *out_path = NULL, *truth_path = NULL;
+    long n_random = 0, duration = -1, seed = -1, jitter = -1, loss = -1, ghost = -1;
+    bool no_occlusion = false;
+    int verbose = 0;
+
+    static const struct option opts[] = {
+        {"preset",       required_argument, 0, 'p'},
+        {"people",       required_argument, 0, 'n'},
+        {"duration",     required_argument, 0, 't'},
+        {"seed",         required_argument, 0, 'R'},
+        {"jitter",       required_argument, 0, 'j'},
+        {"loss",         required_argument, 0, 'L'},
+        {"ghost",        required_argument, 0, 'g'},
+        {"no-occlusion", no_argument,       0, 'O'},
+        {"out",          required_argument, 0, 'o'},
+        {"truth",        required_argument, 0, 'T'},
+        {"list",         no_argument,       0, 'l'},
+        {0, 0, 0, 0},
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "p:n:t:o:T:lv", opts, NULL)) != -1) {
+        switch (c) {
+        case 'p': preset = optarg; break;
+        case 'n': n_random = strtol(optarg, NULL, 0); break;
+        case 't': duration = strtol(optarg, NULL, 0); break;
+        case 'R': seed = strtol(optarg, NULL, 0); break;
+        case 'j': jitter = strtol(optarg, NULL, 0); break;
+        case 'L': loss = strtol(optarg, NULL, 0); break;
+        case 'g': ghost = strtol(optarg, NULL, 0); break;
+        case 'O': no_occlusion = true; break;
+        case 'o': out_path = optarg; break;
+        case 'T': truth_path = optarg; break;
+        case 'l': {
+            const char *name, *desc;
+            for (size_t i = 0; (name = ld2450_scene_preset_name(i, &desc)) != NULL; i++) {
+                printf("%-10s %s\n", name, desc);
+            }
+            return 0;
+        }
+        case 'v': verbose = 1; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (!preset == !n_random || n_random < 0 || n_random > LD2450_SCENE_PEOPLE_MAX ||
+        (!out_path && !truth_path)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    ld2450_scene_person_t people[LD2450_SCENE_PEOPLE_MAX];
+    ld2450_scene_radar_t radar;
+    size_t n;
+    if (preset) {
+        n = ld2450_scene_preset(preset, people, &radar);
+        if (!n) {
+            fprintf(stderr, "unknown preset '%s' (-l lists them)\n", preset);
+            return 2;
+        }
+    } else {
+        ld2450_scene_default_radar(&radar);
+        if (duration < 0) duration = 60000;
+        n = ld2450_scene_random(people, (size_t)n_random, (uint32_t)duration,
+                                seed >= 0 ? (uint32_t)seed : 1);
+    }
+    if (seed >= 0)   radar.seed = (uint32_t)seed;
+    if (jitter >= 0) radar.jitter_mm = (uint16_t)jitter;
+    if (loss >= 0)   radar.still_drop_pct = (uint8_t)loss;
+    if (ghost >= 0)  radar.ghost_pct = (uint8_t)ghost;
+    if (no_occlusion) radar.body_mm = 0;
+    if (duration < 0) duration = ld2450_scene_end_ms(people, n) + 2000;
+
+    FILE *out = out_path ? open_out(out_path, "wb") : NULL;
+    FILE *truth = truth_path ? open_out(truth_path, "w") : NULL;
+    if ((out_path && !out) || (truth_path && !truth)) return 1;
+    if (truth) {
+        fprintf(truth, "# %s, %zu people, seed %u, jitter %u mm, loss %u%%, ghosts %u%%%s\n",
+                preset ? preset : "random", n, radar.seed, radar.jitter_mm,
+                radar.still_drop_pct, radar.ghost_pct, radar.body_mm ? "" : ", no occlusion");
+    }
+
+    ld2450_scene_t s;
+    ld2450_scene_init(&s, people, n, &radar);
+    while (s.next_ms < (uint32_t)duration) {
+        uint8_t frame[LD2450_SCENE_FRAME_LEN];
+        ld2450_scene_truth_t t;
+        ld2450_scene_frame(&s, frame, &t);
+        if (out && fwrite(frame, 1, sizeof(frame), out) != sizeof(frame)) {
+            perror(out_path);
+            return 1;
+        }
+        if (truth) {
+            char line[512];
+            if (ld2450_scene_truth_format(&t, line, sizeof(line)) > 0) fprintf(truth, "%s\n", line);
+        }
+    }
+    if (out && out != stdout) fclose(out);
+    if (truth && truth != stdout) fclose(truth);
+
+    if (verbose) {
+        const ld2450_scene_stats_t *st = &s.stats;
+        fprintf(stderr, "frames %u, person-frames: seen %u, occluded %u, lost %u, capped %u, "
+                "out of view %u; ghost frames %u\n", st->frames, st->seen, st->occluded,
+                st->lost, st->capped, st->out_of_view, st->ghost_frames);
+    }
+    return 0;
+}
@@ -0,0 +1,497 @@
+// SPDX-License-Identifier: MIT
+//
+// ld2450d: the ld2450 component as a Linux daemon.
+//
+// Build: make -C tools/ld2450d
+// Run:   tools/ld2450d/ld2450d [-d /dev/ttyUSB0] [-s /tmp/ld2450d.sock] [options]
+//
+// Reads an LD2450 on a serial device (a USB adapter, or the emulator's pty
+// from tools/ld2450_emu) with the firmware's own UART task, parser, zone
+// evaluation and command worker, built on tools/posix_port.  State is
+// served on a unix socket as JSON lines; a client sends one command per
+// line and gets one line back, and while watching also gets a "state" line
+// whenever targets or zones change and a "done" line when a sensor command
+// it queued finishes.
+//
+// Commands:
+//   state | stats | info | zones          one line of the current values
+//   watch on|off                           state lines on change (default on)
+//   zone N x1,y1,x2,y2,...  | zone N off   set or clear zone N (1-10), mm
+//   single | multi | bt on|off             sensor settings, via the worker
+//   range MAX_MM LEFT_DEG RIGHT_DEG        distance/angle hardware filter
+//   query | restart                        read back / restart the sensor
+//
+// Options:
+//   -d, --device PATH     serial device (default /dev/ttyUSB0)
+//   -b, --baud N          (default 256000)
+//   -s, --socket PATH     (default /tmp/ld2450d.sock)
+//   -z, --zone N:CSV      zone N from "x1,y1,x2,y2,..." (repeatable)
+//       --query           read back the sensor once it is streaming
+//   -v                    debug log; -q warnings only
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ld2450.h"
+#include "ld2450_cmd.h"
+#include "ld2450_cmd_worker.h"
+#include "ld2450_zone_csv.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define CLIENTS_MAX     8
+#define LINE_MAX_LEN    512
+#define ZONES           10
+#define POLL_MS         50      /* state checks: twice per sensor frame */
+
+static const char *TAG = "ld2450d";
+
+typedef struct {
+    int    fd;              /* -1 = free */
+    bool   watch;
+    size_t in_len;
+    char   in[LINE_MAX_LEN];
+} client_t;
+
+static client_t s_clients[CLIENTS_MAX];
+static volatile sig_atomic_t s_stop = 0;
+static int s_done_pipe[2] = { -1, -1 };     /* worker -> main loop */
+
+typedef struct {
+    uint32_t  ticket;
+    uint8_t   op;
+    esp_err_t err;
+} done_msg_t;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    s_stop = 1;
+}
+
+/* ---- Output ---- */
+
+static void client_close(client_t *c)
+{
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+}
+
+/* A client that cannot take a whole line right away is too slow: drop it
+ * rather than stall the loop or send it half a line */
+static void client_send(client_t *c, const char *line, size_t len)
+{
+    if (c->fd < 0) return;
+    ssize_t n = send(c->fd, line, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n != (ssize_t)len) {
+        ESP_LOGW(TAG, "client %d dropped (%s)", c->fd, n < 0 ? strerror(errno) : "short write");
+        client_close(c);
+    }
+}
+
+typedef struct {
+    char   buf[1024];
+    size_t len;
+} line_t;
+
+__attribute__((format(printf, 2, 3)))
+static void out(line_t *l, const char *fmt, ...)
+{
+    if (l->len >= sizeof(l->buf)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(l->buf + l->len, sizeof(l->buf) - l->len, fmt, ap);
+    va_end(ap);
+    if (n > 0) l->len += (size_t)n;
+    if (l->len > sizeof(l->buf) - 2) l->len = sizeof(l->buf) - 2;     /* room for the newline */
+}
+
+static void line_end(line_t *l)
+{
+    l->buf[l->len++] = '\n';
+}
+
+static void broadcast(const line_t *l)
+{
+    for (int i = 0; i < CLIENTS_MAX; i++) {
+        if (s_clients[i].fd >= 0 && s_clients[i].watch) client_send(&s_clients[i], l->buf, l->len);
+    }
+}
+
+/* ---- JSON lines ---- */
+
+static void fmt_state(line_t *l, const ld2450_state_t *st)
+{
+    out(l, "{\"type\":\"state\",\"t_ms\":%lld,\"occupied\":%s,\"count\":%u,\"targets\":[",
+        (long long)(esp_timer_get_time() / 1000), st->occupied_global ? "true" : "false",
+        st->target_count_effective);
+    for (int i = 0; i < 3; i++) {
+        const ld2450_target_t *t = &st->targets[i];
+        if (t->present) out(l, "%s{\"x\":%d,\"y\":%d,\"speed\":%d}", i ? "," : "", t->x_mm, t->y_mm, t->speed);
+        else            out(l, "%snull", i ? "," : "");
+    }
+    out(l, "],\"zones\":[");
+    for (int z = 0; z < ZONES; z++) out(l, "%s%d", z ? "," : "", st->zone_occupied[z] ? 1 : 0);
+    out(l, "]}");
+    line_end(l);
+}
+
+static void fmt_stats(line_t *l)
+{
+    ld2450_rx_stats_t rx;
+    ld2450_get_rx_stats(&rx, false);
+    ld2450_cmd_status_t cs;
+    ld2450_cmd_worker_get_status(&cs);
+    out(l, "{\"type\":\"stats\",\"rx\":{\"bytes\":%u,\"frames\":%u,\"garbage_bytes\":%u,"
+        "\"bad_frames\":%u,\"pauses\":%u,\"paused\":%s,\"last_frame_ms\":%u,\"gap_max_ms\":%u},",
+        rx.bytes, rx.frames, rx.garbage_bytes, rx.bad_frames, rx.pauses,
+        rx.paused ? "true" : "false", rx.last_frame_ms, rx.gap_max_ms);
+    out(l, "\"cmd\":{\"state\":\"%s\",\"pending\":%u,\"last_op\":\"%s\",\"last_err\":\"%s\","
+        "\"last_ms\":%u,\"submitted\":%u,\"completed\":%u,\"failed\":%u,\"rejected\":%u}}",
+        cs.state == LD2450_CMD_STATE_BUSY ? "busy" : cs.state == LD2450_CMD_STATE_FAILED ? "failed" : "idle",
+        cs.pending, ld2450_cmd_op_name(cs.last_op), esp_err_to_name(cs.last_err), cs.last_ms,
+        cs.submitted, cs.completed, cs.failed, cs.rejected);
+    line_end(l);
+}
+
+static void fmt_info(line_t *l)
+{
+    ld2450_sensor_info_t in;
+    ld2450_cmd_get_sensor_info(&in);
+    out(l, "{\"type\":\"info\"");
+    if (in.fw_valid) {
+        out(l, ",\"fw\":\"V%u.%02X.%08X\"", (unsigned)(in.fw_major >> 8), (unsigned)(in.fw_major & 0xFF),
+            (unsigned)in.fw_minor);
+    }
+    if (in.mac_valid) {
+        out(l, ",\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\"",
+            in.mac[0], in.mac[1], in.mac[2], in.mac[3], in.mac[4], in.mac[5]);
+    }
+    if (in.tracking >= 0) out(l, ",\"tracking\":\"%s\"", in.tracking ? "single" : "multi");
+    if (in.bluetooth >= 0) out(l, ",\"bluetooth\":%s", in.bluetooth ? "true" : "false");
+    if (in.region_valid) {
+        out(l, ",\"zone_type\":%u,\"filter\":[", in.zone_type);
+        for (int i = 0; i < 3; i++) {
+            out(l, "%s[%d,%d,%d,%d]", i ? "," : "", in.zone[i][0], in.zone[i][1], in.zone[i][2], in.zone[i][3]);
+        }
+        out(l, "]");
+    }
+    out(l, ",\"sessions\":%u,\"skipped\":%u,\"drift\":%u}", in.sessions, in.skipped, in.drift);
+    line_end(l);
+}
+
+static void fmt_zones(line_t *l)
+{
+    ld2450_zone_t zones[ZONES];
+    ld2450_get_zones(zones, ZONES);
+    out(l, "{\"type\":\"zones\",\"zones\":[");
+    for (int z = 0; z < ZONES; z++) {
+        char csv[160];
+        zone_to_csv(&zones[z], csv, sizeof(csv));
+        out(l, "%s\"%s\"", z ? "," : "", csv);
+    }
+    out(l, "]}");
+    line_end(l);
+}
+
+static void fmt_error(line_t *l, const char *msg)
+{
+    out(l, "{\"type\":\"error\",\"msg\":\"%s\"}", msg);
+    line_end(l);
+}
+
+/* ---- Commands ---- */
+
+static void on_done(uint32_t ticket, esp_err_t err, void *arg)
+{
+    done_msg_t m = { .ticket = ticket, .op = (uint8_t)(uintptr_t)arg, .err = err };
+    if (write(s_done_pipe[1], &m, sizeof(m)) != (ssize_t)sizeof(m)) {
+        ESP_LOGW(TAG, "#%u done notice lost", (unsigned)ticket);
+    }
+}
+
+static void submit(line_t *l, const ld2450_cmd_req_t *req)
+{
+    uint32_t ticket = 0;
+    esp_err_t err = ld2450_cmd_submit(req, on_done, (void *)(uintptr_t)req->op, &ticket);
+    if (err != ESP_OK) {
+        fmt_error(l, esp_err_to_name(err));
+        return;
+    }
+    out(l, "{\"type\":\"queued\",\"ticket\":%u,\"op\":\"%s\"}", ticket, ld2450_cmd_op_name(req->op));
+    line_end(l);
+}
+
+static esp_err_t set_zone_csv(int n, const char *csv)
+{
+    if (n < 1 || n > ZONES) return ESP_ERR_INVALID_ARG;
+    ld2450_zone_t z = { .vertex_count = 0 };
+    if (strcmp(csv, "off") != 0) {
+        int pairs = csv_count_pairs(csv);
+        if (pairs < 3 || pairs > MAX_ZONE_VERTICES) return ESP_ERR_INVALID_ARG;
+        z.vertex_count = (uint8_t)pairs;
+        if (!csv_to_zone(csv, &z)) return ESP_ERR_INVALID_ARG;
+    }
+    return ld2450_set_zone((size_t)(n - 1), &z);
+}
+
+static void handle_line(client_t *c, char *cmd)
+{
+    line_t l = { .len = 0 };
+    char *arg = strchr(cmd, ' ');
+    if (arg) *arg++ = '\0';
+    ld2450_cmd_req_t req = { 0 };
+
+    if (strcmp(cmd, "state") == 0) {
+        ld2450_state_t st;
+        ld2450_get_state(&st);
+        fmt_state(&l, &st);
+    } else if (strcmp(cmd, "stats") == 0) {
+        fmt_stats(&l);
+    } else if (strcmp(cmd, "info") == 0) {
+        fmt_info(&l);
+    } else if (strcmp(cmd, "zones") == 0) {
+        fmt_zones(&l);
+    } else if (strcmp(cmd, "watch") == 0 && arg) {
+        c->watch = strcmp(arg, "on") == 0;
+        out(&l, "{\"type\":\"ok\"}\n");
+    } else if (strcmp(cmd, "zone") == 0 && arg) {
+        char *csv = strchr(arg, ' ');
+        esp_err_t err = csv ? set_zone_csv(atoi(arg), csv + 1) : ESP_ERR_INVALID_ARG;
+        if (err == ESP_OK) out(&l, "{\"type\":\"ok\"}\n");
+        else               fmt_error(&l, esp_err_to_name(err));
+    } else if (strcmp(cmd, "single") == 0) {
+        req.op = LD2450_CMD_OP_SINGLE_TARGET;
+        submit(&l, &req);
+    } else if (strcmp(cmd, "multi") == 0) {
+        req.op = LD2450_CMD_OP_MULTI_TARGET;
+        submit(&l, &req);
+    } else if (strcmp(cmd, "bt") == 0 && arg) {
+        req.op = LD2450_CMD_OP_BLUETOOTH;
+        req.u.bt_enable = strcmp(arg, "on") == 0;
+        submit(&l, &req);
+    } else if (strcmp(cmd, "range") == 0 && arg) {
+        unsigned dist, left, right;
+        if (sscanf(arg, "%u %u %u", &dist, &left, &right) != 3 || dist > 6000 || left > 90 || right > 90) {
+            fmt_error(&l, "range MAX_MM LEFT_DEG RIGHT_DEG");
+        } else {
+            req.op = LD2450_CMD_OP_REGION;
+            req.u.region.max_dist_mm = (uint16_t)dist;
+            req.u.region.angle_left_deg = (uint8_t)left;
+            req.u.region.angle_right_deg = (uint8_t)right;
+            submit(&l, &req);
+        }
+    } else if (strcmp(cmd, "query") == 0) {
+        req.op = LD2450_CMD_OP_QUERY;
+        submit(&l, &req);
+    } else if (strcmp(cmd, "restart") == 0) {
+        req.op = LD2450_CMD_OP_RESTART;
+        submit(&l, &req);
+    } else {
+        fmt_error(&l, "unknown command");
+    }
+    client_send(c, l.buf, l.len);
+}
+
+static void client_read(client_t *c)
+{
+    ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        client_close(c);
+        return;
+    }
+    if (n < 0) return;
+    c->in_len += (size_t)n;
+    c->in[c->in_len] = '\0';
+
+    char *start = c->in, *nl;
+    while (c->fd >= 0 && (nl = strchr(start, '\n')) != NULL) {
+        *nl = '\0';
+        if (nl > start && nl[-1] == '\r') nl[-1] = '\0';
+        if (*start) handle_line(c, start);
+        start = nl + 1;
+    }
+    c->in_len -= (size_t)(start - c->in);
+    memmove(c->in, start, c->in_len);
+    if (c->in_len == sizeof(c->in) - 1) {
+        ESP_LOGW(TAG, "client %d: line too long", c->fd);
+        client_close(c);
+    }
+}
+
+static int listen_on(const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s: path too long\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-d device] [-b baud] [-s socket] [-z n:x1,y1,x2,y2,...]... [--query] [-v|-q]\n",
+            argv0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *device = "/dev/ttyUSB0";
+    const char *sock_path = "/tmp/ld2450d.sock";
+    int baud = 256000;
+    bool query = false;
+
+    static const struct option opts[] = {
+        {"device", required_argument, 0, 'd'},
+        {"baud",   required_argument, 0, 'b'},
+        {"socket", required_argument, 0, 's'},
+        {"zone",   required_argument, 0, 'z'},
+        {"query",  no_argument,       0, 'Q'},
+        {0, 0, 0, 0},
+    };
+    /* Zones are applied after init: remember them until then */
+    const char *zone_args[ZONES];
+    int zone_count = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "d:b:s:z:vq", opts, NULL)) != -1) {
+        switch (c) {
+        case 'd': device = optarg; break;
+        case 'b': baud = atoi(optarg); break;
+        case 's': sock_path = optarg; break;
+        case 'z':
+            if (zone_count < ZONES) zone_args[zone_count++] = optarg;
+            break;
+        case 'Q': query = true; break;
+        case 'v': esp_log_level_set("*", ESP_LOG_DEBUG); break;
+        case 'q': esp_log_level_set("*", ESP_LOG_WARN); break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    /* ld2450_init() treats driver errors as fatal, as on the device: check first */
+    if (access(device, R_OK | W_OK) != 0) {
+        fprintf(stderr, "%s: %s\n", device, strerror(errno));
+        return 1;
+    }
+    if (pipe2(s_done_pipe, O_CLOEXEC) != 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    uart_posix_set_device(UART_NUM_1, device);
+    ld2450_config_t cfg = {
+        .uart_num = UART_NUM_1,
+        .tx_gpio = 0,                   /* no pins: the device path stands in */
+        .rx_gpio = 0,
+        .baud_rate = baud,
+        .rx_buf_size = 2048,
+    };
+    if (ld2450_init(&cfg) != ESP_OK || ld2450_cmd_init() != ESP_OK ||
+        ld2450_cmd_worker_start() != ESP_OK) {
+        fprintf(stderr, "ld2450 init failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < zone_count; i++) {
+        char *sep = strchr(zone_args[i], ':');
+        if (!sep || set_zone_csv(atoi(zone_args[i]), sep + 1) != ESP_OK) {
+            fprintf(stderr, "bad zone \"%s\"\n", zone_args[i]);
+            return 2;
+        }
+    }
+
+    int lfd = listen_on(sock_path);
+    if (lfd < 0) return 1;
+    for (int i = 0; i < CLIENTS_MAX; i++) s_clients[i].fd = -1;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    ESP_LOGI(TAG, "%s at %d baud, serving %s", device, baud, sock_path);
+
+    if (query) {
+        if (ld2450_wait_for_first_frame(3000) != ESP_OK) ESP_LOGW(TAG, "no data frame yet");
+        ld2450_cmd_req_t req = { .op = LD2450_CMD_OP_QUERY };
+        ld2450_cmd_submit(&req, NULL, NULL, NULL);
+    }
+
+    ld2450_state_t last = { 0 };
+    while (!s_stop) {
+        struct pollfd pfd[2 + CLIENTS_MAX];
+        int idx[2 + CLIENTS_MAX];
+        int n = 0;
+        pfd[n++] = (struct pollfd){ .fd = lfd, .events = POLLIN };
+        pfd[n++] = (struct pollfd){ .fd = s_done_pipe[0], .events = POLLIN };
+        for (int i = 0; i < CLIENTS_MAX; i++) {
+            if (s_clients[i].fd < 0) continue;
+            idx[n] = i;
+            pfd[n++] = (struct pollfd){ .fd = s_clients[i].fd, .events = POLLIN };
+        }
+        if (poll(pfd, (nfds_t)n, POLL_MS) < 0 && errno != EINTR) break;
+
+        if (pfd[0].revents & POLLIN) {
+            int fd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC);
+            int slot = -1;
+            for (int i = 0; fd >= 0 && i < CLIENTS_MAX && slot < 0; i++) {
+                if (s_clients[i].fd < 0) slot = i;
+            }
+            if (slot >= 0) {
+                s_clients[slot] = (client_t){ .fd = fd, .watch = true };
+            } else if (fd >= 0) {
+                ESP_LOGW(TAG, "too many clients");
+                close(fd);
+            }
+        }
+        if (pfd[1].revents & POLLIN) {
+            done_msg_t m;
+            if (read(s_done_pipe[0], &m, sizeof(m)) == (ssize_t)sizeof(m)) {
+                line_t l = { .len = 0 };
+                out(&l, "{\"type\":\"done\",\"ticket\":%u,\"op\":\"%s\",\"err\":\"%s\"}",
+                    m.ticket, ld2450_cmd_op_name(m.op), esp_err_to_name(m.err));
+                line_end(&l);
+                broadcast(&l);
+            }
+        }
+        for (int k = 2; k < n; k++) {
+            if (pfd[k].revents & (POLLIN | POLLHUP | POLLERR)) client_read(&s_clients[idx[k]]);
+        }
+
+        /* Targets and zones only: the rest of the snapshot follows from them */
+        ld2450_state_t st;
+        ld2450_get_state(&st);
+        if (memcmp(st.targets, last.targets, sizeof(st.targets)) != 0 ||
+            st.zone_bitmap != last.zone_bitmap || st.occupied_global != last.occupied_global) {
+            line_t l = { .len = 0 };
+            fmt_state(&l, &st);
+            broadcast(&l);
+            last = st;
+        }
+    }
+
+    for (int i = 0; i < CLIENTS_MAX; i++) client_close(&s_clients[i]);
+    close(lfd);
+    unlink(sock_path);
+    return 0;
+}
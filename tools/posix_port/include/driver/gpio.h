@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of driver/gpio.h (see ../README.md): there are no pins, only
+// the names the firmware refers to.
+#pragma once
+#include "esp_bit_defs.h"
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC   (-1)
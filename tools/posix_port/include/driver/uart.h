@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of driver/uart.h (see ../README.md): UART ports backed by
+// serial devices (a USB adapter, or the emulator's pty).
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"     /* as in ESP-IDF, which ld2450.c relies on */
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int uart_port_t;
+
+#define UART_NUM_0          0
+#define UART_NUM_1          1
+#define UART_NUM_2          2
+#define UART_NUM_MAX        3
+#define UART_PIN_NO_CHANGE  (-1)
+
+typedef enum { UART_DATA_5_BITS, UART_DATA_6_BITS, UART_DATA_7_BITS, UART_DATA_8_BITS } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE, UART_PARITY_EVEN = 2, UART_PARITY_ODD } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 1, UART_STOP_BITS_1_5, UART_STOP_BITS_2 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE, UART_HW_FLOWCTRL_RTS, UART_HW_FLOWCTRL_CTS,
+               UART_HW_FLOWCTRL_CTS_RTS } uart_hw_flowcontrol_t;
+typedef enum { UART_SCLK_DEFAULT } uart_sclk_t;
+
+typedef struct {
+    int                   baud_rate;
+    uart_word_length_t    data_bits;
+    uart_parity_t         parity;
+    uart_stop_bits_t      stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t               rx_flow_ctrl_thresh;
+    uart_sclk_t           source_clk;
+} uart_config_t;
+
+/**
+ * POSIX only: serve uart_num from a serial device.  Call before
+ * uart_driver_install(), which opens it.
+ */
+esp_err_t uart_posix_set_device(uart_port_t uart_num, const char *path);
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags);
+esp_err_t uart_driver_delete(uart_port_t uart_num);
+
+/** 8N1 raw at any rate (termios2 BOTHER); other framings are refused. */
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config);
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num);
+
+/* ESP-IDF semantics: returns once length bytes are in, or when no further
+ * bytes arrive within ticks_to_wait of the previous ones. */
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait);
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size);
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
+esp_err_t uart_flush_input(uart_port_t uart_num);
+
+#ifdef __cplusplus
+}
+#endif
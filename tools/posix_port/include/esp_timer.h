@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of esp_timer.h (see ../README.md)
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Microseconds since the process started (CLOCK_MONOTONIC). */
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of freertos/FreeRTOS.h (see ../README.md).
+//
+// One tick is one millisecond.  Tasks are threads and priorities are
+// ignored, so nothing here is preemption-safe the way a single-core
+// FreeRTOS build is: code must already lock what it shares, as the
+// firmware does with its mutexes and critical sections.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "esp_bit_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define configTICK_RATE_HZ   1000
+#define portTICK_PERIOD_MS   1
+#define portMAX_DELAY        ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(ms))
+
+#define pdFALSE  0
+#define pdTRUE   1
+#define pdFAIL   pdFALSE
+#define pdPASS   pdTRUE
+
+/* A critical section is a mutex: it excludes the other threads, and like
+ * the spinlock on ESP32 it must not be taken twice by the same thread. */
+typedef struct {
+    pthread_mutex_t lock;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED  { PTHREAD_MUTEX_INITIALIZER }
+#define portENTER_CRITICAL(mux)       pthread_mutex_lock(&(mux)->lock)
+#define portEXIT_CRITICAL(mux)        pthread_mutex_unlock(&(mux)->lock)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of freertos/portmacro.h (see ../README.md)
+#pragma once
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of freertos/queue.h (see ../README.md): fixed-size items
+// copied in and out of a ring, as in FreeRTOS.
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct port_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t q);
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+
+#define xQueueSendToBack(q, item, ticks)  xQueueSend(q, item, ticks)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of freertos/semphr.h (see ../README.md): mutexes, binary and
+// counting semaphores are all a counter under a pthread mutex.  Mutexes do
+// not inherit priority and are not recursive.
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct port_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        count;
+    uint32_t        max;
+    bool            is_static;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: MIT
+// POSIX port of freertos/task.h (see ../README.md): a task is a detached
+// thread; stack depth and priority are accepted and ignored.
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct port_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out);
+
+/** NULL only: ends the calling task. */
+void vTaskDelete(TaskHandle_t task);
+
+/** The calling thread's task; threads not made by xTaskCreate get one on first use. */
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+/** Milliseconds since the process started. */
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t *prev_wake, TickType_t increment);
+
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+//
+// esp_log and esp_err on POSIX (see README.md).
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define LOG_TAGS_MAX  16
+
+static esp_log_level_t s_default = ESP_LOG_INFO;
+static struct {
+    char            tag[24];
+    esp_log_level_t level;
+} s_tags[LOG_TAGS_MAX];
+static pthread_mutex_t s_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (!tag) return;
+    pthread_mutex_lock(&s_log_lock);
+    if (strcmp(tag, "*") == 0) {
+        s_default = level;
+    } else {
+        for (int i = 0; i < LOG_TAGS_MAX; i++) {
+            if (s_tags[i].tag[0] == '\0' || strcmp(s_tags[i].tag, tag) == 0) {
+                strncpy(s_tags[i].tag, tag, sizeof(s_tags[i].tag) - 1);
+                s_tags[i].level = level;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_log_lock);
+}
+
+static esp_log_level_t level_for(const char *tag)
+{
+    for (int i = 0; i < LOG_TAGS_MAX && s_tags[i].tag[0]; i++) {
+        if (strcmp(s_tags[i].tag, tag) == 0) return s_tags[i].level;
+    }
+    return s_default;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "-EWIDV";
+
+    /* One line at a time, whole, from any thread */
+    pthread_mutex_lock(&s_log_lock);
+    if (level <= level_for(tag)) {
+        va_list ap;
+        va_start(ap, format);
+        fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+        vfprintf(stderr, format, ap);
+        fputc('\n', stderr);
+        va_end(ap);
+    }
+    pthread_mutex_unlock(&s_log_lock);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    default:                       return "UNKNOWN ERROR";
+    }
+}
@@ -0,0 +1,398 @@
+// SPDX-License-Identifier: MIT
+//
+// FreeRTOS and esp_timer on POSIX threads (see README.md).
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+
+/* ---- Time ---- */
+
+static int64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_epoch_us;
+
+__attribute__((constructor)) static void port_clock_init(void)
+{
+    s_epoch_us = mono_us();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return mono_us() - s_epoch_us;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sleep_ms(ticks ? ticks : 1);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *prev_wake, TickType_t increment)
+{
+    TickType_t wake = *prev_wake + increment;
+    TickType_t now = xTaskGetTickCount();
+    *prev_wake = wake;
+    if ((int32_t)(wake - now) <= 0) return pdFALSE;     /* already late */
+    sleep_ms(wake - now);
+    return pdTRUE;
+}
+
+/* Conditions wait on CLOCK_MONOTONIC, like the tick count */
+static void cond_init(pthread_cond_t *c)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec  += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+/* Wait on c until signalled; false once the deadline passes.  Callers loop
+ * on their own predicate, so spurious wake-ups are harmless. */
+static bool cond_wait(pthread_cond_t *c, pthread_mutex_t *m, TickType_t ticks,
+                      const struct timespec *deadline)
+{
+    if (ticks == 0) return false;
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(c, m);
+        return true;
+    }
+    return pthread_cond_timedwait(c, m, deadline) != ETIMEDOUT;
+}
+
+/* ---- Tasks ---- */
+
+struct port_task {
+    pthread_t       thread;
+    TaskFunction_t  fn;
+    void           *arg;
+    char            name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notify;
+};
+
+static __thread struct port_task *t_self;
+
+static struct port_task *task_alloc(const char *name)
+{
+    struct port_task *t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    strncpy(t->name, name ? name : "", sizeof(t->name) - 1);
+    pthread_mutex_init(&t->lock, NULL);
+    cond_init(&t->cond);
+    return t;
+}
+
+static void *task_entry(void *p)
+{
+    struct port_task *t = p;
+    t_self = t;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out)
+{
+    (void)stack_depth;
+    (void)priority;
+    struct port_task *t = task_alloc(name);
+    if (!t) return pdFAIL;
+    t->fn = fn;
+    t->arg = arg;
+
+    /* Publish the handle before the task can use it (xTaskNotifyGive on
+     * itself, or a comparison with xTaskGetCurrentTaskHandle()) */
+    if (out) *out = t;
+    if (pthread_create(&t->thread, NULL, task_entry, t) != 0) {
+        if (out) *out = NULL;
+        free(t);
+        return pdFAIL;
+    }
+    pthread_setname_np(t->thread, t->name);
+    pthread_detach(t->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == t_self) pthread_exit(NULL);
+    abort();    /* deleting another task is not supported */
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!t_self) t_self = task_alloc("thread");
+    return t_self;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    if (!task) return;
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct port_task *t = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&t->lock);
+    while (t->notify == 0 && cond_wait(&t->cond, &t->lock, ticks_to_wait, &deadline)) {}
+    uint32_t v = t->notify;
+    if (v) t->notify = clear_on_exit ? 0 : v - 1;
+    pthread_mutex_unlock(&t->lock);
+    return v;
+}
+
+/* ---- Semaphores ---- */
+
+static SemaphoreHandle_t sem_init(StaticSemaphore_t *s, uint32_t max, uint32_t initial, bool is_static)
+{
+    if (!s) return NULL;
+    pthread_mutex_init(&s->lock, NULL);
+    cond_init(&s->cond);
+    s->max = max;
+    s->count = initial;
+    s->is_static = is_static;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_init(malloc(sizeof(StaticSemaphore_t)), 1, 1, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_init(malloc(sizeof(StaticSemaphore_t)), 1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf)
+{
+    return sem_init(buf, 1, 0, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    return sem_init(malloc(sizeof(StaticSemaphore_t)), max, initial, false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks_to_wait)
+{
+    if (!s) return pdFALSE;
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0 && cond_wait(&s->cond, &s->lock, ticks_to_wait, &deadline)) {}
+    BaseType_t ok = s->count > 0 ? pdTRUE : pdFALSE;
+    if (ok) s->count--;
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    if (!s) return pdFALSE;
+    pthread_mutex_lock(&s->lock);
+    BaseType_t ok = s->count < s->max ? pdTRUE : pdFALSE;
+    if (ok) {
+        s->count++;
+        pthread_cond_signal(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    if (!s) return;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    if (!s->is_static) free(s);
+}
+
+/* ---- Queues ---- */
+
+struct port_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    size_t          item_size;
+    uint32_t        length;
+    uint32_t        head, count;
+    uint8_t         items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    if (length == 0 || item_size == 0) return NULL;
+    struct port_queue *q = calloc(1, sizeof(*q) + (size_t)length * item_size);
+    if (!q) return NULL;
+    pthread_mutex_init(&q->lock, NULL);
+    cond_init(&q->not_empty);
+    cond_init(&q->not_full);
+    q->item_size = item_size;
+    q->length = length;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (!q) return;
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+    free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait)
+{
+    if (!q) return pdFALSE;
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length && cond_wait(&q->not_full, &q->lock, ticks_to_wait, &deadline)) {}
+    BaseType_t ok = q->count < q->length ? pdTRUE : pdFALSE;
+    if (ok) {
+        uint32_t tail = (q->head + q->count) % q->length;
+        memcpy(&q->items[(size_t)tail * q->item_size], item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait)
+{
+    if (!q) return pdFALSE;
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && cond_wait(&q->not_empty, &q->lock, ticks_to_wait, &deadline)) {}
+    BaseType_t ok = q->count > 0 ? pdTRUE : pdFALSE;
+    if (ok) {
+        memcpy(item, &q->items[(size_t)q->head * q->item_size], q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    if (!q) return 0;
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+/* ---- Event groups ---- */
+
+struct port_events {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    EventBits_t     bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct port_events *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
+    pthread_mutex_init(&g->lock, NULL);
+    cond_init(&g->cond);
+    return g;
+}
+
+void vEventGroupDelete(EventGroupHandle_t g)
+{
+    if (!g) return;
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->lock);
+    g->bits |= bits;
+    EventBits_t v = g->bits;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->lock);
+    EventBits_t v = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g)
+{
+    pthread_mutex_lock(&g->lock);
+    EventBits_t v = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        EventBits_t have = g->bits & bits;
+        if (wait_for_all ? have == bits : have != 0) break;
+        if (!cond_wait(&g->cond, &g->lock, ticks_to_wait, &deadline)) break;
+    }
+    EventBits_t v = g->bits;
+    EventBits_t have = v & bits;
+    if (clear_on_exit && (wait_for_all ? have == bits : have != 0)) g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: MIT
+//
+// driver/uart on Linux serial devices (see README.md).
+//
+// The LD2450 runs at 256000 baud, which has no Bxxx constant, so the line
+// is set up with termios2 and BOTHER.  <asm/termbits.h> clashes with
+// <termios.h>, hence the raw ioctls.
+#define _GNU_SOURCE
+#include <asm/termbits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "driver/uart.h"
+#include "esp_log.h"
+
+static const char *TAG = "posix_uart";
+
+static struct {
+    char path[128];
+    int  fd;
+} s_port[UART_NUM_MAX] = {
+    { .fd = -1 }, { .fd = -1 }, { .fd = -1 },
+};
+
+static bool port_valid(uart_port_t n)
+{
+    return n >= 0 && n < UART_NUM_MAX;
+}
+
+esp_err_t uart_posix_set_device(uart_port_t uart_num, const char *path)
+{
+    if (!port_valid(uart_num) || !path || strlen(path) >= sizeof(s_port[0].path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    strcpy(s_port[uart_num].path, path);
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags)
+{
+    (void)rx_buffer_size;       /* the kernel buffers */
+    (void)tx_buffer_size;
+    (void)intr_alloc_flags;
+    if (!port_valid(uart_num) || queue_size != 0 || uart_queue) return ESP_ERR_INVALID_ARG;
+    if (s_port[uart_num].fd >= 0) return ESP_ERR_INVALID_STATE;
+    if (!s_port[uart_num].path[0]) {
+        ESP_LOGE(TAG, "UART%d: no device (uart_posix_set_device)", (int)uart_num);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int fd = open(s_port[uart_num].path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "%s: %s", s_port[uart_num].path, strerror(errno));
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_port[uart_num].fd = fd;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num)
+{
+    if (!port_valid(uart_num) || s_port[uart_num].fd < 0) return ESP_ERR_INVALID_STATE;
+    close(s_port[uart_num].fd);
+    s_port[uart_num].fd = -1;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *cfg)
+{
+    if (!port_valid(uart_num) || !cfg || cfg->baud_rate <= 0) return ESP_ERR_INVALID_ARG;
+    int fd = s_port[uart_num].fd;
+    if (fd < 0) return ESP_ERR_INVALID_STATE;
+    if (cfg->data_bits != UART_DATA_8_BITS || cfg->parity != UART_PARITY_DISABLE ||
+        cfg->stop_bits != UART_STOP_BITS_1 || cfg->flow_ctrl != UART_HW_FLOWCTRL_DISABLE) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0) {
+        ESP_LOGE(TAG, "%s: not a tty (%s)", s_port[uart_num].path, strerror(errno));
+        return ESP_FAIL;
+    }
+    /* Raw 8N1, no modem control */
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= CS8 | CLOCAL | CREAD | BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = (speed_t)cfg->baud_rate;
+    tio.c_ospeed = (speed_t)cfg->baud_rate;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (ioctl(fd, TCSETS2, &tio) != 0) {
+        ESP_LOGE(TAG, "%s: %d baud: %s", s_port[uart_num].path, cfg->baud_rate, strerror(errno));
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num)
+{
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return port_valid(uart_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    if (!port_valid(uart_num) || s_port[uart_num].fd < 0 || !buf) return -1;
+    int fd = s_port[uart_num].fd;
+    uint8_t *out = buf;
+    uint32_t got = 0;
+
+    while (got < length) {
+        int wait = ticks_to_wait == portMAX_DELAY ? -1 : (int)ticks_to_wait;
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, wait);
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) break;                             /* idle for ticks_to_wait */
+        ssize_t n = read(fd, out + got, length - got);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (n <= 0) {
+            /* Device gone (USB unplugged, emulator exited): behave like a
+             * silent line rather than spin on the error */
+            if (got == 0 && ticks_to_wait != portMAX_DELAY) vTaskDelay(ticks_to_wait);
+            break;
+        }
+        got += (uint32_t)n;
+    }
+    return (int)got;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+{
+    if (!port_valid(uart_num) || s_port[uart_num].fd < 0 || !size) return ESP_ERR_INVALID_ARG;
+    int n = 0;
+    if (ioctl(s_port[uart_num].fd, FIONREAD, &n) != 0) return ESP_FAIL;
+    *size = (size_t)n;
+    return ESP_OK;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    if (!port_valid(uart_num) || s_port[uart_num].fd < 0 || !src) return -1;
+    const uint8_t *p = src;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(s_port[uart_num].fd, p + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return (int)done;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num)
+{
+    if (!port_valid(uart_num) || s_port[uart_num].fd < 0) return ESP_ERR_INVALID_ARG;
+    return ioctl(s_port[uart_num].fd, TCFLSH, TCIFLUSH) == 0 ? ESP_OK : ESP_FAIL;
+}
@@ -23,6 +23,7 @@ window.addEventListener('DOMContentLoaded', async () => {
   initOtaInterval();
   await loadConfig();
   await loadStatus();
+  await loadStats();
   await loadOtaStatus();
   await loadOtaInterval();
   await loadOtaIndexUrl();
@@ -84,6 +85,63 @@ async function pollStatus() {
     document.getElementById('sy-heap').textContent  = fmtBytes(s.free_heap);
     document.getElementById('wf-state').textContent = s.wifi || '—';
   } catch (e) {}
+  loadStats();
+}
+
+function applySensorCmdStatus(c) {
+  let txt = c.state + (c.pending ? ' (' + c.pending + ' queued)' : '');
+  if (c.completed) txt += ', last ' + c.last_op + ' ' + (c.last_err === 'ESP_OK' ? 'ok' : c.last_err) +
+    ' in ' + c.last_ms + ' ms';
+  if (c.failed) txt += ', ' + c.failed + ' failed';
+  txt += '; ' + c.sessions + ' sessions, ' + c.skipped + ' skipped';
+  if (c.drift) txt += ', ' + c.drift + ' drift';
+  document.getElementById('st-sensor-cmd').textContent = txt;
+  if (c.sensor_fw) document.getElementById('st-sensor-fw').textContent = c.sensor_fw;
+}
+
+async function loadStats() {
+  try {
+    const r = await fetch('/api/stats');
+    const s = await r.json();
+    const c = s.coords;
+    document.getElementById('st-coord-mode').textContent = c.mode;
+    document.getElementById('st-coord-int').textContent  = c.mode === 'off' ? '—' : c.interval_ms + ' ms';
+    document.getElementById('st-coord-sent').textContent = c.sent;
+    document.getElementById('st-coord-supp').textContent = c.suppressed + ' (+' + c.idle + ' idle)';
+    const rp = s.reports;
+    document.getElementById('st-frames').textContent = rp.events
+      ? (rp.frames / rp.events).toFixed(2) + ' (' + (rp.attrs / rp.events).toFixed(2) + ' unbatched)'
+      : '—';
+    document.getElementById('st-airtime').textContent =
+      s.airtime.ms_hour + ' ms (' + s.airtime.frames_hour + ' frames)';
+    document.getElementById('st-throttled').textContent =
+      s.rate.throttled_occ + ' occupancy, ' + c.throttled + ' coordinate (' + s.rate.tokens + ' tokens)';
+    const k = s.link;
+    document.getElementById('st-ack-lat').textContent = k.samples
+      ? '< ' + k.p50_ms + ' ms / < ' + k.p99_ms + ' ms (' + k.samples + ' ACKs)' : 'no ACKs yet';
+    document.getElementById('st-retries').textContent =
+      k.retries + ' / ' + k.failed + ' of ' + k.sent + ' sent';
+    document.getElementById('st-soft-faults').textContent = k.soft_faults;
+    document.getElementById('st-ack-to').textContent = k.ack_timeout_ms + ' ms' +
+      (k.suggest_ms ? ' (suggested ' + k.suggest_ms + ' ms)' : '');
+    document.getElementById('st-attrs').textContent =
+      s.config_push.attrs_written + ' (' + s.config_push.attrs_skipped + ' skipped)';
+    applySensorCmdStatus(s.sensor_cmd);
+    const f = s.hw_filter;
+    document.getElementById('st-hw-filter').textContent = f.zone_type
+      ? f.mode + ': ' + f.rects.length + ' rect(s), ' + (f.area_cm2 / 10000).toFixed(1) +
+        ' of ' + (f.range_cm2 / 10000).toFixed(1) + ' m² reported'
+      : f.mode + ': off (full range)';
+    const h = s.sensor_health;
+    let ht = h.state + ', ' + h.rate_pct + '% frames, ' + h.garbage_pct + '% garbage';
+    if (h.gaps || h.stalls || h.noisy) {
+      ht += '; ' + h.gaps + ' gaps, ' + h.stalls + ' stalls, ' + h.noisy + ' noisy';
+    }
+    if (h.restarts || h.reapplies) {
+      ht += '; ' + h.restarts + ' restarts, ' + h.reapplies + ' re-applied';
+    }
+    document.getElementById('st-sensor-health').textContent = ht;
+  } catch (e) {}
 }
 
 async function saveConfig(patch) {
@@ -101,6 +159,23 @@ async function saveConfig(patch) {
   }
 }
 
+async function saveRules() {
+  const rules = document.getElementById('rules-text').value
+    .split('\n').map(l => l.trim()).filter(l => l);
+  try {
+    const r = await fetch('/api/config', {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ rules })
+    });
+    const d = await r.json();
+    if (d.status === 'ok') { toast('SAVED', 'ok'); loadConfig(); }
+    else                   toast(d.error ? d.error.toUpperCase() : 'ERROR', 'err');
+  } catch (e) {
+    toast('SAVE FAILED', 'err');
+  }
+}
+
 async function saveAllZones() {
   const patch = {
     zones: cfg.zones.map(z => ({
@@ -138,6 +213,9 @@ function applyToUI() {
     const v = cfg[sel.dataset.key];
     if (v !== undefined) sel.value = String(v);
   });
+  /* Local rules */
+  const rt = document.getElementById('rules-text');
+  if (rt !== focused && cfg.rules) rt.value = cfg.rules.join('\n');
   /* Overlay */
   refreshOverlay();
   buildZoneGrid();
@@ -808,6 +886,10 @@ function _sseShowReconnectBadge(show) {
     try { applyOtaStatus(JSON.parse(e.data)); } catch (_) {}
   });
 
+  es.addEventListener('sensor_cmd', e => {
+    try { applySensorCmdStatus(JSON.parse(e.data)); } catch (_) {}
+  });
+
   es.onerror = () => {
     clearTimeout(_sseReconnectTimer);
     _sseReconnectTimer = setTimeout(() => _sseShowReconnectBadge(true), 5000);
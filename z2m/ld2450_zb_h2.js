@@ -9,6 +9,7 @@
 const ZCL_UINT8    = 0x20;
 const ZCL_UINT16   = 0x21;
 const ZCL_UINT32   = 0x23;
+const ZCL_OCTET_STR = 0x41;
 const ZCL_CHAR_STR = 0x42;
 
 // ---- Expose access flags ----
@@ -37,12 +38,27 @@ for (let n = 0; n < 10; n++) {
     fallbackCooldownAttrs[`fallbackZone${n + 1}Cooldown`] = {ID: 0x0070 + n, type: ZCL_UINT16, write: true};
 }
 
+// ---- Fallback group attribute layout (0x0080 = main, 0x0081-0x008A = zones) ----
+const fallbackGroupAttrs = {
+    fallbackGroup: {ID: 0x0080, type: ZCL_UINT16, write: true},
+};
+for (let n = 0; n < 10; n++) {
+    fallbackGroupAttrs[`fallbackZone${n + 1}Group`] = {ID: 0x0081 + n, type: ZCL_UINT16, write: true};
+}
+
 // ---- Custom cluster definition ----
 const ld2450ConfigCluster = {
     ID: CLUSTER_CONFIG_ID,
     attributes: {
         targetCount:          {ID: 0x0000, type: ZCL_UINT8,    report: true},
         targetCoords:         {ID: 0x0001, type: ZCL_CHAR_STR, report: true},
+        zoneBitmap:           {ID: 0x0002, type: ZCL_UINT16,   report: true},
+        targetData:           {ID: 0x0003, type: ZCL_OCTET_STR, report: true},
+        occEventLog:          {ID: 0x0006, type: ZCL_OCTET_STR, report: true},
+        coordDeadband:        {ID: 0x0004, type: ZCL_UINT16,   write: true},
+        coordMinInterval:     {ID: 0x0005, type: ZCL_UINT16,   write: true},
+        rateBurst:            {ID: 0x0007, type: ZCL_UINT8,    write: true},
+        rateSustained:        {ID: 0x0008, type: ZCL_UINT16,   write: true},
         maxDistance:          {ID: 0x0010, type: ZCL_UINT16,   write: true},
         angleLeft:            {ID: 0x0011, type: ZCL_UINT8,    write: true},
         angleRight:           {ID: 0x0012, type: ZCL_UINT8,    write: true},
@@ -59,15 +75,22 @@ const ld2450ConfigCluster = {
 
         hardTimeoutSec:       {ID: 0x002B, type: ZCL_UINT8,    write: true},
         ackTimeoutMs:         {ID: 0x002C, type: ZCL_UINT16,   write: true},
+        zoneEpReports:        {ID: 0x002D, type: ZCL_UINT8,    write: true},
+        hwFilterMode:         {ID: 0x002E, type: ZCL_UINT8,    write: true},
         bootCount:            {ID: 0x0030, type: ZCL_UINT32,   report: false},
         resetReason:          {ID: 0x0031, type: ZCL_UINT8,    report: false},
         lastUptimeSec:        {ID: 0x0032, type: ZCL_UINT32,   report: false},
         minFreeHeap:          {ID: 0x0033, type: ZCL_UINT32,   report: false},
         diagReset:            {ID: 0x0034, type: ZCL_UINT8,    write: true},
+        throttledOcc:         {ID: 0x0035, type: ZCL_UINT32,   report: false},
+        throttledCoords:      {ID: 0x0036, type: ZCL_UINT32,   report: false},
+        linkStats:            {ID: 0x0037, type: ZCL_OCTET_STR, report: false},
+        sensorCmdStatus:      {ID: 0x0038, type: ZCL_UINT8,    report: false},
         restart:              {ID: 0x00F0, type: ZCL_UINT8,    write: true},
         factoryReset:         {ID: 0x00F1, type: ZCL_UINT8,    write: true},
         ...zoneConfigAttrs,
         ...fallbackCooldownAttrs,
+        ...fallbackGroupAttrs,
     },
     commands: {},
     commandsResponse: {},
@@ -94,6 +117,76 @@ function metresCsvToMm(mCsv) {
 
 // ---- Expose helpers (inline, no require) ----
 
+/* Occupancy event log: [seq u16][count u8][now_ms u32] then count entries,
+ * newest first: [ep | 0x80 if occupied][age_ms u32].  Consecutive payloads
+ * overlap, so each one is pinned to the timeline already held in state via
+ * a shared seq; only a payload with no overlap is anchored to receipt time.
+ * Transition spacing is then exact however late the report arrived. */
+function decodeOccEventLog(buf, prev) {
+    if (buf.length < 7) return null;
+    const seq = buf.readUInt16LE(0);
+    const count = Math.min(buf[2], Math.floor((buf.length - 7) / 5));
+    const entries = [];
+    for (let k = 0; k < count; k++) {
+        const o = 7 + k * 5;
+        entries.push({seq: (seq - k) & 0xFFFF, ep: buf[o] & 0x7F, occupied: (buf[o] & 0x80) !== 0, age: buf.readUInt32LE(o + 1)});
+    }
+
+    let anchor = Date.now();
+    const known = new Map((Array.isArray(prev) ? prev : []).map((e) => [e.seq, e]));
+    for (const e of entries) {
+        const p = known.get(e.seq);
+        if (p && p.endpoint === e.ep && p.occupied === e.occupied) {
+            anchor = Date.parse(p.time) + e.age;
+            break;
+        }
+    }
+
+    return entries.map((e) => ({
+        seq: e.seq,
+        endpoint: e.ep,
+        zone: e.ep >= 2 ? e.ep - 1 : null,
+        occupied: e.occupied,
+        time: new Date(anchor - e.age).toISOString(),
+    }));
+}
+
+/* Link stats (0x0037, see main/ack_stats.h): ACK latency histogram in
+ * power-of-two buckets from 25 ms, then srtt, suggested ACK timeout, soft
+ * faults, failed reports per 1000, and per-EP retries / failures (uint8).
+ * Percentiles are bucket upper edges, as in the firmware; srtt is not exposed. */
+function decodeLinkStats(buf) {
+    if (buf.length < 51 || buf[0] !== 1) return null;
+    const hist = [];
+    for (let b = 0; b < 10; b++) hist.push(buf.readUInt16LE(1 + b * 2));
+    const total = hist.reduce((a, n) => a + n, 0);
+    const pct = (p) => {
+        if (!total) return null;
+        const need = Math.ceil(total * p / 100);
+        let cum = 0;
+        for (let b = 0; b < 10; b++) {
+            cum += hist[b];
+            if (cum >= need) return 25 << b;
+        }
+        return 25 << 9;
+    };
+    let retries = 0, failures = 0;
+    for (let i = 0; i < 11; i++) {
+        retries  += buf[29 + i];
+        failures += buf[40 + i];
+    }
+    const suggested = buf.readUInt16LE(23);
+    return {
+        ack_latency_p50: pct(50),
+        ack_latency_p99: pct(99),
+        ack_timeout_suggested: suggested || null,
+        soft_faults_total: buf.readUInt16LE(25),
+        report_fail_rate: buf.readUInt16LE(27),
+        report_retries: retries,
+        report_failures: failures,
+    };
+}
+
 function binaryExpose(property, label, access, valueOn, valueOff, description, name) {
     return {type: 'binary', name: name || property, label, property, access,
         value_on: valueOn, value_off: valueOff, description};
@@ -105,6 +198,12 @@ function numericExpose(name, label, access, description, opts) {
     return e;
 }
 
+// ZB_ATTR_COORD_PUBLISHING values, indexed by attribute value
+const COORD_MODES = ['off', 'on', 'adaptive'];
+const SENSOR_CMD_STATES = ['idle', 'busy', 'failed'];
+// ZB_ATTR_HW_FILTER_MODE values
+const HW_FILTER_MODES = ['range', 'zones'];
+
 function enumExpose(name, label, access, values, description) {
     return {type: 'enum', name, label, property: name, access, values, description};
 }
@@ -142,22 +241,45 @@ const fzLocal = {
             if (d.angleLeft !== undefined)       result.angle_left         = d.angleLeft;
             if (d.angleRight !== undefined)      result.angle_right        = d.angleRight;
             if (d.trackingMode !== undefined)    result.tracking_mode      = d.trackingMode === 0;
-            if (d.coordPublishing !== undefined) result.coord_publishing   = d.coordPublishing === 1;
+            if (d.hwFilterMode !== undefined)    result.sensor_zone_filter = HW_FILTER_MODES[d.hwFilterMode] ?? 'range';
+            if (d.coordPublishing !== undefined) result.coord_publishing   = COORD_MODES[d.coordPublishing] ?? 'on';
+            if (d.coordDeadband !== undefined)   result.coord_deadband     = d.coordDeadband;
+            if (d.coordMinInterval !== undefined) result.coord_min_interval = d.coordMinInterval;
+            if (d.rateBurst !== undefined)       result.rate_burst         = d.rateBurst;
+            if (d.rateSustained !== undefined)   result.rate_sustained     = d.rateSustained;
             if (d.occupancyCooldown !== undefined)  result.occupancy_cooldown  = d.occupancyCooldown;
             if (d.occupancyDelay !== undefined)     result.occupancy_delay     = d.occupancyDelay;
             if (d.fallbackMode !== undefined)       result.fallback_mode       = d.fallbackMode === 1;
             if (d.fallbackCooldown !== undefined)   result.fallback_cooldown   = d.fallbackCooldown;
+            if (d.fallbackGroup !== undefined)      result.fallback_group      = d.fallbackGroup;
             if (d.fallbackEnable !== undefined)     result.fallback_enable     = d.fallbackEnable === 1;
 
             if (d.hardTimeoutSec !== undefined)     result.hard_timeout_sec    = d.hardTimeoutSec;
             if (d.ackTimeoutMs !== undefined)       result.ack_timeout_ms      = d.ackTimeoutMs;
             if (d.heartbeatEnable !== undefined)    result.heartbeat_enable    = d.heartbeatEnable === 1;
             if (d.heartbeatInterval !== undefined)  result.heartbeat_interval  = d.heartbeatInterval;
+            if (d.zoneEpReports !== undefined)      result.zone_ep_reports     = d.zoneEpReports === 1;
+
+            /* Zone bitmap (EP1): bit n = zone n+1 occupied, one report for all zones */
+            if (d.zoneBitmap !== undefined) {
+                for (let n = 0; n < 10; n++) {
+                    result[`zone_${n + 1}_occupancy`] = ((d.zoneBitmap >> n) & 1) === 1;
+                }
+            }
 
             if (d.bootCount !== undefined)       result.boot_count         = d.bootCount;
             if (d.resetReason !== undefined)     result.reset_reason       = d.resetReason;
             if (d.lastUptimeSec !== undefined)   result.last_uptime_sec    = d.lastUptimeSec;
             if (d.minFreeHeap !== undefined)     result.min_free_heap      = d.minFreeHeap;
+            if (d.throttledOcc !== undefined)    result.throttled_occupancy = d.throttledOcc;
+            if (d.throttledCoords !== undefined) result.throttled_coords   = d.throttledCoords;
+            if (d.sensorCmdStatus !== undefined) {
+                result.sensor_command_status = SENSOR_CMD_STATES[d.sensorCmdStatus] ?? 'idle';
+            }
+            if (d.linkStats !== undefined) {
+                const link = decodeLinkStats(Buffer.from(d.linkStats || []));
+                if (link) Object.assign(result, link);
+            }
 
             if (d.targetCoords !== undefined) {
                 const str = d.targetCoords || '';
@@ -174,6 +296,25 @@ const fzLocal = {
                 }
             }
 
+            /* Packed target data: [presence bits][x,y,speed int16 LE] x 3 (mm, mm, cm/s) */
+            if (d.targetData !== undefined) {
+                const buf = Buffer.from(d.targetData || []);
+                if (buf.length >= 19) {
+                    for (let i = 0; i < 3; i++) {
+                        const present = (buf[0] >> i) & 1;
+                        const o = 1 + i * 6;
+                        result[`target_${i + 1}_x`]     = present ? buf.readInt16LE(o) / 1000 : 0;
+                        result[`target_${i + 1}_y`]     = present ? buf.readInt16LE(o + 2) / 1000 : 0;
+                        result[`target_${i + 1}_speed`] = present ? buf.readInt16LE(o + 4) / 100 : 0;
+                    }
+                }
+            }
+
+            if (d.occEventLog !== undefined) {
+                const events = decodeOccEventLog(Buffer.from(d.occEventLog || []), (meta.state || {}).occupancy_events);
+                if (events) result.occupancy_events = events;
+            }
+
             /* Zone config attrs (n=0..9 firmware, z=1..10 Z2M) */
             for (let n = 0; n < 10; n++) {
                 const z = n + 1;
@@ -182,12 +323,14 @@ const fzLocal = {
                 const cl = d[`zone${z}Cooldown`];
                 const dl = d[`zone${z}Delay`];
                 const fc = d[`fallbackZone${z}Cooldown`];
+                const fg = d[`fallbackZone${z}Group`];
 
                 if (vc !== undefined) result[`zone_${z}_vertex_count`]      = String(vc);
                 if (cs !== undefined) result[`zone_${z}_coords`]            = mmCsvToMetres(cs || '');
                 if (cl !== undefined) result[`zone_${z}_cooldown`]          = cl;
                 if (dl !== undefined) result[`zone_${z}_delay`]             = dl;
                 if (fc !== undefined) result[`fallback_cooldown_zone_${z}`] = fc;
+                if (fg !== undefined) result[`fallback_group_zone_${z}`]    = fg;
             }
 
             return result;
@@ -201,11 +344,16 @@ const tzLocal = {
     config: {
         key: [
             'max_distance', 'angle_left', 'angle_right', 'tracking_mode', 'coord_publishing',
+            'sensor_zone_filter',
+            'coord_deadband', 'coord_min_interval',
+            'rate_burst', 'rate_sustained',
             'occupancy_cooldown', 'occupancy_delay',
-            'fallback_mode', 'fallback_cooldown',
+            'fallback_mode', 'fallback_cooldown', 'fallback_group',
             'fallback_enable', 'hard_timeout_sec', 'ack_timeout_ms',
             'heartbeat_enable', 'heartbeat_interval', 'heartbeat',
+            'zone_ep_reports',
             ...Array.from({length: 10}, (_, i) => `fallback_cooldown_zone_${i + 1}`),
+            ...Array.from({length: 10}, (_, i) => `fallback_group_zone_${i + 1}`),
             ...Array.from({length: 10}, (_, i) => [
                 `zone_${i + 1}_vertex_count`,
                 `zone_${i + 1}_coords`,
@@ -291,23 +439,38 @@ const tzLocal = {
                 return {state: {[key]: value}};
             }
 
+            /* Fallback zone group (fallback_group_zone_N → 0x0080+N, stays on EP1) */
+            const fbZoneGroupMatch = key.match(/^fallback_group_zone_(\d+)$/);
+            if (fbZoneGroupMatch) {
+                const n = parseInt(fbZoneGroupMatch[1]) - 1;  /* 0-indexed */
+                await ep1.write('ld2450Config', {[`fallbackZone${n + 1}Group`]: value});
+                return {state: {[key]: value}};
+            }
+
             /* Main endpoint config */
             const map = {
                 max_distance:       {attr: 'maxDistance',       val: (v) => Math.round(v * 1000)},
                 angle_left:         {attr: 'angleLeft',         val: (v) => v},
                 angle_right:        {attr: 'angleRight',        val: (v) => v},
                 tracking_mode:      {attr: 'trackingMode',      val: (v) => v ? 0 : 1},
-                coord_publishing:   {attr: 'coordPublishing',   val: (v) => v ? 1 : 0},
+                sensor_zone_filter: {attr: 'hwFilterMode',      val: (v) => Math.max(0, HW_FILTER_MODES.indexOf(v))},
+                coord_publishing:   {attr: 'coordPublishing',   val: (v) => typeof v === 'string' ? Math.max(0, COORD_MODES.indexOf(v)) : (v ? 1 : 0)},
+                coord_deadband:     {attr: 'coordDeadband',     val: (v) => v},
+                coord_min_interval: {attr: 'coordMinInterval',  val: (v) => v},
+                rate_burst:         {attr: 'rateBurst',         val: (v) => v},
+                rate_sustained:     {attr: 'rateSustained',     val: (v) => v},
                 occupancy_cooldown: {attr: 'occupancyCooldown', val: (v) => v},
                 occupancy_delay:    {attr: 'occupancyDelay',    val: (v) => v},
                 fallback_mode:      {attr: 'fallbackMode',      val: (v) => v ? 1 : 0},
                 fallback_cooldown:  {attr: 'fallbackCooldown',  val: (v) => v},
+                fallback_group:     {attr: 'fallbackGroup',     val: (v) => v},
                 heartbeat_enable:   {attr: 'heartbeatEnable',   val: (v) => v ? 1 : 0},
                 heartbeat_interval: {attr: 'heartbeatInterval', val: (v) => v},
                 heartbeat:          {attr: 'heartbeat',         val: (_) => 1},
                 fallback_enable:    {attr: 'fallbackEnable',    val: (v) => v ? 1 : 0},
                 hard_timeout_sec:   {attr: 'hardTimeoutSec',    val: (v) => v},
                 ack_timeout_ms:     {attr: 'ackTimeoutMs',      val: (v) => v},
+                zone_ep_reports:    {attr: 'zoneEpReports',     val: (v) => v ? 1 : 0},
             };
             const m = map[key];
             if (m) {
@@ -343,16 +506,29 @@ const tzLocal = {
                 return;
             }
 
+            /* Fallback zone group get */
+            const fbZoneGroupGetMatch = key.match(/^fallback_group_zone_(\d+)$/);
+            if (fbZoneGroupGetMatch) {
+                const n = parseInt(fbZoneGroupGetMatch[1]) - 1;
+                await ep1.read('ld2450Config', [`fallbackZone${n + 1}Group`]);
+                return;
+            }
+
             /* Main endpoint config */
             const attrs = {
                 max_distance: 'maxDistance', angle_left: 'angleLeft',
                 angle_right: 'angleRight', tracking_mode: 'trackingMode',
+                sensor_zone_filter: 'hwFilterMode',
                 coord_publishing: 'coordPublishing', occupancy_cooldown: 'occupancyCooldown',
                 occupancy_delay: 'occupancyDelay',
+                coord_deadband: 'coordDeadband', coord_min_interval: 'coordMinInterval',
+                rate_burst: 'rateBurst', rate_sustained: 'rateSustained',
                 fallback_mode: 'fallbackMode', fallback_cooldown: 'fallbackCooldown',
+                fallback_group: 'fallbackGroup',
                 fallback_enable: 'fallbackEnable',
                 hard_timeout_sec: 'hardTimeoutSec', ack_timeout_ms: 'ackTimeoutMs',
                 heartbeat_enable: 'heartbeatEnable', heartbeat_interval: 'heartbeatInterval',
+                zone_ep_reports: 'zoneEpReports',
             };
             if (attrs[key]) await ep1.read('ld2450Config', [attrs[key]]);
         },
@@ -413,6 +589,8 @@ const exposesDefinition = [
             `Target ${i + 1} X coordinate`, {unit: 'm'}),
         numericExpose(`target_${i + 1}_y`, `Target ${i + 1} Y`, ACCESS_STATE,
             `Target ${i + 1} Y coordinate`, {unit: 'm'}),
+        numericExpose(`target_${i + 1}_speed`, `Target ${i + 1} speed`, ACCESS_STATE,
+            `Target ${i + 1} radial speed (negative = approaching)`, {unit: 'm/s'}),
     ]).flat(),
 
     numericExpose('max_distance', 'Max distance', ACCESS_ALL,
@@ -427,8 +605,29 @@ const exposesDefinition = [
     binaryExpose('tracking_mode', 'Multi target', ACCESS_ALL, true, false,
         'Multi-target tracking (off = single target)'),
 
-    binaryExpose('coord_publishing', 'Coordinate publishing', ACCESS_ALL, true, false,
-        'Enable publishing of target coordinates'),
+    enumExpose('sensor_zone_filter', 'Sensor zone filter', ACCESS_ALL, HW_FILTER_MODES,
+        'What the LD2450 drops before the firmware sees a target: range = outside the distance and angle limits ' +
+        '(up to 3 rectangles fitted to the detection sector), zones = also outside every zone\'s bounding box. ' +
+        'With zones, targets outside all zones no longer count for main occupancy.'),
+
+    enumExpose('coord_publishing', 'Coordinate publishing', ACCESS_ALL, COORD_MODES,
+        'Target coordinate publishing: on = fixed min interval, adaptive = report rate follows target motion (fast when walking, slow when still, silent when empty)'),
+
+    numericExpose('coord_deadband', 'Coordinate dead-band', ACCESS_ALL,
+        'Target movement smaller than this is not reported (filters radar jitter). 0 = report any movement.',
+        {unit: 'mm', value_min: 0, value_max: 1000, value_step: 10}),
+
+    numericExpose('coord_min_interval', 'Coordinate min interval', ACCESS_ALL,
+        'Minimum time between target coordinate reports. 0 = no limit (up to 10 per second).',
+        {unit: 'ms', value_min: 0, value_max: 10000, value_step: 100}),
+
+    numericExpose('rate_burst', 'Report burst', ACCESS_ALL,
+        'Occupancy and coordinate reports the device may send back-to-back before the sustained rate applies.',
+        {value_min: 1, value_max: 100, value_step: 1}),
+
+    numericExpose('rate_sustained', 'Report rate limit', ACCESS_ALL,
+        'Sustained occupancy + coordinate reports per minute. The first transition after a quiet spell is never delayed. 0 = unlimited.',
+        {unit: '/min', value_min: 0, value_max: 3000, value_step: 60}),
 
     numericExpose('occupancy_cooldown', 'Occupancy cooldown', ACCESS_ALL,
         'Minimum time before reporting Clear (main sensor)', {unit: 's', value_min: 0, value_max: 300, value_step: 1}),
@@ -466,6 +665,17 @@ const exposesDefinition = [
             {unit: 's', value_min: 0, value_max: 600, value_step: 1})
     ),
 
+    numericExpose('fallback_group', 'Fallback group (main)', ACCESS_ALL,
+        'Zigbee group the main EP switches in fallback with one group-cast frame. ' +
+        '0 = use On/Off bindings (one frame per bound light)',
+        {value_min: 0, value_max: 65527, value_step: 1}),
+
+    ...Array.from({length: 10}, (_, i) =>
+        numericExpose(`fallback_group_zone_${i + 1}`, `Fallback group zone ${i + 1}`, ACCESS_ALL,
+            `Zigbee group zone ${i + 1} switches in fallback. 0 = use zone ${i + 1} On/Off bindings`,
+            {value_min: 0, value_max: 65527, value_step: 1})
+    ),
+
     /* Software watchdog (heartbeat) */
     binaryExpose('heartbeat_enable', 'Heartbeat watchdog', ACCESS_ALL, true, false,
         'Enable software watchdog. When enabled, the device expects periodic heartbeat writes ' +
@@ -503,6 +713,11 @@ const exposesDefinition = [
         'Default: 2000ms. Increase if your Zigbee network has high latency.',
         {unit: 'ms', value_min: 500, value_max: 10000, value_step: 100}),
 
+    binaryExpose('zone_ep_reports', 'Per-zone reports', ACCESS_ALL, true, false,
+        'Send a separate occupancy report from each zone endpoint (EP2-11). Zone presence is always ' +
+        'also reported as a single bitmap on EP1, so a change spanning several zones is one frame. ' +
+        'Turn off to rely on the bitmap only and cut zone traffic. Soft fallback still tracks every zone.'),
+
     /* Crash diagnostics (read-only) */
     numericExpose('boot_count', 'Boot count', ACCESS_STATE,
         'Total number of device reboots (monotonic counter)', {}),
@@ -518,6 +733,36 @@ const exposesDefinition = [
     numericExpose('min_free_heap', 'Min free heap', ACCESS_STATE,
         'Minimum free heap memory since boot', {unit: 'bytes'}),
 
+    numericExpose('throttled_occupancy', 'Throttled occupancy reports', ACCESS_STATE,
+        'Occupancy transitions held back by the report rate limiter since boot (flicker)'),
+
+    numericExpose('throttled_coords', 'Throttled coordinate reports', ACCESS_STATE,
+        'Target coordinate frames held back by the report rate limiter since boot'),
+
+    numericExpose('ack_latency_p50', 'ACK latency p50', ACCESS_STATE,
+        'Half of the occupancy reports were acknowledged by the coordinator within this time', {unit: 'ms'}),
+
+    numericExpose('ack_latency_p99', 'ACK latency p99', ACCESS_STATE,
+        '99% of the occupancy reports were acknowledged by the coordinator within this time', {unit: 'ms'}),
+
+    numericExpose('ack_timeout_suggested', 'Suggested ACK timeout', ACCESS_STATE,
+        'ACK timeout that covers the measured link (2 x p99). Empty until 50 reports were acknowledged.', {unit: 'ms'}),
+
+    numericExpose('report_retries', 'Report retries', ACCESS_STATE,
+        'Occupancy report retries since boot, summed over all endpoints (each endpoint stops counting at 255)'),
+
+    numericExpose('report_failures', 'Report failures', ACCESS_STATE,
+        'Occupancy reports that failed after all retries since boot, summed over all endpoints (each endpoint stops counting at 255)'),
+
+    numericExpose('report_fail_rate', 'Report failure rate', ACCESS_STATE,
+        'Failed occupancy reports per 1000 sent', {unit: '‰'}),
+
+    numericExpose('soft_faults_total', 'Soft faults', ACCESS_STATE,
+        'Soft fallback entries since boot'),
+
+    enumExpose('sensor_command_status', 'Sensor command status', ACCESS_STATE, SENSOR_CMD_STATES,
+        'LD2450 config commands: busy while one is queued or running, failed if the last one got no ACK'),
+
     enumExpose('diag_reset_boot_count', 'Reset boot count', ACCESS_SET, ['Reset'],
         'Reset the boot counter to 0'),
 
@@ -543,7 +788,7 @@ async function configureBindingsAndReads(device, coordinatorEndpoint) {
 
     /* Read EP1 config attrs in small batches to avoid ZCL INSUFFICIENT_SPACE */
     await ep1.read('ld2450Config', [
-        'targetCount', 'targetCoords', 'maxDistance', 'angleLeft', 'angleRight',
+        'targetCount', 'targetData', 'maxDistance', 'angleLeft', 'angleRight',
     ]);
     await ep1.read('ld2450Config', [
         'trackingMode', 'coordPublishing', 'occupancyCooldown', 'occupancyDelay',
@@ -556,6 +801,12 @@ async function configureBindingsAndReads(device, coordinatorEndpoint) {
         'heartbeatEnable', 'heartbeatInterval',
         'bootCount', 'resetReason', 'lastUptimeSec', 'minFreeHeap',
     ]);
+    await ep1.read('ld2450Config', ['zoneBitmap', 'zoneEpReports', 'hwFilterMode', 'coordDeadband', 'coordMinInterval']);
+    await ep1.read('ld2450Config', ['occEventLog']);
+    await ep1.read('ld2450Config', ['rateBurst', 'rateSustained', 'throttledOcc', 'throttledCoords']);
+    await ep1.read('ld2450Config', ['linkStats', 'sensorCmdStatus']);
+    await ep1.read('ld2450Config', ['fallbackGroup', ...Array.from({length: 5}, (_, i) => `fallbackZone${i + 1}Group`)]);
+    await ep1.read('ld2450Config', Array.from({length: 5}, (_, i) => `fallbackZone${i + 6}Group`));
 
     /* EPs 2-11: occupancy + per-zone config cluster */
     for (let n = 0; n < 10; n++) {
@@ -609,9 +860,9 @@ const definition = {
         registerCustomClusters(device);
         const ep1 = device.getEndpoint(1);
         await configureBindingsAndReads(device, coordinatorEndpoint);
+        /* Sensor attrs (target count/data, zone bitmap, event log) are pushed by
+         * the firmware as one batched report per poll; no reporting config. */
         await ep1.configureReporting('ld2450Config', [
-            {attribute: 'targetCount',  minimumReportInterval: 0, maximumReportInterval: 300,  reportableChange: 1},
-            {attribute: 'targetCoords', minimumReportInterval: 0, maximumReportInterval: 300},
             {attribute: 'fallbackMode', minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
         ]);
     },
@@ -629,10 +880,10 @@ const definitionC6 = {
         registerCustomClusters(device);
         const ep1 = device.getEndpoint(1);
         await configureBindingsAndReads(device, coordinatorEndpoint);
+        /* Sensor attrs (target count/data, zone bitmap, event log) are pushed by
+         * the firmware as one batched report per poll; no reporting config. */
         /* Split into small batches to stay within ZCL frame size limits */
         await ep1.configureReporting('ld2450Config', [
-            {attribute: 'targetCount',      minimumReportInterval: 0, maximumReportInterval: 300,  reportableChange: 1},
-            {attribute: 'targetCoords',     minimumReportInterval: 0, maximumReportInterval: 300},
             {attribute: 'fallbackMode',     minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
             {attribute: 'maxDistance',      minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
             {attribute: 'angleLeft',        minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
@@ -643,6 +894,7 @@ const definitionC6 = {
             {attribute: 'coordPublishing',  minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
             {attribute: 'occupancyCooldown',minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
             {attribute: 'occupancyDelay',   minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+            {attribute: 'zoneEpReports',    minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
         ]);
         await ep1.configureReporting('ld2450Config', [
             {attribute: 'fallbackEnable',   minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
@@ -652,6 +904,13 @@ const definitionC6 = {
             {attribute: 'heartbeatEnable',  minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
             {attribute: 'heartbeatInterval',minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
         ]);
+        await ep1.configureReporting('ld2450Config', [
+            {attribute: 'coordDeadband',    minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+            {attribute: 'coordMinInterval', minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+            {attribute: 'rateBurst',        minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+            {attribute: 'rateSustained',    minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+            {attribute: 'hwFilterMode',     minimumReportInterval: 0, maximumReportInterval: 3600, reportableChange: 0},
+        ]);
         /* Zone config attrs — each zone on its own EP, one call per EP */
         for (let n = 0; n < 10; n++) {
             const zoneEp = device.getEndpoint(n + 2);